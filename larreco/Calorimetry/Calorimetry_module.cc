@@ -41,8 +41,8 @@
 #include <TVector3.h>
 
 // Framework includes
-#include "art/Framework/Core/EDProducer.h"
 #include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Core/SharedProducer.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Handle.h"
 #include "art/Framework/Services/Registry/ServiceHandle.h"
@@ -85,13 +85,13 @@ namespace calo {
    *
    *
    */
-  class Calorimetry : public art::EDProducer {
+  class Calorimetry : public art::SharedProducer {
 
   public:
-    explicit Calorimetry(fhicl::ParameterSet const& pset);
+    explicit Calorimetry(fhicl::ParameterSet const& pset, art::ProcessingFrame const&);
 
   private:
-    void produce(art::Event& evt) override;
+    void produce(art::Event& evt, art::ProcessingFrame const&) override;
     void ReadCaloTree();
 
     bool BeginsOnBoundary(art::Ptr<recob::Track> lar_track);
@@ -106,7 +106,7 @@ namespace calo {
                   std::vector<double> const& trkx0,
                   double* xyz3d,
                   double& pitch,
-                  double TickT0);
+                  double TickT0) const;
 
     std::string fTrackModuleLabel;
     std::string fSpacePointModuleLabel;
@@ -119,26 +119,13 @@ namespace calo {
                                            // at the track start
     CalorimetryAlg caloAlg;
 
-    int fnsps;
-    std::vector<int> fwire;
-    std::vector<double> ftime;
-    std::vector<double> fstime;
-    std::vector<double> fetime;
-    std::vector<double> fMIPs;
-    std::vector<double> fdQdx;
-    std::vector<double> fdEdx;
-    std::vector<double> fResRng;
-    std::vector<float> fpitch;
-    std::vector<TVector3> fXYZ;
-    std::vector<size_t> fHitIndex;
-
   }; // class Calorimetry
 
 }
 
 //-------------------------------------------------
-calo::Calorimetry::Calorimetry(fhicl::ParameterSet const& pset)
-  : EDProducer{pset}
+calo::Calorimetry::Calorimetry(fhicl::ParameterSet const& pset, art::ProcessingFrame const&)
+  : SharedProducer{pset}
   , fTrackModuleLabel(pset.get<std::string>("TrackModuleLabel"))
   , fSpacePointModuleLabel(pset.get<std::string>("SpacePointModuleLabel"))
   , fT0ModuleLabel(pset.get<std::string>("T0ModuleLabel"))
@@ -147,6 +134,8 @@ calo::Calorimetry::Calorimetry(fhicl::ParameterSet const& pset)
   , fFlipTrack_dQdx(pset.get<bool>("FlipTrack_dQdx", true))
   , caloAlg(pset.get<fhicl::ParameterSet>("CaloAlg"))
 {
+  // The per track arrays are local to produce() so events can be processed concurrently
+  async<art::InEvent>();
 
   if (pset.has_key("NotOnTrackZcut")) fNotOnTrackZcut = pset.get<double>("NotOnTrackZcut");
 
@@ -155,7 +144,7 @@ calo::Calorimetry::Calorimetry(fhicl::ParameterSet const& pset)
 }
 
 //------------------------------------------------------------------------------------//
-void calo::Calorimetry::produce(art::Event& evt)
+void calo::Calorimetry::produce(art::Event& evt, art::ProcessingFrame const&)
 {
   auto const clock_data = art::ServiceHandle<detinfo::DetectorClocksService const>()->DataFor(evt);
   auto const det_prop =
@@ -223,17 +212,17 @@ void calo::Calorimetry::produce(art::Event& evt)
 
       geo::PlaneID planeID; //(cstat,tpc,ipl);
 
-      fwire.clear();
-      ftime.clear();
-      fstime.clear();
-      fetime.clear();
-      fMIPs.clear();
-      fdQdx.clear();
-      fdEdx.clear();
-      fpitch.clear();
-      fResRng.clear();
-      fXYZ.clear();
-      fHitIndex.clear();
+      std::vector<int> hitWires;
+      std::vector<double> hitTimes;
+      std::vector<double> hitSTimes;
+      std::vector<double> hitETimes;
+      std::vector<double> hitMIPs;
+      std::vector<double> hitdQdx;
+      std::vector<double> hitdEdx;
+      std::vector<double> hitResRng;
+      std::vector<float> hitPitch;
+      std::vector<TVector3> hitXYZ;
+      std::vector<size_t> hitIndices;
 
       float Kin_En = 0.;
       float Trk_Length = 0.;
@@ -255,7 +244,7 @@ void calo::Calorimetry::produce(art::Event& evt)
                                      vresRange,
                                      deadwire,
                                      util::kBogusD,
-                                     fpitch,
+                                     hitPitch,
                                      recob::tracking::convertCollToPoint(vXYZ),
                                      planeID);
         util::CreateAssn(evt, *calorimetrycol, tracklist[trkIter], *assn);
@@ -275,7 +264,7 @@ void calo::Calorimetry::produce(art::Event& evt)
       double DSChg = 0;
       // temp array holding distance betweeen space points
       std::vector<double> spdelta;
-      fnsps = 0; // number of space points
+      int nsps = 0; // number of space points
       std::vector<double> ChargeBeg;
       std::stack<double> ChargeEnd;
 
@@ -453,7 +442,7 @@ void calo::Calorimetry::produce(art::Event& evt)
         if (pitch <= 0) pitch = fTrkPitch;
         if (!pitch) continue;
 
-        if (fnsps == 0) {
+        if (nsps == 0) {
           xx = xyz3d[0];
           yy = xyz3d[1];
           zz = xyz3d[2];
@@ -488,38 +477,38 @@ void calo::Calorimetry::produce(art::Event& evt)
         if (allHits[hits[ipl][ihit]]->WireID().Wire > wire1)
           wire1 = allHits[hits[ipl][ihit]]->WireID().Wire;
 
-        fMIPs.push_back(MIPs);
-        fdEdx.push_back(dEdx);
-        fdQdx.push_back(dQdx);
-        fwire.push_back(wire);
-        ftime.push_back(time);
-        fstime.push_back(stime);
-        fetime.push_back(etime);
-        fpitch.push_back(pitch);
+        hitMIPs.push_back(MIPs);
+        hitdEdx.push_back(dEdx);
+        hitdQdx.push_back(dQdx);
+        hitWires.push_back(wire);
+        hitTimes.push_back(time);
+        hitSTimes.push_back(stime);
+        hitETimes.push_back(etime);
+        hitPitch.push_back(pitch);
         TVector3 v(xyz3d[0], xyz3d[1], xyz3d[2]);
-        fXYZ.push_back(v);
-        fHitIndex.push_back(hitIndex);
-        ++fnsps;
+        hitXYZ.push_back(v);
+        hitIndices.push_back(hitIndex);
+        ++nsps;
       }
-      if (fnsps < 2) {
+      if (nsps < 2) {
         vdEdx.clear();
         vdQdx.clear();
         vresRange.clear();
         deadwire.clear();
-        fpitch.clear();
+        hitPitch.clear();
         calorimetrycol->push_back(anab::Calorimetry(util::kBogusD,
                                                     vdEdx,
                                                     vdQdx,
                                                     vresRange,
                                                     deadwire,
                                                     util::kBogusD,
-                                                    fpitch,
+                                                    hitPitch,
                                                     recob::tracking::convertCollToPoint(vXYZ),
                                                     planeID));
         util::CreateAssn(evt, *calorimetrycol, tracklist[trkIter], *assn);
         continue;
       }
-      for (int isp = 0; isp < fnsps; ++isp) {
+      for (int isp = 0; isp < nsps; ++isp) {
         if (isp > 3) break;
         USChg += ChargeBeg[isp];
       }
@@ -536,7 +525,7 @@ void calo::Calorimetry::produce(art::Event& evt)
       }
       else {
         // Use the track direction to determine the residual range
-        if (!fXYZ.empty()) {
+        if (!hitXYZ.empty()) {
           TVector3 track_start(tracklist[trkIter]->Trajectory().Vertex().X(),
                                tracklist[trkIter]->Trajectory().Vertex().Y(),
                                tracklist[trkIter]->Trajectory().Vertex().Z());
@@ -544,8 +533,8 @@ void calo::Calorimetry::produce(art::Event& evt)
                              tracklist[trkIter]->Trajectory().End().Y(),
                              tracklist[trkIter]->Trajectory().End().Z());
 
-          if ((fXYZ[0] - track_start).Mag() + (fXYZ.back() - track_end).Mag() <
-              (fXYZ[0] - track_end).Mag() + (fXYZ.back() - track_start).Mag()) {
+          if ((hitXYZ[0] - track_start).Mag() + (hitXYZ.back() - track_end).Mag() <
+              (hitXYZ[0] - track_end).Mag() + (hitXYZ.back() - track_start).Mag()) {
             GoingDS = true;
           }
           else {
@@ -555,54 +544,54 @@ void calo::Calorimetry::produce(art::Event& evt)
       }
 
       // determine the starting residual range and fill the array
-      fResRng.resize(fnsps);
-      if (fResRng.size() < 2 || spdelta.size() < 2) {
+      hitResRng.resize(nsps);
+      if (hitResRng.size() < 2 || spdelta.size() < 2) {
         mf::LogWarning("Calorimetry")
-          << "fResrng.size() = " << fResRng.size() << " spdelta.size() = " << spdelta.size();
+          << "fResrng.size() = " << hitResRng.size() << " spdelta.size() = " << spdelta.size();
       }
       if (GoingDS) {
-        fResRng[fnsps - 1] = spdelta[fnsps - 1] / 2;
-        for (int isp = fnsps - 2; isp > -1; isp--) {
-          fResRng[isp] = fResRng[isp + 1] + spdelta[isp + 1];
+        hitResRng[nsps - 1] = spdelta[nsps - 1] / 2;
+        for (int isp = nsps - 2; isp > -1; isp--) {
+          hitResRng[isp] = hitResRng[isp + 1] + spdelta[isp + 1];
         }
       }
       else {
-        fResRng[0] = spdelta[1] / 2;
-        for (int isp = 1; isp < fnsps; isp++) {
-          fResRng[isp] = fResRng[isp - 1] + spdelta[isp];
+        hitResRng[0] = spdelta[1] / 2;
+        for (int isp = 1; isp < nsps; isp++) {
+          hitResRng[isp] = hitResRng[isp - 1] + spdelta[isp];
         }
       }
 
       MF_LOG_DEBUG("CaloPrtHit") << " pt wire  time  ResRng    MIPs   pitch   dE/dx    Ai X Y Z\n";
 
       double Ai = -1;
-      for (int i = 0; i < fnsps; ++i) { //loop over all 3D points
-        vresRange.push_back(fResRng[i]);
-        vdEdx.push_back(fdEdx[i]);
-        vdQdx.push_back(fdQdx[i]);
-        vXYZ.push_back(fXYZ[i]);
-        if (i != 0 && i != fnsps - 1) { // ignore the first and last point
+      for (int i = 0; i < nsps; ++i) { //loop over all 3D points
+        vresRange.push_back(hitResRng[i]);
+        vdEdx.push_back(hitdEdx[i]);
+        vdQdx.push_back(hitdQdx[i]);
+        vXYZ.push_back(hitXYZ[i]);
+        if (i != 0 && i != nsps - 1) { // ignore the first and last point
           // Calculate PIDA
-          Ai = fdEdx[i] * pow(fResRng[i], 0.42);
+          Ai = hitdEdx[i] * pow(hitResRng[i], 0.42);
           nPIDA++;
           PIDA += Ai;
         }
 
         MF_LOG_DEBUG("CaloPrtHit")
           << std::setw(4) << trkIter << std::setw(4) << ipl << std::setw(4) << i << std::setw(4)
-          << fwire[i] << std::setw(6) << (int)ftime[i]
+          << hitWires[i] << std::setw(6) << (int)hitTimes[i]
           << std::setiosflags(std::ios::fixed | std::ios::showpoint) << std::setprecision(2)
-          << std::setw(8) << fResRng[i] << std::setprecision(1) << std::setw(8) << fMIPs[i]
-          << std::setprecision(2) << std::setw(8) << fpitch[i] << std::setw(8) << fdEdx[i]
-          << std::setw(8) << Ai << std::setw(8) << fXYZ[i].x() << std::setw(8) << fXYZ[i].y()
-          << std::setw(8) << fXYZ[i].z() << "\n";
+          << std::setw(8) << hitResRng[i] << std::setprecision(1) << std::setw(8) << hitMIPs[i]
+          << std::setprecision(2) << std::setw(8) << hitPitch[i] << std::setw(8) << hitdEdx[i]
+          << std::setw(8) << Ai << std::setw(8) << hitXYZ[i].x() << std::setw(8) << hitXYZ[i].y()
+          << std::setw(8) << hitXYZ[i].z() << "\n";
       } // end looping over 3D points
       if (nPIDA > 0) { PIDA = PIDA / (double)nPIDA; }
       else {
         PIDA = -1;
       }
       MF_LOG_DEBUG("CaloPrtTrk") << "Plane # " << ipl << "TrkPitch= " << std::setprecision(2)
-                                 << fTrkPitch << " nhits= " << fnsps << "\n"
+                                 << fTrkPitch << " nhits= " << nsps << "\n"
                                  << std::setiosflags(std::ios::fixed | std::ios::showpoint)
                                  << "Trk Length= " << std::setprecision(1) << Trk_Length << " cm,"
                                  << " KE calo= " << std::setprecision(1) << Kin_En << " MeV,"
@@ -659,9 +648,9 @@ void calo::Calorimetry::produce(art::Event& evt)
                                                   vresRange,
                                                   deadwire,
                                                   Trk_Length,
-                                                  fpitch,
+                                                  hitPitch,
                                                   recob::tracking::convertCollToPoint(vXYZ),
-                                                  fHitIndex,
+                                                  hitIndices,
                                                   planeID));
       util::CreateAssn(evt, *calorimetrycol, tracklist[trkIter], *assn);
 
@@ -681,7 +670,7 @@ void calo::Calorimetry::GetPitch(detinfo::DetectorPropertiesData const& det_prop
                                  std::vector<double> const& trkx0,
                                  double* xyz3d,
                                  double& pitch,
-                                 double TickT0)
+                                 double TickT0) const
 {
   // Get 3d coordinates and track pitch for each hit
   // Find 5 nearest space points and determine xyz and curvature->track pitch
@@ -77,6 +77,7 @@
 #include "larreco/RecoAlg/Cluster3DAlgs/IHit3DBuilder.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/PCASeedFinderAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/ParallelHitsSeedFinderAlg.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/PooledAllocator.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/PrincipalComponentsAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/SkeletonAlg.h"
 #include "larreco/RecoAlg/ClusterParamsImportWrapper.h"
@@ -612,6 +613,9 @@ namespace lar_cluster3d {
     // This really only does anything if we are monitoring since it clears our tree variables
     this->PrepareEvent(evt);
 
+    // Give the list nodes of this event back to the heap once the lists below are gone
+    reco::PooledMemoryScope pooledMemoryScope;
+
     // Get instances of the primary data structures needed
     reco::ClusterParametersList clusterParametersList;
     IHit3DBuilder::RecobHitToPtrMap clusterHitToArtPtrMap;
@@ -7,10 +7,11 @@
 // from cetlib version v3_03_01.
 ////////////////////////////////////////////////////////////////////////
 
-#include "art/Framework/Core/EDProducer.h"
 #include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Core/SharedProducer.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Principal/Run.h"
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "canvas/Utilities/InputTag.h"
 #include "fhiclcpp/ParameterSet.h"
@@ -24,19 +25,20 @@
 #include "lardataobj/RecoBase/SpacePoint.h"
 #include "larreco/RecoAlg/DBScan3DAlg.h"
 
+#include <atomic>
 #include <memory>
 
 namespace cluster {
   class DBCluster3D;
 }
 
-class cluster::DBCluster3D : public art::EDProducer {
+class cluster::DBCluster3D : public art::SharedProducer {
 
   using Point_t = recob::tracking::Point_t;
   using Vector_t = recob::tracking::Vector_t;
 
 public:
-  explicit DBCluster3D(fhicl::ParameterSet const& p);
+  explicit DBCluster3D(fhicl::ParameterSet const& p, art::ProcessingFrame const&);
   // The compiler-generated destructor is fine for non-base
   // classes without bare pointers or other resource use.
 
@@ -48,28 +50,37 @@ public:
 
 private:
   // Required functions.
-  void produce(art::Event& e) override;
+  void produce(art::Event& e, art::ProcessingFrame const&) override;
+
+  // Selected optional functions.
+  void beginRun(art::Run const& r, art::ProcessingFrame const&) override;
 
   const art::InputTag fHitModuleLabel;
   const art::InputTag fSpacePointModuleLabel;
   const art::InputTag fSPHitAssnLabel;
 
+  // Configured prototype, copied for each event so that events can run concurrently.
+  // The copies share its bad channel map, which is built once in beginRun
   DBScan3DAlg fDBScan;
 
   geo::GeometryCore const* fGeom;
 
   double tickToDist;
   double fMinHitDis;
+
+  std::atomic<bool> fCheckedAssns{false};
 };
 
-cluster::DBCluster3D::DBCluster3D(fhicl::ParameterSet const& p)
-  : EDProducer{p}
+cluster::DBCluster3D::DBCluster3D(fhicl::ParameterSet const& p, art::ProcessingFrame const&)
+  : SharedProducer{p}
   , fHitModuleLabel(p.get<art::InputTag>("HitModuleLabel"))
   , fSpacePointModuleLabel(p.get<art::InputTag>("SpacePointModuleLabel"))
   , fSPHitAssnLabel(p.get<art::InputTag>("SPHitAssnLabel"))
   , fDBScan(p.get<fhicl::ParameterSet>("DBScan3DAlg"))
   , fMinHitDis(p.get<double>("MinHitDis"))
 {
+  async<art::InEvent>();
+
   produces<std::vector<recob::Slice>>();
   produces<art::Assns<recob::Slice, recob::Hit>>();
   produces<art::Assns<recob::Slice, recob::SpacePoint>>();
@@ -84,7 +95,13 @@ cluster::DBCluster3D::DBCluster3D(fhicl::ParameterSet const& p)
   fMinHitDis *= fMinHitDis;
 }
 
-void cluster::DBCluster3D::produce(art::Event& evt)
+void cluster::DBCluster3D::beginRun(art::Run const&, art::ProcessingFrame const&)
+{
+  // no events are in flight at a run transition
+  fDBScan.build_badchannelmap();
+}
+
+void cluster::DBCluster3D::produce(art::Event& evt, art::ProcessingFrame const&)
 {
   auto scol = std::make_unique<std::vector<recob::Slice>>();
   auto slc_hit_assn = std::make_unique<art::Assns<recob::Slice, recob::Hit>>();
@@ -107,8 +124,7 @@ void cluster::DBCluster3D::produce(art::Event& evt)
     return;
   }
   // Find the first Hit - SpacePoint assn and check consistency on the first event
-  static bool first = true;
-  if (first) {
+  if (!fCheckedAssns) {
     bool success = false;
     bool foundsps = false;
     for (auto& hit : hits) {
@@ -121,7 +137,7 @@ void cluster::DBCluster3D::produce(art::Event& evt)
     if ((!success) && foundsps)
       throw cet::exception("DBCluster3D")
         << "HitModuleLabel, SpacePointModuleLabel and SPHitAssnLabel are inconsistent\n";
-    first = false;
+    fCheckedAssns = true;
   } // first
 
   art::FindManyP<recob::Hit> hitFromSp(spsHandle, evt, fSPHitAssnLabel);
@@ -129,13 +145,14 @@ void cluster::DBCluster3D::produce(art::Event& evt)
     std::cout << "hitFromSp is invalid\n";
     return;
   }
-  fDBScan.init(sps, hitFromSp);
-  fDBScan.dbscan();
+  DBScan3DAlg dbscan{fDBScan};
+  dbscan.init(sps, hitFromSp);
+  dbscan.dbscan();
 
   //Find number of slices
   int maxid = INT_MIN;
-  for (size_t i = 0; i < fDBScan.points.size(); ++i) {
-    if (fDBScan.points[i].cluster_id > maxid) maxid = fDBScan.points[i].cluster_id;
+  for (size_t i = 0; i < dbscan.points.size(); ++i) {
+    if (dbscan.points[i].cluster_id > maxid) maxid = dbscan.points[i].cluster_id;
   }
   size_t nslc = 0;
   if (maxid >= 0) nslc = maxid + 1;
@@ -147,10 +164,10 @@ void cluster::DBCluster3D::produce(art::Event& evt)
   for (auto& hit : hits) {
     auto& sps = spFromHit.at(hit.key());
     if (sps.size()) { //found associated space point
-      if (fDBScan.points[sps[0].key()].cluster_id >= 0) {
-        slcHits[fDBScan.points[sps[0].key()].cluster_id].push_back(hit);
+      if (dbscan.points[sps[0].key()].cluster_id >= 0) {
+        slcHits[dbscan.points[sps[0].key()].cluster_id].push_back(hit);
         hitmap[geo::PlaneID(hit->WireID())].push_back(
-          std::make_pair(hit, fDBScan.points[sps[0].key()].cluster_id));
+          std::make_pair(hit, dbscan.points[sps[0].key()].cluster_id));
       }
     } // sps.size()
   }   // hit
@@ -186,9 +203,9 @@ void cluster::DBCluster3D::produce(art::Event& evt)
 
   //Save spacepoints for each slice
   std::vector<std::vector<art::Ptr<recob::SpacePoint>>> sps_in_slc(nslc);
-  for (size_t i = 0; i < fDBScan.points.size(); ++i) {
-    if (fDBScan.points[i].cluster_id >= 0) {
-      sps_in_slc[fDBScan.points[i].cluster_id].push_back(sps[i]);
+  for (size_t i = 0; i < dbscan.points.size(); ++i) {
+    if (dbscan.points[i].cluster_id >= 0) {
+      sps_in_slc[dbscan.points[i].cluster_id].push_back(sps[i]);
     }
   } // i
 
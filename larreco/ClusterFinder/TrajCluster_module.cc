@@ -10,9 +10,10 @@
 #include <string>
 
 // Framework libraries
-#include "art/Framework/Core/EDProducer.h"
 #include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Core/SharedProducer.h"
 #include "art/Framework/Principal/Event.h"
+#include "art/Utilities/SharedResource.h"
 #include "art_root_io/TFileService.h"
 #include "canvas/Persistency/Common/FindManyP.h"
 #include "canvas/Utilities/InputTag.h"
@@ -52,15 +53,17 @@ namespace cluster {
    * - *TrajClusterAlg* (parameter set, mandatory): full configuration for
    *   TrajClusterAlg algorithm
    *
+   * Events are reconstructed concurrently unless the algorithm is configured
+   * in debug mode or to save the shower tree.
    */
-  class TrajCluster : public art::EDProducer {
+  class TrajCluster : public art::SharedProducer {
   public:
-    explicit TrajCluster(fhicl::ParameterSet const& pset);
+    explicit TrajCluster(fhicl::ParameterSet const& pset, art::ProcessingFrame const&);
 
   private:
-    void produce(art::Event& evt) override;
-    void beginJob() override;
-    void endJob() override;
+    void produce(art::Event& evt, art::ProcessingFrame const&) override;
+    void beginJob(art::ProcessingFrame const&) override;
+    void endJob(art::ProcessingFrame const&) override;
 
     tca::TrajClusterAlg fTCAlg; // define TrajClusterAlg object
     TTree* showertree;
@@ -132,9 +135,14 @@ namespace cluster {
   } // SortHits
 
   //----------------------------------------------------------------------------
-  TrajCluster::TrajCluster(fhicl::ParameterSet const& pset)
-    : EDProducer{pset}, fTCAlg{pset.get<fhicl::ParameterSet>("TrajClusterAlg")}
+  TrajCluster::TrajCluster(fhicl::ParameterSet const& pset, art::ProcessingFrame const&)
+    : SharedProducer{pset}, fTCAlg{pset.get<fhicl::ParameterSet>("TrajClusterAlg")}
   {
+    // debugging and the shower tree use state that is shared by all events
+    if (fTCAlg.SerialOnly())
+      serialize<art::InEvent>(art::SharedResource<art::TFileService>);
+    else
+      async<art::InEvent>();
     fHitModuleLabel = "NA";
     if (pset.has_key("HitModuleLabel")) fHitModuleLabel = pset.get<art::InputTag>("HitModuleLabel");
     fSliceModuleLabel = "NA";
@@ -187,7 +195,7 @@ namespace cluster {
   } // TrajCluster::TrajCluster()
 
   //----------------------------------------------------------------------------
-  void TrajCluster::beginJob()
+  void TrajCluster::beginJob(art::ProcessingFrame const&)
   {
     art::ServiceHandle<art::TFileService const> tfs;
 
@@ -196,7 +204,7 @@ namespace cluster {
   }
 
   //----------------------------------------------------------------------------
-  void TrajCluster::endJob()
+  void TrajCluster::endJob(art::ProcessingFrame const&)
   {
     std::vector<unsigned int> const& fAlgModCount = fTCAlg.GetAlgModCount();
     std::vector<std::string> const& fAlgBitNames = fTCAlg.GetAlgBitNames();
@@ -217,7 +225,7 @@ namespace cluster {
   }   // endJob
 
   //----------------------------------------------------------------------------
-  void TrajCluster::produce(art::Event& evt)
+  void TrajCluster::produce(art::Event& evt, art::ProcessingFrame const&)
   {
     // Get a single hit collection from a HitsModuleLabel or multiple sets of "sliced" hits
     // (aka clusters of hits that are close to each other in 3D) from a SliceModuleLabel.
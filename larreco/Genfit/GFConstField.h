@@ -47,6 +47,9 @@ namespace genf {
     //! return value at position
     TVector3 get(const TVector3& pos) const;
 
+    //! whether the field vanishes everywhere
+    bool isZero() const { return fF1 == 0. && fF2 == 0. && fF3 == 0.; }
+
   private:
     double fF1, fF2, fF3;
   };
@@ -24,6 +24,7 @@
 #define GFFIELDMANAGER_H
 
 #include "GFAbsBField.h"
+#include "GFConstField.h"
 #include <iostream>
 
 /** @brief Singleton which provides access to magnetic field for track representations
@@ -69,6 +70,13 @@ namespace genf {
       return fField->get(x);
     }
 
+    //! whether the field is a constant null field, in which tracks are straight lines
+    static bool isZeroField()
+    {
+      auto const* constField = dynamic_cast<const GFConstField*>(fField);
+      return constField && constField->isZero();
+    }
+
     //! set the magntic field here. Magnetic field classes must be derived from GFAbsBField
     void init(GFAbsBField* b) { fField = b; }
 
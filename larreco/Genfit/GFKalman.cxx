@@ -27,6 +27,7 @@
 #include "larreco/Genfit/GFAbsRecoHit.h"
 #include "larreco/Genfit/GFAbsTrackRep.h"
 #include "larreco/Genfit/GFException.h"
+#include "larreco/Genfit/GFMatrixTypes.h"
 #include "larreco/Genfit/GFTrack.h"
 
 #include "art/Framework/Services/Registry/ServiceHandle.h"
@@ -669,7 +670,7 @@ TMatrixT<Double_t> genf::GFKalman::calcCov7x7(const TMatrixT<Double_t>& cov,
                                               const GFDetPlane& plane)
 {
   // This ends up, confusingly, as: 7 columns, 5 rows!
-  TMatrixT<Double_t> jac(7, 5); // X,Y,Z,UX,UY,UZ,Theta in detector coords
+  GFMatrix75 jac; // X,Y,Z,UX,UY,UZ,Theta in detector coords
 
   TVector3 u = plane.getU();
   TVector3 v = plane.getV();
@@ -681,7 +682,6 @@ TMatrixT<Double_t> genf::GFKalman::calcCov7x7(const TMatrixT<Double_t>& cov,
   TVector3 pTilde = w;
   double pTildeMag = pTilde.Mag();
 
-  jac.Zero();
   jac[6][0] = 1.; //  Should be C as in GFSpacepointHitPolicy. 16-Feb-2013.
 
   jac[0][3] = u[0];
@@ -705,26 +705,25 @@ TMatrixT<Double_t> genf::GFKalman::calcCov7x7(const TMatrixT<Double_t>& cov,
   // y = A.x => x = A^T.A.A^T.y
   // Thus, y's Jacobians Jac become for x (Jac^T.Jac)^(-1) Jac^T
 
-  TMatrixT<Double_t> jac_t(TMatrixT<Double_t>::kTransposed, jac);
-  TMatrixT<Double_t> jjInv(jac_t * jac);
-  //jInv.Zero();
+  const GFMatrix57 jac_t = ROOT::Math::Transpose(jac);
+  GFMatrix55 jjInv = jac_t * jac;
 
   double det(0.0);
-  try {
-    jjInv.Invert(&det); // this is all 1s on the diagonal, perhaps
-                        // to no one's surprise.
+  jjInv.Det2(det);
+  if (TMath::IsNaN(det)) {
+    throw GFException("GFKalman: det of Jac.T*Jac is nan", __LINE__, __FILE__).setFatal();
   }
-  catch (cet::exception&) {
+  if (!jjInv.Invert()) { // this is all 1s on the diagonal, perhaps
+                         // to no one's surprise.
     throw GFException(
       "GFKalman: Jac.T*Jac is not invertible. But keep plowing on ... ", __LINE__, __FILE__)
       .setFatal();
   }
-  if (TMath::IsNaN(det)) {
-    throw GFException("GFKalman: det of Jac.T*Jac is nan", __LINE__, __FILE__).setFatal();
-  }
 
-  TMatrixT<Double_t> j5x7 = jjInv * jac_t;
-  TMatrixT<Double_t> c7x7 = j5x7.T() * (cov * j5x7);
+  const GFMatrix57 j5x7 = jjInv * jac_t;
+  TMatrixT<Double_t> c7x7(7, 7);
+  const GFMatrix57 covJ = toSMatrix<5, 5>(cov) * j5x7;
+  toTMatrix(GFMatrix77(ROOT::Math::Transpose(j5x7) * covJ), c7x7);
   return c7x7;
 }
 
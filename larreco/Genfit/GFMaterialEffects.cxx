@@ -20,6 +20,7 @@
 #include "larreco/Genfit/GFMaterialEffects.h"
 
 #include <math.h>
+#include <mutex>
 
 #include "larreco/Genfit/GFException.h"
 
@@ -27,6 +28,7 @@
 #include "TGeoManager.h"
 #include "TGeoMaterial.h"
 #include "TGeoMedium.h"
+#include "TGeoNavigator.h"
 #include "TGeoVolume.h"
 #include "TMatrixT.h"
 #include "TMatrixTBase.h"
@@ -34,6 +36,70 @@
 #include "TParticlePDG.h"
 
 genf::GFMaterialEffects* genf::GFMaterialEffects::finstance = NULL;
+std::mutex genf::GFMaterialEffects::finstanceMutex;
+
+namespace {
+  // State of the stepping along the current track, with the straight segment inside a
+  // single volume that it was last found in, the material and particle parameters and
+  // the quantities computed from them. The material effects are a process-wide singleton
+  // shared by all the fits, so everything changing from one call to the next is kept per
+  // thread; the singleton only holds the configuration.
+  struct StepState {
+    bool uniformMedium = false;
+
+    TGeoManager* navGeoManager = nullptr; // geometry navigated by navigator
+    TGeoNavigator* navigator = nullptr;   // owned by navGeoManager
+
+    TVector3 trackPos;
+    TVector3 trackDir;
+    TGeoMedium* medium = nullptr;  // medium at trackPos
+    bool inSegment = false;        // trackPos is in the cached segment
+    bool navigatorAtTrack = false; // navigator is at trackPos
+
+    TGeoManager* segGeoManager = nullptr;
+    TVector3 segStart;
+    TVector3 segDir;
+    double segLength = 0;
+    double segOffset = 0; // position of trackPos along the segment
+    TGeoMedium* segMedium = nullptr;
+
+    TGeoMaterial* material = nullptr;
+    int particlePdg = 0;
+
+    double step = 0; // stepsize
+
+    // cached values for energy loss and noise calculations
+    double beta = 0;
+    double dedx = 0;
+    double gamma = 0;
+    double gammaSquare = 0;
+
+    double matDensity = 0;
+    double matZ = 0;
+    double matA = 0;
+    double radiationLength = 0;
+    double mEE = 0; // mean excitation energy
+
+    int pdg = 0;
+    double charge = 0; // of particlePdg
+    double mass = 0;   // of particlePdg
+  };
+
+  thread_local StepState gStep;
+
+  // Navigator of this thread in the current geometry: TGeoManager's own navigator is
+  // shared by all the threads unless the geometry was set up for several of them
+  TGeoNavigator* navigator()
+  {
+    if (gStep.navGeoManager != gGeoManager) {
+      static std::mutex navigatorMutex; // adding a navigator is not thread-safe
+      std::lock_guard<std::mutex> lock(navigatorMutex);
+      gStep.navigator = gGeoManager->AddNavigator();
+      gStep.navGeoManager = gGeoManager;
+    }
+    return gStep.navigator;
+  }
+}
 
 genf::GFMaterialEffects::~GFMaterialEffects()
 {
@@ -59,29 +125,19 @@ genf::GFMaterialEffects::GFMaterialEffects()
   , fEnergyLossBrems(true)
   , fNoiseBrems(true)
   , me(0.510998910E-3)
-  , fstep(0)
-  , fbeta(0)
-  , fdedx(0)
-  , fgamma(0)
-  , fgammaSquare(0)
-  , fmatDensity(0)
-  , fmatZ(0)
-  , fmatA(0)
-  , fradiationLength(0)
-  , fmEE(0)
-  , fpdg(0)
-  , fcharge(0)
-  , fmass(0)
+  , fCacheSegments(true)
 {}
 
 genf::GFMaterialEffects* genf::GFMaterialEffects::getInstance()
 {
+  std::lock_guard<std::mutex> lock(finstanceMutex);
   if (finstance == NULL) finstance = new GFMaterialEffects();
   return finstance;
 }
 
 void genf::GFMaterialEffects::destruct()
 {
+  std::lock_guard<std::mutex> lock(finstanceMutex);
   if (finstance != NULL) {
     delete finstance;
     finstance = NULL;
@@ -96,11 +152,13 @@ double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
                                         TMatrixT<Double_t>* noise,
                                         const TMatrixT<Double_t>* jacobian,
                                         const TVector3* directionBefore,
-                                        const TVector3* directionAfter)
+                                        const TVector3* directionAfter,
+                                        bool uniformMedium)
 {
 
   //assert(points.size()==pointPaths.size());
-  fpdg = pdg;
+  gStep.pdg = pdg;
+  gStep.uniformMedium = uniformMedium;
 
   double momLoss = 0.;
 
@@ -121,12 +179,7 @@ double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
       double step;
       */
 
-      gGeoManager->InitTrack(points.at(i - 1).X(),
-                             points.at(i - 1).Y(),
-                             points.at(i - 1).Z(),
-                             dir.X(),
-                             dir.Y(),
-                             dir.Z());
+      initTrack(points.at(i - 1), dir);
 
       while (X < dist) {
 
@@ -134,11 +187,10 @@ double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
         //        geoMatManager->getMaterialParameters(matDensity, matZ, matA, radiationLength, mEE);
 
         //        step = geoMatManager->stepOrNextBoundary(dist-X);
-        gGeoManager->FindNextBoundaryAndStep(dist - X);
-        fstep = gGeoManager->GetStep();
+        gStep.step = nextStep(dist - X);
 
         // Loop over EnergyLoss classes
-        if (fmatZ > 1.E-3) {
+        if (gStep.matZ > 1.E-3) {
           /*
           for(unsigned int j=0;j<fEnergyLoss.size();++j){
             momLoss += realPath/dist*fEnergyLoss.at(j)->energyLoss(step,
@@ -169,7 +221,7 @@ double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
           if (doNoise && fEnergyLossBrems && fNoiseBrems) this->noiseBrems(mom, noise);
         }
 
-        X += fstep;
+        X += gStep.step;
       }
     }
   }
@@ -185,12 +237,15 @@ double genf::GFMaterialEffects::stepper(const double& maxDist,
                                         const double& diry,
                                         const double& dirz,
                                         const double& mom,
-                                        const int& /* pdg */)
+                                        const int& /* pdg */,
+                                        bool uniformMedium)
 {
 
   static const double maxPloss = .005; // maximum relative momentum loss allowed
 
-  gGeoManager->InitTrack(posx, posy, posz, dirx, diry, dirz);
+  gStep.uniformMedium = uniformMedium;
+
+  initTrack(TVector3(posx, posy, posz), TVector3(dirx, diry, dirz));
 
   double X(0.);
   double dP = 0.;
@@ -204,14 +259,13 @@ double genf::GFMaterialEffects::stepper(const double& maxDist,
 
     getParameters();
 
-    gGeoManager->FindNextBoundaryAndStep(maxDist - X);
-    fstep = gGeoManager->GetStep();
+    gStep.step = nextStep(maxDist - X);
     //
     //    step = geoMatManager->stepOrNextBoundary(maxDist-X);
 
     // Loop over EnergyLoss classes
 
-    if (fmatZ > 1.E-3) {
+    if (gStep.matZ > 1.E-3) {
       /*
       for(unsigned int j=0;j<fEnergyLoss.size();++j){
         momLoss += fEnergyLoss.at(j)->energyLoss(step,
@@ -237,52 +291,142 @@ double genf::GFMaterialEffects::stepper(const double& maxDist,
         throw GFException(std::string(__func__) + ": invalid fraction", __LINE__, __FILE__)
           .setFatal();
       dP += fraction * momLoss;
-      X += fraction * fstep;
+      X += fraction * gStep.step;
       break;
     }
 
     dP += momLoss;
-    X += fstep;
+    X += gStep.step;
   }
 
   return X;
 }
 
+void genf::GFMaterialEffects::initTrack(const TVector3& pos, const TVector3& dir)
+{
+  static const double dirTolerance = 1.E-9;
+  static const double posTolerance = 1.E-5; // cm
+
+  gStep.trackPos = pos;
+  gStep.trackDir = dir;
+  if (gStep.uniformMedium) return;
+
+  // is the point on the cached segment, going the same way?
+  if (fCacheSegments && gStep.segGeoManager == gGeoManager &&
+      (dir - gStep.segDir).Mag2() < dirTolerance * dirTolerance) {
+    double t = (pos - gStep.segStart) * gStep.segDir;
+    if (t >= 0. && t < gStep.segLength &&
+        (pos - gStep.segStart - t * gStep.segDir).Mag2() < posTolerance * posTolerance) {
+      gStep.segOffset = t;
+      gStep.medium = gStep.segMedium;
+      gStep.inSegment = true;
+      gStep.navigatorAtTrack = false;
+      return;
+    }
+  }
+
+  navigator()->InitTrack(pos.X(), pos.Y(), pos.Z(), dir.X(), dir.Y(), dir.Z());
+  gStep.medium = navigator()->GetCurrentVolume()->GetMedium();
+  gStep.inSegment = false;
+  gStep.navigatorAtTrack = true;
+}
+
+double genf::GFMaterialEffects::nextStep(double maxStep)
+{
+  // steps ending closer than this to a boundary are left to TGeo
+  static const double boundaryMargin = 1.E-4; // cm
+
+  if (gStep.uniformMedium) return maxStep;
+
+  if (fCacheSegments) {
+    if (!gStep.inSegment) { // find the segment to the boundary of the current volume
+      if (!gStep.navigatorAtTrack) {
+        navigator()->InitTrack(gStep.trackPos.X(),
+                               gStep.trackPos.Y(),
+                               gStep.trackPos.Z(),
+                               gStep.trackDir.X(),
+                               gStep.trackDir.Y(),
+                               gStep.trackDir.Z());
+        gStep.navigatorAtTrack = true;
+      }
+      navigator()->FindNextBoundary();
+      gStep.segGeoManager = gGeoManager;
+      gStep.segStart = gStep.trackPos;
+      gStep.segDir = gStep.trackDir;
+      gStep.segLength = navigator()->GetStep();
+      gStep.segOffset = 0.;
+      gStep.segMedium = gStep.medium;
+      gStep.inSegment = true;
+    }
+
+    if (gStep.segLength - gStep.segOffset > maxStep + boundaryMargin) { // stays in the segment
+      gStep.segOffset += maxStep;
+      gStep.trackPos += maxStep * gStep.trackDir;
+      gStep.navigatorAtTrack = false;
+      return maxStep;
+    }
+  }
+
+  // the step may cross the boundary (or segments are not cached): let TGeo step
+  if (!gStep.navigatorAtTrack)
+    navigator()->InitTrack(gStep.trackPos.X(),
+                           gStep.trackPos.Y(),
+                           gStep.trackPos.Z(),
+                           gStep.trackDir.X(),
+                           gStep.trackDir.Y(),
+                           gStep.trackDir.Z());
+  navigator()->FindNextBoundaryAndStep(maxStep);
+  const double* point = navigator()->GetCurrentPoint();
+  gStep.trackPos.SetXYZ(point[0], point[1], point[2]);
+  gStep.medium = navigator()->GetCurrentVolume()->GetMedium();
+  gStep.inSegment = false;
+  gStep.navigatorAtTrack = true;
+  return navigator()->GetStep();
+}
+
 void genf::GFMaterialEffects::getParameters()
 {
-  if (!gGeoManager->GetCurrentVolume()->GetMedium())
-    throw GFException(std::string(__func__) + ": no medium", __LINE__, __FILE__).setFatal();
-  TGeoMaterial* mat = gGeoManager->GetCurrentVolume()->GetMedium()->GetMaterial();
-  fmatDensity = mat->GetDensity();
-  fmatZ = mat->GetZ();
-  fmatA = mat->GetA();
-  fradiationLength = mat->GetRadLen();
-  fmEE = MeanExcEnergy_get(mat);
+  if (!gStep.uniformMedium) {
+    if (!gStep.medium)
+      throw GFException(std::string(__func__) + ": no medium", __LINE__, __FILE__).setFatal();
+    TGeoMaterial* mat = gStep.medium->GetMaterial();
+    if (mat != gStep.material) {
+      gStep.material = mat;
+      gStep.matDensity = mat->GetDensity();
+      gStep.matZ = mat->GetZ();
+      gStep.matA = mat->GetA();
+      gStep.radiationLength = mat->GetRadLen();
+      gStep.mEE = MeanExcEnergy_get(mat);
+    }
+  }
 
   // You know what? F*ck it. Just force this to be LAr.... is what I *could/will* say here ....
-  // See comment in energyLossBetheBloch() for why fmEE is in eV here.
-  fmatDensity = 1.40;
-  fmatZ = 18.0;
-  fmatA = 39.95;
-  fradiationLength = 13.947;
-  fmEE = 188.0;
-
-  TParticlePDG* part = TDatabasePDG::Instance()->GetParticle(fpdg);
-  fcharge = part->Charge() / (3.);
-  fmass = part->Mass();
+  // See comment in energyLossBetheBloch() for why gStep.mEE is in eV here.
+  gStep.matDensity = 1.40;
+  gStep.matZ = 18.0;
+  gStep.matA = 39.95;
+  gStep.radiationLength = 13.947;
+  gStep.mEE = 188.0;
+
+  if (gStep.pdg != gStep.particlePdg) {
+    TParticlePDG* part = TDatabasePDG::Instance()->GetParticle(gStep.pdg);
+    gStep.charge = part->Charge() / (3.);
+    gStep.mass = part->Mass();
+    gStep.particlePdg = gStep.pdg;
+  }
 }
 
 void genf::GFMaterialEffects::calcBeta(double mom)
 {
-  fbeta = mom / sqrt(fmass * fmass + mom * mom);
+  gStep.beta = mom / sqrt(gStep.mass * gStep.mass + mom * mom);
 
   //for numerical stability
-  fgammaSquare = 1. - fbeta * fbeta;
-  if (fgammaSquare > 1.E-10)
-    fgammaSquare = 1. / fgammaSquare;
+  gStep.gammaSquare = 1. - gStep.beta * gStep.beta;
+  if (gStep.gammaSquare > 1.E-10)
+    gStep.gammaSquare = 1. / gStep.gammaSquare;
   else
-    fgammaSquare = 1.E10;
-  fgamma = sqrt(fgammaSquare);
+    gStep.gammaSquare = 1.E10;
+  gStep.gamma = sqrt(gStep.gammaSquare);
 }
 
 //---- Energy-loss and Noise calculations -----------------------------------------
@@ -290,34 +434,34 @@ void genf::GFMaterialEffects::calcBeta(double mom)
 double genf::GFMaterialEffects::energyLossBetheBloch(const double& mom)
 {
 
-  // calc fdedx, also needed in noiseBetheBloch!
-  fdedx = 0.307075 * fmatZ / fmatA * fmatDensity / (fbeta * fbeta) * fcharge * fcharge;
-  double massRatio = me / fmass;
-  // me=0.000511 here is in GeV. So fmEE must come in here in eV to get converted to MeV.
+  // calc gStep.dedx, also needed in noiseBetheBloch!
+  gStep.dedx = 0.307075 * gStep.matZ / gStep.matA * gStep.matDensity / (gStep.beta * gStep.beta) * gStep.charge * gStep.charge;
+  double massRatio = me / gStep.mass;
+  // me=0.000511 here is in GeV. So gStep.mEE must come in here in eV to get converted to MeV.
   double argument =
-    fgammaSquare * fbeta * fbeta * me * 1.E3 * 2. /
-    ((1.E-6 * fmEE) * sqrt(1 + 2 * sqrt(fgammaSquare) * massRatio + massRatio * massRatio));
+    gStep.gammaSquare * gStep.beta * gStep.beta * me * 1.E3 * 2. /
+    ((1.E-6 * gStep.mEE) * sqrt(1 + 2 * sqrt(gStep.gammaSquare) * massRatio + massRatio * massRatio));
 
-  if (fmass == 0.0) return (0.0);
-  if (argument <= exp(fbeta * fbeta)) {
-    fdedx = 0.;
+  if (gStep.mass == 0.0) return (0.0);
+  if (argument <= exp(gStep.beta * gStep.beta)) {
+    gStep.dedx = 0.;
     // so-called Anderson-Ziegler domain ... Let's approximate it with a flat
     // 100 MeV/cm, looking at the muon dE/dx curve in the PRD Review, or, ahem, wikipedia.
     // http://pdg.lbl.gov/2011/reviews/rpp2011-rev-passage-particles-matter.pdf
     // But there's a practical problem: must not reduce momentum to zero for tracking in G3,
     // so allow only 50% reduction of kinetic energy.
-    //      fdedx = 100.0*1.E-3/fstep;  // in GeV/cm, hence 1.e-3
-    //if (fdedx > 0.5*0.5*fmass*fbeta*fbeta/fstep) fdedx = 0.5*0.5*fmass*fbeta*fbeta/fstep;
+    //      gStep.dedx = 100.0*1.E-3/gStep.step;  // in GeV/cm, hence 1.e-3
+    //if (gStep.dedx > 0.5*0.5*gStep.mass*gStep.beta*gStep.beta/gStep.step) gStep.dedx = 0.5*0.5*gStep.mass*gStep.beta*gStep.beta/gStep.step;
   }
   else {
-    fdedx *= (log(argument) - fbeta * fbeta); // Bethe-Bloch [MeV/cm]
-    fdedx *= 1.E-3;                           // in GeV/cm, hence 1.e-3
-    if (fdedx < 0.) fdedx = 0;
+    gStep.dedx *= (log(argument) - gStep.beta * gStep.beta); // Bethe-Bloch [MeV/cm]
+    gStep.dedx *= 1.E-3;                           // in GeV/cm, hence 1.e-3
+    if (gStep.dedx < 0.) gStep.dedx = 0;
   }
 
-  double DE = fstep * fdedx; //always positive
+  double DE = gStep.step * gStep.dedx; //always positive
   double momLoss =
-    sqrt(mom * mom + 2. * sqrt(mom * mom + fmass * fmass) * DE + DE * DE) - mom; //always positive
+    sqrt(mom * mom + 2. * sqrt(mom * mom + gStep.mass * gStep.mass) * DE + DE * DE) - mom; //always positive
 
   //in vacuum it can numerically happen that momLoss becomes a small negative number. A cut-off at 0.01 eV for momentum loss seems reasonable
   if (fabs(momLoss) < 1.E-11) momLoss = 1.E-11;
@@ -332,37 +476,37 @@ void genf::GFMaterialEffects::noiseBetheBloch(const double& mom, TMatrixT<double
   // ENERGY LOSS FLUCTUATIONS; calculate sigma^2(E);
   double sigma2E = 0.;
   double zeta =
-    153.4E3 * fcharge * fcharge / (fbeta * fbeta) * fmatZ / fmatA * fmatDensity * fstep; // eV
-  double Emax = 2.E9 * me * fbeta * fbeta * fgammaSquare /
-                (1. + 2. * fgamma * me / fmass + (me / fmass) * (me / fmass)); // eV
+    153.4E3 * gStep.charge * gStep.charge / (gStep.beta * gStep.beta) * gStep.matZ / gStep.matA * gStep.matDensity * gStep.step; // eV
+  double Emax = 2.E9 * me * gStep.beta * gStep.beta * gStep.gammaSquare /
+                (1. + 2. * gStep.gamma * me / gStep.mass + (me / gStep.mass) * (me / gStep.mass)); // eV
   double kappa = zeta / Emax;
 
   if (kappa > 0.01) {                                   // Vavilov-Gaussian regime
-    sigma2E += zeta * Emax * (1. - fbeta * fbeta / 2.); // eV^2
+    sigma2E += zeta * Emax * (1. - gStep.beta * gStep.beta / 2.); // eV^2
   }
   else { // Urban/Landau approximation
     double alpha = 0.996;
     double sigmaalpha = 15.76;
     // calculate number of collisions Nc
-    double I = 16. * pow(fmatZ, 0.9); // eV
+    double I = 16. * pow(gStep.matZ, 0.9); // eV
     double f2 = 0.;
-    if (fmatZ > 2.) f2 = 2. / fmatZ;
+    if (gStep.matZ > 2.) f2 = 2. / gStep.matZ;
     double f1 = 1. - f2;
-    double e2 = 10. * fmatZ * fmatZ;             // eV
+    double e2 = 10. * gStep.matZ * gStep.matZ;             // eV
     double e1 = pow((I / pow(e2, f2)), 1. / f1); // eV
 
-    double mbbgg2 = 2.E9 * fmass * fbeta * fbeta * fgammaSquare; // eV
-    double Sigma1 = fdedx * 1.0E9 * f1 / e1 * (log(mbbgg2 / e1) - fbeta * fbeta) /
-                    (log(mbbgg2 / I) - fbeta * fbeta) * 0.6; // 1/cm
-    double Sigma2 = fdedx * 1.0E9 * f2 / e2 * (log(mbbgg2 / e2) - fbeta * fbeta) /
-                    (log(mbbgg2 / I) - fbeta * fbeta) * 0.6;                             // 1/cm
-    double Sigma3 = fdedx * 1.0E9 * Emax / (I * (Emax + I) * log((Emax + I) / I)) * 0.4; // 1/cm
+    double mbbgg2 = 2.E9 * gStep.mass * gStep.beta * gStep.beta * gStep.gammaSquare; // eV
+    double Sigma1 = gStep.dedx * 1.0E9 * f1 / e1 * (log(mbbgg2 / e1) - gStep.beta * gStep.beta) /
+                    (log(mbbgg2 / I) - gStep.beta * gStep.beta) * 0.6; // 1/cm
+    double Sigma2 = gStep.dedx * 1.0E9 * f2 / e2 * (log(mbbgg2 / e2) - gStep.beta * gStep.beta) /
+                    (log(mbbgg2 / I) - gStep.beta * gStep.beta) * 0.6;                             // 1/cm
+    double Sigma3 = gStep.dedx * 1.0E9 * Emax / (I * (Emax + I) * log((Emax + I) / I)) * 0.4; // 1/cm
 
-    double Nc = (Sigma1 + Sigma2 + Sigma3) * fstep;
+    double Nc = (Sigma1 + Sigma2 + Sigma3) * gStep.step;
 
     if (Nc > 50.) { // truncated Landau distribution
       // calculate sigmaalpha  (see GEANT3 manual W5013)
-      double RLAMED = -0.422784 - fbeta * fbeta - log(zeta / Emax);
+      double RLAMED = -0.422784 - gStep.beta * gStep.beta - log(zeta / Emax);
       double RLAMAX =
         0.60715 + 1.1934 * RLAMED + (0.67794 + 0.052382 * RLAMED) * exp(0.94753 + 0.74442 * RLAMED);
       // from lambda max to sigmaalpha=sigma (empirical polynomial)
@@ -381,14 +525,14 @@ void genf::GFMaterialEffects::noiseBetheBloch(const double& mom, TMatrixT<double
     else {                                                                         // Urban model
       double Ealpha = I / (1. - (alpha * Emax / (Emax + I)));                      // eV
       double meanE32 = I * (Emax + I) / Emax * (Ealpha - I);                       // eV^2
-      sigma2E += fstep * (Sigma1 * e1 * e1 + Sigma2 * e2 * e2 + Sigma3 * meanE32); // eV^2
+      sigma2E += gStep.step * (Sigma1 * e1 * e1 + Sigma2 * e2 * e2 + Sigma3 * meanE32); // eV^2
     }
   }
 
   sigma2E *= 1.E-18; // eV -> GeV
 
   // update noise matrix
-  (*noise)[6][6] += (mom * mom + fmass * fmass) / pow(mom, 6.) * sigma2E;
+  (*noise)[6][6] += (mom * mom + gStep.mass * gStep.mass) / pow(mom, 6.) * sigma2E;
 }
 
 void genf::GFMaterialEffects::noiseCoulomb(const double& mom,
@@ -401,13 +545,13 @@ void genf::GFMaterialEffects::noiseCoulomb(const double& mom,
   // MULTIPLE SCATTERING; calculate sigma^2
   // PANDA report PV/01-07 eq(43); linear in step length
   double sigma2 =
-    225.E-6 / (fbeta * fbeta * mom * mom) * fstep / fradiationLength * fmatZ / (fmatZ + 1) *
-    log(159. * pow(fmatZ, -1. / 3.)) /
+    225.E-6 / (gStep.beta * gStep.beta * mom * mom) * gStep.step / gStep.radiationLength * gStep.matZ / (gStep.matZ + 1) *
+    log(159. * pow(gStep.matZ, -1. / 3.)) /
     log(
       287. *
       pow(
-        fmatZ,
-        -0.5)); // sigma^2 = 225E-6/mom^2 * XX0/fbeta^2 * Z/(Z+1) * ln(159*Z^(-1/3))/ln(287*Z^(-1/2)
+        gStep.matZ,
+        -0.5)); // sigma^2 = 225E-6/mom^2 * XX0/gStep.beta^2 * Z/(Z+1) * ln(159*Z^(-1/3))/ln(287*Z^(-1/2)
 
   // noiseBefore
   TMatrixT<double> noiseBefore(7, 7);
@@ -508,7 +652,7 @@ void genf::GFMaterialEffects::noiseCoulomb(const double& mom,
 double genf::GFMaterialEffects::energyLossBrems(const double& mom) const
 {
 
-  if (fabs(fpdg) != 11) return 0; // only for electrons and positrons
+  if (fabs(gStep.pdg) != 11) return 0; // only for electrons and positrons
 
 #if !defined(BETHE)
   static const double C[101] = {
@@ -550,7 +694,7 @@ double genf::GFMaterialEffects::energyLossBrems(const double& mom) const
     -0.193843E-08, 0.211839E-10,  0.157544E-04,  -0.304104E-05, -0.624410E-06, 0.120124E-06,
     -0.457445E-08, -0.188222E-05, -0.407118E-06, 0.375106E-06,  -0.466881E-07, 0.158312E-08,
     0.945037E-07,  0.564718E-07,  -0.319231E-07, 0.371926E-08,  -0.123111E-09};
-  static const double xi = 2.10, fbeta = 1.00, vl = 0.001;
+  static const double xi = 2.10, gStep.beta = 1.00, vl = 0.001;
 #endif
 
   double BCUT = 10000.; // energy up to which soft bremsstrahlung energy loss is calculated
@@ -636,16 +780,16 @@ double genf::GFMaterialEffects::energyLossBrems(const double& mom) const
       YY = YY * Y;
     }
 
-    S = S + fmatZ * SS;
+    S = S + gStep.matZ * SS;
 
     if (S > 0.) {
       double CORR = 1.;
 #if !defined(BETHE)
-      CORR = 1. / (1. + 0.805485E-10 * fmatDensity * fmatZ * E * E /
-                          (fmatA * kc * kc)); // MIGDAL correction factor
+      CORR = 1. / (1. + 0.805485E-10 * gStep.matDensity * gStep.matZ * E * E /
+                          (gStep.matA * kc * kc)); // MIGDAL correction factor
 #endif
 
-      double FAC = fmatZ * (fmatZ + xi) * E * E * pow((kc * CORR / T), beta) / (E + me);
+      double FAC = gStep.matZ * (gStep.matZ + xi) * E * E * pow((kc * CORR / T), beta) / (E + me);
       if (FAC <= 0.) return 0.;
       dedxBrems = FAC * S;
 
@@ -667,7 +811,7 @@ double genf::GFMaterialEffects::energyLossBrems(const double& mom) const
         dedxBrems = dedxBrems * S; // GeV barn
       }
 
-      dedxBrems = 0.60221367 * fmatDensity * dedxBrems / fmatA; // energy loss dE/dx [GeV/cm]
+      dedxBrems = 0.60221367 * gStep.matDensity * dedxBrems / gStep.matA; // energy loss dE/dx [GeV/cm]
     }
   }
 
@@ -675,12 +819,12 @@ double genf::GFMaterialEffects::energyLossBrems(const double& mom) const
 
   double factor = 1.; // positron correction factor
 
-  if (fpdg == -11) {
+  if (gStep.pdg == -11) {
     static const double AA = 7522100., A1 = 0.415, A3 = 0.0021, A5 = 0.00054;
 
     double ETA = 0.;
-    if (fmatZ > 0.) {
-      double X = log(AA * mom / fmatZ * fmatZ);
+    if (gStep.matZ > 0.) {
+      double X = log(AA * mom / gStep.matZ * gStep.matZ);
       if (X > -8.) {
         if (X >= +9.)
           ETA = 1.;
@@ -707,9 +851,9 @@ double genf::GFMaterialEffects::energyLossBrems(const double& mom) const
     }
   }
 
-  double DE = fstep * factor * dedxBrems; //always positive
+  double DE = gStep.step * factor * dedxBrems; //always positive
   double momLoss =
-    sqrt(mom * mom + 2. * sqrt(mom * mom + fmass * fmass) * DE + DE * DE) - mom; //always positive
+    sqrt(mom * mom + 2. * sqrt(mom * mom + gStep.mass * gStep.mass) * DE + DE * DE) - mom; //always positive
 
   return momLoss;
 }
@@ -717,16 +861,16 @@ double genf::GFMaterialEffects::energyLossBrems(const double& mom) const
 void genf::GFMaterialEffects::noiseBrems(const double& mom, TMatrixT<double>* noise) const
 {
 
-  if (fabs(fpdg) != 11) return; // only for electrons and positrons
+  if (fabs(gStep.pdg) != 11) return; // only for electrons and positrons
 
-  double LX = 1.442695 * fstep / fradiationLength;
+  double LX = 1.442695 * gStep.step / gStep.radiationLength;
   double S2B = mom * mom * (1. / pow(3., LX) - 1. / pow(4., LX));
   double DEDXB = pow(fabs(S2B), 0.5);
   DEDXB = 1.2E9 * DEDXB;          //eV
   double sigma2E = DEDXB * DEDXB; //eV^2
   sigma2E *= 1.E-18;              // eV -> GeV
 
-  (*noise)[6][6] += (mom * mom + fmass * fmass) / pow(mom, 6.) * sigma2E;
+  (*noise)[6][6] += (mom * mom + gStep.mass * gStep.mass) / pow(mom, 6.) * sigma2E;
 }
 
 /*
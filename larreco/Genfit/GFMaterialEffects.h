@@ -26,6 +26,7 @@
 
 #include "TObject.h"
 #include "TVector3.h"
+#include <mutex>
 #include <vector>
 
 class TGeoMaterial;
@@ -42,6 +43,11 @@ class TGeoMaterial;
  *  exceed a specified maximum momentum loss. After propagation, the energy loss
  *  for the given length and (optionally) the noise matrix can be calculated.
  *
+ *  The single instance only holds the configuration, which must be set before
+ *  the fits start. The stepping position, the material and particle parameters
+ *  and the TGeoNavigator used are kept per thread, so that fits may run on
+ *  several threads at once; TGeo itself also needs the geometry to be set up
+ *  for them (TGeoManager::SetMaxThreads).
  *
  */
 
@@ -52,6 +58,7 @@ namespace genf {
     GFMaterialEffects();
     virtual ~GFMaterialEffects();
     static GFMaterialEffects* finstance;
+    static std::mutex finstanceMutex;
 
   public:
     static GFMaterialEffects* getInstance();
@@ -62,8 +69,16 @@ namespace genf {
     void setNoiseCoulomb(bool opt = true) { fNoiseCoulomb = opt; }
     void setEnergyLossBrems(bool opt = true) { fEnergyLossBrems = opt; }
     void setNoiseBrems(bool opt = true) { fNoiseBrems = opt; }
+    //! Remember the straight segment to the next volume boundary (default), see nextStep()
+    /** The results are the same without the cache, only slower. */
+    void setCacheSegments(bool opt = true) { fCacheSegments = opt; }
 
     //! Calculates energy loss in the travelled path, optional calculation of noise matrix
+    /** With uniformMedium the whole detector is treated as a single medium, without
+     *  geometry navigation. The material parameters are forced to liquid argon in
+     *  getParameters() anyway; in this mode the steps are also not split at volume
+     *  boundaries, and TGeo is not used at all.
+     */
     double effects(const std::vector<TVector3>& points,
                    const std::vector<double>& pointPaths,
                    const double& mom,
@@ -72,10 +87,12 @@ namespace genf {
                    TMatrixT<Double_t>* noise = NULL,
                    const TMatrixT<Double_t>* jacobian = NULL,
                    const TVector3* directionBefore = NULL,
-                   const TVector3* directionAfter = NULL);
+                   const TVector3* directionAfter = NULL,
+                   bool uniformMedium = false);
 
     //! Returns maximum length so that a specified momentum loss will not be exceeded
     /**  The stepper returns the maximum length that the particle may travel, so that a specified relative momentum loss will not be exceeded.
+  *  See effects() for uniformMedium.
   */
     double stepper(const double& maxDist,
                    const double& posx,
@@ -85,14 +102,17 @@ namespace genf {
                    const double& diry,
                    const double& dirz,
                    const double& mom,
-                   const int& pdg);
+                   const int& pdg,
+                   bool uniformMedium = false);
     double stepper(const double& maxDist,
                    const TVector3& pos,
                    const TVector3& dir,
                    const double& mom,
-                   const int& pdg)
+                   const int& pdg,
+                   bool uniformMedium = false)
     {
-      return stepper(maxDist, pos.X(), pos.Y(), pos.Z(), dir.X(), dir.Y(), dir.Z(), mom, pdg);
+      return stepper(
+        maxDist, pos.X(), pos.Y(), pos.Z(), dir.X(), dir.Y(), dir.Z(), mom, pdg, uniformMedium);
     };
 
   private:
@@ -102,13 +122,23 @@ namespace genf {
     //GFGeoMatManager *geoMatManager;
     void getParameters();
 
-    //! sets fbeta, fgamma, fgammasquare; must only be used after calling getParameters()
+    //! Starts stepping from pos along the unit vector dir
+    void initTrack(const TVector3& pos, const TVector3& dir);
+
+    //! Returns the next step, limited to maxStep and to the current volume
+    /** The straight segment from the starting point to the boundary of its
+     *  volume is remembered (per thread), and steps within it do not navigate
+     *  the geometry. Almost all the steps of a track in a LArTPC are in the
+     *  same segment.
+     */
+    double nextStep(double maxStep);
+
+    //! sets beta, gamma and gamma squared; must only be used after calling getParameters()
     void calcBeta(double mom);
 
     //! Returns energy loss
     /**  Uses Bethe Bloch formula to calculate energy loss.
-    *  Calcuates and sets fdedx which needed also for noiseBetheBloch.
-    *  Therefore it is not a const function!
+    *  Calcuates and sets dE/dx which needed also for noiseBetheBloch.
     *
   */
     double energyLossBetheBloch(const double& mom);
@@ -120,7 +150,7 @@ namespace genf {
     *  - truncated Landau distribution
     *  - Urban model
     *
-    *  Needs fdedx, which is calculated in energyLossBetheBloch, so it has to be calles afterwards!
+    *  Needs dE/dx, which is calculated in energyLossBetheBloch, so it has to be calles afterwards!
     */
     void noiseBetheBloch(const double& mom, TMatrixT<double>* noise) const;
 
@@ -343,23 +373,7 @@ namespace genf {
 
     const double me; // electron mass (GeV)
 
-    double fstep; // stepsize
-
-    // cached values for energy loss and noise calculations
-    double fbeta;
-    double fdedx;
-    double fgamma;
-    double fgammaSquare;
-
-    double fmatDensity;
-    double fmatZ;
-    double fmatA;
-    double fradiationLength;
-    double fmEE; // mean excitation energy
-
-    int fpdg;
-    double fcharge;
-    double fmass;
+    bool fCacheSegments;
 
     // public:
     //classDef(GFMaterialEffects,1)
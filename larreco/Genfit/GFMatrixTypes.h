@@ -0,0 +1,51 @@
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef GFMATRIXTYPES_H
+#define GFMATRIXTYPES_H
+
+#include "Math/SMatrix.h"
+#include <TMatrixT.h>
+
+#include <cassert>
+
+/** @brief Fixed-size matrices for the track representation algebra
+ *
+ * The track representations keep their state and covariance in TMatrixT for
+ * the sake of the public interface, but the propagation and projection steps
+ * have dimensions known at compile time: 5 track parameters on a plane and 7
+ * global parameters (x, y, z, a_x, a_y, a_z, q/p) along the Runge-Kutta path.
+ * Doing that algebra with ROOT::Math::SMatrix avoids the heap allocation and
+ * the generic multiplication of TMatrixT for every temporary; the conversion
+ * helpers below copy from and to TMatrixT at the interface boundaries.
+ */
+namespace genf {
+
+  using GFMatrix55 = ROOT::Math::SMatrix<double, 5, 5>;
+  using GFMatrix57 = ROOT::Math::SMatrix<double, 5, 7>;
+  using GFMatrix75 = ROOT::Math::SMatrix<double, 7, 5>;
+  using GFMatrix77 = ROOT::Math::SMatrix<double, 7, 7>;
+
+  /// Copies a TMatrixT, which must have R rows and C columns, into an SMatrix
+  template <unsigned int R, unsigned int C>
+  ROOT::Math::SMatrix<double, R, C> toSMatrix(const TMatrixT<Double_t>& m)
+  {
+    assert(m.GetNrows() == (Int_t)R && m.GetNcols() == (Int_t)C);
+    // both store the elements row by row
+    return ROOT::Math::SMatrix<double, R, C>(m.GetMatrixArray(), R * C);
+  }
+
+  /// Copies an SMatrix into a TMatrixT, resizing it if needed
+  template <unsigned int R, unsigned int C>
+  void toTMatrix(const ROOT::Math::SMatrix<double, R, C>& s, TMatrixT<Double_t>& m)
+  {
+    if (m.GetNrows() != (Int_t)R || m.GetNcols() != (Int_t)C) m.ResizeTo(R, C);
+    m.SetMatrixArray(s.Array());
+  }
+
+} // namespace genf
+
+#endif
+
+/** @} */
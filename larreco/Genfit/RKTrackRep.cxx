@@ -28,6 +28,7 @@
 #include "larreco/Genfit/GFException.h"
 #include "larreco/Genfit/GFFieldManager.h"
 #include "larreco/Genfit/GFMaterialEffects.h"
+#include "larreco/Genfit/GFMatrixTypes.h"
 #include "larreco/Genfit/GFTrackCand.h"
 #include <algorithm> // std::fill
 #include <iostream>
@@ -470,8 +471,9 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
                                      TMatrixT<Double_t>& covPred)
 {
 
-  TMatrixT<Double_t> cov7x7(7, 7);
-  TMatrixT<Double_t> J_pM(7, 5);
+  // the jacobians and the covariances have fixed size: use SMatrix for the algebra
+  GFMatrix77 cov7x7;
+  GFMatrix75 J_pM;
 
   TVector3 o = fRefPlane.getO();
   TVector3 u = fRefPlane.getU();
@@ -502,23 +504,24 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
   // dqOp/dqOp
   J_pM[6][0] = 1.;
 
-  TMatrixT<Double_t> J_pM_transp(J_pM);
-  J_pM_transp.T();
+  const GFMatrix57 J_pM_transp = ROOT::Math::Transpose(J_pM);
 
-  cov7x7 = J_pM * (fCov * J_pM_transp);
-  if (cov7x7[0][0] >= 1000. || cov7x7[0][0] < 1.E-50) {
+  GFMatrix57 covJ = toSMatrix<5, 5>(fCov) * J_pM_transp;
+  cov7x7 = J_pM * covJ;
+  if (cov7x7(0, 0) >= 1000. || cov7x7(0, 0) < 1.E-50) {
     if (pOut) {
       (*pOut) << "RKTrackRep::extrapolate(): cov7x7[0][0] is crazy. Rescale off-diags. Try again. "
                  "fCov, cov7x7 were: "
               << std::endl;
       PrintROOTobject(*pOut, fCov);
-      PrintROOTobject(*pOut, cov7x7);
+      (*pOut) << cov7x7 << std::endl;
     }
     rescaleCovOffDiags();
-    cov7x7 = J_pM * (fCov * J_pM_transp);
+    covJ = toSMatrix<5, 5>(fCov) * J_pM_transp;
+    cov7x7 = J_pM * covJ;
     if (pOut) {
       (*pOut) << "New cov7x7 and fCov are ... " << std::endl;
-      PrintROOTobject(*pOut, cov7x7);
+      (*pOut) << cov7x7 << std::endl;
       PrintROOTobject(*pOut, fCov);
     }
   }
@@ -536,7 +539,10 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
   ;
   state7[6][0] = fState[0][0];
 
-  double coveredDistance = this->Extrap(pl, &state7, &cov7x7);
+  TMatrixT<Double_t> extrapCov(7, 7);
+  toTMatrix(cov7x7, extrapCov);
+  double coveredDistance = this->Extrap(pl, &state7, &extrapCov);
+  cov7x7 = toSMatrix<7, 7>(extrapCov);
 
   TVector3 O = pl.getO();
   TVector3 U = pl.getU();
@@ -552,7 +558,7 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
   double QOP = state7[6][0];
   TVector3 A(AX, AY, AZ);
   TVector3 Point(X, Y, Z);
-  TMatrixT<Double_t> J_Mp(5, 7);
+  GFMatrix57 J_Mp;
 
   // J_Mp matrix is d(q/p,u',v',u,v) / d(x,y,z,ax,ay,az,q/p)
   J_Mp[0][6] = 1.;
@@ -574,11 +580,8 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
   J_Mp[4][1] = V.Y();
   J_Mp[4][2] = V.Z();
 
-  TMatrixT<Double_t> J_Mp_transp(J_Mp);
-  J_Mp_transp.T();
-
-  covPred.ResizeTo(5, 5);
-  covPred = J_Mp * (cov7x7 * J_Mp_transp);
+  const GFMatrix75 covJ_Mp = cov7x7 * ROOT::Math::Transpose(J_Mp);
+  toTMatrix(GFMatrix55(J_Mp * covJ_Mp), covPred);
 
   statePred.ResizeTo(5, 1);
   statePred[0][0] = QOP;
@@ -712,6 +715,9 @@ bool genf::RKTrackRep::RKutta(const GFDetPlane& plane,
   points.clear();
   pointPaths.clear();
 
+  // in a null field the trajectory is a straight line, see the main cycle
+  const bool zeroField = GFFieldManager::isZeroField();
+
   if (fabs(fCharge / P[6]) < Pmin) {
     std::cerr << "RKTrackRep::RKutta ==> momentum too low: " << fabs(fCharge / P[6]) * 1000.
               << " MeV" << std::endl;
@@ -820,7 +826,8 @@ bool genf::RKTrackRep::RKutta(const GFDetPlane& plane,
                                                            Ssign * A[1],
                                                            Ssign * A[2],
                                                            fabs(fCharge / P[6]),
-                                                           fPdg);
+                                                           fPdg,
+                                                           fUniformMedium);
 
     //std::cout<< "RKTrackRep: S,R[0],R[1],R[2], A[0],A[1],A[2], stepperLen is " << S <<", "<< R[0] <<", "<< R[1]<<", " << R[2] <<", "<< A[0]<<", " << A[1]<<", " << A[2]<<", " << stepperLen << std::endl;
     if (stepperLen < MINSTEP)
@@ -834,150 +841,186 @@ bool genf::RKTrackRep::RKutta(const GFDetPlane& plane,
       stopBecauseOfMaterial = true;
     }
 
-    double H0[12], H1[12], H2[12], r[3];
-    double S3 = P3 * S, S4 = .25 * S, PS2 = Pinv * S;
-
-    //
-    // First point
-    //
-    r[0] = R[0];
-    r[1] = R[1];
-    r[2] = R[2];
-    TVector3 pos(r[0], r[1], r[2]);                     // vector of start coordinates R0	(x, y, z)
-    TVector3 H0vect = GFFieldManager::getFieldVal(pos); // magnetic field in 10^-4 T = kGauss
-    H0[0] = PS2 * H0vect.X();
-    H0[1] = PS2 * H0vect.Y();
-    H0[2] = PS2 * H0vect.Z(); // H0 is PS2*(Hx, Hy, Hz) @ R0
-    double A0 = A[1] * H0[2] - A[2] * H0[1], B0 = A[2] * H0[0] - A[0] * H0[2],
-           C0 = A[0] * H0[1] - A[1] * H0[0];               // (ax, ay, az) x H0
-    double A2 = A[0] + A0, B2 = A[1] + B0, C2 = A[2] + C0; // (A0, B0, C0) + (ax, ay, az)
-    double A1 = A2 + A[0], B1 = B2 + A[1], C1 = C2 + A[2]; // (A0, B0, C0) + 2*(ax, ay, az)
-
-    //
-    // Second point
-    //
-    r[0] += A1 * S4;
-    r[1] += B1 * S4;
-    r[2] += C1 * S4; //setup.Field(r,H1);
-    pos.SetXYZ(r[0], r[1], r[2]);
-    TVector3 H1vect = GFFieldManager::getFieldVal(pos);
-    H1[0] = H1vect.X() * PS2;
-    H1[1] = H1vect.Y() * PS2;
-    H1[2] = H1vect.Z() *
-            PS2; // H1 is PS2*(Hx, Hy, Hz) @ (x, y, z) + 0.25*S * [(A0, B0, C0) + 2*(ax, ay, az)]
-    double A3, B3, C3, A4, B4, C4, A5, B5, C5;
-    A3 = B2 * H1[2] - C2 * H1[1] + A[0];
-    B3 = C2 * H1[0] - A2 * H1[2] + A[1];
-    C3 = A2 * H1[1] - B2 * H1[0] + A[2]; // (A2, B2, C2) x H1 + (ax, ay, az)
-    A4 = B3 * H1[2] - C3 * H1[1] + A[0];
-    B4 = C3 * H1[0] - A3 * H1[2] + A[1];
-    C4 = A3 * H1[1] - B3 * H1[0] + A[2]; // (A3, B3, C3) x H1 + (ax, ay, az)
-    A5 = A4 - A[0] + A4;
-    B5 = B4 - A[1] + B4;
-    C5 = C4 - A[2] + C4; //    2*(A4, B4, C4) - (ax, ay, az)
-
-    //
-    // Last point
-    //
-    r[0] = R[0] + S * A4;
-    r[1] = R[1] + S * B4;
-    r[2] = R[2] + S * C4; //setup.Field(r,H2);
-    pos.SetXYZ(r[0], r[1], r[2]);
-    TVector3 H2vect = GFFieldManager::getFieldVal(pos);
-    H2[0] = H2vect.X() * PS2;
-    H2[1] = H2vect.Y() * PS2;
-    H2[2] = H2vect.Z() * PS2; // H2 is PS2*(Hx, Hy, Hz) @ (x, y, z) + 0.25*S * (A4, B4, C4)
-    double A6 = B5 * H2[2] - C5 * H2[1], B6 = C5 * H2[0] - A5 * H2[2],
-           C6 = A5 * H2[1] - B5 * H2[0]; // (A5, B5, C5) x H2
+    double EST = 0.; // approximation quality of the step, exact for a straight line
+    if (zeroField) {
+      //
+      // Straight line: the direction and its derivatives do not change along
+      // the step, so there is no field to sample and no stage to evaluate
+      //
+      if (calcCov) {
+        for (int i = 7; i != ND; i += 7) {
+          double* dR = &P[i];     // dR = (dX/dpN,  dY/dpN,  dZ/dpN)
+          double* dA = &P[i + 3]; // dA = (dAx/dpN, dAy/dpN, dAz/dpN)
+          dR[0] += dA[0] * S;
+          dR[1] += dA[1] * S;
+          dR[2] += dA[2] * S;
+        }
+      }
 
-    //
-    // Test approximation quality on given step and possible step reduction
-    //
-    double EST =
-      fabs((A1 + A6) - (A3 + A4)) + fabs((B1 + B6) - (B3 + B4)) +
-      fabs(
-        (C1 + C6) -
-        (C3 +
-         C4)); // EST = ||(ABC1+ABC6)-(ABC3+ABC4)||_1  =  ||(axzy x H0 + ABC5 x H2) - (ABC2 x H1 + ABC3 x H1)||_1
-    if (EST > DLT) {
-      S *= 0.5;
-      stopBecauseOfMaterial = false;
-      continue;
+      R[0] += A[0] * S;
+      R[1] += A[1] * S;
+      R[2] += A[2] * S;
+      SA[0] = SA[1] = SA[2] = 0.;
     }
+    else {
+      double H0[12], H1[12], H2[12], r[3];
+      double S3 = P3 * S, S4 = .25 * S, PS2 = Pinv * S;
+
+      //
+      // First point
+      //
+      r[0] = R[0];
+      r[1] = R[1];
+      r[2] = R[2];
+      TVector3 pos(r[0], r[1], r[2]);                     // vector of start coordinates R0	(x, y, z)
+      TVector3 H0vect = GFFieldManager::getFieldVal(pos); // magnetic field in 10^-4 T = kGauss
+      H0[0] = PS2 * H0vect.X();
+      H0[1] = PS2 * H0vect.Y();
+      H0[2] = PS2 * H0vect.Z(); // H0 is PS2*(Hx, Hy, Hz) @ R0
+      double A0 = A[1] * H0[2] - A[2] * H0[1], B0 = A[2] * H0[0] - A[0] * H0[2],
+             C0 = A[0] * H0[1] - A[1] * H0[0];               // (ax, ay, az) x H0
+      double A2 = A[0] + A0, B2 = A[1] + B0, C2 = A[2] + C0; // (A0, B0, C0) + (ax, ay, az)
+      double A1 = A2 + A[0], B1 = B2 + A[1], C1 = C2 + A[2]; // (A0, B0, C0) + 2*(ax, ay, az)
+
+      //
+      // Second point
+      //
+      r[0] += A1 * S4;
+      r[1] += B1 * S4;
+      r[2] += C1 * S4; //setup.Field(r,H1);
+      pos.SetXYZ(r[0], r[1], r[2]);
+      TVector3 H1vect = GFFieldManager::getFieldVal(pos);
+      H1[0] = H1vect.X() * PS2;
+      H1[1] = H1vect.Y() * PS2;
+      H1[2] = H1vect.Z() *
+              PS2; // H1 is PS2*(Hx, Hy, Hz) @ (x, y, z) + 0.25*S * [(A0, B0, C0) + 2*(ax, ay, az)]
+      double A3, B3, C3, A4, B4, C4, A5, B5, C5;
+      A3 = B2 * H1[2] - C2 * H1[1] + A[0];
+      B3 = C2 * H1[0] - A2 * H1[2] + A[1];
+      C3 = A2 * H1[1] - B2 * H1[0] + A[2]; // (A2, B2, C2) x H1 + (ax, ay, az)
+      A4 = B3 * H1[2] - C3 * H1[1] + A[0];
+      B4 = C3 * H1[0] - A3 * H1[2] + A[1];
+      C4 = A3 * H1[1] - B3 * H1[0] + A[2]; // (A3, B3, C3) x H1 + (ax, ay, az)
+      A5 = A4 - A[0] + A4;
+      B5 = B4 - A[1] + B4;
+      C5 = C4 - A[2] + C4; //    2*(A4, B4, C4) - (ax, ay, az)
+
+      //
+      // Last point
+      //
+      r[0] = R[0] + S * A4;
+      r[1] = R[1] + S * B4;
+      r[2] = R[2] + S * C4; //setup.Field(r,H2);
+      pos.SetXYZ(r[0], r[1], r[2]);
+      TVector3 H2vect = GFFieldManager::getFieldVal(pos);
+      H2[0] = H2vect.X() * PS2;
+      H2[1] = H2vect.Y() * PS2;
+      H2[2] = H2vect.Z() * PS2; // H2 is PS2*(Hx, Hy, Hz) @ (x, y, z) + 0.25*S * (A4, B4, C4)
+      double A6 = B5 * H2[2] - C5 * H2[1], B6 = C5 * H2[0] - A5 * H2[2],
+             C6 = A5 * H2[1] - B5 * H2[0]; // (A5, B5, C5) x H2
+
+      //
+      // Test approximation quality on given step and possible step reduction
+      //
+      EST =
+        fabs((A1 + A6) - (A3 + A4)) + fabs((B1 + B6) - (B3 + B4)) +
+        fabs(
+          (C1 + C6) -
+          (C3 +
+           C4)); // EST = ||(ABC1+ABC6)-(ABC3+ABC4)||_1  =  ||(axzy x H0 + ABC5 x H2) - (ABC2 x H1 + ABC3 x H1)||_1
+      if (EST > DLT) {
+        S *= 0.5;
+        stopBecauseOfMaterial = false;
+        continue;
+      }
 
-    //
-    // Derivatives of track parameters in last point
-    //
-    if (calcCov) {
-      for (int i = 7; i != ND;
-           i += 7) { // i = 7, 14, 21, 28, 35, 42, 49;    ND = 56;	ND1 = 49; rows of Jacobian
-
-        double* dR = &P[i];     // dR = (dX/dpN,  dY/dpN,  dZ/dpN)
-        double* dA = &P[i + 3]; // dA = (dAx/dpN, dAy/dpN, dAz/dpN); N = X,Y,Z,Ax,Ay,Az,q/p
-
-        //first point
-        double dA0 = H0[2] * dA[1] - H0[1] * dA[2]; // dA0/dp	}
-        double dB0 = H0[0] * dA[2] - H0[2] * dA[0]; // dB0/dp	 } = dA x H0
-        double dC0 = H0[1] * dA[0] - H0[0] * dA[1]; // dC0/dp	}
-
-        if (i == ND1) {
-          dA0 += A0;
-          dB0 += B0;
-          dC0 += C0;
-        } // if last row: (dA0, dB0, dC0) := (dA0, dB0, dC0) + (A0, B0, C0)
-
-        double dA2 = dA0 + dA[0]; // }
-        double dB2 = dB0 + dA[1]; //  } = (dA0, dB0, dC0) + dA
-        double dC2 = dC0 + dA[2]; // }
-
-        //second point
-        double dA3 = dA[0] + dB2 * H1[2] - dC2 * H1[1]; // dA3/dp	}
-        double dB3 =
-          dA[1] + dC2 * H1[0] - dA2 * H1[2];            // dB3/dp	 } = dA + (dA2, dB2, dC2) x H1
-        double dC3 = dA[2] + dA2 * H1[1] - dB2 * H1[0]; // dC3/dp	}
-
-        if (i == ND1) {
-          dA3 += A3 - A[0];
-          dB3 += B3 - A[1];
-          dC3 += C3 - A[2];
-        } // if last row: (dA3, dB3, dC3) := (dA3, dB3, dC3) + (A3, B3, C3) - (ax, ay, az)
-
-        double dA4 = dA[0] + dB3 * H1[2] - dC3 * H1[1]; // dA4/dp	}
-        double dB4 =
-          dA[1] + dC3 * H1[0] - dA3 * H1[2];            // dB4/dp	 } = dA + (dA3, dB3, dC3) x H1
-        double dC4 = dA[2] + dA3 * H1[1] - dB3 * H1[0]; // dC4/dp	}
-
-        if (i == ND1) {
-          dA4 += A4 - A[0];
-          dB4 += B4 - A[1];
-          dC4 += C4 - A[2];
-        } // if last row: (dA4, dB4, dC4) := (dA4, dB4, dC4) + (A4, B4, C4) - (ax, ay, az)
-
-        //last point
-        double dA5 = dA4 + dA4 - dA[0]; // }
-        double dB5 = dB4 + dB4 - dA[1]; //  } =  2*(dA4, dB4, dC4) - dA
-        double dC5 = dC4 + dC4 - dA[2]; // }
-
-        double dA6 = dB5 * H2[2] - dC5 * H2[1]; // dA6/dp	}
-        double dB6 = dC5 * H2[0] - dA5 * H2[2]; // dB6/dp	 } = (dA5, dB5, dC5) x H2
-        double dC6 = dA5 * H2[1] - dB5 * H2[0]; // dC6/dp	}
-
-        if (i == ND1) {
-          dA6 += A6;
-          dB6 += B6;
-          dC6 += C6;
-        } // if last row: (dA6, dB6, dC6) := (dA6, dB6, dC6) + (A6, B6, C6)
-
-        dR[0] += (dA2 + dA3 + dA4) * S3;
-        dA[0] = (dA0 + dA3 + dA3 + dA5 + dA6) *
-                P3; // dR := dR + S3*[(dA2, dB2, dC2) +   (dA3, dB3, dC3) + (dA4, dB4, dC4)]
-        dR[1] += (dB2 + dB3 + dB4) * S3;
-        dA[1] =
-          (dB0 + dB3 + dB3 + dB5 + dB6) *
-          P3; // dA :=     1/3*[(dA0, dB0, dC0) + 2*(dA3, dB3, dC3) + (dA5, dB5, dC5) + (dA6, dB6, dC6)]
-        dR[2] += (dC2 + dC3 + dC4) * S3;
-        dA[2] = (dC0 + dC3 + dC3 + dC5 + dC6) * P3;
+      //
+      // Derivatives of track parameters in last point
+      //
+      if (calcCov) {
+        for (int i = 7; i != ND;
+             i += 7) { // i = 7, 14, 21, 28, 35, 42, 49;    ND = 56;	ND1 = 49; rows of Jacobian
+
+          double* dR = &P[i];     // dR = (dX/dpN,  dY/dpN,  dZ/dpN)
+          double* dA = &P[i + 3]; // dA = (dAx/dpN, dAy/dpN, dAz/dpN); N = X,Y,Z,Ax,Ay,Az,q/p
+
+          //first point
+          double dA0 = H0[2] * dA[1] - H0[1] * dA[2]; // dA0/dp	}
+          double dB0 = H0[0] * dA[2] - H0[2] * dA[0]; // dB0/dp	 } = dA x H0
+          double dC0 = H0[1] * dA[0] - H0[0] * dA[1]; // dC0/dp	}
+
+          if (i == ND1) {
+            dA0 += A0;
+            dB0 += B0;
+            dC0 += C0;
+          } // if last row: (dA0, dB0, dC0) := (dA0, dB0, dC0) + (A0, B0, C0)
+
+          double dA2 = dA0 + dA[0]; // }
+          double dB2 = dB0 + dA[1]; //  } = (dA0, dB0, dC0) + dA
+          double dC2 = dC0 + dA[2]; // }
+
+          //second point
+          double dA3 = dA[0] + dB2 * H1[2] - dC2 * H1[1]; // dA3/dp	}
+          double dB3 =
+            dA[1] + dC2 * H1[0] - dA2 * H1[2];            // dB3/dp	 } = dA + (dA2, dB2, dC2) x H1
+          double dC3 = dA[2] + dA2 * H1[1] - dB2 * H1[0]; // dC3/dp	}
+
+          if (i == ND1) {
+            dA3 += A3 - A[0];
+            dB3 += B3 - A[1];
+            dC3 += C3 - A[2];
+          } // if last row: (dA3, dB3, dC3) := (dA3, dB3, dC3) + (A3, B3, C3) - (ax, ay, az)
+
+          double dA4 = dA[0] + dB3 * H1[2] - dC3 * H1[1]; // dA4/dp	}
+          double dB4 =
+            dA[1] + dC3 * H1[0] - dA3 * H1[2];            // dB4/dp	 } = dA + (dA3, dB3, dC3) x H1
+          double dC4 = dA[2] + dA3 * H1[1] - dB3 * H1[0]; // dC4/dp	}
+
+          if (i == ND1) {
+            dA4 += A4 - A[0];
+            dB4 += B4 - A[1];
+            dC4 += C4 - A[2];
+          } // if last row: (dA4, dB4, dC4) := (dA4, dB4, dC4) + (A4, B4, C4) - (ax, ay, az)
+
+          //last point
+          double dA5 = dA4 + dA4 - dA[0]; // }
+          double dB5 = dB4 + dB4 - dA[1]; //  } =  2*(dA4, dB4, dC4) - dA
+          double dC5 = dC4 + dC4 - dA[2]; // }
+
+          double dA6 = dB5 * H2[2] - dC5 * H2[1]; // dA6/dp	}
+          double dB6 = dC5 * H2[0] - dA5 * H2[2]; // dB6/dp	 } = (dA5, dB5, dC5) x H2
+          double dC6 = dA5 * H2[1] - dB5 * H2[0]; // dC6/dp	}
+
+          if (i == ND1) {
+            dA6 += A6;
+            dB6 += B6;
+            dC6 += C6;
+          } // if last row: (dA6, dB6, dC6) := (dA6, dB6, dC6) + (A6, B6, C6)
+
+          dR[0] += (dA2 + dA3 + dA4) * S3;
+          dA[0] = (dA0 + dA3 + dA3 + dA5 + dA6) *
+                  P3; // dR := dR + S3*[(dA2, dB2, dC2) +   (dA3, dB3, dC3) + (dA4, dB4, dC4)]
+          dR[1] += (dB2 + dB3 + dB4) * S3;
+          dA[1] =
+            (dB0 + dB3 + dB3 + dB5 + dB6) *
+            P3; // dA :=     1/3*[(dA0, dB0, dC0) + 2*(dA3, dB3, dC3) + (dA5, dB5, dC5) + (dA6, dB6, dC6)]
+          dR[2] += (dC2 + dC3 + dC4) * S3;
+          dA[2] = (dC0 + dC3 + dC3 + dC5 + dC6) * P3;
+        }
       }
+
+      //
+      // Track parameters in last point
+      //
+      R[0] += (A2 + A3 + A4) * S3;
+      A[0] += (SA[0] = (A0 + A3 + A3 + A5 + A6) * P3 -
+                       A[0]); // R  = R0 + S3*[(A2, B2, C2) +   (A3, B3, C3) + (A4, B4, C4)]
+      R[1] += (B2 + B3 + B4) * S3;
+      A[1] +=
+        (SA[1] = (B0 + B3 + B3 + B5 + B6) * P3 -
+                 A[1]); // A  =     1/3*[(A0, B0, C0) + 2*(A3, B3, C3) + (A5, B5, C5) + (A6, B6, C6)]
+      R[2] += (C2 + C3 + C4) * S3;
+      A[2] += (SA[2] = (C0 + C3 + C3 + C5 + C6) * P3 - A[2]); // SA = A_new - A_old
     }
 
     Way2 += S; // add stepsize to way (signed)
@@ -986,19 +1029,6 @@ bool genf::RKTrackRep::RKutta(const GFDetPlane& plane,
                 << " p/q = " << 1. / P[6] << " GeV" << std::endl;
       return (false);
     }
-
-    //
-    // Track parameters in last point
-    //
-    R[0] += (A2 + A3 + A4) * S3;
-    A[0] += (SA[0] = (A0 + A3 + A3 + A5 + A6) * P3 -
-                     A[0]); // R  = R0 + S3*[(A2, B2, C2) +   (A3, B3, C3) + (A4, B4, C4)]
-    R[1] += (B2 + B3 + B4) * S3;
-    A[1] +=
-      (SA[1] = (B0 + B3 + B3 + B5 + B6) * P3 -
-               A[1]); // A  =     1/3*[(A0, B0, C0) + 2*(A3, B3, C3) + (A5, B5, C5) + (A6, B6, C6)]
-    R[2] += (C2 + C3 + C4) * S3;
-    A[2] += (SA[2] = (C0 + C3 + C3 + C5 + C6) * P3 - A[2]); // SA = A_new - A_old
     Sl = S;                                                 // last S used
 
     // if extrapolation has changed direction, delete the last point, because it is
@@ -1149,10 +1179,13 @@ double genf::RKTrackRep::Extrap(const GFDetPlane& plane,
     P[i] = (*state)[i][0];
   }
 
+  // jac and noise are handed to GFMaterialEffects as TMatrixT, so they are
+  // allocated once; the covariance propagation itself uses SMatrix
   TMatrixT<Double_t> jac(7, 7);
-  TMatrixT<Double_t> jacT(7, 7);
-  TMatrixT<Double_t> oldCov(7, 7);
-  if (calcCov) oldCov = (*cov);
+  TMatrixT<Double_t> noise(7, 7);
+  GFMatrix77 jacS;
+  GFMatrix77 covS;
+  if (calcCov) covS = toSMatrix<7, 7>(*cov);
   double coveredDistance(0.);
   double sumDistance(0.);
 
@@ -1249,16 +1282,15 @@ double genf::RKTrackRep::Extrap(const GFDetPlane& plane,
       for (int i = 0; i < 7; ++i) {
         for (int j = 0; j < 7; ++j) {
           if (i < 6)
-            jac[i][j] = P[(i + 1) * 7 + j];
+            jacS(i, j) = P[(i + 1) * 7 + j];
           else
-            jac[i][j] = P[(i + 1) * 7 + j] / P[6];
+            jacS(i, j) = P[(i + 1) * 7 + j] / P[6];
         }
       }
-      jacT = jac;
-      jacT.T();
+      toTMatrix(jacS, jac);
     }
 
-    TMatrixT<Double_t> noise(7, 7); // zero everywhere by default
+    noise.Zero();
 
     // call MatEffects
     double momLoss; // momLoss has a sign - negative loss means momentum gain
@@ -1282,15 +1314,17 @@ double genf::RKTrackRep::Extrap(const GFDetPlane& plane,
                                                         &noise,
                                                         &jac,
                                                         &directionBefore,
-                                                        &directionAfter);
+                                                        &directionAfter,
+                                                        fUniformMedium);
 
     if (fabs(P[6]) > 1.E-10) { // do momLoss only for defined 1/momentum .ne.0
       P[6] = fCharge / (fabs(fCharge / P[6]) - momLoss);
     }
 
     if (calcCov) { //propagate cov and add noise
-      oldCov = *cov;
-      *cov = jacT * ((oldCov)*jac) + noise;
+      // evaluate the inner product first: nested SMatrix expressions are lazy
+      const GFMatrix77 covJac = covS * jacS;
+      covS = ROOT::Math::Transpose(jacS) * covJac + toSMatrix<7, 7>(noise);
     }
 
     //we arrived at the destination plane, if we point to the active area
@@ -1306,6 +1340,7 @@ double genf::RKTrackRep::Extrap(const GFDetPlane& plane,
   (*state)[4][0] = P[4];
   (*state)[5][0] = P[5];
   (*state)[6][0] = P[6];
+  if (calcCov) toTMatrix(covS, *cov);
 
   return sumDistance;
 }
@@ -135,6 +135,9 @@ namespace genf {
     void switchDirection() { fDirection = (!fDirection); }
     //! Set PDG particle code
     void setPDG(int);
+    //! Treats the whole detector as a single medium in the material effects
+    /** No geometry navigation, see GFMaterialEffects::effects(). */
+    void setUniformMedium(bool opt = true) { fUniformMedium = opt; }
     int getPDG();
     void rescaleCovOffDiags();
 
@@ -163,7 +166,7 @@ namespace genf {
     TMatrixT<double> fAuxInfo;
 
     RKTrackRep& operator=(const RKTrackRep* /* rhs */) { return *this; }
-    RKTrackRep(const RKTrackRep& /* rhs */) : GFAbsTrackRep() {}
+    RKTrackRep(const RKTrackRep& rhs) : GFAbsTrackRep(), fUniformMedium(rhs.fUniformMedium) {}
     bool fDirection;
 
     //! PDG particle code
@@ -172,6 +175,8 @@ namespace genf {
     double fMass;
     //! Charge
     double fCharge;
+    //! Material effects without geometry navigation
+    bool fUniformMedium = false;
     //! Contains all material effects
     //GFMaterialEffects *fEffect;
 
@@ -55,7 +55,6 @@
 #include "TH1F.h"
 #include "TMath.h"
 
-#include "tbb/concurrent_vector.h"
 #include "tbb/parallel_for.h"
 
 namespace hit {
@@ -93,7 +92,7 @@ namespace hit {
     //only Standard and Morphological implementation is threadsafe.
     std::vector<std::unique_ptr<reco_tool::ICandidateHitFinder>>
       fHitFinderToolVec; ///< For finding candidate hits
-    // only Marqdt implementation is threadsafe.
+    // only Marqdt and GaussianLM implementations are threadsafe.
     std::unique_ptr<reco_tool::IPeakFitter> fPeakFitterTool; ///< Perform fit to candidate peaks
     //HitFilterAlg implementation is threadsafe.
     std::unique_ptr<HitFilterAlg> fHitFilterAlg; ///< algorithm used to filter out noise hits
@@ -242,15 +241,6 @@ namespace hit {
 
     if (fFilterHits) filteredHitCol = &hcol;
 
-    //store in a thread safe way
-    struct hitstruct {
-      recob::Hit hit_tbb;
-      art::Ptr<recob::Wire> wire_tbb;
-    };
-
-    tbb::concurrent_vector<hitstruct> hitstruct_vec;
-    tbb::concurrent_vector<hitstruct> filthitstruct_vec;
-
     //    if (fAllHitsInstanceName != "") filteredHitCol = &hcol;
 
     // ##########################################
@@ -259,6 +249,18 @@ namespace hit {
     art::Handle<std::vector<recob::Wire>> wireVecHandle;
     evt.getByLabel(fCalDataModuleLabel, wireVecHandle);
 
+    //store in a thread safe way: each ROI task owns the slot indexed by its wire and ROI
+    //so the output order is the same as a serial loop, whatever the thread scheduling
+    struct hitstruct {
+      recob::Hit hit_tbb;
+      art::Ptr<recob::Wire> wire_tbb;
+    };
+
+    using HitStructSlots = std::vector<std::vector<std::vector<hitstruct>>>;
+
+    HitStructSlots hitstruct_vec(wireVecHandle->size());
+    HitStructSlots filthitstruct_vec(filteredHitCol ? wireVecHandle->size() : 0);
+
     //#################################################
     //###    Set the charge determination method    ###
     //### Default is to compute the normalized area ###
@@ -315,6 +317,9 @@ namespace hit {
         // #################################################
         const recob::Wire::RegionsOfInterest_t& signalROI = wire->SignalROI();
 
+        hitstruct_vec[wireIter].resize(signalROI.n_ranges());
+        if (filteredHitCol) filthitstruct_vec[wireIter].resize(signalROI.n_ranges());
+
         // for (const auto& range : signalROI.get_ranges()) {
         tbb::parallel_for(
           static_cast<std::size_t>(0),
@@ -500,7 +505,7 @@ namespace hit {
 
                 // This loop will store ALL hits
                 hitstruct tmp{std::move(hit), wire};
-                hitstruct_vec.push_back(std::move(tmp));
+                hitstruct_vec[wireIter][rangeIter].push_back(std::move(tmp));
 
                 numHits++;
               } // <---End loop over gaussians
@@ -558,7 +563,7 @@ namespace hit {
                 for (const auto& filteredHit : filteredHitVec)
                   if (!fHitFilterAlg || fHitFilterAlg->IsGoodHit(filteredHit)) {
                     hitstruct tmp{std::move(filteredHit), wire};
-                    filthitstruct_vec.push_back(std::move(tmp));
+                    filthitstruct_vec[wireIter][rangeIter].push_back(std::move(tmp));
                   }
 
                 if (fFillHists) fChi2->Fill(chi2PerNDF);
@@ -569,13 +574,16 @@ namespace hit {
       }       //<---End looping over all the wires
     );        //end tbb parallel for
 
-    for (size_t i = 0; i < hitstruct_vec.size(); i++) {
-      allHitCol.emplace_back(hitstruct_vec[i].hit_tbb, hitstruct_vec[i].wire_tbb);
-    }
+    // Gather the hits in wire, ROI, then fit order
+    for (const auto& wireSlots : hitstruct_vec)
+      for (const auto& roiSlot : wireSlots)
+        for (const auto& hitStruct : roiSlot)
+          allHitCol.emplace_back(hitStruct.hit_tbb, hitStruct.wire_tbb);
 
-    for (size_t j = 0; j < filthitstruct_vec.size(); j++) {
-      filteredHitCol->emplace_back(filthitstruct_vec[j].hit_tbb, filthitstruct_vec[j].wire_tbb);
-    }
+    for (const auto& wireSlots : filthitstruct_vec)
+      for (const auto& roiSlot : wireSlots)
+        for (const auto& hitStruct : roiSlot)
+          filteredHitCol->emplace_back(hitStruct.hit_tbb, hitStruct.wire_tbb);
 
     //==================================================================================================
     // End of the event -- move the hit collection and the associations into the event
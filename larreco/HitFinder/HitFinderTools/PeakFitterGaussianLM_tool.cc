@@ -0,0 +1,660 @@
+////////////////////////////////////////////////////////////////////////
+/// \file   PeakFitterGaussianLM.cc
+///
+/// \brief  Fits a sum of Gaussians plus a baseline to candidate peaks with
+///         a self-contained Levenberg-Marquardt minimizer
+///
+///         This is a drop-in replacement for PeakFitterGaussian: it takes the
+///         same parameters, applies the same starting values and limits and
+///         minimizes the same (unweighted) chi square, but it does not go
+///         through ROOT. The fit workspaces are reused per thread and grow
+///         to the largest fit seen, so there is no limit on the number of
+///         peaks; the tool holds no mutable state and can be called
+///         concurrently from the GausHitFinder tasks.
+///
+////////////////////////////////////////////////////////////////////////
+
+#include "larreco/HitFinder/HitFinderTools/IPeakFitter.h"
+#include "larreco/RecoAlg/MultiGaussianKernel.h"
+
+#include "art/Utilities/ToolMacros.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace reco_tool {
+
+  class PeakFitterGaussianLM : IPeakFitter {
+  public:
+    explicit PeakFitterGaussianLM(const fhicl::ParameterSet& pset);
+
+    void findPeakParameters(const std::vector<float>&,
+                            const ICandidateHitFinder::HitCandidateVec&,
+                            PeakParamsVec&,
+                            double&,
+                            int&) const override;
+
+  private:
+    /// Number of ticks evaluated at once when filling the normal equations
+    static constexpr size_t kBlockSize = 32;
+
+    /// Parameters of one fit, Gaussians first (amplitude, mean, sigma) then the baseline
+    struct FitParams {
+      size_t nGaus;
+      size_t nFree; ///< Number of parameters varied in the fit (baseline last, if floating)
+      std::vector<double> value;
+      std::vector<double> error;
+      std::vector<double> lowLimit;
+      std::vector<double> highLimit;
+      double chi2;
+    };
+
+    /// Square matrices of the free parameters, stored by rows
+    using Matrix = std::vector<double>;
+    using Vector = std::vector<double>;
+
+    /// Buffers of a fit, reused by all the fits on the same thread
+    struct Workspace {
+      Matrix alpha;
+      Matrix curvature;
+      Matrix trialAlpha;
+      Vector beta;
+      Vector step;
+      Vector trialBeta;
+      Vector trialValue;
+      Vector unit;
+      std::vector<double> deriv;  ///< Derivatives of the model on a block of ticks
+      std::vector<double> fitted; ///< Fitted function in FindRefitCand
+    };
+
+    static Workspace& GetWorkspace();
+
+    // Member variables from the fhicl file
+    const double fMinWidth;         ///< minimum initial width for gaussian fit
+    const double fMaxWidthMult;     ///< multiplier for max width for gaussian fit
+    const double fPeakRange;        ///< set range limits for peak center
+    const double fAmpRange;         ///< set range limit for peak amplitude
+    const bool fFloatBaseline;      ///< Allow baseline to "float" away from zero
+    const bool fRefit;              ///< If true will attempt to refit with an extra Gaussian
+    const double fRefitThreshold;   ///< Reduced Chi2 threshold above which to refit
+    const double fRefitImprovement; ///< Factor by which the refit must improve the chi2
+    const int fMaxIterations;       ///< Maximum number of Levenberg-Marquardt steps
+    const double fTolerance;        ///< Relative chi2 change at which the fit has converged
+
+    void SetFitParameters(FitParams& fitParams,
+                          const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
+                          const float baseline,
+                          const float startTime,
+                          const float roiSize) const;
+
+    bool Fit(const float* signal, int roiSize, FitParams& fitParams) const;
+
+    double FillNormalEquations(const float* signal,
+                               int roiSize,
+                               const FitParams& fitParams,
+                               const double* value,
+                               Matrix& alpha,
+                               Vector& beta,
+                               std::vector<double>& deriv) const;
+
+    bool CholeskyDecompose(Matrix& matrix, size_t nPar) const;
+
+    void CholeskySolve(const Matrix& decomposed, size_t nPar, Vector& vec) const;
+
+    void GetFitParameters(const FitParams& fitParams,
+                          PeakParamsVec& peakParamsVec,
+                          const int roiSize,
+                          const float startTime,
+                          double& chi2PerNDF,
+                          int& NDF) const;
+
+    ICandidateHitFinder::HitCandidate FindRefitCand(
+      const FitParams& fitParams,
+      const std::vector<float>& waveform,
+      const int startTime,
+      const int roiSize,
+      const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
+      const PeakParamsVec& fittedPeakVec) const;
+
+    std::pair<ICandidateHitFinder::HitCandidate, PeakFitParams_t> FindShiftedGaussian(
+      const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
+      const PeakParamsVec& fittedPeakVec) const;
+  };
+
+  //----------------------------------------------------------------------
+  // Constructor.
+  PeakFitterGaussianLM::PeakFitterGaussianLM(const fhicl::ParameterSet& pset)
+    : fMinWidth(pset.get<double>("MinWidth", 0.5))
+    , fMaxWidthMult(pset.get<double>("MaxWidthMult", 3.))
+    , fPeakRange(pset.get<double>("PeakRangeFact", 2.))
+    , fAmpRange(pset.get<double>("PeakAmpRange", 2.))
+    , fFloatBaseline(pset.get<bool>("FloatBaseline", false))
+    , fRefit(pset.get<bool>("Refit"))
+    , fRefitThreshold(pset.get<double>("RefitThreshold"))
+    , fRefitImprovement(pset.get<double>("RefitImprovement"))
+    , fMaxIterations(pset.get<int>("MaxIterations", 100))
+    , fTolerance(pset.get<double>("Tolerance", 1.e-4))
+  {}
+
+  // --------------------------------------------------------------------------------------------
+  PeakFitterGaussianLM::Workspace& PeakFitterGaussianLM::GetWorkspace()
+  {
+    thread_local Workspace workspace;
+    return workspace;
+  }
+
+  // --------------------------------------------------------------------------------------------
+  void PeakFitterGaussianLM::findPeakParameters(
+    const std::vector<float>& roiSignalVec,
+    const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
+    PeakParamsVec& peakParamsVec,
+    double& chi2PerNDF,
+    int& NDF) const
+  {
+    // *** NOTE: as for PeakFitterGaussian, this algorithm assumes the reference time for input
+    //           hit candidates is to the first tick of the input waveform (ie 0)
+    //
+    if (hitCandidateVec.empty()) return;
+
+    // in case of a fit failure, set the chi-square to infinity
+    chi2PerNDF = std::numeric_limits<double>::infinity();
+
+    int startTime = hitCandidateVec.front().startTick;
+    int endTime = hitCandidateVec.back().stopTick;
+    int roiSize = endTime - startTime;
+
+    if (roiSize <= 0) return;
+
+    const float* signal = roiSignalVec.data() + startTime;
+
+    // Set the baseline if so desired
+    const float baseline(fFloatBaseline ? roiSignalVec[startTime] : 0.f);
+
+    FitParams fitParams;
+
+    SetFitParameters(fitParams, hitCandidateVec, baseline, startTime, roiSize);
+
+    if (!Fit(signal, roiSize, fitParams)) return;
+
+    GetFitParameters(fitParams, peakParamsVec, roiSize, startTime, chi2PerNDF, NDF);
+
+    if (fRefit && chi2PerNDF > fRefitThreshold &&
+        chi2PerNDF < std::numeric_limits<double>::infinity()) {
+
+      const ICandidateHitFinder::HitCandidate refitParams =
+        FindRefitCand(fitParams, roiSignalVec, startTime, roiSize, hitCandidateVec, peakParamsVec);
+
+      if (refitParams.hitHeight > 0) {
+        ICandidateHitFinder::HitCandidateVec newHitCandidateVec = hitCandidateVec;
+        newHitCandidateVec.push_back(refitParams);
+
+        FitParams refitFitParams;
+
+        SetFitParameters(refitFitParams, newHitCandidateVec, baseline, startTime, roiSize);
+
+        if (Fit(signal, roiSize, refitFitParams)) {
+          const double newChi2PerNDF =
+            refitFitParams.chi2 / double(roiSize - int(refitFitParams.nFree));
+
+          if (newChi2PerNDF * fRefitImprovement < chi2PerNDF || newChi2PerNDF < fRefitThreshold) {
+            peakParamsVec.clear();
+            GetFitParameters(refitFitParams, peakParamsVec, roiSize, startTime, chi2PerNDF, NDF);
+          }
+        }
+      }
+    }
+
+    return;
+  }
+
+  void PeakFitterGaussianLM::SetFitParameters(
+    FitParams& fitParams,
+    const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
+    const float baseline,
+    const float startTime,
+    const float roiSize) const
+  {
+    const size_t nGaus = hitCandidateVec.size();
+
+    fitParams.nGaus = nGaus;
+    fitParams.nFree = 3 * nGaus + (fFloatBaseline ? 1 : 0);
+    fitParams.value.resize(3 * nGaus + 1);
+    fitParams.error.resize(3 * nGaus + 1);
+    fitParams.lowLimit.resize(3 * nGaus + 1);
+    fitParams.highLimit.resize(3 * nGaus + 1);
+    fitParams.chi2 = std::numeric_limits<double>::infinity();
+
+    // last parameter is the baseline, fixed unless floating
+    fitParams.value[3 * nGaus] = baseline;
+    fitParams.error[3 * nGaus] = 0.;
+    fitParams.lowLimit[3 * nGaus] = fFloatBaseline ? baseline - 12. : baseline;
+    fitParams.highLimit[3 * nGaus] = fFloatBaseline ? baseline + 12. : baseline;
+
+    size_t parIdx{0};
+    for (auto const& candidateHit : hitCandidateVec) {
+      double const peakMean = candidateHit.hitCenter - startTime;
+      double const peakWidth = candidateHit.hitSigma;
+      double const amplitude = candidateHit.hitHeight - baseline;
+      double const meanLowLim = std::max(peakMean - fPeakRange * peakWidth, 0.);
+      double const meanHiLim = std::min(peakMean + fPeakRange * peakWidth, double(roiSize));
+      double const ampLowLim = std::min(0.1 * amplitude, fAmpRange * amplitude);
+      double const ampHiLim = std::max(0.1 * amplitude, fAmpRange * amplitude);
+
+      fitParams.value[parIdx] = amplitude;
+      fitParams.value[parIdx + 1] = peakMean;
+      fitParams.value[parIdx + 2] = peakWidth;
+      fitParams.lowLimit[parIdx] = ampLowLim;
+      fitParams.highLimit[parIdx] = ampHiLim;
+      fitParams.lowLimit[parIdx + 1] = meanLowLim;
+      fitParams.highLimit[parIdx + 1] = meanHiLim;
+      fitParams.lowLimit[parIdx + 2] = std::max(fMinWidth, 0.1 * peakWidth);
+      fitParams.highLimit[parIdx + 2] = fMaxWidthMult * peakWidth;
+
+      parIdx += 3;
+    }
+
+    // Start inside the limits, as the ROOT fitter would
+    for (size_t idx = 0; idx < 3 * nGaus; idx++)
+      fitParams.value[idx] =
+        std::clamp(fitParams.value[idx], fitParams.lowLimit[idx], fitParams.highLimit[idx]);
+  }
+
+  // Levenberg-Marquardt minimization of the chi square, with the parameters projected back
+  // onto their limits after each step. Returns false if the fit failed.
+  bool PeakFitterGaussianLM::Fit(const float* signal, int roiSize, FitParams& fitParams) const
+  {
+    const size_t nFree = fitParams.nFree;
+
+    if (roiSize <= int(nFree)) return false;
+
+    Workspace& workspace = GetWorkspace();
+    Matrix& alpha = workspace.alpha;
+    Vector& beta = workspace.beta;
+    Matrix& curvature = workspace.curvature;
+    Vector& step = workspace.step;
+    Vector& trialValue = workspace.trialValue;
+    Matrix& trialAlpha = workspace.trialAlpha;
+    Vector& trialBeta = workspace.trialBeta;
+
+    alpha.resize(nFree * nFree);
+    curvature.resize(nFree * nFree);
+    trialAlpha.resize(nFree * nFree);
+    beta.resize(nFree);
+    trialBeta.resize(nFree);
+    trialValue = fitParams.value;
+
+    double chi2 = FillNormalEquations(
+      signal, roiSize, fitParams, fitParams.value.data(), alpha, beta, workspace.deriv);
+    double lambda = 1.e-3;
+    bool converged = false;
+
+    if (!std::isfinite(chi2)) return false;
+
+    for (int iteration = 0; iteration < fMaxIterations && !converged; iteration++) {
+      // Damped normal equations
+      curvature = alpha;
+      for (size_t idx = 0; idx < nFree; idx++)
+        curvature[idx * nFree + idx] *= 1. + lambda;
+
+      step = beta;
+
+      // Parameters on a limit and pushed beyond it stay there for this step, so that
+      // clamping them does not spoil the step of the others
+      for (size_t idx = 0; idx < nFree; idx++) {
+        if (!((fitParams.value[idx] <= fitParams.lowLimit[idx] && beta[idx] < 0.) ||
+              (fitParams.value[idx] >= fitParams.highLimit[idx] && beta[idx] > 0.)))
+          continue;
+
+        for (size_t col = 0; col < idx; col++)
+          curvature[idx * nFree + col] = 0.;
+        for (size_t row = idx + 1; row < nFree; row++)
+          curvature[row * nFree + idx] = 0.;
+        curvature[idx * nFree + idx] = 1.;
+        step[idx] = 0.;
+      }
+
+      if (!CholeskyDecompose(curvature, nFree)) {
+        lambda *= 10.;
+        continue;
+      }
+
+      CholeskySolve(curvature, nFree, step);
+
+      for (size_t idx = 0; idx < nFree; idx++)
+        trialValue[idx] = std::clamp(
+          fitParams.value[idx] + step[idx], fitParams.lowLimit[idx], fitParams.highLimit[idx]);
+
+      double trialChi2 = FillNormalEquations(
+        signal, roiSize, fitParams, trialValue.data(), trialAlpha, trialBeta, workspace.deriv);
+
+      if (std::isfinite(trialChi2) && trialChi2 <= chi2) {
+        converged = chi2 - trialChi2 <= fTolerance * std::max(trialChi2, 1.);
+
+        std::copy(trialValue.begin(), trialValue.begin() + nFree, fitParams.value.begin());
+        alpha.swap(trialAlpha);
+        beta.swap(trialBeta);
+        chi2 = trialChi2;
+        lambda = std::max(0.1 * lambda, 1.e-9);
+      }
+      else {
+        lambda *= 10.;
+
+        // No step improves the chi square anymore, we are at the minimum
+        converged = lambda > 1.e9;
+      }
+    }
+
+    fitParams.chi2 = chi2;
+
+    // The parameter errors come from the inverse of the (undamped) curvature matrix
+    if (!CholeskyDecompose(alpha, nFree)) return false;
+
+    Vector& unit = workspace.unit;
+
+    for (size_t idx = 0; idx < nFree; idx++) {
+      unit.assign(nFree, 0.);
+      unit[idx] = 1.;
+      CholeskySolve(alpha, nFree, unit);
+      fitParams.error[idx] = std::sqrt(unit[idx]);
+    }
+
+    return true;
+  }
+
+  // Computes the chi square at the parameter values value and fills the normal equations
+  // (J^T J) and J^T r for the free parameters of fitParams. Only the lower triangle of alpha is
+  // filled. The model and its derivatives are evaluated a block of ticks at a time by the
+  // vectorized kernel, into deriv.
+  double PeakFitterGaussianLM::FillNormalEquations(const float* signal,
+                                                   int roiSize,
+                                                   const FitParams& fitParams,
+                                                   const double* value,
+                                                   Matrix& alpha,
+                                                   Vector& beta,
+                                                   std::vector<double>& deriv) const
+  {
+    const size_t nGaus = fitParams.nGaus;
+    const size_t nFree = fitParams.nFree;
+    const double baseline = value[3 * nGaus];
+
+    std::array<double, kBlockSize> model;
+    std::array<double, kBlockSize> residual;
+
+    deriv.resize((3 * nGaus + 1) * kBlockSize);
+
+    for (size_t row = 0; row < nFree; row++) {
+      beta[row] = 0.;
+      std::fill(alpha.begin() + row * nFree, alpha.begin() + row * nFree + row + 1, 0.);
+    }
+
+    // baseline derivative, if it is free
+    std::fill(deriv.begin() + 3 * nGaus * kBlockSize,
+              deriv.begin() + (3 * nGaus + 1) * kBlockSize,
+              1.);
+
+    double chi2(0.);
+
+    for (size_t first = 0; first < size_t(roiSize); first += kBlockSize) {
+      const size_t nTicks = std::min(kBlockSize, size_t(roiSize) - first);
+
+      // Bin centers, as for the histogram fit
+      hit::EvaluateMultiGaussianAndJacobian(value,
+                                            nGaus,
+                                            baseline,
+                                            first + 0.5,
+                                            nTicks,
+                                            model.data(),
+                                            deriv.data(),
+                                            kBlockSize);
+
+      for (size_t tick = 0; tick < nTicks; tick++) {
+        residual[tick] = signal[first + tick] - model[tick];
+        chi2 += residual[tick] * residual[tick];
+      }
+
+      for (size_t row = 0; row < nFree; row++) {
+        const double* rowDeriv = deriv.data() + row * kBlockSize;
+        double* alphaRow = alpha.data() + row * nFree;
+
+        for (size_t tick = 0; tick < nTicks; tick++)
+          beta[row] += residual[tick] * rowDeriv[tick];
+
+        for (size_t col = 0; col <= row; col++) {
+          const double* colDeriv = deriv.data() + col * kBlockSize;
+
+          for (size_t tick = 0; tick < nTicks; tick++)
+            alphaRow[col] += rowDeriv[tick] * colDeriv[tick];
+        }
+      }
+    }
+
+    return chi2;
+  }
+
+  // In place Cholesky decomposition of the lower triangle of a symmetric matrix
+  bool PeakFitterGaussianLM::CholeskyDecompose(Matrix& matrix, size_t nPar) const
+  {
+    for (size_t col = 0; col < nPar; col++) {
+      double* colRow = matrix.data() + col * nPar;
+      double diag = colRow[col];
+
+      for (size_t idx = 0; idx < col; idx++)
+        diag -= colRow[idx] * colRow[idx];
+
+      if (!(diag > 0.)) return false;
+
+      colRow[col] = std::sqrt(diag);
+
+      for (size_t row = col + 1; row < nPar; row++) {
+        double* rowPtr = matrix.data() + row * nPar;
+        double sum = rowPtr[col];
+
+        for (size_t idx = 0; idx < col; idx++)
+          sum -= rowPtr[idx] * colRow[idx];
+
+        rowPtr[col] = sum / colRow[col];
+      }
+    }
+
+    return true;
+  }
+
+  // Solves L L^T x = vec in place given the decomposition from CholeskyDecompose
+  void PeakFitterGaussianLM::CholeskySolve(const Matrix& decomposed,
+                                           size_t nPar,
+                                           Vector& vec) const
+  {
+    for (size_t row = 0; row < nPar; row++) {
+      const double* rowPtr = decomposed.data() + row * nPar;
+      double sum = vec[row];
+
+      for (size_t idx = 0; idx < row; idx++)
+        sum -= rowPtr[idx] * vec[idx];
+
+      vec[row] = sum / rowPtr[row];
+    }
+
+    for (size_t row = nPar; row-- > 0;) {
+      double sum = vec[row];
+
+      for (size_t idx = row + 1; idx < nPar; idx++)
+        sum -= decomposed[idx * nPar + row] * vec[idx];
+
+      vec[row] = sum / decomposed[row * nPar + row];
+    }
+  }
+
+  void PeakFitterGaussianLM::GetFitParameters(const FitParams& fitParams,
+                                              PeakParamsVec& peakParamsVec,
+                                              const int roiSize,
+                                              const float startTime,
+                                              double& chi2PerNDF,
+                                              int& NDF) const
+  {
+    NDF = roiSize - int(fitParams.nFree);
+    chi2PerNDF = fitParams.chi2 / NDF;
+
+    int parIdx{0};
+    for (size_t idx = 0; idx < fitParams.nGaus; idx++) {
+      PeakFitParams_t peakParams;
+
+      peakParams.peakAmplitude = fitParams.value[parIdx];
+      peakParams.peakAmplitudeError = fitParams.error[parIdx];
+      peakParams.peakCenter = fitParams.value[parIdx + 1] + startTime;
+      peakParams.peakCenterError = fitParams.error[parIdx + 1];
+      peakParams.peakSigma = fitParams.value[parIdx + 2];
+      peakParams.peakSigmaError = fitParams.error[parIdx + 2];
+
+      peakParamsVec.emplace_back(peakParams);
+
+      parIdx += 3;
+    }
+  }
+
+  // Same choice of the extra candidate as PeakFitterGaussian::FindRefitCand
+  ICandidateHitFinder::HitCandidate PeakFitterGaussianLM::FindRefitCand(
+    const FitParams& fitParams,
+    const std::vector<float>& waveform,
+    const int startTime,
+    const int roiSize,
+    const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
+    const PeakParamsVec& fittedPeakVec) const
+  {
+    // Find the candidate that was shifted most by the fit
+    std::pair<ICandidateHitFinder::HitCandidate, PeakFitParams_t> shiftedHitCanPair =
+      FindShiftedGaussian(hitCandidateVec, fittedPeakVec);
+
+    // If the candidate was shifted more than some given amount, place a new candidate on the other side
+    float offset(shiftedHitCanPair.second.peakCenter - shiftedHitCanPair.first.hitCenter);
+
+    // If we have too many Gaussians it is just a mess
+    if (std::abs(offset) > 1.f && hitCandidateVec.size() == 1) {
+
+      offset = std::min(offset, roiSize / 8.f);
+
+      const int candPos(
+        offset > 0 ?
+          std::min(shiftedHitCanPair.first.hitCenter + 4.f * offset,
+                   (shiftedHitCanPair.first.hitCenter + shiftedHitCanPair.first.stopTick) / 2.f) :
+          std::max(shiftedHitCanPair.first.hitCenter + 4.f * offset,
+                   (shiftedHitCanPair.first.hitCenter + shiftedHitCanPair.first.startTick) / 2.f));
+
+      return ICandidateHitFinder::HitCandidate{0,
+                                               0,
+                                               0,
+                                               0,
+                                               0,
+                                               0,
+                                               float(candPos + startTime),
+                                               3.f * std::abs(offset),
+                                               0.5f * waveform[candPos]};
+    }
+
+    // The fitted function at each tick (the search below may look one past the end)
+    std::vector<double>& fitted = GetWorkspace().fitted;
+    fitted.resize(roiSize + 1);
+
+    hit::EvaluateMultiGaussian(fitParams.value.data(),
+                               fitParams.nGaus,
+                               fitParams.value[3 * fitParams.nGaus],
+                               0.,
+                               fitted.size(),
+                               fitted.data());
+
+    // If we are not trying a  peak that was shifted, find the largest diff between fitted and input
+    int maxDiffPos(std::numeric_limits<int>::max());
+    float maxDiff(0);
+    for (int i = 0; i < roiSize; i++) {
+      float diff(waveform[startTime + i] - fitted[i]);
+
+      // Prefer excesses over deficits
+      if (diff > 0) diff *= 1.25;
+
+      diff *= diff;
+
+      // We want to avoid adding new Gaussians in the tails
+      float peakDist(std::numeric_limits<float>::max());
+      for (auto const& hitCandidate : hitCandidateVec)
+        peakDist = std::min(peakDist, std::abs(hitCandidate.hitCenter - float(startTime) - i));
+
+      // Or too close to a peak
+      if (peakDist < 3) continue;
+
+      diff *= std::log(peakDist);
+
+      if (std::abs(diff) > std::abs(maxDiff)) {
+        maxDiff = diff;
+        maxDiffPos = i;
+      }
+    }
+
+    if (maxDiffPos == std::numeric_limits<int>::max())
+      return ICandidateHitFinder::HitCandidate{0,
+                                               0,
+                                               0,
+                                               0,
+                                               0,
+                                               0,
+                                               std::numeric_limits<float>::lowest(),
+                                               std::numeric_limits<float>::lowest(),
+                                               std::numeric_limits<float>::lowest()};
+
+    // Recover the actual diff
+    maxDiff = (waveform[startTime + maxDiffPos] - fitted[maxDiffPos]);
+
+    int lowLim(maxDiffPos);
+    int highLim(maxDiffPos);
+    const bool useMax(maxDiff > 0);
+
+    // Find the point where the excess crosses the fitted Gaussian
+    if (useMax) {
+      while (lowLim > 0 && waveform[startTime + lowLim] > fitted[lowLim])
+        lowLim--;
+
+      while (highLim < roiSize && waveform[startTime + highLim] > fitted[highLim])
+        highLim++;
+    }
+    else {
+      while (lowLim > 0 && waveform[startTime + lowLim] < fitted[lowLim])
+        lowLim--;
+
+      while (highLim < roiSize && waveform[startTime + highLim] < fitted[highLim])
+        highLim++;
+    }
+
+    const float amplitude(std::max(std::abs(2 * maxDiff), waveform[startTime + maxDiffPos] / 2.f));
+
+    return ICandidateHitFinder::HitCandidate{
+      0, 0, 0, 0, 0, 0, float(maxDiffPos + startTime), 0.5f * (highLim - lowLim), amplitude};
+  }
+
+  std::pair<ICandidateHitFinder::HitCandidate, IPeakFitter::PeakFitParams_t>
+  PeakFitterGaussianLM::FindShiftedGaussian(
+    const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
+    const PeakParamsVec& fittedPeakVec) const
+  {
+    float minDiff(std::numeric_limits<float>::max());
+    ICandidateHitFinder::HitCandidate const* minHit{nullptr};
+    PeakFitParams_t const* minPeak{nullptr};
+
+    for (auto const& hitCand : hitCandidateVec) {
+      for (auto const& fittedPeak : fittedPeakVec) {
+        const float offset(hitCand.hitCenter - fittedPeak.peakCenter);
+        if (std::abs(offset) < minDiff) {
+          minDiff = offset;
+          minHit = &hitCand;
+          minPeak = &fittedPeak;
+        }
+      }
+    }
+
+    assert(minPeak);
+    return std::pair<ICandidateHitFinder::HitCandidate, PeakFitParams_t>(*minHit, *minPeak);
+  }
+
+  DEFINE_ART_CLASS_TOOL(PeakFitterGaussianLM)
+}
@@ -3,8 +3,6 @@
 /// \author T. Usher
 ////////////////////////////////////////////////////////////////////////
 
-#include "larcore/CoreUtils/ServiceUtil.h"
-#include "larcore/Geometry/Geometry.h"
 #include "larreco/HitFinder/HitFinderTools/IPeakFitter.h"
 #include "larreco/RecoAlg/GausFitCache.h" // hit::GausFitCache
 
@@ -15,6 +13,7 @@
 
 #include <cassert>
 #include <fstream>
+#include <limits>
 
 #include "TF1.h"
 #include "TH1F.h"
@@ -90,8 +89,6 @@ namespace reco_tool {
 
     mutable TH1F fHistogram;
 
-    const geo::GeometryCore* fGeometry = lar::providerFrom<geo::Geometry>();
-
     void SetFitParameters(TF1& Gaus,
                           const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
                           const unsigned int nGaus,
@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////
+///
+/// \file   WaveformMorphology.h
+///
+/// \brief  Running minimum/maximum over a window sliding along a
+///         waveform, as used for the erosion, dilation, opening and
+///         closing of the morphological filter in WaveformTools.
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef WaveformMorphology_H
+#define WaveformMorphology_H
+
+#include <algorithm>
+#include <vector>
+
+namespace reco_tool {
+
+  /// Fills output with the extremum of the input in the window from bin
+  /// i - halfWindowSize + 1 to bin i + halfWindowSize, clipped at the start of
+  /// the input; comp is the ordering, std::less for the minimum and
+  /// std::greater for the maximum. The last halfWindowSize bins, whose window
+  /// would run past the end, repeat the value of the last complete window.
+  /// Windows of less than two bins leave the input unchanged.
+  ///
+  /// This is the van Herk/Gil-Werman algorithm: the input is cut in blocks of
+  /// the window size, and each window is the union of the tail of one block
+  /// and the head of the next. With the running extremum of the blocks taken
+  /// backward and forward, every bin costs three comparisons, independently
+  /// of the window size.
+  template <typename T, typename Compare>
+  void runningExtremum(const std::vector<T>& input,
+                       int halfWindowSize,
+                       Compare comp,
+                       std::vector<T>& output)
+  {
+    const int nBins = input.size();
+
+    if ((nBins == 0) || (halfWindowSize < 1)) {
+      output = input;
+      return;
+    }
+
+    // the preferred value of the two, the first one when they are equivalent
+    auto extremum = [&comp](T left, T right) -> T { return comp(right, left) ? right : left; };
+
+    const int windowSize = 2 * halfWindowSize;
+
+    // extremum from each bin to the end of its block
+    std::vector<T> blockTail(nBins);
+    for (int blockStart = 0; blockStart < nBins; blockStart += windowSize) {
+      int bin = std::min(blockStart + windowSize, nBins) - 1;
+      blockTail[bin] = input[bin];
+      for (--bin; bin >= blockStart; --bin)
+        blockTail[bin] = extremum(input[bin], blockTail[bin + 1]);
+    }
+
+    output.resize(nBins);
+
+    // extremum from the start of the block to the current bin, combined with
+    // the tail of the previous block except for the first block, where the
+    // windows are clipped at the start of the input
+    T blockHead = input[0];
+    for (int blockStart = 0; blockStart < nBins; blockStart += windowSize) {
+      const int blockEnd = std::min(blockStart + windowSize, nBins);
+      blockHead = input[blockStart];
+      for (int bin = blockStart; bin < blockEnd; ++bin) {
+        blockHead = extremum(blockHead, input[bin]);
+
+        const int center = bin - halfWindowSize;
+        if (center < 0) continue;
+
+        output[center] =
+          blockStart ? extremum(blockTail[bin - windowSize + 1], blockHead) : blockHead;
+      }
+    }
+
+    // the input is shorter than half the window: one window for all the bins
+    const int lastCenter = nBins - halfWindowSize - 1;
+    if (lastCenter < 0) {
+      output.assign(nBins, blockHead);
+      return;
+    }
+
+    for (int bin = lastCenter + 1; bin < nBins; ++bin)
+      output[bin] = output[lastCenter];
+  }
+
+} // namespace reco_tool
+
+#endif
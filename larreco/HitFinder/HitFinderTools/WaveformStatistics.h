@@ -0,0 +1,180 @@
+///////////////////////////////////////////////////////////////////////
+///
+/// \file   WaveformStatistics.h
+///
+/// \brief  Running median and truncated mean/RMS of a waveform, as used
+///         for the median smoothing and the noise estimate in
+///         WaveformTools.
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef WaveformStatistics_H
+#define WaveformStatistics_H
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <vector>
+
+namespace reco_tool {
+
+  /// Fills output with the median of the input over a window of nBins bins
+  /// (made odd if needed) centered on each bin. As in the original smoothing,
+  /// the first nBins/2 and the last nBins/2 + 1 bins are copied unchanged, and
+  /// so is an input not longer than the window.
+  ///
+  /// The window is kept sorted while it slides: the outgoing value is found by
+  /// a binary search and the incoming one takes its place with one step of an
+  /// insertion sort, instead of copying and sorting the window for every bin.
+  template <typename T>
+  void slidingMedian(const std::vector<T>& input, size_t nBins, std::vector<T>& output)
+  {
+    // For our purposes, nBins must be odd
+    if (nBins % 2 == 0) nBins++;
+
+    output.resize(input.size());
+
+    if (input.size() <= nBins) {
+      std::copy(input.begin(), input.end(), output.begin());
+      return;
+    }
+
+    const size_t medianBin = nBins / 2;
+    const size_t lastStart = input.size() - nBins; // first window not used
+
+    // First bins are not smoothed
+    std::copy(input.begin(), input.begin() + medianBin, output.begin());
+
+    std::vector<T> window(input.begin(), input.begin() + nBins);
+    std::sort(window.begin(), window.end());
+
+    for (size_t start = 0; start < lastStart; ++start) {
+      output[start + medianBin] = window[medianBin];
+
+      // slide the window by one bin, keeping it sorted
+      const T& outgoing = input[start];
+      const T& incoming = input[start + nBins];
+
+      // the hole left by the outgoing value moves to where the incoming one belongs
+      auto hole = std::lower_bound(window.begin(), window.end(), outgoing);
+      while ((hole != window.begin()) && (incoming < *(hole - 1))) {
+        *hole = *(hole - 1);
+        --hole;
+      }
+      while ((hole + 1 != window.end()) && (*(hole + 1) < incoming)) {
+        *hole = *(hole + 1);
+        ++hole;
+      }
+      *hole = incoming;
+    }
+
+    // Last bins are not smoothed
+    std::copy(
+      input.begin() + lastStart + medianBin, input.end(), output.begin() + lastStart + medianBin);
+  }
+
+  /// Computes the baseline of the waveform from its most probable value, the
+  /// RMS of all the samples around it, and the RMS of the nTrunc samples
+  /// closest to it, where nTrunc is the number of samples near the most
+  /// probable value.
+  ///
+  /// The samples are counted in quarter ADC bins in a flat histogram, unless
+  /// their range is too wide for one, and the truncated samples are selected
+  /// with std::nth_element rather than by sorting the whole waveform. The full
+  /// RMS is summed in the order of the samples, so it does not depend on that
+  /// selection.
+  template <typename T>
+  void truncatedMeanRMS(const std::vector<T>& waveform,
+                        T& mean,
+                        T& rmsFull,
+                        T& rmsTrunc,
+                        int& nTrunc)
+  {
+    // Find the most probable value in quarter ADC bins; a flat histogram is
+    // used when the range of the samples allows it, a map otherwise
+    constexpr int maxHistogramBins = 1 << 16;
+
+    std::vector<int> keys(waveform.size());
+    std::transform(waveform.begin(), waveform.end(), keys.begin(), [](const T& val) {
+      return int(std::round(4. * val));
+    });
+
+    int minKey(0), maxKey(0);
+    if (!keys.empty()) {
+      auto const minMaxItr = std::minmax_element(keys.begin(), keys.end());
+      minKey = *minMaxItr.first;
+      maxKey = *minMaxItr.second;
+    }
+
+    const bool flat = (double(maxKey) - double(minKey) < maxHistogramBins);
+    std::vector<int> histogram(flat ? maxKey - minKey + 1 : 0, 0);
+    std::map<int, int> frequencyMap;
+
+    int mpCount(0);
+    int mpVal(0);
+    int nKeys(0);
+
+    for (const int key : keys) {
+      int& count = flat ? histogram[key - minKey] : frequencyMap[key];
+
+      if (count++ == 0) nKeys++;
+
+      if (count > mpCount) {
+        mpCount = count;
+        mpVal = key;
+      }
+    }
+
+    auto countOf = [&](int key) {
+      if (flat) return ((key >= minKey) && (key <= maxKey)) ? histogram[key - minKey] : 0;
+      auto const keyItr = frequencyMap.find(key);
+      return (keyItr != frequencyMap.end()) ? keyItr->second : 0;
+    };
+
+    // take a weighted average of two neighbor bins
+    int meanCnt = 0;
+    int meanSum = 0;
+    int binRange = std::min(16, nKeys / 2 + 1);
+
+    for (int idx = -binRange; idx <= binRange; idx++) {
+      const int count = countOf(mpVal + idx);
+
+      if (5 * count > mpCount) {
+        meanSum += (mpVal + idx) * count;
+        meanCnt += count;
+      }
+    }
+
+    mean = 0.25 * T(meanSum) / T(meanCnt); // Note that bins were expanded by a factor of 4 above
+
+    // do rms calculation - the old fashioned way and over all adc values
+    std::vector<T> locWaveform(waveform.size());
+    std::transform(waveform.begin(), waveform.end(), locWaveform.begin(), [mean](const T& val) {
+      return val - mean;
+    });
+
+    const double sumFull =
+      std::inner_product(locWaveform.begin(), locWaveform.end(), locWaveform.begin(), 0.);
+
+    // bring the samples closest to the mean to the front, in no particular order
+    auto const truncItr = locWaveform.begin() + meanCnt;
+    std::nth_element(
+      locWaveform.begin(), truncItr, locWaveform.end(), [](const auto& left, const auto& right) {
+        return std::fabs(left) < std::fabs(right);
+      });
+
+    const double sumTrunc =
+      std::inner_product(locWaveform.begin(), truncItr, locWaveform.begin(), 0.);
+
+    rmsFull = sumFull;
+    rmsFull = std::sqrt(std::max(T(0.), rmsFull / T(locWaveform.size())));
+
+    rmsTrunc = sumTrunc;
+    rmsTrunc = std::sqrt(std::max(T(0.), rmsTrunc / T(meanCnt)));
+    nTrunc = meanCnt;
+  }
+
+} // namespace reco_tool
+
+#endif
@@ -5,7 +5,10 @@
 
 #include "art/Utilities/ToolMacros.h"
 #include "larreco/HitFinder/HitFinderTools/IWaveformTool.h"
+#include "larreco/HitFinder/HitFinderTools/WaveformMorphology.h"
+#include "larreco/HitFinder/HitFinderTools/WaveformStatistics.h"
 #include <cmath>
+#include <functional>
 #include <numeric> // std::inner_product
 
 #include "TProfile.h"
@@ -219,38 +222,8 @@ namespace reco_tool {
                                    std::vector<T>& smoothVec,
                                    size_t nBins) const
   {
-    // For our purposes, nBins must be odd
-    if (nBins % 2 == 0) nBins++;
-
-    // Make sure the input vector is right sized
-    if (inputVec.size() != smoothVec.size()) smoothVec.resize(inputVec.size());
-
-    // Basic set up
-    typename std::vector<T> medianVec(nBins);
-    typename std::vector<T>::const_iterator startItr = inputVec.begin();
-    typename std::vector<T>::const_iterator stopItr = startItr;
-
-    std::advance(stopItr, inputVec.size() - nBins);
-
-    size_t medianBin = nBins / 2;
-    size_t smoothBin = medianBin;
-
-    // First bins are not smoothed
-    std::copy(startItr, startItr + medianBin, smoothVec.begin());
-
-    while (std::distance(startItr, stopItr) > 0) {
-      std::copy(startItr, startItr + nBins, medianVec.begin());
-      std::sort(medianVec.begin(), medianVec.end());
-
-      T medianVal = medianVec[medianBin];
-
-      smoothVec[smoothBin++] = medianVal;
-
-      startItr++;
-    }
-
-    // Last bins are not smoothed
-    std::copy(startItr + medianBin, inputVec.end(), smoothVec.begin() + smoothBin);
+    // The window is kept sorted while sliding along the waveform
+    slidingMedian(inputVec, nBins, smoothVec);
 
     return;
   }
@@ -283,60 +256,8 @@ namespace reco_tool {
     // We need to get a reliable estimate of the mean and can't assume the input waveform will be ~zero mean...
     // Basic idea is to find the most probable value in the ROI presented to us
     // From that we can develop an average of the true baseline of the ROI.
-    // To do that we employ a map based scheme
-    std::map<int, int> frequencyMap;
-    int mpCount(0);
-    int mpVal(0);
-
-    for (const auto& val : waveform) {
-      int intVal = std::round(4. * val);
-
-      frequencyMap[intVal]++;
-
-      if (frequencyMap.at(intVal) > mpCount) {
-        mpCount = frequencyMap.at(intVal);
-        mpVal = intVal;
-      }
-    }
-
-    // take a weighted average of two neighbor bins
-    int meanCnt = 0;
-    int meanSum = 0;
-    int binRange = std::min(16, int(frequencyMap.size() / 2 + 1));
-
-    for (int idx = -binRange; idx <= binRange; idx++) {
-      std::map<int, int>::iterator neighborItr = frequencyMap.find(mpVal + idx);
-
-      if (neighborItr != frequencyMap.end() && 5 * neighborItr->second > mpCount) {
-        meanSum += neighborItr->first * neighborItr->second;
-        meanCnt += neighborItr->second;
-      }
-    }
-
-    mean = 0.25 * T(meanSum) / T(meanCnt); // Note that bins were expanded by a factor of 4 above
-
-    // do rms calculation - the old fashioned way and over all adc values
-    typename std::vector<T> locWaveform = waveform;
-
-    std::transform(locWaveform.begin(),
-                   locWaveform.end(),
-                   locWaveform.begin(),
-                   std::bind(std::minus<T>(), std::placeholders::_1, mean));
-
-    // sort in ascending order so we can truncate the sume
-    std::sort(locWaveform.begin(), locWaveform.end(), [](const auto& left, const auto& right) {
-      return std::fabs(left) < std::fabs(right);
-    });
-
-    // recalculate the rms for truncation
-    rmsFull = std::inner_product(locWaveform.begin(), locWaveform.end(), locWaveform.begin(), 0.);
-    rmsFull = std::sqrt(std::max(T(0.), rmsFull / T(locWaveform.size())));
-
-    // recalculate the rms for truncation
-    rmsTrunc = std::inner_product(
-      locWaveform.begin(), locWaveform.begin() + meanCnt, locWaveform.begin(), 0.);
-    rmsTrunc = std::sqrt(std::max(T(0.), rmsTrunc / T(meanCnt)));
-    nTrunc = meanCnt;
+    // The samples closest to it are then selected for the truncated rms, without sorting.
+    truncatedMeanRMS(waveform, mean, rmsFull, rmsTrunc, nTrunc);
 
     return;
   }
@@ -596,62 +517,24 @@ namespace reco_tool {
     // Set the window size
     int halfWindowSize(structuringElement / 2);
 
-    // Initialize min and max elements
-    std::pair<typename Waveform<T>::const_iterator, typename Waveform<T>::const_iterator>
-      minMaxItr =
-        std::minmax_element(inputWaveform.begin(), inputWaveform.begin() + halfWindowSize);
+    // The erosion and dilation are the running min and max over the window
+    runningExtremum(inputWaveform, halfWindowSize, std::less<T>(), erosionVec);
+    runningExtremum(inputWaveform, halfWindowSize, std::greater<T>(), dilationVec);
 
-    typename Waveform<T>::const_iterator minElementItr = minMaxItr.first;
-    typename Waveform<T>::const_iterator maxElementItr = minMaxItr.second;
-
-    // Initialize the erosion and dilation vectors
-    erosionVec.resize(inputWaveform.size());
-    dilationVec.resize(inputWaveform.size());
+    // Now loop through the elements and complete the average and difference vectors
     averageVec.resize(inputWaveform.size());
     differenceVec.resize(inputWaveform.size());
 
-    // Now loop through remaining elements and complete the vectors
-    typename Waveform<T>::iterator minItr = erosionVec.begin();
-    typename Waveform<T>::iterator maxItr = dilationVec.begin();
-    typename Waveform<T>::iterator aveItr = averageVec.begin();
-    typename Waveform<T>::iterator difItr = differenceVec.begin();
-
-    for (typename Waveform<T>::const_iterator inputItr = inputWaveform.begin();
-         inputItr != inputWaveform.end();
-         inputItr++) {
-      // There are two conditions to check:
-      // 1) is the current min/max element outside the current window?
-      // 2) is the new element smaller/larger than the current min/max?
-
-      // Make sure we are not running off the end of the vector
-      if (std::distance(inputItr, inputWaveform.end()) > halfWindowSize) {
-        if (std::distance(minElementItr, inputItr) >= halfWindowSize)
-          minElementItr =
-            std::min_element(inputItr - halfWindowSize + 1, inputItr + halfWindowSize + 1);
-        else if (*(inputItr + halfWindowSize) < *minElementItr)
-          minElementItr = inputItr + halfWindowSize;
-
-        if (std::distance(maxElementItr, inputItr) >= halfWindowSize)
-          maxElementItr =
-            std::max_element(inputItr - halfWindowSize + 1, inputItr + halfWindowSize + 1);
-        else if (*(inputItr + halfWindowSize) > *maxElementItr)
-          maxElementItr = inputItr + halfWindowSize;
-      }
-
-      // Update the vectors
-      *minItr++ = *minElementItr;
-      *maxItr++ = *maxElementItr;
-      *aveItr++ = 0.5 * (*maxElementItr + *minElementItr);
-      *difItr++ = *maxElementItr - *minElementItr;
+    for (size_t curBin = 0; curBin < inputWaveform.size(); curBin++) {
+      averageVec[curBin] = 0.5 * (dilationVec[curBin] + erosionVec[curBin]);
+      differenceVec[curBin] = dilationVec[curBin] - erosionVec[curBin];
 
       if (!histogramMap.empty()) {
-        int curBin = std::distance(inputWaveform.begin(), inputItr);
-
-        histogramMap.at(WAVEFORM)->Fill(curBin, *inputItr);
-        histogramMap.at(EROSION)->Fill(curBin, *minElementItr);
-        histogramMap.at(DILATION)->Fill(curBin, *maxElementItr);
-        histogramMap.at(AVERAGE)->Fill(curBin, 0.5 * (*maxElementItr + *minElementItr));
-        histogramMap.at(DIFFERENCE)->Fill(curBin, *maxElementItr - *minElementItr);
+        histogramMap.at(WAVEFORM)->Fill(curBin, inputWaveform[curBin]);
+        histogramMap.at(EROSION)->Fill(curBin, erosionVec[curBin]);
+        histogramMap.at(DILATION)->Fill(curBin, dilationVec[curBin]);
+        histogramMap.at(AVERAGE)->Fill(curBin, 0.5 * (dilationVec[curBin] + erosionVec[curBin]));
+        histogramMap.at(DIFFERENCE)->Fill(curBin, dilationVec[curBin] - erosionVec[curBin]);
       }
     }
 
@@ -708,76 +591,17 @@ namespace reco_tool {
     // Set the window size
     int halfWindowSize(structuringElement / 2);
 
-    // Start with the opening, here we get the max element in the input erosion vector
-    typename Waveform<T>::const_iterator maxElementItr =
-      std::max_element(erosionVec.begin(), erosionVec.begin() + halfWindowSize);
-
-    // Initialize the opening vector
-    openingVec.resize(erosionVec.size());
-
-    // Now loop through remaining elements and complete the vectors
-    typename Waveform<T>::iterator maxItr = openingVec.begin();
-
-    for (typename Waveform<T>::const_iterator inputItr = erosionVec.begin();
-         inputItr != erosionVec.end();
-         inputItr++) {
-      // There are two conditions to check:
-      // 1) is the current min/max element outside the current window?
-      // 2) is the new element smaller/larger than the current min/max?
-
-      // Make sure we are not running off the end of the vector
-      if (std::distance(inputItr, erosionVec.end()) > halfWindowSize) {
-        if (std::distance(maxElementItr, inputItr) >= halfWindowSize)
-          maxElementItr =
-            std::max_element(inputItr - halfWindowSize + 1, inputItr + halfWindowSize + 1);
-        else if (*(inputItr + halfWindowSize) > *maxElementItr)
-          maxElementItr = inputItr + halfWindowSize;
-      }
+    // The opening is the running max of the erosion, the closing the running min of the dilation
+    runningExtremum(erosionVec, halfWindowSize, std::greater<T>(), openingVec);
+    runningExtremum(dilationVec, halfWindowSize, std::less<T>(), closingVec);
 
-      // Update the vectors
-      *maxItr++ = *maxElementItr;
-
-      if (!histogramMap.empty()) {
-        int curBin = std::distance(erosionVec.begin(), inputItr);
-
-        histogramMap.at(OPENING)->Fill(curBin, *maxElementItr);
-      }
-    }
-
-    // Now go with the closling, here we get the min element in the input dilation vector
-    typename Waveform<T>::const_iterator minElementItr =
-      std::min_element(dilationVec.begin(), dilationVec.begin() + halfWindowSize);
-
-    // Initialize the opening and closing vectors
-    closingVec.resize(dilationVec.size());
-
-    // Now loop through remaining elements and complete the vectors
-    typename Waveform<T>::iterator minItr = closingVec.begin();
-
-    for (typename Waveform<T>::const_iterator inputItr = dilationVec.begin();
-         inputItr != dilationVec.end();
-         inputItr++) {
-      // There are two conditions to check:
-      // 1) is the current min/max element outside the current window?
-      // 2) is the new element smaller/larger than the current min/max?
-
-      // Make sure we are not running off the end of the vector
-      if (std::distance(inputItr, dilationVec.end()) > halfWindowSize) {
-        if (std::distance(minElementItr, inputItr) >= halfWindowSize)
-          minElementItr =
-            std::min_element(inputItr - halfWindowSize + 1, inputItr + halfWindowSize + 1);
-        else if (*(inputItr + halfWindowSize) < *minElementItr)
-          minElementItr = inputItr + halfWindowSize;
-      }
-
-      // Update the vectors
-      *minItr++ = *minElementItr;
-
-      if (!histogramMap.empty()) {
-        int curBin = std::distance(dilationVec.begin(), inputItr);
+    if (!histogramMap.empty()) {
+      for (size_t curBin = 0; curBin < openingVec.size(); curBin++)
+        histogramMap.at(OPENING)->Fill(curBin, openingVec[curBin]);
 
-        histogramMap.at(CLOSING)->Fill(curBin, *minElementItr);
-        histogramMap.at(DOPENCLOSING)->Fill(curBin, *minElementItr - openingVec.at(curBin));
+      for (size_t curBin = 0; curBin < closingVec.size(); curBin++) {
+        histogramMap.at(CLOSING)->Fill(curBin, closingVec[curBin]);
+        histogramMap.at(DOPENCLOSING)->Fill(curBin, closingVec[curBin] - openingVec.at(curBin));
       }
     }
 
@@ -21,6 +21,7 @@
 #include <iostream>
 #include <sstream>
 #include <utility> // std::pair<>, std::make_pair()
+#include <vector>
 
 // framework libraries
 #include "messagefacility/MessageLogger/MessageLogger.h"
@@ -30,6 +31,7 @@
 #include "lardata/Utilities/SimpleFits.h" // lar::util::GaussianFit<>
 #include "larevt/CalibrationDBI/Interface/ChannelStatusProvider.h"
 #include "larevt/CalibrationDBI/Interface/ChannelStatusService.h"
+#include "larreco/RecoAlg/MultiGaussianKernel.h"
 
 // ROOT Includes
 #include "TF1.h"
@@ -405,12 +407,24 @@ namespace hit {
       } // ii bumps
 
       // search for other bumps that may be hidden by the already found ones
+      std::vector<double> setParams;
+      std::vector<double> fitted(npt);
       for (unsigned short ii = bumps.size(); ii < nGaus; ++ii) {
         // bump height must exceed fMinPeak
         float big = fMinPeak[thePlane];
         unsigned short imbig = 0;
-        for (unsigned short jj = 0; jj < npt; ++jj) {
-          float diff = signl[jj] - Gn->Eval((Double_t)jj, 0, 0, 0);
+        // evaluate the Gaussians set so far on all the ticks at once
+        setParams.clear();
+        for (unsigned short jj = 0; jj < ii; ++jj) {
+          if (Gn->GetParameter(jj * 3 + 2) <= 0) continue;
+          for (unsigned short ipar = 0; ipar < 3; ++ipar)
+            setParams.push_back(Gn->GetParameter(jj * 3 + ipar));
+        } // jj
+        EvaluateMultiGaussian(setParams.data(), setParams.size() / 3, 0., 0., npt, fitted.data());
+        // tick 0 is skipped: the Gaussians not set yet (all zero parameters) made
+        // Gn->Eval(0) a NaN there, so it never was a bump candidate
+        for (unsigned short jj = 1; jj < npt; ++jj) {
+          float diff = signl[jj] - fitted[jj];
           if (diff > big) {
             big = diff;
             imbig = jj;
@@ -1,5 +1,7 @@
 #include "larreco/RecoAlg/CMTool/CMTAlgMerge/CBAlgoArray.h"
 
+#include <algorithm>
+
 namespace cmtool {
 
   //------------------------------------------
@@ -8,6 +10,7 @@ namespace cmtool {
   {
     _algo_array.clear();
     _ask_and.clear();
+    _last_and_algo_index = 0;
   }
 
   //-----------------------
@@ -94,6 +97,70 @@ namespace cmtool {
   }
 
   //------------------------
+  bool CBAlgoArray::MayMerge(double dist) const
+  {
+    // Follow Bool() with the running status possibly true or false, the algorithms with a
+    // reach up to dist answering false and the others either way
+    bool can_true = false;
+    bool can_false = false;
+    bool stopped_true = false;
+
+    for (size_t i = 0; i < _algo_array.size(); ++i) {
+
+      double algo_dist = _algo_array.at(i)->MaxMergeDistance();
+      bool algo_true = algo_dist < 0 || algo_dist > dist;
+
+      if (!i) {
+        can_true = algo_true;
+        can_false = true;
+        continue;
+      }
+
+      if (_ask_and.at(i))
+        can_false = false;
+      else {
+        stopped_true = stopped_true || can_true;
+        can_true = false;
+      }
+
+      if (i > _last_and_algo_index) {
+        stopped_true = stopped_true || can_true;
+        can_true = false;
+      }
+
+      if (_ask_and.at(i)) {
+        can_false = can_true;
+        can_true = can_true && algo_true;
+      }
+      else
+        can_true = can_false && algo_true;
+    }
+
+    return stopped_true || can_true;
+  }
+
+  double CBAlgoArray::MaxMergeDistance() const
+  {
+    std::vector<double> dists;
+    for (auto const& algo : _algo_array)
+      if (algo->MaxMergeDistance() >= 0) dists.push_back(algo->MaxMergeDistance());
+
+    std::sort(dists.begin(), dists.end());
+
+    for (auto const dist : dists)
+      if (!MayMerge(dist)) return dist;
+
+    return -1.;
+  }
+
+  bool CBAlgoArray::Symmetric() const
+  {
+    for (auto const& algo : _algo_array)
+      if (!algo->Symmetric()) return false;
+
+    return true;
+  }
+
   void CBAlgoArray::Report()
   //------------------------
   {
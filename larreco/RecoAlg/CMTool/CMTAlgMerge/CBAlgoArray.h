@@ -67,6 +67,12 @@ namespace cmtool {
     virtual bool Bool(const ::cluster::ClusterParamsAlg& cluster1,
                       const ::cluster::ClusterParamsAlg& cluster2);
 
+    /// Shortest reach of the algorithms beyond which their AND/OR conditions never merge
+    virtual double MaxMergeDistance() const;
+
+    /// Symmetric if all the algorithms are
+    virtual bool Symmetric() const;
+
     /**
        Optional function: called after each Merge() function call by CMergeManager IFF
        CMergeManager is run with verbosity level kPerMerging. Maybe useful for debugging.
@@ -84,6 +90,9 @@ namespace cmtool {
     virtual void Reset();
 
   protected:
+    /// Whether Bool() may be true for clusters too far apart for the algorithms reaching dist
+    bool MayMerge(double dist) const;
+
     /**
        A list of algorithms to be run over. Algorithms are executed in consecutive order
        in this vector, which is the order of calling AddMergeAlgo function. For each
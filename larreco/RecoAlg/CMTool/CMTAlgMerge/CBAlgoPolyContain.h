@@ -38,6 +38,11 @@ namespace cmtool {
     virtual bool Bool(const ::cluster::ClusterParamsAlg& cluster1,
                       const ::cluster::ClusterParamsAlg& cluster2);
 
+    /// Polygons apart do not contain one another
+    virtual double MaxMergeDistance() const { return 0.; }
+
+    virtual bool Symmetric() const { return true; }
+
     /// Method to re-configure the instance
     void reconfigure();
   };
@@ -38,6 +38,12 @@ namespace cmtool {
     virtual bool Bool(const ::cluster::ClusterParamsAlg& cluster1,
                       const ::cluster::ClusterParamsAlg& cluster2);
 
+    /// Polygons apart do not overlap
+    virtual double MaxMergeDistance() const { return 0.; }
+
+    /// Symmetric unless printing
+    virtual bool Symmetric() const { return !(_debug || _verbose); }
+
     void SetDebug(bool debug) { _debug = debug; }
 
     //both clusters must have > this # of hits to be considered for merging
@@ -1,5 +1,6 @@
 #include "larreco/RecoAlg/CMTool/CMTAlgMerge/CBAlgoPolyShortestDist.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace cmtool {
@@ -97,6 +98,11 @@ namespace cmtool {
   }
 
   //------------------------------
+  double CBAlgoPolyShortestDist::MaxMergeDistance() const
+  {
+    return std::sqrt(std::max(_dist_sqrd_cut, 0.));
+  }
+
   void CBAlgoPolyShortestDist::Report()
   //------------------------------
   {}
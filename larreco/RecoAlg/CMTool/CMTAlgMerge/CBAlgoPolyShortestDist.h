@@ -63,6 +63,12 @@ namespace cmtool {
     virtual bool Bool(const ::cluster::ClusterParamsAlg& cluster1,
                       const ::cluster::ClusterParamsAlg& cluster2);
 
+    /**
+       Polygon points are never closer than the bounding boxes. The pairs CMergeManager prunes
+       with its broad phase are not seen here, so they do not update tmp_min_dist.
+    */
+    virtual double MaxMergeDistance() const;
+
     /**
        Optional function: called after each Merge() function call by CMergeManager IFF
        CMergeManager is run with verbosity level kPerMerging. Maybe useful for debugging.
@@ -88,6 +94,7 @@ namespace cmtool {
 
     bool _debug;
 
+    /// Smallest squared distance of the pairs asked about since EventBegin()
     double tmp_min_dist;
   };
 }
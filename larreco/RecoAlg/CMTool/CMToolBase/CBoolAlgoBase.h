@@ -45,6 +45,20 @@ namespace cmtool {
       else
         return true;
     }
+
+    /**
+       Optional function: the largest distance in wire/time [cm] between the bounding boxes of
+       the polygons of two clusters that Bool() may still merge. CMergeManager, with its broad
+       phase on, does not ask about pairs farther apart. Negative (default) if there is no limit.
+    */
+    virtual double MaxMergeDistance() const { return -1.; }
+
+    /**
+       Optional function: true if Bool() is symmetric and depends on nothing but the two clusters,
+       so that pairs may be evaluated in any order and concurrently (no state kept or printed).
+       CMergeManager then evaluates the pairs in parallel if asked to. False by default.
+    */
+    virtual bool Symmetric() const { return false; }
   };
 
 }
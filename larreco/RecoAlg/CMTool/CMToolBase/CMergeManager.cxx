@@ -2,10 +2,14 @@
 
 #include "RtypesCore.h"
 #include "TString.h"
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
+
+#include "tbb/parallel_for.h"
 
 #include "lardata/Utilities/PxUtils.h"
 #include "larreco/RecoAlg/CMTool/CMToolBase/CBoolAlgoBase.h"
@@ -21,6 +25,8 @@ namespace cmtool {
     _iter_ctr = 0;
     _merge_algo = nullptr;
     _separate_algo = nullptr;
+    _broad_phase = false;
+    _parallel_pairs = false;
     Reset();
   }
 
@@ -252,53 +258,56 @@ namespace cmtool {
     // Merging
     //
 
-    // Run over clusters and execute merging algorithms
-    for (auto citer1 = _priority.rbegin(); citer1 != _priority.rend(); ++citer1) {
+    auto const candidates = MergeCandidates(in_clusters, merge_flag);
 
-      auto citer2 = citer1;
+    // A symmetric algorithm has all the pairs evaluated at once, in parallel. Pairs prohibited
+    // now will remain so, and the others are checked again below as merging goes, in order.
+    std::vector<char> merge_v;
 
-      UChar_t plane1 = in_clusters.at((*citer1).second).Plane();
+    if (_parallel_pairs && _debug_mode > kPerMerging && _merge_algo->Symmetric()) {
 
-      while (1) {
-        citer2++;
-        if (citer2 == _priority.rend()) break;
+      merge_v.resize(candidates.size(), false);
 
-        // Skip if not on the same plane
-        UChar_t plane2 = in_clusters.at((*citer2).second).Plane();
-        if (plane1 != plane2) continue;
+      tbb::parallel_for(static_cast<std::size_t>(0), candidates.size(), [&](std::size_t i) {
+        auto const& pair = candidates[i];
+        if (book_keeper.MergeAllowed(pair.first, pair.second))
+          merge_v[i] = _merge_algo->Bool(in_clusters.at(pair.first), in_clusters.at(pair.second));
+      });
+    }
 
-        // Skip if this combination is not meant to be compared
-        if (!(merge_flag.at((*citer2).second)) && !(merge_flag.at((*citer1).second))) continue;
+    // Run over cluster pairs and execute merging algorithms
+    for (size_t i = 0; i < candidates.size(); ++i) {
 
-        // Skip if this combination is not allowed to merge
-        if (!(book_keeper.MergeAllowed((*citer1).second, (*citer2).second))) continue;
+      auto const& pair = candidates[i];
 
-        if (_debug_mode <= kPerMerging) {
+      // Skip if this combination is not allowed to merge
+      if (!(book_keeper.MergeAllowed(pair.first, pair.second))) continue;
 
-          std::cout << Form("    \033[93mInspecting a pair (%zu, %zu) for merging... \033[00m",
-                            (*citer1).second,
-                            (*citer2).second)
-                    << std::endl;
-        }
+      if (_debug_mode <= kPerMerging) {
 
-        bool merge =
-          _merge_algo->Bool(in_clusters.at((*citer1).second), in_clusters.at((*citer2).second));
+        std::cout << Form("    \033[93mInspecting a pair (%zu, %zu) for merging... \033[00m",
+                          pair.first,
+                          pair.second)
+                  << std::endl;
+      }
 
-        if (_debug_mode <= kPerMerging) {
+      bool merge = merge_v.empty() ?
+                     _merge_algo->Bool(in_clusters.at(pair.first), in_clusters.at(pair.second)) :
+                     merge_v[i];
 
-          if (merge)
-            std::cout << "    \033[93mfound to be merged!\033[00m " << std::endl << std::endl;
+      if (_debug_mode <= kPerMerging) {
 
-          else
-            std::cout << "    \033[93mfound NOT to be merged...\033[00m" << std::endl << std::endl;
+        if (merge)
+          std::cout << "    \033[93mfound to be merged!\033[00m " << std::endl << std::endl;
 
-        } // end looping over all sets of algorithms
+        else
+          std::cout << "    \033[93mfound NOT to be merged...\033[00m" << std::endl << std::endl;
 
-        if (merge) book_keeper.Merge((*citer1).second, (*citer2).second);
+      } // end looping over all sets of algorithms
 
-      } // end looping over all cluster pairs for citer1
+      if (merge) book_keeper.Merge(pair.first, pair.second);
 
-    } // end looping over clusters
+    } // end looping over cluster pairs
 
     if (_debug_mode <= kPerIteration && book_keeper.GetResult().size() != in_clusters.size()) {
 
@@ -315,6 +324,111 @@ namespace cmtool {
     }
   }
 
+  std::vector<std::pair<size_t, size_t>> CMergeManager::MergeCandidates(
+    const std::vector<cluster::ClusterParamsAlg>& in_clusters,
+    const std::vector<bool>& merge_flag) const
+  {
+    // Clusters by decreasing priority
+    std::vector<size_t> order;
+    order.reserve(_priority.size());
+    for (auto citer = _priority.rbegin(); citer != _priority.rend(); ++citer)
+      order.push_back((*citer).second);
+
+    std::vector<std::pair<size_t, size_t>> candidates;
+
+    // Adds a pair of positions in the priority order, if meant to be compared
+    auto addPair = [&](size_t pos1, size_t pos2) {
+      size_t index1 = order[pos1];
+      size_t index2 = order[pos2];
+
+      // Skip if not on the same plane
+      if (in_clusters.at(index1).Plane() != in_clusters.at(index2).Plane()) return;
+
+      // Skip if this combination is not meant to be compared
+      if (!(merge_flag.at(index1)) && !(merge_flag.at(index2))) return;
+
+      candidates.emplace_back(index1, index2);
+    };
+
+    double max_dist = _broad_phase ? _merge_algo->MaxMergeDistance() : -1.;
+
+    if (max_dist < 0) {
+      for (size_t pos1 = 0; pos1 < order.size(); ++pos1)
+        for (size_t pos2 = pos1 + 1; pos2 < order.size(); ++pos2)
+          addPair(pos1, pos2);
+    }
+    else {
+
+      // Pairs of positions in the priority order
+      std::vector<std::pair<size_t, size_t>> pairs;
+
+      // Sweep and prune: the bounding boxes of the polygons, sorted by plane and first wire,
+      // are compared to those of the same plane that did not end more than max_dist before
+      struct Box {
+        int plane;
+        float wmin, wmax, tmin, tmax;
+        size_t pos;
+      };
+
+      std::vector<Box> boxes;
+      std::vector<bool> boxed(order.size(), false);
+
+      for (size_t pos = 0; pos < order.size(); ++pos) {
+
+        auto const& cluster = in_clusters.at(order[pos]);
+        auto const& poly = cluster.GetParams().PolyObject;
+
+        // Clusters without polygon are compared to all the others
+        if (!poly.Size()) continue;
+
+        Box box{cluster.Plane(), poly.Point(0).first, poly.Point(0).first, 0.F, 0.F, pos};
+        box.tmin = box.tmax = poly.Point(0).second;
+        for (unsigned int n = 1; n < poly.Size(); ++n) {
+          box.wmin = std::min(box.wmin, poly.Point(n).first);
+          box.wmax = std::max(box.wmax, poly.Point(n).first);
+          box.tmin = std::min(box.tmin, poly.Point(n).second);
+          box.tmax = std::max(box.tmax, poly.Point(n).second);
+        }
+        boxes.push_back(box);
+        boxed[pos] = true;
+      }
+
+      std::sort(boxes.begin(), boxes.end(), [](Box const& a, Box const& b) {
+        return a.plane < b.plane || (a.plane == b.plane && a.wmin < b.wmin);
+      });
+
+      std::vector<Box const*> active;
+      for (auto const& box : boxes) {
+
+        active.erase(std::remove_if(active.begin(),
+                                    active.end(),
+                                    [&](Box const* other) {
+                                      return other->plane != box.plane ||
+                                             other->wmax + max_dist < box.wmin;
+                                    }),
+                     active.end());
+
+        for (auto const other : active) {
+          if (other->tmin > box.tmax + max_dist || box.tmin > other->tmax + max_dist) continue;
+          pairs.push_back(std::minmax(other->pos, box.pos));
+        }
+
+        active.push_back(&box);
+      }
+
+      for (size_t pos1 = 0; pos1 < order.size(); ++pos1)
+        for (size_t pos2 = pos1 + 1; pos2 < order.size(); ++pos2)
+          if (!boxed[pos1] || !boxed[pos2]) pairs.emplace_back(pos1, pos2);
+
+      std::sort(pairs.begin(), pairs.end());
+
+      for (auto const& pair : pairs)
+        addPair(pair.first, pair.second);
+    }
+
+    return candidates;
+  }
+
   void CMergeManager::RunSeparate(const std::vector<cluster::ClusterParamsAlg>& in_clusters,
                                   CMergeBookKeeper& book_keeper) const
   {
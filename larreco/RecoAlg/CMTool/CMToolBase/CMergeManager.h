@@ -45,6 +45,12 @@ namespace cmtool {
     /// A simple method to add an algorithm for separation
     void AddSeparateAlgo(CBoolAlgoBase* algo) { _separate_algo = algo; }
 
+    /// Switch to skip the pairs too far apart for the merging algorithm, see MaxMergeDistance()
+    void BroadPhase(bool doit = true) { _broad_phase = doit; }
+
+    /// Switch to evaluate the pairs in parallel if the merging algorithm is Symmetric()
+    void ParallelPairs(bool doit = true) { _parallel_pairs = doit; }
+
     /// A method to obtain output clusters
     const std::vector<cluster::ClusterParamsAlg>& GetClusters() const { return _out_clusters; }
 
@@ -82,6 +88,11 @@ namespace cmtool {
     void RunSeparate(const std::vector<cluster::ClusterParamsAlg>& in_clusters,
                      CMergeBookKeeper& book_keeper) const;
 
+    /// Pairs of clusters to be compared, in the order of priority
+    std::vector<std::pair<size_t, size_t>> MergeCandidates(
+      const std::vector<cluster::ClusterParamsAlg>& in_clusters,
+      const std::vector<bool>& merge_flag) const;
+
   protected:
     /// Output clusters
     std::vector<cluster::ClusterParamsAlg> _out_clusters;
@@ -95,6 +106,12 @@ namespace cmtool {
     /// Separation algorithm
     ::cmtool::CBoolAlgoBase* _separate_algo;
 
+    /// Broad phase switch
+    bool _broad_phase;
+
+    /// Parallel pair evaluation switch
+    bool _parallel_pairs;
+
     size_t _iter_ctr;
 
     std::vector<CMergeBookKeeper> _book_keeper_v;
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/PooledAllocator.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/Voronoi/DCEL.h"
 namespace recob {
   class Hit;
@@ -320,19 +321,19 @@ namespace reco {
   /**
  *  @brief export some data structure definitions
  */
-  using Hit2DListPtr = std::list<const reco::ClusterHit2D*>;
-  using HitPairListPtr = std::list<const reco::ClusterHit3D*>;
+  using Hit2DListPtr = reco::PooledList<const reco::ClusterHit2D*>;
+  using HitPairListPtr = reco::PooledList<const reco::ClusterHit3D*>;
   using HitPairSetPtr = std::set<const reco::ClusterHit3D*>;
-  using HitPairListPtrList = std::list<HitPairListPtr>;
+  using HitPairListPtrList = reco::PooledList<HitPairListPtr>;
   using HitPairClusterMap = std::map<int, HitPairListPtr>;
-  using HitPairList = std::list<reco::ClusterHit3D>;
+  using HitPairList = reco::PooledList<reco::ClusterHit3D>;
   //using HitPairList              = std::list<std::unique_ptr<reco::ClusterHit3D>>;
 
   using PCAHitPairClusterMapPair =
     std::pair<reco::PrincipalComponents, reco::HitPairClusterMap::iterator>;
   using PlaneToClusterParamsMap = std::map<size_t, RecobClusterParameters>;
   using EdgeTuple = std::tuple<const reco::ClusterHit3D*, const reco::ClusterHit3D*, double>;
-  using EdgeList = std::list<EdgeTuple>;
+  using EdgeList = reco::PooledList<EdgeTuple>;
   using Hit3DToEdgePair = std::pair<const reco::ClusterHit3D*, reco::EdgeList>;
   using Hit3DToEdgeMap = std::unordered_map<const reco::ClusterHit3D*, reco::EdgeList>;
   using Hit2DToHit3DListMap = std::unordered_map<const reco::ClusterHit2D*, reco::HitPairListPtr>;
@@ -341,10 +342,10 @@ namespace reco {
 
   using ProjectedPoint = std::
     tuple<float, float, const reco::ClusterHit3D*>; ///< Projected coordinates and pointer to hit
-  using ProjectedPointList = std::list<ProjectedPoint>;
+  using ProjectedPointList = reco::PooledList<ProjectedPoint>;
   using ConvexHullKinkTuple = std::
     tuple<ProjectedPoint, Eigen::Vector2f, Eigen::Vector2f>; ///< Point plus edges that point to it
-  using ConvexHullKinkTupleList = std::list<ConvexHullKinkTuple>;
+  using ConvexHullKinkTupleList = reco::PooledList<ConvexHullKinkTuple>;
 
   /**
  *  @brief Define a container for working with the convex hull
@@ -388,7 +389,7 @@ namespace reco {
  *  @brief Class wrapping the above and containing volatile information to characterize the cluster
  */
   class ClusterParameters;
-  using ClusterParametersList = std::list<ClusterParameters>;
+  using ClusterParametersList = reco::PooledList<ClusterParameters>;
 
   class ClusterParameters {
   public:
@@ -21,7 +21,9 @@
 #include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
 
 // std includes
+#include <limits>
 #include <memory>
+#include <vector>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // implementation follows
@@ -77,8 +79,9 @@ namespace lar_cluster3d {
     /**
      *  @brief the main routine for DBScan
      */
-    void expandCluster(const kdTree::KdTreeNode&,
-                       kdTree::CandPairList&,
+    void expandCluster(const kdTree::FlatKdTree&,
+                       const std::vector<kdTree::CandPairVec>&,
+                       const kdTree::CandPairVec&,
                        reco::ClusterParameters&,
                        size_t) const;
 
@@ -146,29 +149,34 @@ namespace lar_cluster3d {
     // DBScan is driven of its "epsilon neighborhood". Computing adjacency within DBScan can be time
     // consuming so the idea is the prebuild the adjaceny map and then run DBScan.
     // We'll employ a kdTree to implement this scheme
-    kdTree::KdTreeNodeList kdTreeNodeContainer;
-    kdTree::KdTreeNode topNode = m_kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
+    kdTree::FlatKdTree flatKdTree;
+
+    m_kdTree.BuildFlatKdTree(hitPairList, flatKdTree);
 
     if (m_enableMonitoring) m_timeVector[BUILDHITTOHITMAP] = m_kdTree.getTimeToExecute();
 
     if (m_enableMonitoring) theClockDBScan.start();
 
+    // Every hit gets its neighborhood looked up exactly once so do them all up front, in parallel
+    std::vector<kdTree::CandPairVec> candPairVecs;
+
+    m_kdTree.FindAllNearestNeighbors(flatKdTree, candPairVecs, std::numeric_limits<float>::max());
+
+    size_t hitIdx(0);
+
     // Ok, here we go!
     // The idea is to loop through all of the input 3D hits and do the clustering
     for (const auto& hit : hitPairList) {
+      // The flat tree keeps the hits in input order
+      const kdTree::CandPairVec& candPairVec = candPairVecs[hitIdx++];
+
       // Check if the hit has already been visited
       if (hit.getStatusBits() & reco::ClusterHit3D::CLUSTERVISITED) continue;
 
       // Mark as visited
       hit.setStatusBit(reco::ClusterHit3D::CLUSTERVISITED);
 
-      // Find the neighborhood for this hit
-      kdTree::CandPairList candPairList;
-      float bestDistance(std::numeric_limits<float>::max());
-
-      m_kdTree.FindNearestNeighbors(&hit, topNode, candPairList, bestDistance);
-
-      if (candPairList.size() < m_minPairPts) {
+      if (candPairVec.size() < m_minPairPts) {
         hit.setStatusBit(reco::ClusterHit3D::CLUSTERNOISE);
       }
       else {
@@ -181,7 +189,7 @@ namespace lar_cluster3d {
         curCluster.addHit3D(&hit);
 
         // expand the cluster
-        expandCluster(topNode, candPairList, curCluster, m_minPairPts);
+        expandCluster(flatKdTree, candPairVecs, candPairVec, curCluster, m_minPairPts);
       }
     }
 
@@ -225,29 +233,34 @@ namespace lar_cluster3d {
     // DBScan is driven of its "epsilon neighborhood". Computing adjacency within DBScan can be time
     // consuming so the idea is the prebuild the adjaceny map and then run DBScan.
     // We'll employ a kdTree to implement this scheme
-    kdTree::KdTreeNodeList kdTreeNodeContainer;
-    kdTree::KdTreeNode topNode = m_kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
+    kdTree::FlatKdTree flatKdTree;
+
+    m_kdTree.BuildFlatKdTree(hitPairList, flatKdTree);
 
     if (m_enableMonitoring) m_timeVector[BUILDHITTOHITMAP] = m_kdTree.getTimeToExecute();
 
     if (m_enableMonitoring) theClockDBScan.start();
 
+    // Every hit gets its neighborhood looked up exactly once so do them all up front, in parallel
+    std::vector<kdTree::CandPairVec> candPairVecs;
+
+    m_kdTree.FindAllNearestNeighbors(flatKdTree, candPairVecs, std::numeric_limits<float>::max());
+
+    size_t hitIdx(0);
+
     // Ok, here we go!
     // The idea is to loop through all of the input 3D hits and do the clustering
     for (const auto& hit : hitPairList) {
+      // The flat tree keeps the hits in input order
+      const kdTree::CandPairVec& candPairVec = candPairVecs[hitIdx++];
+
       // Check if the hit has already been visited
       if (hit->getStatusBits() & reco::ClusterHit3D::CLUSTERVISITED) continue;
 
       // Mark as visited
       hit->setStatusBit(reco::ClusterHit3D::CLUSTERVISITED);
 
-      // Find the neighborhood for this hit
-      kdTree::CandPairList candPairList;
-      float bestDistance(std::numeric_limits<float>::max());
-
-      m_kdTree.FindNearestNeighbors(hit, topNode, candPairList, bestDistance);
-
-      if (candPairList.size() < m_minPairPts) {
+      if (candPairVec.size() < m_minPairPts) {
         hit->setStatusBit(reco::ClusterHit3D::CLUSTERNOISE);
       }
       else {
@@ -260,7 +273,7 @@ namespace lar_cluster3d {
         curCluster.addHit3D(hit);
 
         // expand the cluster
-        expandCluster(topNode, candPairList, curCluster, m_minPairPts);
+        expandCluster(flatKdTree, candPairVecs, candPairVec, curCluster, m_minPairPts);
       }
     }
 
@@ -290,17 +303,20 @@ namespace lar_cluster3d {
     return;
   }
 
-  void DBScanAlg::expandCluster(const kdTree::KdTreeNode& topNode,
-                                kdTree::CandPairList& candPairList,
+  void DBScanAlg::expandCluster(const kdTree::FlatKdTree& flatKdTree,
+                                const std::vector<kdTree::CandPairVec>& candPairVecs,
+                                const kdTree::CandPairVec& seedCandPairVec,
                                 reco::ClusterParameters& cluster,
                                 size_t minPts) const
   {
     // This is the main inside loop for the DBScan based clustering algorithm
+    // The candidate queue is consumed front to back and only ever grows at the end
+    kdTree::CandPairVec candPairQueue(seedCandPairVec);
 
     // Loop over added hits until list has been exhausted
-    while (!candPairList.empty()) {
+    for (size_t queueIdx = 0; queueIdx < candPairQueue.size(); queueIdx++) {
       // Dereference the point so we can see in the debugger...
-      const reco::ClusterHit3D* neighborHit = candPairList.front().second;
+      const reco::ClusterHit3D* neighborHit = candPairQueue[queueIdx].second;
 
       // Process if we've not been here before
       if (!(neighborHit->getStatusBits() & reco::ClusterHit3D::CLUSTERVISITED)) {
@@ -308,16 +324,13 @@ namespace lar_cluster3d {
         neighborHit->setStatusBit(reco::ClusterHit3D::CLUSTERVISITED);
 
         // get the neighborhood around this point
-        kdTree::CandPairList neighborCandPairList;
-        float bestDistance(std::numeric_limits<float>::max());
-
-        m_kdTree.FindNearestNeighbors(neighborHit, topNode, neighborCandPairList, bestDistance);
+        const kdTree::CandPairVec& neighborCandPairVec =
+          candPairVecs[flatKdTree.getHitIndex(neighborHit)];
 
         // If the epsilon neighborhood of this point is large enough then add its points to our list
-        if (neighborCandPairList.size() >= minPts) {
-          std::copy(neighborCandPairList.begin(),
-                    neighborCandPairList.end(),
-                    std::back_inserter(candPairList));
+        if (neighborCandPairVec.size() >= minPts) {
+          candPairQueue.insert(
+            candPairQueue.end(), neighborCandPairVec.begin(), neighborCandPairVec.end());
         }
       }
 
@@ -326,8 +339,6 @@ namespace lar_cluster3d {
         neighborHit->setStatusBit(reco::ClusterHit3D::CLUSTERATTACHED);
         cluster.addHit3D(neighborHit);
       }
-
-      candPairList.pop_front();
     }
 
     return;
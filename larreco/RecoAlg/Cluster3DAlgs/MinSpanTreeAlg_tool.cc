@@ -29,6 +29,7 @@
 #include <iostream>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 // Eigen includes
 #include <Eigen/Core>
@@ -82,7 +83,7 @@ namespace lar_cluster3d {
      *  @brief Driver for Prim's algorithm
      */
     void RunPrimsAlgorithm(reco::HitPairList&,
-                           kdTree::KdTreeNode&,
+                           const kdTree::FlatKdTree&,
                            reco::ClusterParametersList&) const;
 
     /**
@@ -105,7 +106,7 @@ namespace lar_cluster3d {
     /**
      *  @brief Alternative version of FindBestPathInCluster utilizing an A* algorithm
      */
-    void FindBestPathInCluster(reco::ClusterParameters&, kdTree::KdTreeNode&) const;
+    void FindBestPathInCluster(reco::ClusterParameters&, const kdTree::FlatKdTree&) const;
 
     /**
      *  @brief Algorithm to find shortest path between two 3D hits
@@ -113,7 +114,7 @@ namespace lar_cluster3d {
     void AStar(const reco::ClusterHit3D*,
                const reco::ClusterHit3D*,
                float alpha,
-               kdTree::KdTreeNode&,
+               const kdTree::FlatKdTree&,
                reco::ClusterParameters&) const;
 
     using BestNodeTuple = std::tuple<const reco::ClusterHit3D*, float, float>;
@@ -217,13 +218,14 @@ namespace lar_cluster3d {
     // DBScan is driven of its "epsilon neighborhood". Computing adjacency within DBScan can be time
     // consuming so the idea is the prebuild the adjaceny map and then run DBScan.
     // The following call does this work
-    kdTree::KdTreeNodeList kdTreeNodeContainer;
-    kdTree::KdTreeNode topNode = m_kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
+    kdTree::FlatKdTree flatKdTree;
+
+    m_kdTree.BuildFlatKdTree(hitPairList, flatKdTree);
 
     if (m_enableMonitoring) m_timeVector.at(BUILDHITTOHITMAP) = m_kdTree.getTimeToExecute();
 
     // Run DBScan to get candidate clusters
-    RunPrimsAlgorithm(hitPairList, topNode, clusterParametersList);
+    RunPrimsAlgorithm(hitPairList, flatKdTree, clusterParametersList);
 
     // Initial clustering is done, now trim the list and get output parameters
     cet::cpu_timer theClockBuildClusters;
@@ -241,7 +243,7 @@ namespace lar_cluster3d {
 
     // Test run the path finding algorithm
     for (auto& clusterParams : clusterParametersList)
-      FindBestPathInCluster(clusterParams, topNode);
+      FindBestPathInCluster(clusterParams, flatKdTree);
 
     mf::LogDebug("MinSpanTreeAlg") << ">>>>> Cluster3DHits done, found "
                                    << clusterParametersList.size() << " clusters" << std::endl;
@@ -251,7 +253,7 @@ namespace lar_cluster3d {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
   void MinSpanTreeAlg::RunPrimsAlgorithm(reco::HitPairList& hitPairList,
-                                         kdTree::KdTreeNode& topNode,
+                                         const kdTree::FlatKdTree& flatKdTree,
                                          reco::ClusterParametersList& clusterParametersList) const
   {
     // If no hits then no work
@@ -263,6 +265,12 @@ namespace lar_cluster3d {
     // Start clocks if requested
     if (m_enableMonitoring) theClockDBScan.start();
 
+    // Each hit is added to a cluster once and only then are its neighbors needed, so look them
+    // all up front in parallel
+    std::vector<kdTree::CandPairVec> candPairVecs;
+
+    m_kdTree.FindAllNearestNeighbors(flatKdTree, candPairVecs, 1.5);
+
     // Initialization
     size_t clusterIdx(0);
 
@@ -302,17 +310,14 @@ namespace lar_cluster3d {
       // Add the lastUsedHit to the current cluster
       curCluster->push_back(lastAddedHit);
 
-      // Set up to find the list of nearest neighbors to the last used hit...
-      kdTree::CandPairList CandPairList;
-      float bestDistance(1.5); //std::numeric_limits<float>::max());
-
-      // And find them... result will be an unordered list of neigbors
-      m_kdTree.FindNearestNeighbors(lastAddedHit, topNode, CandPairList, bestDistance);
+      // Recover the list of nearest neighbors to the last used hit, an unordered list of neighbors
+      const kdTree::CandPairVec& CandPairList =
+        candPairVecs[flatKdTree.getHitIndex(lastAddedHit)];
 
       // Copy edges to the current list (but only for hits not already in a cluster)
       //        for(auto& pair : CandPairList)
       //            if (!(pair.second->getStatusBits() & reco::ClusterHit3D::CLUSTERATTACHED)) curEdgeList.push_back(reco::EdgeTuple(lastAddedHit,pair.second,pair.first));
-      for (auto& pair : CandPairList) {
+      for (const auto& pair : CandPairList) {
         if (!(pair.second->getStatusBits() & reco::ClusterHit3D::CLUSTERATTACHED)) {
           double edgeWeight = lastAddedHit->getHitChiSquare() * pair.second->getHitChiSquare();
 
@@ -443,7 +448,7 @@ namespace lar_cluster3d {
   }
 
   void MinSpanTreeAlg::FindBestPathInCluster(reco::ClusterParameters& clusterParams,
-                                             kdTree::KdTreeNode& topNode) const
+                                             const kdTree::FlatKdTree& flatKdTree) const
   {
     // Set up for timing the function
     cet::cpu_timer theClockPathFinding;
@@ -512,7 +517,7 @@ namespace lar_cluster3d {
                     << std::endl;
 
           // Call the AStar function to try to find the best path...
-          //                AStar(startHit,stopHit,alpha,topNode,clusterParams);
+          //                AStar(startHit,stopHit,alpha,flatKdTree,clusterParams);
 
           float cost(std::numeric_limits<float>::max());
 
@@ -541,7 +546,7 @@ namespace lar_cluster3d {
   void MinSpanTreeAlg::AStar(const reco::ClusterHit3D* startNode,
                              const reco::ClusterHit3D* goalNode,
                              float alpha,
-                             kdTree::KdTreeNode& topNode,
+                             const kdTree::FlatKdTree& flatKdTree,
                              reco::ClusterParameters& clusterParams) const
   {
     // Recover the list of hits and edges
@@ -0,0 +1,428 @@
+/**
+ *  @file   PooledAllocator.h
+ *
+ *  @brief  Stateless allocator serving list nodes from per-thread free lists
+ *
+ *          The 3D clustering builds and tears down very large numbers of
+ *          std::list nodes per event (hit lists, edge lists, projected point
+ *          lists...). Routing every node through the global heap makes the
+ *          allocator a hot spot and scatters the nodes in memory. This
+ *          allocator carves nodes out of large contiguous chunks instead:
+ *          each thread owns a cache with its chunks and its free list, so the
+ *          common path takes no lock.
+ *
+ *          Every chunk is aligned to its own size and records the cache owning
+ *          it, so a node released on another thread goes back to that cache:
+ *          it is pushed onto a lock-free list the owner drains when its free
+ *          list runs dry. When a thread exits its cache is left to the store,
+ *          which hands it over to the next thread needing one.
+ *
+ *          Chunks are not given back to the heap on every free. A reset point
+ *          (see ReleasePooledMemory and PooledMemoryScope, used once per event
+ *          by the Cluster3D module) frees the chunks of the calling thread, and
+ *          those left behind by exited threads, once all their nodes are back.
+ *          The store is shared between a static handle and every thread using
+ *          it, so it outlives the thread_local caches whatever the order of
+ *          destruction; whatever is left is freed with it.
+ *
+ *          The allocator is stateless (all instances compare equal) so lists
+ *          using it keep the full std::list interface, including splice.
+ *          Containers using it must not have static storage duration. The
+ *          node size is only looked at in allocate/deallocate so lists of
+ *          incomplete types (e.g. ClusterParametersList) are fine.
+ *
+ */
+#ifndef RECO_POOLEDALLOCATOR_H
+#define RECO_POOLEDALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace reco {
+
+  namespace detail {
+
+    /**
+     *  @brief Keeps the release function of every node pool in use
+     */
+    class PoolRegistry {
+    public:
+      using ReleaseFunc_t = void (*)();
+
+      static void add(ReleaseFunc_t release)
+      {
+        PoolRegistry& registry = instance();
+        std::lock_guard<std::mutex> lock(registry.fMutex);
+
+        registry.fReleaseFuncs.push_back(release);
+      }
+
+      static void releaseAll()
+      {
+        PoolRegistry& registry = instance();
+        std::vector<ReleaseFunc_t> releaseFuncs;
+        {
+          std::lock_guard<std::mutex> lock(registry.fMutex);
+
+          releaseFuncs = registry.fReleaseFuncs;
+        }
+
+        for (ReleaseFunc_t release : releaseFuncs)
+          release();
+      }
+
+    private:
+      static PoolRegistry& instance()
+      {
+        static PoolRegistry theRegistry;
+        return theRegistry;
+      }
+
+      std::mutex fMutex;
+      std::vector<ReleaseFunc_t> fReleaseFuncs;
+    };
+
+    /**
+     *  @brief Pool of fixed size blocks shared by all allocators with the same node layout
+     */
+    template <std::size_t Size, std::size_t Align>
+    class NodePool {
+    public:
+      static void* allocate()
+      {
+        Cache* cache = tlsCache;
+
+        if (!cache) cache = attach();
+
+        if (!cache->head) refill(*cache);
+
+        FreeNode* node = cache->head;
+
+        cache->head = node->next;
+        ++cache->live;
+
+        return node;
+      }
+
+      static void deallocate(void* ptr) noexcept
+      {
+        FreeNode* node = static_cast<FreeNode*>(ptr);
+        Cache* owner = chunkOf(node)->owner;
+
+        if (owner == tlsCache) {
+          node->next = owner->head;
+          owner->head = node;
+          --owner->live;
+        }
+        else {
+          // Node of another thread: hand it back to its owner
+          FreeNode* head = owner->remote.load(std::memory_order_relaxed);
+
+          do {
+            node->next = head;
+          } while (!owner->remote.compare_exchange_weak(
+            head, node, std::memory_order_release, std::memory_order_relaxed));
+        }
+      }
+
+      /// Frees the chunks of this thread, and of exited threads, whose nodes are all back
+      static void release()
+      {
+        if (Cache* cache = tlsCache) {
+          drain(*cache);
+
+          if (cache->live == 0) freeChunks(*cache);
+        }
+
+        sharedStore()->releaseOrphans();
+      }
+
+      /// Number of chunks currently held by the pool
+      static std::size_t numChunks() { return sharedStore()->numChunks(); }
+
+    private:
+      struct FreeNode {
+        FreeNode* next;
+      };
+
+      struct Cache;
+
+      /// Header at the start of each chunk, followed by the blocks
+      struct Chunk {
+        Cache* owner;
+        Chunk* next;
+      };
+
+      static constexpr std::size_t kAlign = Align > alignof(FreeNode) ? Align : alignof(FreeNode);
+      static constexpr std::size_t kBlockSize =
+        ((Size > sizeof(FreeNode) ? Size : sizeof(FreeNode)) + kAlign - 1) / kAlign * kAlign;
+      static constexpr std::size_t kHeaderSize = (sizeof(Chunk) + kAlign - 1) / kAlign * kAlign;
+
+      /// Smallest power of two holding the header and at least 64 blocks, at least 64 kB
+      static constexpr std::size_t chunkSize()
+      {
+        std::size_t size = 65536;
+
+        while (size < kHeaderSize + 64 * kBlockSize)
+          size *= 2;
+
+        return size;
+      }
+
+      static constexpr std::size_t kChunkSize = chunkSize();
+      static constexpr std::size_t kBlocksPerChunk = (kChunkSize - kHeaderSize) / kBlockSize;
+
+      /// Chunks and free nodes of one thread; nodes freed by other threads land on remote
+      struct Cache {
+        FreeNode* head = nullptr;
+        std::size_t live = 0; ///< blocks handed out and not back on head yet
+        Chunk* chunks = nullptr;
+        std::size_t nChunks = 0;
+        std::atomic<FreeNode*> remote{nullptr};
+        bool orphan = false; ///< no thread owns it (guarded by the store mutex)
+      };
+
+      static Chunk* chunkOf(void* ptr) noexcept
+      {
+        return reinterpret_cast<Chunk*>(reinterpret_cast<std::uintptr_t>(ptr) & ~(kChunkSize - 1));
+      }
+
+      /// Moves the nodes freed by other threads onto the free list
+      static void drain(Cache& cache) noexcept
+      {
+        FreeNode* node = cache.remote.exchange(nullptr, std::memory_order_acquire);
+
+        while (node) {
+          FreeNode* next = node->next;
+
+          node->next = cache.head;
+          cache.head = node;
+          --cache.live;
+          node = next;
+        }
+      }
+
+      static void refill(Cache& cache)
+      {
+        drain(cache);
+
+        if (cache.head) return;
+
+        char* memory = static_cast<char*>(::operator new(kChunkSize, std::align_val_t(kChunkSize)));
+        Chunk* chunk = new (memory) Chunk{&cache, cache.chunks};
+
+        cache.chunks = chunk;
+        ++cache.nChunks;
+
+        // Thread the new blocks into a free list in address order
+        for (std::size_t idx = kBlocksPerChunk; idx-- > 0;) {
+          FreeNode* node = reinterpret_cast<FreeNode*>(memory + kHeaderSize + idx * kBlockSize);
+
+          node->next = cache.head;
+          cache.head = node;
+        }
+      }
+
+      static void freeChunks(Cache& cache) noexcept
+      {
+        while (Chunk* chunk = cache.chunks) {
+          cache.chunks = chunk->next;
+          ::operator delete(chunk, std::align_val_t(kChunkSize));
+        }
+
+        cache.head = nullptr;
+        cache.nChunks = 0;
+      }
+
+      /// Owner of all the caches, kept alive by a static handle and by each thread using it
+      class Store {
+      public:
+        ~Store()
+        {
+          for (auto& cache : fCaches)
+            freeChunks(*cache);
+        }
+
+        Cache* adopt()
+        {
+          std::lock_guard<std::mutex> lock(fMutex);
+
+          for (auto& cache : fCaches) {
+            if (cache->orphan) {
+              cache->orphan = false;
+              return cache.get();
+            }
+          }
+
+          fCaches.push_back(std::make_unique<Cache>());
+
+          return fCaches.back().get();
+        }
+
+        void abandon(Cache& cache) noexcept
+        {
+          drain(cache);
+
+          if (cache.live == 0) freeChunks(cache);
+
+          std::lock_guard<std::mutex> lock(fMutex);
+
+          cache.orphan = true;
+        }
+
+        void releaseOrphans() noexcept
+        {
+          std::lock_guard<std::mutex> lock(fMutex);
+
+          for (auto& cache : fCaches) {
+            if (!cache->orphan) continue;
+
+            drain(*cache);
+
+            if (cache->live == 0) freeChunks(*cache);
+          }
+        }
+
+        std::size_t numChunks()
+        {
+          std::lock_guard<std::mutex> lock(fMutex);
+          std::size_t nChunks = 0;
+
+          for (auto& cache : fCaches)
+            nChunks += cache->nChunks;
+
+          return nChunks;
+        }
+
+      private:
+        std::mutex fMutex;
+        std::vector<std::unique_ptr<Cache>> fCaches;
+      };
+
+      /// Ties the cache of a thread to that thread, and the store to the thread lifetime
+      struct ThreadHandle {
+        ThreadHandle() : store(sharedStore()), cache(store->adopt()) { tlsCache = cache; }
+
+        ~ThreadHandle()
+        {
+          tlsCache = nullptr;
+          tlsDetached = true;
+          store->abandon(*cache);
+        }
+
+        std::shared_ptr<Store> store;
+        Cache* cache;
+      };
+
+      static std::shared_ptr<Store> sharedStore()
+      {
+        static std::shared_ptr<Store> theStore = [] {
+          PoolRegistry::add(&NodePool::release);
+          return std::make_shared<Store>();
+        }();
+        return theStore;
+      }
+
+      static Cache* attach()
+      {
+        // Allocations from later thread_local destructors get a cache freed with the store
+        if (tlsDetached) return tlsCache = sharedStore()->adopt();
+
+        static thread_local ThreadHandle theHandle;
+        return theHandle.cache;
+      }
+
+      static inline thread_local Cache* tlsCache = nullptr;
+      static inline thread_local bool tlsDetached = false;
+    };
+
+  } // namespace detail
+
+  /**
+   *  @brief Allocator drawing single objects from a detail::NodePool, larger requests go to the heap
+   */
+  template <typename T>
+  class PooledAllocator {
+  public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    PooledAllocator() noexcept = default;
+
+    template <typename U>
+    PooledAllocator(const PooledAllocator<U>&) noexcept
+    {}
+
+    T* allocate(std::size_t n)
+    {
+      if (n == 1) return static_cast<T*>(detail::NodePool<sizeof(T), alignof(T)>::allocate());
+
+      return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+      if (n == 1)
+        detail::NodePool<sizeof(T), alignof(T)>::deallocate(ptr);
+      else
+        ::operator delete(ptr, std::align_val_t(alignof(T)));
+    }
+
+    /// Number of chunks held by the pool serving single objects of type T
+    static std::size_t numChunks() { return detail::NodePool<sizeof(T), alignof(T)>::numChunks(); }
+  };
+
+  template <typename T, typename U>
+  bool operator==(const PooledAllocator<T>&, const PooledAllocator<U>&) noexcept
+  {
+    return true;
+  }
+
+  template <typename T, typename U>
+  bool operator!=(const PooledAllocator<T>&, const PooledAllocator<U>&) noexcept
+  {
+    return false;
+  }
+
+  /**
+   *  @brief std::list whose nodes come from the pooled allocator
+   */
+  template <typename T>
+  using PooledList = std::list<T, PooledAllocator<T>>;
+
+  /**
+   *  @brief Reset point: gives back to the heap the chunks whose nodes are all free
+   *
+   *  Only the chunks of the calling thread and of threads which have exited
+   *  are considered; those of a pool with nodes still in use are kept.
+   */
+  inline void ReleasePooledMemory()
+  {
+    detail::PoolRegistry::releaseAll();
+  }
+
+  /**
+   *  @brief Calls ReleasePooledMemory when going out of scope
+   *
+   *  Declare it before the pooled containers of a unit of work (e.g. an event)
+   *  so that it is destroyed after them.
+   */
+  class PooledMemoryScope {
+  public:
+    PooledMemoryScope() = default;
+    PooledMemoryScope(const PooledMemoryScope&) = delete;
+    PooledMemoryScope& operator=(const PooledMemoryScope&) = delete;
+    ~PooledMemoryScope() { ReleasePooledMemory(); }
+  };
+
+} // namespace reco
+
+#endif
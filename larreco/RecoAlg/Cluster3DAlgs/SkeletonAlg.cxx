@@ -361,7 +361,7 @@ namespace lar_cluster3d {
     reco::HitPairListPtr::iterator hitPairItr = skeletonHitList.begin();
 
     for (int bestPlaneVecIdx = 0; bestPlaneVecIdx < 2; bestPlaneVecIdx++) {
-      std::list<reco::ClusterHit3D> tempHitPairList;
+      reco::HitPairList tempHitPairList;
       reco::HitPairListPtr tempHitPairListPtr;
 
       std::map<const reco::ClusterHit3D*, const reco::ClusterHit3D*> hit3DToHit3DMap;
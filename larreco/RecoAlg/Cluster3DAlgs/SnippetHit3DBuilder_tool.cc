@@ -65,7 +65,7 @@ namespace lar_cluster3d {
   using SnippetHitMap = std::map<HitStartEndPair, HitVector>;
   using PlaneToSnippetHitMap = std::map<geo::PlaneID, SnippetHitMap>;
   using TPCToPlaneToSnippetHitMap = std::map<geo::TPCID, PlaneToSnippetHitMap>;
-  using Hit2DList = std::list<reco::ClusterHit2D>;
+  using Hit2DList = reco::PooledList<reco::ClusterHit2D>;
   using Hit2DSet = std::set<const reco::ClusterHit2D*, Hit2DSetCompare>;
   using WireToHitSetMap = std::map<unsigned int, Hit2DSet>;
   using PlaneToWireToHitSetMap = std::map<geo::PlaneID, WireToHitSetMap>;
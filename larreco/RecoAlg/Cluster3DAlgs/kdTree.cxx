@@ -13,8 +13,14 @@
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
 
+// TBB
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
 // std includes
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // implementation follows
@@ -221,6 +227,227 @@ namespace lar_cluster3d {
     return CandPairList.size();
   }
 
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  void kdTree::BuildFlatKdTree(const reco::HitPairList& hitPairList, FlatKdTree& flatKdTree) const
+  {
+    cet::cpu_timer theClockBuildNeighborhood;
+
+    if (fEnableMonitoring) theClockBuildNeighborhood.start();
+
+    Hit3DVec hit3DVec;
+
+    hit3DVec.reserve(hitPairList.size());
+
+    for (const auto& hit : hitPairList)
+      hit3DVec.emplace_back(&hit);
+
+    FillFlatKdTree(std::move(hit3DVec), flatKdTree);
+
+    if (fEnableMonitoring) {
+      theClockBuildNeighborhood.stop();
+      fTimeToBuild = theClockBuildNeighborhood.accumulated_real_time();
+    }
+
+    return;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  void kdTree::BuildFlatKdTree(const reco::HitPairListPtr& hitPairList,
+                               FlatKdTree& flatKdTree) const
+  {
+    cet::cpu_timer theClockBuildNeighborhood;
+
+    if (fEnableMonitoring) theClockBuildNeighborhood.start();
+
+    Hit3DVec hit3DVec;
+
+    hit3DVec.reserve(hitPairList.size());
+
+    for (const auto& hit3D : hitPairList) {
+      // Make sure all the bits used by the clustering stage have been cleared
+      hit3D->clearStatusBits(~(reco::ClusterHit3D::HITINVIEW0 | reco::ClusterHit3D::HITINVIEW1 |
+                               reco::ClusterHit3D::HITINVIEW2));
+      for (const auto& hit2D : hit3D->getHits())
+        if (hit2D) hit2D->clearStatusBits(0xFFFFFFFF);
+      hit3DVec.emplace_back(hit3D);
+    }
+
+    FillFlatKdTree(std::move(hit3DVec), flatKdTree);
+
+    if (fEnableMonitoring) {
+      theClockBuildNeighborhood.stop();
+      fTimeToBuild = theClockBuildNeighborhood.accumulated_real_time();
+    }
+
+    return;
+  }
+
+  void kdTree::FillFlatKdTree(Hit3DVec&& hit3DVec, FlatKdTree& flatKdTree) const
+  {
+    flatKdTree.clear();
+
+    flatKdTree.fHits = std::move(hit3DVec);
+
+    size_t nHits = flatKdTree.fHits.size();
+
+    for (auto& posVec : flatKdTree.fPosition)
+      posVec.resize(nHits);
+
+    flatKdTree.fHitToIndex.reserve(nHits);
+
+    for (size_t idx = 0; idx < nHits; idx++) {
+      const Eigen::Vector3f& position = flatKdTree.fHits[idx]->getPosition();
+
+      for (size_t axis = 0; axis < 3; axis++)
+        flatKdTree.fPosition[axis][idx] = position[axis];
+
+      flatKdTree.fHitToIndex.emplace(flatKdTree.fHits[idx], idx);
+    }
+
+    // The tree is built over hit indices, at most 2N - 1 nodes
+    std::vector<uint32_t> hitIdxVec(nHits);
+
+    std::iota(hitIdxVec.begin(), hitIdxVec.end(), 0);
+
+    flatKdTree.fNodes.reserve(2 * nHits);
+
+    BuildFlatKdTree(hitIdxVec.begin(), hitIdxVec.end(), flatKdTree);
+
+    return;
+  }
+
+  void kdTree::BuildFlatKdTree(std::vector<uint32_t>::iterator first,
+                               std::vector<uint32_t>::iterator last,
+                               FlatKdTree& flatKdTree) const
+  {
+    // Reserve our slot first so the nodes end up in pre-order
+    size_t nodeIdx = flatKdTree.fNodes.size();
+
+    flatKdTree.fNodes.push_back({0., 0, KdTreeNode::null});
+
+    // End condition, make a leaf (or a null node if the input is empty)
+    if (std::distance(first, last) < 2) {
+      if (first != last) {
+        flatKdTree.fNodes[nodeIdx].axis = KdTreeNode::leaf;
+        flatKdTree.fNodes[nodeIdx].index = *first;
+      }
+
+      return;
+    }
+
+    // Split exactly as the node based tree does: along the axis with the largest range and at
+    // the first occurence of the median value
+    float rangeVec[3];
+
+    for (size_t axis = 0; axis < 3; axis++) {
+      const std::vector<float>& axisPos = flatKdTree.fPosition[axis];
+      auto minMaxPair = std::minmax_element(
+        first, last, [&axisPos](uint32_t left, uint32_t right) { return axisPos[left] < axisPos[right]; });
+
+      rangeVec[axis] = axisPos[*minMaxPair.second] - axisPos[*minMaxPair.first];
+    }
+
+    size_t maxRangeIdx = std::distance(rangeVec, std::max_element(rangeVec, rangeVec + 3));
+    const std::vector<float>& axisPos = flatKdTree.fPosition[maxRangeIdx];
+
+    std::sort(first, last, [&axisPos](uint32_t left, uint32_t right) {
+      return axisPos[left] < axisPos[right];
+    });
+
+    std::vector<uint32_t>::iterator middleItr = first + std::distance(first, last) / 2;
+
+    while (std::distance(first, middleItr) > 1 && !(axisPos[*(middleItr - 1)] < axisPos[*middleItr]))
+      middleItr--;
+
+    float axisVal = 0.5 * (axisPos[*middleItr] + axisPos[*(middleItr - 1)]);
+
+    // Left child is the next node, remember where the right child starts
+    BuildFlatKdTree(first, middleItr, flatKdTree);
+
+    uint32_t rightIdx = flatKdTree.fNodes.size();
+
+    BuildFlatKdTree(middleItr, last, flatKdTree);
+
+    FlatKdTree::Node& node = flatKdTree.fNodes[nodeIdx];
+
+    node.axisValue = axisVal;
+    node.index = rightIdx;
+    node.axis = maxRangeIdx;
+
+    return;
+  }
+
+  size_t kdTree::FindNearestNeighbors(size_t refIdx,
+                                      const FlatKdTree& flatKdTree,
+                                      CandPairVec& candPairVec,
+                                      float& bestDist) const
+  {
+    if (!flatKdTree.fNodes.empty())
+      FindNearestNeighbors(refIdx, flatKdTree, 0, candPairVec, bestDist);
+
+    return candPairVec.size();
+  }
+
+  void kdTree::FindNearestNeighbors(size_t refIdx,
+                                    const FlatKdTree& flatKdTree,
+                                    uint32_t nodeIdx,
+                                    CandPairVec& candPairVec,
+                                    float& bestDist) const
+  {
+    const FlatKdTree::Node& node = flatKdTree.fNodes[nodeIdx];
+
+    // Same logic as the node based search so the neighborhoods are identical
+    if (node.axis == KdTreeNode::leaf) {
+      if (node.index == refIdx)
+        bestDist = fRefLeafBestDist;
+      else if (consistentPairs(
+                 flatKdTree.fHits[refIdx], flatKdTree.fHits[node.index], bestDist)) {
+        candPairVec.emplace_back(bestDist, flatKdTree.fHits[node.index]);
+
+        bestDist = std::max(fRefLeafBestDist, bestDist);
+      }
+    }
+    else if (node.axis != KdTreeNode::null) {
+      float refPosition = flatKdTree.fPosition[node.axis][refIdx];
+
+      if (refPosition < node.axisValue) {
+        FindNearestNeighbors(refIdx, flatKdTree, nodeIdx + 1, candPairVec, bestDist);
+
+        if (refPosition + bestDist > node.axisValue)
+          FindNearestNeighbors(refIdx, flatKdTree, node.index, candPairVec, bestDist);
+      }
+      else {
+        FindNearestNeighbors(refIdx, flatKdTree, node.index, candPairVec, bestDist);
+
+        if (refPosition - bestDist < node.axisValue)
+          FindNearestNeighbors(refIdx, flatKdTree, nodeIdx + 1, candPairVec, bestDist);
+      }
+    }
+
+    return;
+  }
+
+  void kdTree::FindAllNearestNeighbors(const FlatKdTree& flatKdTree,
+                                       std::vector<CandPairVec>& candPairVecs,
+                                       float bestDist) const
+  {
+    candPairVecs.resize(flatKdTree.size());
+
+    // Queries only read the tree and the hits so they can all run concurrently
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, flatKdTree.size()),
+                      [&](const tbb::blocked_range<size_t>& range) {
+                        for (size_t idx = range.begin(); idx != range.end(); idx++) {
+                          float queryBestDist(bestDist);
+
+                          candPairVecs[idx].clear();
+
+                          FindNearestNeighbors(idx, flatKdTree, candPairVecs[idx], queryBestDist);
+                        }
+                      });
+
+    return;
+  }
+
   bool kdTree::FindEntry(const reco::ClusterHit3D* refHit,
                          const KdTreeNode& node,
                          CandPairList& CandPairList,
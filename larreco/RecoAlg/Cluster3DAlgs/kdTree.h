@@ -18,7 +18,9 @@ namespace fhicl {
 #include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
 
 // std includes
+#include <cstdint>
 #include <list>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -101,9 +103,50 @@ namespace lar_cluster3d {
      */
     KdTreeNode BuildKdTree(const reco::HitPairListPtr&, KdTreeNodeList&) const;
 
+    /**
+     *  @brief Flat, array laid out version of the tree for batched neighborhood queries
+     */
+    class FlatKdTree;
+
+    using CandPairVec = std::vector<CandPair>;
+
+    /**
+     *  @brief Given an input HitPairList, build the flat version of the kd tree
+     */
+    void BuildFlatKdTree(const reco::HitPairList&, FlatKdTree&) const;
+
+    /**
+     *  @brief Given an input HitPairListPtr, build the flat version of the kd tree
+     */
+    void BuildFlatKdTree(const reco::HitPairListPtr&, FlatKdTree&) const;
+
+    /**
+     *  @brief Find the neighbors of the hit with the given index in the flat tree, same
+     *         selection (and ordering) as the node based FindNearestNeighbors
+     */
+    size_t FindNearestNeighbors(size_t, const FlatKdTree&, CandPairVec&, float&) const;
+
+    /**
+     *  @brief Batched query: find the neighbors of every hit in the flat tree in parallel
+     *
+     *  @param flatKdTree    The tree to query
+     *  @param candPairVecs  Output neighborhoods, indexed as the hits in the tree
+     *  @param bestDist      Starting search distance for each query
+     */
+    void FindAllNearestNeighbors(const FlatKdTree& flatKdTree,
+                                 std::vector<CandPairVec>& candPairVecs,
+                                 float bestDist) const;
+
     float getTimeToExecute() const { return fTimeToBuild; }
 
   private:
+    void FillFlatKdTree(Hit3DVec&&, FlatKdTree&) const;
+    void BuildFlatKdTree(std::vector<uint32_t>::iterator,
+                         std::vector<uint32_t>::iterator,
+                         FlatKdTree&) const;
+
+    void FindNearestNeighbors(size_t, const FlatKdTree&, uint32_t, CandPairVec&, float&) const;
+
     /**
      *  @brief The bigger question: are two pairs of hits consistent?
      */
@@ -169,5 +212,49 @@ namespace lar_cluster3d {
     const KdTreeNode& m_rightTree;
   };
 
+  /**
+ *  @brief define the flat kd tree
+ *
+ *         Nodes are stored in pre-order so the left child of a node is the next entry in the
+ *         node vector and only the right child index needs to be kept. Hit positions are kept
+ *         as separate x/y/z arrays indexed like the input hits.
+ */
+  class kdTree::FlatKdTree {
+  public:
+    struct Node {
+      float axisValue;  ///< Split value, not used for leaves
+      uint32_t index;   ///< Right child for split nodes, hit index for leaves
+      uint8_t axis;     ///< One of KdTreeNode::SplitAxis
+    };
+
+    using NodeVec = std::vector<Node>;
+
+    void clear()
+    {
+      fHits.clear();
+      for (auto& posVec : fPosition)
+        posVec.clear();
+      fNodes.clear();
+      fHitToIndex.clear();
+    }
+
+    size_t size() const { return fHits.size(); }
+    bool empty() const { return fHits.empty(); }
+
+    const Hit3DVec& getHits() const { return fHits; }
+    const reco::ClusterHit3D* getHit(size_t idx) const { return fHits[idx]; }
+    size_t getHitIndex(const reco::ClusterHit3D* hit) const { return fHitToIndex.at(hit); }
+    const std::vector<float>& getPosition(size_t axis) const { return fPosition[axis]; }
+    const NodeVec& getNodes() const { return fNodes; }
+
+  private:
+    friend class kdTree;
+
+    Hit3DVec fHits;                   ///< The hits, in input order
+    std::vector<float> fPosition[3];  ///< x, y and z of the hits
+    NodeVec fNodes;                   ///< Tree nodes in pre-order, root first
+    std::unordered_map<const reco::ClusterHit3D*, size_t> fHitToIndex;
+  };
+
 } // namespace lar_cluster3d
 #endif
@@ -1,6 +1,5 @@
 #include "larreco/RecoAlg/DBScan3DAlg.h"
 #include "larcore/Geometry/Geometry.h"
-#include "larcorealg/CoreUtils/NumericUtils.h" // util::absDiff()
 #include "larcorealg/Geometry/GeometryCore.h"
 #include "lardataobj/RecoBase/Hit.h"
 #include "lardataobj/RecoBase/SpacePoint.h"
@@ -9,12 +8,21 @@
 
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "cetlib/pow.h"
+#include "cetlib_except/exception.h"
 #include "fhiclcpp/ParameterSet.h"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <stdio.h>
 #include <stdlib.h>
 
+namespace {
+  // number of bits used for each cell coordinate in a cell key
+  constexpr unsigned int kCellBits = 21;
+  constexpr long kMaxCell = (1L << kCellBits) - 1;
+}
+
 cluster::DBScan3DAlg::DBScan3DAlg(fhicl::ParameterSet const& pset)
   : epsilon(pset.get<float>("epsilon"))
   , minpts(pset.get<unsigned int>("minpts"))
@@ -30,25 +38,7 @@ void cluster::DBScan3DAlg::init(const std::vector<art::Ptr<recob::SpacePoint>>&
                                 art::FindManyP<recob::Hit>& hitFromSp)
 {
 
-  if (badchannelmap.empty()) {
-    lariov::ChannelStatusProvider const& channelStatus =
-      art::ServiceHandle<lariov::ChannelStatusService const>()->GetProvider();
-    geo::GeometryCore const* geom = &*(art::ServiceHandle<geo::Geometry const>());
-    // build a map to count bad channels around each wire ID
-    for (auto& pid : geom->Iterate<geo::PlaneID>()) {
-      for (auto& wid1 : geom->Iterate<geo::WireID>(pid)) {
-        unsigned int nbadchs = 0;
-        for (auto& wid2 : geom->Iterate<geo::WireID>(pid)) {
-          if (wid1 == wid2) continue;
-          if (lar::util::absDiff(wid1.Wire, wid2.Wire) < neighbors &&
-              !channelStatus.IsGood(geom->PlaneWireToChannel(wid2)))
-            ++nbadchs;
-        }
-        badchannelmap[wid1] = nbadchs;
-      }
-    }
-    std::cout << "Done building bad channel map." << std::endl;
-  }
+  build_badchannelmap();
 
   points.clear();
   for (auto& spt : sps) {
@@ -59,10 +49,123 @@ void cluster::DBScan3DAlg::init(const std::vector<art::Ptr<recob::SpacePoint>>&
     point.nbadchannels = 0;
     auto& hits = hitFromSp.at(spt.key());
     for (auto& hit : hits) {
-      point.nbadchannels += badchannelmap[hit->WireID()];
+      point.nbadchannels += count_badchannels(hit->WireID());
     }
     points.push_back(point);
   }
+  build_index();
+}
+
+//----------------------------------------------------------
+void cluster::DBScan3DAlg::build_badchannelmap()
+{
+  if (badchannelmap) return;
+  auto map = std::make_shared<BadChannelMap>();
+  lariov::ChannelStatusProvider const& channelStatus =
+    art::ServiceHandle<lariov::ChannelStatusService const>()->GetProvider();
+  geo::GeometryCore const* geom = &*(art::ServiceHandle<geo::Geometry const>());
+  // count the bad channels around each wire ID with a sliding window over the
+  // bad channel prefix sum of each plane
+  std::vector<unsigned int> nbadbelow;
+  for (auto& pid : geom->Iterate<geo::PlaneID>()) {
+    unsigned int const nwires = geom->Nwires(pid);
+    map->planes.push_back(pid);
+    map->offsets.push_back(map->counts.size());
+    // nbadbelow[w] is the number of bad channels on wires [0, w)
+    nbadbelow.assign(nwires + 1, 0);
+    for (auto& wid : geom->Iterate<geo::WireID>(pid)) {
+      bool const bad = !channelStatus.IsGood(geom->PlaneWireToChannel(wid));
+      nbadbelow[wid.Wire + 1] = bad ? 1 : 0;
+    }
+    for (unsigned int wire = 0; wire < nwires; ++wire)
+      nbadbelow[wire + 1] += nbadbelow[wire];
+    // count the other wires with |wire - wire2| < neighbors
+    for (unsigned int wire = 0; wire < nwires; ++wire) {
+      if (neighbors == 0) {
+        map->counts.push_back(0);
+        continue;
+      }
+      unsigned int const lo = wire + 1 > neighbors ? wire + 1 - neighbors : 0;
+      unsigned int const hi = std::min(nwires, wire + neighbors);
+      unsigned int const self = nbadbelow[wire + 1] - nbadbelow[wire];
+      map->counts.push_back(nbadbelow[hi] - nbadbelow[lo] - self);
+    }
+  }
+  // the planes are iterated in order but make sure the lookup can rely on it
+  if (!std::is_sorted(map->planes.begin(), map->planes.end()))
+    throw cet::exception("DBScan3DAlg") << "Planes are not iterated in sorted order\n";
+  badchannelmap = std::move(map);
+  std::cout << "Done building bad channel map." << std::endl;
+}
+
+//----------------------------------------------------------
+unsigned int cluster::DBScan3DAlg::count_badchannels(geo::WireID const& wid) const
+{
+  auto const& pid = wid.asPlaneID();
+  auto const& planes = badchannelmap->planes;
+  auto const& offsets = badchannelmap->offsets;
+  auto const& counts = badchannelmap->counts;
+  auto it = std::lower_bound(planes.begin(), planes.end(), pid);
+  if (it == planes.end() || *it != pid) return 0;
+  std::size_t const iplane = it - planes.begin();
+  std::size_t const end = iplane + 1 < offsets.size() ? offsets[iplane + 1] : counts.size();
+  std::size_t const index = offsets[iplane] + wid.Wire;
+  return index < end ? counts[index] : 0;
+}
+
+//----------------------------------------------------------
+std::uint64_t cluster::DBScan3DAlg::cell_key(long ix, long iy, long iz) const
+{
+  return (std::uint64_t(ix) << (2 * kCellBits)) | (std::uint64_t(iy) << kCellBits) |
+         std::uint64_t(iz);
+}
+
+//----------------------------------------------------------
+void cluster::DBScan3DAlg::build_index()
+{
+  cellkeys.clear();
+  cellpoints.clear();
+  maxnbadchannels = 0;
+  if (points.empty()) return;
+
+  double lo[3], hi[3];
+  for (unsigned int k = 0; k < 3; ++k) {
+    lo[k] = std::numeric_limits<double>::max();
+    hi[k] = std::numeric_limits<double>::lowest();
+  }
+  for (auto const& point : points) {
+    Double32_t const* xyz = point.sp->XYZ();
+    for (unsigned int k = 0; k < 3; ++k) {
+      lo[k] = std::min(lo[k], double(xyz[k]));
+      hi[k] = std::max(hi[k], double(xyz[k]));
+    }
+    maxnbadchannels = std::max(maxnbadchannels, point.nbadchannels);
+  }
+
+  // The cell size is the bare epsilon distance, enlarged if needed so that the cell
+  // coordinates fit in a key
+  cellsize = std::sqrt(epsilon);
+  for (unsigned int k = 0; k < 3; ++k) {
+    gridorigin[k] = lo[k];
+    cellsize = std::max(cellsize, (hi[k] - lo[k]) / (kMaxCell - 1));
+  }
+  if (!(cellsize > 0)) cellsize = 1;
+
+  std::vector<std::pair<std::uint64_t, unsigned int>> sorted(points.size());
+  for (unsigned int i = 0; i < points.size(); ++i) {
+    Double32_t const* xyz = points[i].sp->XYZ();
+    long cell[3];
+    for (unsigned int k = 0; k < 3; ++k)
+      cell[k] = std::min(long((xyz[k] - gridorigin[k]) / cellsize), kMaxCell);
+    sorted[i] = std::make_pair(cell_key(cell[0], cell[1], cell[2]), i);
+  }
+  std::sort(sorted.begin(), sorted.end());
+  cellkeys.reserve(sorted.size());
+  cellpoints.reserve(sorted.size());
+  for (auto const& entry : sorted) {
+    cellkeys.push_back(entry.first);
+    cellpoints.push_back(entry.second);
+  }
 }
 
 node_t* cluster::DBScan3DAlg::create_node(unsigned int index)
@@ -103,18 +206,46 @@ epsilon_neighbours_t* cluster::DBScan3DAlg::get_epsilon_neighbours(unsigned int
     perror("Failed to allocate epsilon neighbours.");
     return en;
   }
-  for (unsigned int i = 0; i < points.size(); ++i) {
-    if (i == index) continue;
-    if (dist(&points[index], &points[i]) > epsilon)
-      continue;
-    else {
-      if (append_at_end(i, en) == FAILURE) {
-        destroy_epsilon_neighbours(en);
-        en = NULL;
-        break;
+  // Bad channels reduce the distance between two points, so the search radius is
+  // the largest distance that can pass the epsilon cut in dist() given the bad
+  // channels of this point, with a margin for rounding
+  auto const nbadchannels = points[index].nbadchannels + maxnbadchannels;
+  double const radius =
+    std::sqrt(epsilon + cet::square(nbadchannels * badchannelweight)) * (1 + 1e-4);
+  long const ncells = long(radius / cellsize) + 1;
+  Double32_t const* xyz = points[index].sp->XYZ();
+  long cell[3];
+  for (unsigned int k = 0; k < 3; ++k)
+    cell[k] = std::min(long((xyz[k] - gridorigin[k]) / cellsize), kMaxCell);
+  long const izlo = std::max(cell[2] - ncells, 0L);
+  long const izhi = std::min(cell[2] + ncells, kMaxCell);
+
+  candidates.clear();
+  for (long ix = std::max(cell[0] - ncells, 0L); ix <= std::min(cell[0] + ncells, kMaxCell);
+       ++ix) {
+    for (long iy = std::max(cell[1] - ncells, 0L); iy <= std::min(cell[1] + ncells, kMaxCell);
+         ++iy) {
+      // cells that are adjacent in z are contiguous
+      auto first = std::lower_bound(cellkeys.begin(), cellkeys.end(), cell_key(ix, iy, izlo));
+      auto last = std::upper_bound(first, cellkeys.end(), cell_key(ix, iy, izhi));
+      for (auto it = first; it != last; ++it) {
+        unsigned int const i = cellpoints[it - cellkeys.begin()];
+        if (i == index) continue;
+        if (dist(&points[index], &points[i]) > epsilon) continue;
+        candidates.push_back(i);
       }
     }
   }
+  // keep the neighbours in point order, as found by a scan over all points
+  std::sort(candidates.begin(), candidates.end());
+
+  for (auto i : candidates) {
+    if (append_at_end(i, en) == FAILURE) {
+      destroy_epsilon_neighbours(en);
+      en = NULL;
+      break;
+    }
+  }
   return en;
 }
 
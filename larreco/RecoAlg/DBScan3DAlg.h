@@ -45,7 +45,9 @@ namespace fhicl {
   class ParameterSet;
 }
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h" // for WireID
@@ -85,12 +87,39 @@ namespace cluster {
               art::FindManyP<recob::Hit>& hitFromSp);
     void dbscan();
 
+    // Builds the bad channel map if it has not been built yet. Copies of the algorithm
+    // share the map, so build it before copying the algorithm for each event
+    void build_badchannelmap();
+
   private:
     double epsilon;
     unsigned int minpts;
     double badchannelweight;
     unsigned int neighbors;
-    std::map<geo::WireID, int> badchannelmap;
+    // Number of bad channels within `neighbors` wires of each wire. The counts of all
+    // planes are stored contiguously; planes (sorted) and offsets give the position of
+    // the first wire of each plane. Filled once, read-only after.
+    struct BadChannelMap {
+      std::vector<geo::PlaneID> planes;
+      std::vector<std::size_t> offsets;
+      std::vector<unsigned int> counts;
+    };
+    std::shared_ptr<BadChannelMap const> badchannelmap;
+
+    unsigned int count_badchannels(geo::WireID const& wid) const;
+
+    // Spatial index of the points, built in init(). The points are binned in cubic
+    // cells of side cellsize and sorted by cell key so that the points in a cell, or
+    // in a run of cells along z, are contiguous in cellpoints.
+    double cellsize;
+    double gridorigin[3];
+    unsigned int maxnbadchannels;
+    std::vector<std::uint64_t> cellkeys;  // sorted cell keys, one per entry in cellpoints
+    std::vector<unsigned int> cellpoints; // point indices sorted by cell key
+    std::vector<unsigned int> candidates; // scratch list of neighbour candidates
+
+    void build_index();
+    std::uint64_t cell_key(long ix, long iy, long iz) const;
 
     node_t* create_node(unsigned int index);
     int append_at_end(unsigned int index, epsilon_neighbours_t* en);
@@ -27,8 +27,10 @@
 #include "lardataobj/RecoBase/Hit.h"
 #include "larreco/RecoAlg/DBScanAlg.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <numeric>
 
 //----------------------------------------------------------
 // RStarTree stuff
@@ -267,9 +269,9 @@ void cluster::DBScanAlg::InitScan(const detinfo::DetectorClocksData& clockData,
   fpointId_to_clusterId.clear();
   fnoise.clear();
   fvisited.clear();
-  fsim.clear();
-  fsim2.clear();
-  fsim3.clear();
+  fSweepPos.clear();
+  fSweepOrder.clear();
+  fSweepSortedPos.clear();
   fclusters.clear();
   fWirePitch.clear();
 
@@ -344,7 +346,8 @@ void cluster::DBScanAlg::InitScan(const detinfo::DetectorClocksData& clockData,
 }
 
 //----------------------------------------------------------
-double cluster::DBScanAlg::getSimilarity(const std::vector<double> v1, const std::vector<double> v2)
+double cluster::DBScanAlg::getSimilarity(const std::vector<double>& v1,
+                                         const std::vector<double>& v2) const
 {
 
   //for Euclidean distance comment everything out except this-->>>
@@ -380,8 +383,8 @@ double cluster::DBScanAlg::getSimilarity(const std::vector<double> v1, const std
 }
 
 //----------------------------------------------------------------
-double cluster::DBScanAlg::getSimilarity2(const std::vector<double> v1,
-                                          const std::vector<double> v2)
+double cluster::DBScanAlg::getSimilarity2(const std::vector<double>& v1,
+                                          const std::vector<double>& v2) const
 {
 
   //-------------------------------------------
@@ -419,8 +422,8 @@ double cluster::DBScanAlg::getSimilarity2(const std::vector<double> v1,
 }
 
 //----------------------------------------------------------------
-double cluster::DBScanAlg::getWidthFactor(const std::vector<double> v1,
-                                          const std::vector<double> v2)
+double cluster::DBScanAlg::getWidthFactor(const std::vector<double>& v1,
+                                          const std::vector<double>& v2) const
 {
 
   //double k=0.13; //this number was determined by looking at flat muon hits' widths.
@@ -446,62 +449,62 @@ double cluster::DBScanAlg::getWidthFactor(const std::vector<double> v1,
 }
 
 //----------------------------------------------------------------
-//\todo this is O(n) in the number of hits, while the high performance
-//      claimed for DBSCAN relies on it being O(log n)!
+void cluster::DBScanAlg::buildSweepIndex()
+{
+  // getSimilarity compares |x1 - x2| - (bad wires in [wire1, wire2)) * wire_dist with eps.
+  // With b(x) the number of bad wires below the wire at x, that is |s1 - s2| for
+  // s = x - b(x) * wire_dist since b(x) increases with x
+  double wire_dist = fWirePitch[0];
+  std::vector<uint32_t> badWires(fBadChannels.begin(), fBadChannels.end());
+  unsigned int const size = fps.size();
+  fSweepPos.resize(size);
+  for (unsigned int i = 0; i < size; ++i) {
+    unsigned int wire = (unsigned int)(fps[i][0] / wire_dist + 0.5);
+    std::size_t nbad = std::lower_bound(badWires.begin(), badWires.end(), wire) - badWires.begin();
+    fSweepPos[i] = fps[i][0] - nbad * wire_dist;
+  }
+  fSweepOrder.resize(size);
+  std::iota(fSweepOrder.begin(), fSweepOrder.end(), 0);
+  std::sort(fSweepOrder.begin(), fSweepOrder.end(), [this](unsigned int a, unsigned int b) {
+    return fSweepPos[a] < fSweepPos[b];
+  });
+  fSweepSortedPos.resize(size);
+  for (unsigned int i = 0; i < size; ++i)
+    fSweepSortedPos[i] = fSweepPos[fSweepOrder[i]];
+}
+
+//----------------------------------------------------------------
+// The similarities are computed on demand for the points that can pass the
+// first (wire) term of the ellipse condition, using the sweep index
 std::vector<unsigned int> cluster::DBScanAlg::findNeighbors(unsigned int pid,
                                                             double threshold,
                                                             double threshold2)
 {
   std::vector<unsigned int> ne;
 
-  for (int unsigned j = 0; j < fsim.size(); j++) {
-    if ((pid != j) &&
-        (((fsim[pid][j]) / (threshold * threshold)) +
-         ((fsim2[pid][j]) / (threshold2 * threshold2 * (fsim3[pid][j])))) < 1) { //ellipse
+  // a small margin on the window protects against rounding in the comparison
+  double const pos = fSweepPos[pid];
+  double const window = threshold + 1e-6 * (1 + threshold + std::abs(pos));
+  auto first = std::lower_bound(fSweepSortedPos.begin(), fSweepSortedPos.end(), pos - window);
+  auto last = std::upper_bound(first, fSweepSortedPos.end(), pos + window);
+  for (auto it = first; it != last; ++it) {
+    unsigned int j = fSweepOrder[it - fSweepSortedPos.begin()];
+    if (j == pid) continue;
+    // evaluate with the lower index first as was done when filling the similarity matrices
+    auto const& v1 = fps[std::min(pid, j)];
+    auto const& v2 = fps[std::max(pid, j)];
+    if (((getSimilarity(v1, v2)) / (threshold * threshold)) +
+          ((getSimilarity2(v1, v2)) / (threshold2 * threshold2 * (getWidthFactor(v1, v2)))) <
+        1) { //ellipse
       ne.push_back(j);
     }
-  } // end loop over fsim
+  } // end loop over sweep window
+  // return the neighbors in point order
+  std::sort(ne.begin(), ne.end());
 
   return ne;
 }
 
-//-----------------------------------------------------------------
-void cluster::DBScanAlg::computeSimilarity()
-{
-  int size = fps.size();
-  fsim.resize(size, std::vector<double>(size));
-  for (int i = 0; i < size; i++) {
-    for (int j = i + 1; j < size; j++) {
-      fsim[j][i] = fsim[i][j] = getSimilarity(fps[i], fps[j]);
-    }
-  }
-}
-
-//------------------------------------------------------------------
-void cluster::DBScanAlg::computeSimilarity2()
-{
-  int size = fps.size();
-  fsim2.resize(size, std::vector<double>(size));
-  for (int i = 0; i < size; i++) {
-    for (int j = i + 1; j < size; j++) {
-      fsim2[j][i] = fsim2[i][j] = getSimilarity2(fps[i], fps[j]);
-    }
-  }
-}
-
-//------------------------------------------------------------------
-void cluster::DBScanAlg::computeWidthFactor()
-{
-  int size = fps.size();
-  fsim3.resize(size, std::vector<double>(size));
-
-  for (int i = 0; i < size; i++) {
-    for (int j = i + 1; j < size; j++) {
-      fsim3[j][i] = fsim3[i][j] = getWidthFactor(fps[i], fps[j]);
-    }
-  }
-}
-
 //----------------------------------------------------------------
 /////////////////////////////////////////////////////////////////
 // This is the algorithm that finds clusters:
@@ -512,9 +515,7 @@ void cluster::DBScanAlg::run_cluster()
   case 2: return run_dbscan_cluster();
   case 1: return run_FN_cluster();
   default:
-    computeSimilarity();  // watch out for this, they are *slow*
-    computeSimilarity2(); // "
-    computeWidthFactor(); // "
+    buildSweepIndex();
     return run_FN_naive_cluster();
   }
 }
@@ -58,21 +58,15 @@ namespace cluster {
       const std::vector<art::Ptr<recob::Hit>>& allhits,
       std::set<uint32_t> badChannels,
       const std::vector<geo::WireID>& wireids = std::vector<geo::WireID>()); //wireids is optional
-    double getSimilarity(const std::vector<double> v1, const std::vector<double> v2);
+    double getSimilarity(const std::vector<double>& v1, const std::vector<double>& v2) const;
     std::vector<unsigned int> findNeighbors(unsigned int pid, double threshold, double threshold2);
-    void computeSimilarity();
     void run_cluster();
-    double getSimilarity2(const std::vector<double> v1, const std::vector<double> v2);
-    void computeSimilarity2();
-    double getWidthFactor(const std::vector<double> v1, const std::vector<double> v2);
-    void computeWidthFactor();
+    double getSimilarity2(const std::vector<double>& v1, const std::vector<double>& v2) const;
+    double getWidthFactor(const std::vector<double>& v1, const std::vector<double>& v2) const;
 
     std::vector<std::vector<unsigned int>> fclusters; ///< collection of something
     std::vector<std::vector<double>> fps;            ///< the collection of points we are working on
     std::vector<unsigned int> fpointId_to_clusterId; ///< mapping point_id -> clusterId
-    std::vector<std::vector<double>> fsim;           ///<
-    std::vector<std::vector<double>> fsim2;          ///<
-    std::vector<std::vector<double>> fsim3;          ///<
     double fMaxWidth;
 
     RTree fRTree;
@@ -99,6 +93,14 @@ namespace cluster {
                                        ///< dead wire counting ala
                                        ///< fBadChannelSum[m]-fBadChannelSum[n].
 
+    // Sweep index for findNeighbors. The wire coordinate of each point less the
+    // width of the bad wires below it is the quantity that getSimilarity compares
+    // with eps, so only the points within eps of it in this coordinate are tested
+    std::vector<double> fSweepPos;           ///< bad-wire corrected coordinate of each point
+    std::vector<unsigned int> fSweepOrder;   ///< point indices sorted by fSweepPos
+    std::vector<double> fSweepSortedPos;     ///< fSweepPos in fSweepOrder order
+    void buildSweepIndex();
+
     // Three differnt version of the clustering code
     void run_dbscan_cluster();
     void run_FN_cluster();
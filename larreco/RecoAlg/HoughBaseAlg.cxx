@@ -27,6 +27,10 @@
 #include <stdint.h> // uint32_t
 #include <vector>
 
+// TBB
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
 // ROOT/CLHEP libraries
 #include "CLHEP/Random/RandFlat.h"
 #include <TStopwatch.h>
@@ -70,50 +74,6 @@ constexpr double PI = M_PI; // or CLHEP::pi in CLHEP/Units/PhysicalConstants.h
 #define _sin(x) ((((((a6 * (x) + a5) * (x) + a4) * (x) + a3) * (x) + a2) * (x) + a1) * (x) + a0)
 #define _cos(x) _sin(TMath::Pi() * 0.5 - (x))
 
-namespace cluster {
-  class HoughTransform {
-  public:
-    void Init(unsigned int dx, unsigned int dy, float rhores, unsigned int numACells);
-    std::array<int, 3> AddPointReturnMax(int x, int y);
-    bool SubtractPoint(int x, int y);
-    int GetCell(int row, int col) const;
-    void SetCell(int row, int col, int value) { m_accum[row].set(col, value); }
-    void GetAccumSize(int& numRows, int& numCols)
-    {
-      numRows = m_accum.size();
-      numCols = (int)m_rowLength;
-    }
-    int NumAccumulated() { return m_numAccumulated; }
-    void GetEquation(float row, float col, float& rho, float& theta) const;
-    int GetMax(int& xmax, int& ymax) const;
-
-    void reconfigure(fhicl::ParameterSet const& pset);
-
-  private:
-    /// rho -> # hits (for convenience)
-    typedef HoughTransformCounters<int, signed char, 64> BaseMap_t;
-    typedef HoughTransformCounters<int, signed char, 64> DistancesMap_t;
-
-    /// Type of the Hough transform (angle, distance) map with custom allocator
-    typedef std::vector<DistancesMap_t> HoughImage_t;
-
-    unsigned int m_dx;
-    unsigned int m_dy;
-    unsigned int m_rowLength;
-    unsigned int m_numAngleCells;
-    float m_rhoResolutionFactor;
-    // Note, m_accum is a vector of associative containers,
-    // the vector elements are called by rho, theta is the container key,
-    // the number of hits is the value corresponding to the key
-    HoughImage_t m_accum; ///< column (map key)=rho, row (vector index)=theta
-    int m_numAccumulated;
-    std::vector<double> m_cosTable;
-    std::vector<double> m_sinTable;
-
-    std::array<int, 3> DoAddPointReturnMax(int x, int y, bool bSubtract = false);
-  }; // class HoughTransform
-}
-
 template <typename T>
 inline T sqr(T v)
 {
@@ -148,9 +108,9 @@ cluster::HoughTransformCounters<K, C, S, A, SC>::get_max(SubCounter_t current_ma
     for (size_t index = 0; index < block.size(); ++index) {
       if (block[index] > max.second)
         max = {Base_t::make_const_iterator(iCBlock, index), block[index]};
-      ++iCBlock;
     } // for elements in this block
-  }   // while blocks
+    ++iCBlock;
+  } // while blocks
   return max;
 } // cluster::HoughTransformCounters<>::get_max(SubCounter_t)
 
@@ -263,6 +223,7 @@ cluster::HoughBaseAlg::HoughBaseAlg(fhicl::ParameterSet const& pset)
   fMissedHits = pset.get<int>("MissedHits");
   fMissedHitsDistance = pset.get<float>("MissedHitsDistance");
   fMissedHitsToLineSize = pset.get<float>("MissedHitsToLineSize");
+  fDenseAccumulator = pset.get<bool>("DenseAccumulator", false);
 }
 
 //------------------------------------------------------------------------------
@@ -375,7 +336,7 @@ size_t cluster::HoughBaseAlg::Transform(
 
   ///Init specifies the size of the two-dimensional accumulator
   ///(based on the arguments, number of wires and number of time samples).
-  c.Init(dx, dy, fRhoResolutionFactor, fNumAngleCells);
+  c.Init(dx, dy, fRhoResolutionFactor, fNumAngleCells, fDenseAccumulator);
   /// Adds all of the hits to the accumulator
 
   c.GetAccumSize(accDy, accDx);
@@ -634,17 +595,125 @@ size_t cluster::HoughBaseAlg::Transform(
 }
 
 //------------------------------------------------------------------------------
-inline int cluster::HoughTransform::GetCell(int row, int col) const
+void cluster::HoughTransformTiles::Init(unsigned int numAngles)
+{
+  m_numAngles = numAngles;
+  m_rows.clear();
+  m_rows.resize((numAngles + kTileAngles - 1) / kTileAngles);
+} // cluster::HoughTransformTiles::Init()
+
+//------------------------------------------------------------------------------
+inline cluster::HoughTransformTiles::Counter_t*
+cluster::HoughTransformTiles::Tile(int tileRow, int tileCol, bool create)
+{
+  TileRow_t& row = m_rows[tileRow];
+  const int nCols = row.offsets.size();
+
+  if (tileCol >= row.firstCol && tileCol < row.firstCol + nCols) {
+    const int offset = row.offsets[tileCol - row.firstCol];
+    if (offset >= 0) return row.storage.data() + offset;
+  }
+  if (!create) return nullptr;
+
+  // extend the band of columns of this row to include tileCol
+  if (nCols == 0) {
+    row.firstCol = tileCol;
+    row.offsets.assign(1, -1);
+  }
+  else if (tileCol < row.firstCol) {
+    row.offsets.insert(row.offsets.begin(), row.firstCol - tileCol, -1);
+    row.firstCol = tileCol;
+  }
+  else if (tileCol >= row.firstCol + nCols) {
+    row.offsets.resize(tileCol - row.firstCol + 1, -1);
+  }
+
+  const int offset = row.storage.size();
+  row.offsets[tileCol - row.firstCol] = offset;
+  row.storage.resize(offset + kTileSize, 0);
+  return row.storage.data() + offset;
+} // cluster::HoughTransformTiles::Tile()
+
+//------------------------------------------------------------------------------
+inline const cluster::HoughTransformTiles::Counter_t* cluster::HoughTransformTiles::Tile(
+  int tileRow,
+  int tileCol) const
+{
+  const TileRow_t& row = m_rows[tileRow];
+  const int col = tileCol - row.firstCol;
+  if (col < 0 || col >= (int)row.offsets.size() || row.offsets[col] < 0) return nullptr;
+  return row.storage.data() + row.offsets[col];
+} // cluster::HoughTransformTiles::Tile() const
+
+//------------------------------------------------------------------------------
+int cluster::HoughTransformTiles::Get(int angle, int dist) const
+{
+  if (angle < 0 || angle >= m_numAngles) return 0;
+  const int tileCol = TileCol(dist);
+  const Counter_t* tile = Tile(angle / kTileAngles, tileCol);
+  return tile ? tile[(angle % kTileAngles) * kTileDists + dist - tileCol * kTileDists] : 0;
+} // cluster::HoughTransformTiles::Get()
+
+//------------------------------------------------------------------------------
+void cluster::HoughTransformTiles::Set(int angle, int dist, int value)
+{
+  if (angle < 0 || angle >= m_numAngles) return;
+  const int tileCol = TileCol(dist);
+  Counter_t* tile = Tile(angle / kTileAngles, tileCol, value != 0);
+  if (tile) tile[(angle % kTileAngles) * kTileDists + dist - tileCol * kTileDists] = value;
+} // cluster::HoughTransformTiles::Set()
+
+//------------------------------------------------------------------------------
+void cluster::HoughTransformTiles::AddRange(int angle,
+                                            int first,
+                                            int end,
+                                            Counter_t delta,
+                                            Max_t& max)
+{
+  const int tileRow = angle / kTileAngles;
+  const int angleOffset = (angle % kTileAngles) * kTileDists;
+
+  for (int dist = first; dist < end;) {
+    const int tileCol = TileCol(dist);
+    const int tileEnd = std::min(end, (tileCol + 1) * kTileDists);
+    Counter_t* counters = Tile(tileRow, tileCol, true) + angleOffset;
+
+    for (int i = dist - tileCol * kTileDists; dist < tileEnd; ++i, ++dist) {
+      const Counter_t value = (counters[i] += delta);
+      if (value > max[0]) max = {{value, dist, angle}};
+    }
+  } // for tiles
+} // cluster::HoughTransformTiles::AddRange()
+
+//------------------------------------------------------------------------------
+void cluster::HoughTransformTiles::GetMax(int angle, Max_t& max) const
+{
+  const TileRow_t& row = m_rows[angle / kTileAngles];
+  const int angleOffset = (angle % kTileAngles) * kTileDists;
+
+  for (size_t col = 0; col < row.offsets.size(); ++col) {
+    if (row.offsets[col] < 0) continue;
+    const Counter_t* counters = row.storage.data() + row.offsets[col] + angleOffset;
+    for (int i = 0; i < kTileDists; ++i) {
+      if (counters[i] > max[0])
+        max = {{counters[i], (row.firstCol + (int)col) * kTileDists + i, angle}};
+    }
+  } // for tiles
+} // cluster::HoughTransformTiles::GetMax()
+
+//------------------------------------------------------------------------------
+int cluster::HoughTransform::GetCell(int row, int col) const
 {
+  if (m_dense) return m_tiles.Get(row, col);
   return m_accum[row][col];
 } // cluster::HoughTransform::GetCell()
 
 //------------------------------------------------------------------------------
 // returns a vector<int> where the first is the overall maximum,
 // the second is the max x value, and the third is the max y value.
-inline std::array<int, 3> cluster::HoughTransform::AddPointReturnMax(int x, int y)
+std::array<int, 3> cluster::HoughTransform::AddPointReturnMax(int x, int y)
 {
-  if ((x > (int)m_dx) || (y > (int)m_dy) || x < 0.0 || y < 0.0) {
+  if (!InRange(x, y)) {
     std::array<int, 3> max;
     max.fill(0);
     return max;
@@ -653,21 +722,38 @@ inline std::array<int, 3> cluster::HoughTransform::AddPointReturnMax(int x, int
 }
 
 //------------------------------------------------------------------------------
-inline bool cluster::HoughTransform::SubtractPoint(int x, int y)
+bool cluster::HoughTransform::SubtractPoint(int x, int y)
 {
-  if ((x > (int)m_dx) || (y > (int)m_dy) || x < 0.0 || y < 0.0) return false;
+  if (!InRange(x, y)) return false;
   DoAddPointReturnMax(x, y, true); // true = subtract
   return true;
 }
 
+//------------------------------------------------------------------------------
+void cluster::HoughTransform::AddPoints(std::vector<std::pair<int, int>> const& points)
+{
+  if (m_dense) {
+    std::vector<std::pair<int, int>> inRange;
+    inRange.reserve(points.size());
+    for (auto const& point : points)
+      if (InRange(point.first, point.second)) inRange.push_back(point);
+    DenseAddPoints(inRange);
+    return;
+  }
+  for (auto const& point : points)
+    AddPointReturnMax(point.first, point.second);
+} // cluster::HoughTransform::AddPoints()
+
 //------------------------------------------------------------------------------
 void cluster::HoughTransform::Init(unsigned int dx,
                                    unsigned int dy,
                                    float rhores,
-                                   unsigned int numACells)
+                                   unsigned int numACells,
+                                   bool dense /* = false */)
 {
   m_numAngleCells = numACells;
   m_rhoResolutionFactor = rhores;
+  m_dense = dense;
 
   m_accum.clear();
   //--- BEGIN issue #19494 -----------------------------------------------------
@@ -695,7 +781,12 @@ void cluster::HoughTransform::Init(unsigned int dx,
   m_dx = dx;
   m_dy = dy;
   m_rowLength = (unsigned int)(m_rhoResolutionFactor * 2 * std::sqrt(dx * dx + dy * dy));
-  m_accum.resize(m_numAngleCells);
+  if (m_dense) {
+    m_tiles.Init(m_numAngleCells);
+    m_dists.resize(m_numAngleCells);
+  }
+  else
+    m_accum.resize(m_numAngleCells);
 
   // this math must be coherent with the one in GetEquation()
   double angleStep = PI / m_numAngleCells;
@@ -718,6 +809,17 @@ void cluster::HoughTransform::GetEquation(float row, float col, float& rho, floa
 //------------------------------------------------------------------------------
 int cluster::HoughTransform::GetMax(int& xmax, int& ymax) const
 {
+  if (m_dense) {
+    HoughTransformTiles::Max_t max{{-1, 0, 0}};
+    for (unsigned int i = 0; i < m_numAngleCells; ++i)
+      m_tiles.GetMax(i, max);
+    if (max[0] >= 0) {
+      xmax = max[2];
+      ymax = max[1];
+    }
+    return max[0];
+  }
+
   int maxVal = -1;
   for (unsigned int i = 0; i < m_accum.size(); i++) {
 
@@ -739,6 +841,8 @@ std::array<int, 3> cluster::HoughTransform::DoAddPointReturnMax(int x,
                                                                 int y,
                                                                 bool bSubtract /* = false */)
 {
+  if (m_dense) return DenseAddPoint(x, y, bSubtract);
+
   std::array<int, 3> max;
   max.fill(-1);
 
@@ -827,6 +931,99 @@ std::array<int, 3> cluster::HoughTransform::DoAddPointReturnMax(int x,
   return max;
 } // cluster::HoughTransform::DoAddPointReturnMax()
 
+//------------------------------------------------------------------------------
+// distance of the point for this angle; this math must be the same as in
+// DoAddPointReturnMax()
+inline int cluster::HoughTransform::Distance(unsigned int iAngleStep, int x, int y) const
+{
+  const int distCenter = (int)(m_rowLength / 2.);
+  if (iAngleStep == 0) return (int)(distCenter + (m_rhoResolutionFactor * x));
+  return (int)(distCenter + m_rhoResolutionFactor *
+                              (m_cosTable[iAngleStep] * x + m_sinTable[iAngleStep] * y));
+} // cluster::HoughTransform::Distance()
+
+//------------------------------------------------------------------------------
+// same as DoAddPointReturnMax(), on the dense accumulator
+std::array<int, 3> cluster::HoughTransform::DenseAddPoint(int x, int y, bool bSubtract)
+{
+  const int distCenter = (int)(m_rowLength / 2.);
+  const int numAngles = m_numAngleCells;
+
+  // all the distances at once; this math must be the same as in Distance()
+  const double rhores = m_rhoResolutionFactor;
+  const double* cosTable = m_cosTable.data();
+  const double* sinTable = m_sinTable.data();
+  int* dists = m_dists.data();
+  for (int iAngleStep = 1; iAngleStep < numAngles; ++iAngleStep)
+    dists[iAngleStep] =
+      (int)(distCenter + rhores * (cosTable[iAngleStep] * x + sinTable[iAngleStep] * y));
+  dists[0] = Distance(0, x, y);
+
+  // when subtracting nothing can beat this maximum
+  HoughTransformTiles::Max_t max{{bSubtract ? std::numeric_limits<int>::max() : 2, -1, -1}};
+
+  for (int iAngleStep = 1; iAngleStep < numAngles; ++iAngleStep) {
+    // same range rules as in DoAddPointReturnMax()
+    const int dist = dists[iAngleStep];
+    const int lastDist = dists[iAngleStep - 1];
+    int first_dist = dist;
+    int end_dist = dist + 1;
+    if (lastDist != dist) {
+      first_dist = dist > lastDist ? lastDist : dist + 1;
+      end_dist = dist > lastDist ? dist : lastDist + 1;
+    }
+    m_tiles.AddRange(iAngleStep, first_dist, end_dist, bSubtract ? -1 : 1, max);
+  } // for angles
+
+  if (bSubtract) {
+    --m_numAccumulated;
+    max.fill(-1);
+  }
+  else {
+    ++m_numAccumulated;
+    if (max[0] == 2) max.fill(-1); // no cell above 2
+  }
+
+  return max;
+} // cluster::HoughTransform::DenseAddPoint()
+
+//------------------------------------------------------------------------------
+// same as DenseAddPoint() for each point in turn, without the maxima; the
+// angles are split in slices of whole tile rows, which do not share storage,
+// and each task adds all the points to its slice
+void cluster::HoughTransform::DenseAddPoints(std::vector<std::pair<int, int>> const& points)
+{
+  constexpr int kSliceAngles = 64 * HoughTransformTiles::kTileAngles;
+
+  const int numAngles = m_numAngleCells;
+  const int nSlices = (numAngles + kSliceAngles - 1) / kSliceAngles;
+
+  tbb::parallel_for(tbb::blocked_range<int>(0, nSlices), [&](tbb::blocked_range<int> const& r) {
+    // nothing can beat this maximum, it is not needed
+    HoughTransformTiles::Max_t noMax{{std::numeric_limits<int>::max(), -1, -1}};
+    for (int iSlice = r.begin(); iSlice != r.end(); ++iSlice) {
+      const int angleBegin = std::max(1, iSlice * kSliceAngles);
+      const int angleEnd = std::min(numAngles, (iSlice + 1) * kSliceAngles);
+      for (auto const& [x, y] : points) {
+        int lastDist = Distance(angleBegin - 1, x, y);
+        for (int iAngleStep = angleBegin; iAngleStep < angleEnd; ++iAngleStep) {
+          const int dist = Distance(iAngleStep, x, y);
+          int first_dist = dist;
+          int end_dist = dist + 1;
+          if (lastDist != dist) {
+            first_dist = dist > lastDist ? lastDist : dist + 1;
+            end_dist = dist > lastDist ? dist : lastDist + 1;
+          }
+          m_tiles.AddRange(iAngleStep, first_dist, end_dist, 1, noMax);
+          lastDist = dist;
+        } // for angles
+      }   // for points
+    }     // for slices
+  });
+
+  m_numAccumulated += points.size();
+} // cluster::HoughTransform::DenseAddPoints()
+
 //------------------------------------------------------------------------------
 //this method saves a BMP image of the Hough Accumulator, which can be viewed with gimp
 void cluster::HoughBaseAlg::HLSSaveBMPFile(const char* fileName, unsigned char* pix, int dx, int dy)
@@ -1089,7 +1286,7 @@ size_t cluster::HoughBaseAlg::FastTransform(detinfo::DetectorClocksData const& c
   //Init specifies the size of the two-dimensional accumulator
   //(based on the arguments, number of wires and number of time samples).
   //adds all of the hits (that have not yet been associated with a line) to the accumulator
-  c.Init(dx, dy, fRhoResolutionFactor, fNumAngleCells);
+  c.Init(dx, dy, fRhoResolutionFactor, fNumAngleCells, fDenseAccumulator);
 
   // count is how many points are left to randomly insert
   unsigned int count = hit.size();
@@ -1361,11 +1558,14 @@ size_t cluster::HoughBaseAlg::Transform(detinfo::DetectorPropertiesData const& d
   int dx = geom->Nwires(geo::PlaneID{0, 0, 0}); // number of wires
   const int dy = detProp.ReadOutWindowSize();   // number of time samples.
 
-  c.Init(dx, dy, fRhoResolutionFactor, fNumAngleCells);
+  c.Init(dx, dy, fRhoResolutionFactor, fNumAngleCells, fDenseAccumulator);
 
+  std::vector<std::pair<int, int>> points;
+  points.reserve(hits.size());
   for (unsigned int i = 0; i < hits.size(); ++i) {
-    c.AddPointReturnMax(hits[i]->WireID().Wire, (int)(hits[i]->PeakTime()));
+    points.emplace_back(hits[i]->WireID().Wire, (int)(hits[i]->PeakTime()));
   } // end loop over hits
+  c.AddPoints(points);
 
   //gets the actual two-dimensional size of the accumulator
   int accDx = 0;
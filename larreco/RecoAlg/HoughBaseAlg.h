@@ -120,6 +120,17 @@
 // architectures. No check is performed for overflow; that can also be
 // implemented at a small cost.
 //
+// Dense accumulator
+// ----------------------------------------------------------------------------
+//
+// With DenseAccumulator set, the counters are instead stored in a dense array
+// split in tiles of 8 angles by 64 distances. Tiles are allocated the first
+// time a point touches them, which keeps memory bounded like with the maps,
+// and then never looked up through a tree again. The distances of a point are
+// computed for all the angles in one vectorizable loop, and the angles are
+// filled in slices of whole tile rows, in parallel. The maximum is resolved
+// in the same order as with the maps, so the lines found are the same.
+//
 //
 ////////////////////////////////////////////////////////////////////////
 #ifndef HOUGHBASEALG_H
@@ -452,6 +463,114 @@ namespace cluster {
 
   }; // class HoughTransformCounters
 
+  /// Dense (angle, distance) accumulator, stored as tiles of small counters.
+  /// Each row of tiles covers kTileAngles angles and only the tiles a point
+  /// actually touches are allocated, so memory stays close to the map one.
+  /// Any distance is accepted, including negative ones.
+  class HoughTransformTiles {
+  public:
+    using Counter_t = signed char;
+    /// { value, distance, angle } of a maximum
+    using Max_t = std::array<int, 3>;
+
+    static constexpr int kTileAngles = 8;
+    static constexpr int kTileDists = 64;
+    static constexpr int kTileSize = kTileAngles * kTileDists;
+
+    void Init(unsigned int numAngles);
+    int Get(int angle, int dist) const;
+    void Set(int angle, int dist, int value);
+
+    /// Adds delta to the cells [first, end) of this angle, updating max with
+    /// the first cell strictly above it
+    void AddRange(int angle, int first, int end, Counter_t delta, Max_t& max);
+    /// Updates max with the first cell of this angle strictly above it
+    void GetMax(int angle, Max_t& max) const;
+
+  private:
+    struct TileRow_t {
+      int firstCol = 0;         ///< tile column of the first entry of offsets
+      std::vector<int> offsets; ///< tile offsets in storage, -1 if not allocated
+      std::vector<Counter_t> storage;
+    };
+    std::vector<TileRow_t> m_rows;
+    int m_numAngles = 0;
+
+    /// Tile column of a distance (rounded down also for negative distances)
+    static int TileCol(int dist)
+    {
+      return (dist >= 0 ? dist : dist - kTileDists + 1) / kTileDists;
+    }
+
+    Counter_t* Tile(int tileRow, int tileCol, bool create);
+    const Counter_t* Tile(int tileRow, int tileCol) const;
+  }; // class HoughTransformTiles
+
+  class HoughTransform {
+  public:
+    void Init(unsigned int dx,
+              unsigned int dy,
+              float rhores,
+              unsigned int numACells,
+              bool dense = false);
+    std::array<int, 3> AddPointReturnMax(int x, int y);
+    /// Adds all the points; with the dense accumulator, the angles are filled
+    /// in parallel, each task adding all the points to its own slice of angles
+    void AddPoints(std::vector<std::pair<int, int>> const& points);
+    bool SubtractPoint(int x, int y);
+    int GetCell(int row, int col) const;
+    void SetCell(int row, int col, int value)
+    {
+      if (m_dense)
+        m_tiles.Set(row, col, value);
+      else
+        m_accum[row].set(col, value);
+    }
+    void GetAccumSize(int& numRows, int& numCols)
+    {
+      numRows = m_numAngleCells;
+      numCols = (int)m_rowLength;
+    }
+    int NumAccumulated() { return m_numAccumulated; }
+    void GetEquation(float row, float col, float& rho, float& theta) const;
+    int GetMax(int& xmax, int& ymax) const;
+
+    void reconfigure(fhicl::ParameterSet const& pset);
+
+  private:
+    /// rho -> # hits (for convenience)
+    typedef HoughTransformCounters<int, signed char, 64> BaseMap_t;
+    typedef HoughTransformCounters<int, signed char, 64> DistancesMap_t;
+
+    /// Type of the Hough transform (angle, distance) map with custom allocator
+    typedef std::vector<DistancesMap_t> HoughImage_t;
+
+    unsigned int m_dx;
+    unsigned int m_dy;
+    unsigned int m_rowLength;
+    unsigned int m_numAngleCells;
+    float m_rhoResolutionFactor;
+    // Note, m_accum is a vector of associative containers,
+    // the vector elements are called by rho, theta is the container key,
+    // the number of hits is the value corresponding to the key
+    HoughImage_t m_accum; ///< column (map key)=rho, row (vector index)=theta
+    bool m_dense = false; ///< whether m_tiles is used instead of m_accum
+    HoughTransformTiles m_tiles; ///< dense accumulator, same indexing as m_accum
+    int m_numAccumulated;
+    std::vector<double> m_cosTable;
+    std::vector<double> m_sinTable;
+    std::vector<int> m_dists; ///< distances of the point being added, per angle
+
+    bool InRange(int x, int y) const
+    {
+      return x >= 0 && y >= 0 && x <= (int)m_dx && y <= (int)m_dy;
+    }
+    int Distance(unsigned int iAngleStep, int x, int y) const;
+    std::array<int, 3> DoAddPointReturnMax(int x, int y, bool bSubtract = false);
+    std::array<int, 3> DenseAddPoint(int x, int y, bool bSubtract);
+    void DenseAddPoints(std::vector<std::pair<int, int>> const& points);
+  }; // class HoughTransform
+
   class HoughBaseAlg {
   public:
     /// Data structure collecting charge information to be filled in cluster
@@ -542,6 +661,7 @@ namespace cluster {
       fMissedHitsDistance; ///< Distance between hits in a hough line before a hit is considered missed
     float
       fMissedHitsToLineSize; ///< Ratio of missed hits to line size for a line to be considered a fake
+    bool fDenseAccumulator; ///< Use the dense tiled accumulator instead of the counter maps
   };
 
 } // namespace
@@ -0,0 +1,293 @@
+/**
+ * @file   MultiGaussianKernel.cxx
+ * @brief  Vectorized evaluation of a sum of Gaussians over a whole ROI
+ * @see    MultiGaussianKernel.h
+ *
+ * The kernel is written once with the GCC/Clang vector extensions and
+ * instantiated for 2 (SSE2, NEON), 4 (AVX2) and 8 (AVX-512) doubles per
+ * vector. The exponential is computed in the vector registers as well: with
+ * the reduction `exp(x) = 2^n exp(r)`, `|r| < ln(2)/2`, and a polynomial for
+ * `exp(r)`. Arguments are never positive here; below -708 the result would
+ * not be a normal number and it is flushed to zero.
+ */
+
+// our header
+#include "larreco/RecoAlg/MultiGaussianKernel.h"
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+  using KernelFunction = void (*)(double const*,
+                                  std::size_t,
+                                  double,
+                                  double,
+                                  std::size_t,
+                                  double*,
+                                  double*,
+                                  std::size_t);
+
+#if defined(__GNUC__) || defined(__clang__)
+
+  typedef double Double2 __attribute__((vector_size(16)));
+  typedef long long Int2 __attribute__((vector_size(16)));
+  typedef double Double4 __attribute__((vector_size(32)));
+  typedef long long Int4 __attribute__((vector_size(32)));
+  typedef double Double8 __attribute__((vector_size(64)));
+  typedef long long Int8 __attribute__((vector_size(64)));
+
+  /// Replaces each lane of x (x <= 0) with exp(x)
+  template <typename V, typename I>
+  [[gnu::always_inline]] inline void expNonPositive(V& x)
+  {
+    constexpr double log2e = 1.44269504088896338700e+00;
+    constexpr double ln2Hi = 6.93147180369123816490e-01;
+    constexpr double ln2Lo = 1.90821492927058770002e-10;
+    // adding this rounds to an integer, which ends up in the low mantissa bits
+    constexpr double shifter = 0x1.8p52;
+
+    I const negligible = (I)(x < -708.);
+
+    V const t = x * log2e + shifter;
+    V const n = t - shifter;
+    V const r = (x - n * ln2Hi) - n * ln2Lo;
+
+    // Taylor series of exp(r) up to r^12, enough for double precision
+    V p = V{} + 1. / 479001600.;
+    p = p * r + 1. / 39916800.;
+    p = p * r + 1. / 3628800.;
+    p = p * r + 1. / 362880.;
+    p = p * r + 1. / 40320.;
+    p = p * r + 1. / 5040.;
+    p = p * r + 1. / 720.;
+    p = p * r + 1. / 120.;
+    p = p * r + 1. / 24.;
+    p = p * r + 1. / 6.;
+    p = p * r + 0.5;
+    p = p * r + 1.;
+    p = p * r + 1.;
+
+    // 2^n built directly in the exponent bits
+    I const scale = ((I)t + 1023) << 52;
+
+    x = (V)((I)(p * (V)scale) & ~negligible);
+  }
+
+  /// Evaluates the lanes starting at point first; only count (<= lanes) are stored
+  template <typename V, typename I, bool Full>
+  [[gnu::always_inline]] inline void evaluateBlock(double const* params,
+                                                   std::size_t nGaus,
+                                                   V const& x,
+                                                   double baseline,
+                                                   std::size_t first,
+                                                   std::size_t count,
+                                                   double* model,
+                                                   double* jacobian,
+                                                   std::size_t stride)
+  {
+    auto store = [count](double* dest, V const& value) {
+      if constexpr (Full)
+        std::memcpy(dest, &value, sizeof(V));
+      else
+        std::memcpy(dest, &value, count * sizeof(double));
+    };
+
+    V sum = V{} + baseline;
+
+    for (std::size_t gaus = 0; gaus < nGaus; gaus++) {
+      double const amplitude = params[3 * gaus];
+      double const invSigma = 1. / params[3 * gaus + 2];
+      V const z = (x - params[3 * gaus + 1]) * invSigma;
+      V expo = -0.5 * z * z;
+
+      expNonPositive<V, I>(expo);
+
+      V const value = amplitude * expo;
+
+      sum += value;
+
+      if (jacobian) {
+        double* row = jacobian + 3 * gaus * stride + first;
+
+        store(row, expo);
+        store(row + stride, value * z * invSigma);
+        store(row + 2 * stride, value * z * z * invSigma);
+      }
+    }
+
+    store(model + first, sum);
+  }
+
+  template <typename V, typename I>
+  [[gnu::always_inline]] inline void evaluateImpl(double const* params,
+                                                  std::size_t nGaus,
+                                                  double baseline,
+                                                  double xStart,
+                                                  std::size_t nPoints,
+                                                  double* model,
+                                                  double* jacobian,
+                                                  std::size_t stride)
+  {
+    constexpr std::size_t nLanes = sizeof(V) / sizeof(double);
+
+    V lane;
+    for (std::size_t idx = 0; idx < nLanes; idx++)
+      lane[idx] = idx;
+
+    std::size_t first = 0;
+
+    for (; first + nLanes <= nPoints; first += nLanes)
+      evaluateBlock<V, I, true>(
+        params, nGaus, lane + (xStart + first), baseline, first, nLanes, model, jacobian, stride);
+
+    if (first < nPoints)
+      evaluateBlock<V, I, false>(params,
+                                 nGaus,
+                                 lane + (xStart + first),
+                                 baseline,
+                                 first,
+                                 nPoints - first,
+                                 model,
+                                 jacobian,
+                                 stride);
+  }
+
+  void evaluateGeneric(double const* params,
+                       std::size_t nGaus,
+                       double baseline,
+                       double xStart,
+                       std::size_t nPoints,
+                       double* model,
+                       double* jacobian,
+                       std::size_t stride)
+  {
+    evaluateImpl<Double2, Int2>(
+      params, nGaus, baseline, xStart, nPoints, model, jacobian, stride);
+  }
+
+#if defined(__x86_64__)
+  __attribute__((target("avx2,fma"))) void evaluateAVX2(double const* params,
+                                                        std::size_t nGaus,
+                                                        double baseline,
+                                                        double xStart,
+                                                        std::size_t nPoints,
+                                                        double* model,
+                                                        double* jacobian,
+                                                        std::size_t stride)
+  {
+    evaluateImpl<Double4, Int4>(
+      params, nGaus, baseline, xStart, nPoints, model, jacobian, stride);
+  }
+
+  __attribute__((target("avx512f"))) void evaluateAVX512(double const* params,
+                                                         std::size_t nGaus,
+                                                         double baseline,
+                                                         double xStart,
+                                                         std::size_t nPoints,
+                                                         double* model,
+                                                         double* jacobian,
+                                                         std::size_t stride)
+  {
+    evaluateImpl<Double8, Int8>(
+      params, nGaus, baseline, xStart, nPoints, model, jacobian, stride);
+  }
+#endif // __x86_64__
+
+#else // no vector extensions: plain scalar code
+
+  void evaluateGeneric(double const* params,
+                       std::size_t nGaus,
+                       double baseline,
+                       double xStart,
+                       std::size_t nPoints,
+                       double* model,
+                       double* jacobian,
+                       std::size_t stride)
+  {
+    for (std::size_t idx = 0; idx < nPoints; idx++) {
+      double const x = xStart + idx;
+      double sum = baseline;
+
+      for (std::size_t gaus = 0; gaus < nGaus; gaus++) {
+        double const invSigma = 1. / params[3 * gaus + 2];
+        double const z = (x - params[3 * gaus + 1]) * invSigma;
+        double const expo = std::exp(-0.5 * z * z);
+        double const value = params[3 * gaus] * expo;
+
+        sum += value;
+
+        if (jacobian) {
+          double* row = jacobian + 3 * gaus * stride + idx;
+
+          row[0] = expo;
+          row[stride] = value * z * invSigma;
+          row[2 * stride] = value * z * z * invSigma;
+        }
+      }
+
+      model[idx] = sum;
+    }
+  }
+
+#endif // vector extensions
+
+  struct Kernel {
+    KernelFunction function;
+    const char* name;
+  };
+
+  Kernel selectKernel()
+  {
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return {evaluateAVX512, "AVX-512"};
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return {evaluateAVX2, "AVX2"};
+#endif
+    return {evaluateGeneric, "generic"};
+  }
+
+  Kernel const& kernel()
+  {
+    static Kernel const theKernel = selectKernel();
+    return theKernel;
+  }
+
+} // local namespace
+
+namespace hit {
+
+  //----------------------------------------------------------------------------
+  void EvaluateMultiGaussian(double const* params,
+                             std::size_t nGaus,
+                             double baseline,
+                             double xStart,
+                             std::size_t nPoints,
+                             double* model)
+  {
+    kernel().function(params, nGaus, baseline, xStart, nPoints, model, nullptr, 0);
+  } // EvaluateMultiGaussian()
+
+  //----------------------------------------------------------------------------
+  void EvaluateMultiGaussianAndJacobian(double const* params,
+                                        std::size_t nGaus,
+                                        double baseline,
+                                        double xStart,
+                                        std::size_t nPoints,
+                                        double* model,
+                                        double* jacobian,
+                                        std::size_t stride)
+  {
+    kernel().function(params, nGaus, baseline, xStart, nPoints, model, jacobian, stride);
+  } // EvaluateMultiGaussianAndJacobian()
+
+  //----------------------------------------------------------------------------
+  const char* MultiGaussianKernelInstructionSet()
+  {
+    return kernel().name;
+  }
+
+} // namespace hit
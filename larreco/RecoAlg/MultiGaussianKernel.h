@@ -0,0 +1,68 @@
+/**
+ * @file   MultiGaussianKernel.h
+ * @brief  Vectorized evaluation of a sum of Gaussians over a whole ROI
+ *
+ * The hit fitters spend most of their time evaluating a sum of Gaussians (and
+ * its derivatives with respect to the parameters) tick by tick. The functions
+ * here do it for a whole range of ticks at once, a few ticks per instruction:
+ * the implementation is chosen at the first call among AVX-512, AVX2 and a
+ * portable version according to what the CPU supports.
+ *
+ * The parameters are laid out as in ROOT's `gaus(0) + gaus(3) + ...`:
+ * amplitude, mean and sigma of the first Gaussian, then of the second one and
+ * so on. The function is evaluated at `x = xStart + i` for `i` from `0` to
+ * `nPoints - 1`.
+ *
+ * Results agree with `std::exp` based scalar code to about 1e-13 relative to
+ * the size of the terms.
+ */
+
+#ifndef MULTIGAUSSIANKERNEL_H
+#define MULTIGAUSSIANKERNEL_H 1
+
+// C/C++ standard libraries
+#include <cstddef>
+
+namespace hit {
+
+  /**
+   * @brief Evaluates baseline plus a sum of Gaussians at nPoints equally spaced points
+   * @param params parameters of the Gaussians (amplitude, mean, sigma) x nGaus
+   * @param nGaus number of Gaussians
+   * @param baseline constant added to the sum
+   * @param xStart abscissa of the first point (the following are one unit apart)
+   * @param nPoints number of points
+   * @param model (output) nPoints values of the function
+   */
+  void EvaluateMultiGaussian(double const* params,
+                             std::size_t nGaus,
+                             double baseline,
+                             double xStart,
+                             std::size_t nPoints,
+                             double* model);
+
+  /**
+   * @brief Evaluates the function like EvaluateMultiGaussian, and its derivatives
+   * @param jacobian (output) derivatives, one row of `stride` elements per parameter
+   * @param stride distance between the rows of jacobian (at least nPoints)
+   *
+   * The first nPoints elements of row `3 * i + k` receive the derivative of the
+   * function with respect to parameter `k` (amplitude, mean, sigma) of the
+   * Gaussian `i`. The derivative with respect to the baseline is always 1 and
+   * it is not filled.
+   */
+  void EvaluateMultiGaussianAndJacobian(double const* params,
+                                        std::size_t nGaus,
+                                        double baseline,
+                                        double xStart,
+                                        std::size_t nPoints,
+                                        double* model,
+                                        double* jacobian,
+                                        std::size_t stride);
+
+  /// Returns the name of the instruction set used by the kernel on this machine
+  const char* MultiGaussianKernelInstructionSet();
+
+} // namespace hit
+
+#endif // MULTIGAUSSIANKERNEL_H
@@ -16,10 +16,14 @@
 
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include <cassert>
+#include <cmath>
+
 // Impact factors on the objective function:  U     V     Z
 float pma::Element3D::fOptFactors[3] = {0.2F, 0.8F, 1.0F};
 
-pma::Element3D::Element3D() : fTPC(-1), fCryo(-1), fFrozen(false), fHitsRadius(0)
+pma::Element3D::Element3D()
+  : fTPC(-1), fCryo(-1), fFrozen(false), fHitArraysValid(false), fHitsRadius(0)
 {
   fNThisHitsEnabledAll = 0;
   for (unsigned int i = 0; i < 3; i++) {
@@ -41,11 +45,13 @@ size_t pma::Element3D::NEnabledHits(unsigned int view) const
 
 void pma::Element3D::SortHits(void)
 {
+  fHitArraysValid = false;
   std::sort(fAssignedHits.begin(), fAssignedHits.end(), pma::bTrajectory3DOrderLess());
 }
 
 void pma::Element3D::ClearAssigned(pma::Track3D* trk)
 {
+  fHitArraysValid = false;
   fAssignedPoints.clear();
   fAssignedHits.clear();
   fHitsRadius = 0.0;
@@ -53,6 +59,8 @@ void pma::Element3D::ClearAssigned(pma::Track3D* trk)
 
 void pma::Element3D::UpdateHitParams(void)
 {
+  fHitArraysValid = false;
+
   std::vector<pma::Hit3D*> hitsColl, hitsInd1, hitsInd2;
   for (size_t i = 0; i < 3; ++i)
     fNThisHitsEnabledAll = 0;
@@ -182,6 +190,31 @@ double pma::Element3D::SumDist2(void) const
   return hit_sum;
 }
 
+void pma::Element3D::CacheHitArrays(bool state)
+{
+  fHitArraysValid = state;
+  if (!state) return;
+
+  fHitArrays.clear();
+  fHitArrays.reserve(fAssignedHits.size());
+  for (auto h : fAssignedHits) {
+    if (h->IsEnabled()) {
+      fHitArrays.push_back(*h, OptFactor(h->View2D()) * h->GetSigmaFactor());
+    }
+  }
+  assert(SameSumDist2Hits());
+}
+
+bool pma::Element3D::SameSumDist2Hits()
+{
+  fHitArraysValid = false;
+  double const fromHits = SumDist2Hits();
+  fHitArraysValid = true;
+  double const fromArrays = SumDist2Hits();
+
+  return std::fabs(fromArrays - fromHits) <= 1.0e-9 * fromHits;
+}
+
 double pma::Element3D::SumDist2(unsigned int view) const
 {
   if (fTPC < 0) {
@@ -258,6 +291,8 @@ bool pma::Element3D::SelectRndHits(size_t nmax_per_view)
     count[i] = 0;
   }
 
+  fHitArraysValid = false;
+
   bool b, changed = false;
   for (auto h : fAssignedHits) {
     b = h->IsEnabled();
@@ -281,6 +316,8 @@ bool pma::Element3D::SelectRndHits(size_t nmax_per_view)
 
 bool pma::Element3D::SelectAllHits(void)
 {
+  fHitArraysValid = false;
+
   bool changed = false;
   for (auto h : fAssignedHits) {
     changed |= !(h->IsEnabled());
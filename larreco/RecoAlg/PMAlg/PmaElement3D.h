@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+#include "larreco/RecoAlg/PMAlg/PmaHit2DArrays.h"
 #include "larreco/RecoAlg/PMAlg/Utilities.h"
 
 class TVector2;
@@ -60,13 +61,19 @@ public:
     return false;
   }
 
-  pma::Hit3D& Hit(size_t index) { return *(fAssignedHits[index]); }
+  pma::Hit3D& Hit(size_t index)
+  {
+    fHitArraysValid = false;
+    return *(fAssignedHits[index]);
+  }
   void RemoveHitAt(size_t index)
   {
+    fHitArraysValid = false;
     if (index < fAssignedHits.size()) fAssignedHits.erase(fAssignedHits.begin() + index);
   }
   void AddHit(pma::Hit3D* h)
   {
+    fHitArraysValid = false;
     fAssignedHits.push_back(h);
     SetProjection(*h);
   }
@@ -93,6 +100,13 @@ public:
 
   double SumDist2(void) const;
   double SumDist2(unsigned int view) const;
+
+  /// Copy the 2D data of enabled hits to contiguous arrays, read by SumDist2() instead of
+  /// the hits until hits are assigned, removed or modified through this element. Only
+  /// for the scope of an optimization which does not touch the hits, call with false to
+  /// drop the copy.
+  void CacheHitArrays(bool state);
+
   double SumHitsQ(unsigned int view) const { return fSumHitsQ[view]; }
   unsigned int NHits(unsigned int view) const { return fNHits[view]; }
   unsigned int NThisHits(unsigned int view) const { return fNThisHits[view]; }
@@ -116,8 +130,14 @@ protected:
 
   virtual double SumDist2Hits(void) const = 0;
 
+  /// Debug check of the copy made by CacheHitArrays(): SumDist2Hits() from the arrays
+  /// and from the hits agree.
+  bool SameSumDist2Hits();
+
   bool fFrozen;
   std::vector<pma::Hit3D*> fAssignedHits; // 2D hits
+  pma::Hit2DArrays fHitArrays;            // enabled hits copied by CacheHitArrays()
+  bool fHitArraysValid;
   std::vector<TVector3*> fAssignedPoints; // 3D peculiar points reconstructed elsewhere
   size_t fNThisHits[3];
   size_t fNThisHitsEnabledAll;
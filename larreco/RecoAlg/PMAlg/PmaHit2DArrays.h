@@ -0,0 +1,58 @@
+/**
+ *  @file   PmaHit2DArrays.h
+ *
+ *  @brief  Implementation of the Projection Matching Algorithm
+ *
+ *          2D data of hits stored contiguously, one plain array per quantity, for the
+ *          loops of the optimization which visit every hit many times.
+ *          See PmaTrack3D.h file for details.
+ */
+
+#ifndef PmaHit2DArrays_h
+#define PmaHit2DArrays_h
+
+#include "larreco/RecoAlg/PMAlg/PmaHit3D.h"
+
+#include <vector>
+
+namespace pma {
+  struct Hit2DArrays;
+}
+
+struct pma::Hit2DArrays {
+  std::vector<double> x, y;       // hit position in 2D wire view, scaled to [cm]
+  std::vector<float> weight;      // impact factor on the objective function
+  std::vector<unsigned int> view; // 2D wire view of the hit
+  std::vector<int> tpc;           // TPC of the hit
+
+  size_t size() const noexcept { return x.size(); }
+
+  void clear() noexcept
+  {
+    x.clear();
+    y.clear();
+    weight.clear();
+    view.clear();
+    tpc.clear();
+  }
+
+  void reserve(size_t n)
+  {
+    x.reserve(n);
+    y.reserve(n);
+    weight.reserve(n);
+    view.reserve(n);
+    tpc.reserve(n);
+  }
+
+  void push_back(pma::Hit3D const& h, float w)
+  {
+    x.push_back(h.Point2D().X());
+    y.push_back(h.Point2D().Y());
+    weight.push_back(w);
+    view.push_back(h.View2D());
+    tpc.push_back(h.TPC());
+  }
+};
+
+#endif
@@ -18,6 +18,7 @@
 #include "lardataalg/DetectorInfo/DetectorPropertiesData.h"
 
 #include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib/pow.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
 // Fixed optimization directions:     X      Y      Z
@@ -182,6 +183,15 @@ double pma::Node3D::GetDistance2To(const TVector2& p2d, unsigned int view) const
 double pma::Node3D::SumDist2Hits() const
 {
   double sum = 0.0F;
+  if (fHitArraysValid) {
+    for (size_t i = 0; i < fHitArrays.size(); ++i) {
+      TVector2 const& proj = fProj2D[fHitArrays.view[i]];
+      double const dx = fHitArrays.x[i] - proj.X(), dy = fHitArrays.y[i] - proj.Y();
+      sum += fHitArrays.weight[i] * cet::sum_of_squares(dx, dy);
+    }
+    return sum;
+  }
+
   for (auto h : fAssignedHits) {
     if (h->IsEnabled()) {
       unsigned int view = h->View2D();
@@ -824,6 +834,8 @@ void pma::Node3D::Optimize(float penaltyValue, float endSegWeight)
 
 void pma::Node3D::ClearAssigned(pma::Track3D* trk)
 {
+  fHitArraysValid = false;
+
   if (!trk) {
     // like in the base class:
     fAssignedPoints.clear();
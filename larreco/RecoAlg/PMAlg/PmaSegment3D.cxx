@@ -44,6 +44,16 @@ double pma::Segment3D::SumDist2Hits(void) const
   pma::Node3D* v1 = static_cast<pma::Node3D*>(next);
 
   double sum = 0.0F;
+  if (fHitArraysValid) {
+    for (size_t i = 0; i < fHitArrays.size(); ++i) {
+      TVector2 const& p0 = v0->Projection2D(fHitArrays.view[i]);
+      TVector2 const& p1 = v1->Projection2D(fHitArrays.view[i]);
+      sum += fHitArrays.weight[i] *
+             GetDist2(fHitArrays.x[i], fHitArrays.y[i], p0.X(), p0.Y(), p1.X(), p1.Y());
+    }
+    return sum;
+  }
+
   for (auto h : fAssignedHits) {
     if (h->IsEnabled()) {
       unsigned int view = h->View2D();
@@ -247,9 +257,14 @@ double pma::Segment3D::GetDist2(const TVector3& psrc, const TVector3& p0, const
 
 double pma::Segment3D::GetDist2(const TVector2& psrc, const TVector2& p0, const TVector2& p1)
 {
-  pma::Vector2D v0(psrc.X() - p0.X(), psrc.Y() - p0.Y());
-  pma::Vector2D v1(p1.X() - p0.X(), p1.Y() - p0.Y());
-  pma::Vector2D v2(psrc.X() - p1.X(), psrc.Y() - p1.Y());
+  return GetDist2(psrc.X(), psrc.Y(), p0.X(), p0.Y(), p1.X(), p1.Y());
+}
+
+double pma::Segment3D::GetDist2(double px, double py, double x0, double y0, double x1, double y1)
+{
+  pma::Vector2D v0(px - x0, py - y0);
+  pma::Vector2D v1(x1 - x0, y1 - y0);
+  pma::Vector2D v2(px - x1, py - y1);
 
   double v1Norm2 = v1.Mag2();
   if (v1Norm2 >= 1.0E-6) // >= 0.01mm
@@ -281,8 +296,8 @@ double pma::Segment3D::GetDist2(const TVector2& psrc, const TVector2& p0, const
   }
   else // short segment or its projection
   {
-    double dx = 0.5 * (p0.X() + p1.X()) - psrc.X();
-    double dy = 0.5 * (p0.Y() + p1.Y()) - psrc.Y();
+    double dx = 0.5 * (x0 + x1) - px;
+    double dy = 0.5 * (y0 + y1) - py;
     return dx * dx + dy * dy;
   }
 }
@@ -65,6 +65,9 @@ public:
 
   pma::Track3D* Parent(void) const { return fParent; }
 
+  /// Distance^2 used for the 2D point (px, py) and the 2D segment (x0, y0)-(x1, y1).
+  static double GetDist2(double px, double py, double x0, double y0, double x1, double y1);
+
 private:
   Segment3D(const pma::Segment3D& src);
 
@@ -19,9 +19,15 @@
 #include "lardataalg/DetectorInfo/DetectorPropertiesData.h"
 
 #include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib/pow.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <limits>
 
 #include "range/v3/algorithm.hpp"
 #include "range/v3/view.hpp"
@@ -1871,12 +1877,17 @@ double pma::Track3D::Optimize(const detinfo::DetectorPropertiesData& detProp,
           return 0.0;
         }
 
+        // hits stay as they are until the next projection
+        CacheHitArrays(true);
+
         for (auto n : fNodes)
           n->Optimize(fPenaltyValue, fEndSegWeight);
 
         g1 = g0;
         g0 = GetObjFunction();
 
+        CacheHitArrays(false);
+
         if (g0 == 0.0F) {
           MakeProjection();
           break;
@@ -2591,6 +2602,110 @@ pma::Element3D* pma::Track3D::GetNearestElement(const TVector2& p2d,
   return pe_min;
 }
 
+void pma::Track3D::GetNearestElements(pma::Hit2DArrays const& hits,
+                                      bool skipFrontVtx,
+                                      bool skipBackVtx,
+                                      std::vector<pma::Element3D*>& result) const
+{
+  result.assign(hits.size(), nullptr);
+
+  if (fSegments.front()->TPC() < 0) skipFrontVtx = false;
+  if (fSegments.back()->TPC() < 0) skipBackVtx = false;
+
+  if (skipFrontVtx && skipBackVtx && (fSegments.size() == 1)) {
+    std::fill(result.begin(), result.end(), fSegments.front()); // no need for searching...
+    return;
+  }
+
+  size_t v0 = 0, v1 = fNodes.size();
+  if (skipFrontVtx) v0 = 1;
+  if (skipBackVtx) --v1;
+
+  // copy the candidates in the order of GetNearestElement(): nodes, then segments;
+  // a node is stored as a segment with both ends at the node projection
+  std::vector<pma::Element3D*> elements;
+  std::vector<int> tpcs;
+  std::array<std::vector<double>, 3> x0, y0, x1, y1; // by view
+  auto addCandidate = [&](pma::Element3D* el, pma::Node3D const* n0, pma::Node3D const* n1) {
+    elements.push_back(el);
+    tpcs.push_back(el->TPC());
+    for (unsigned int view = 0; view < 3; ++view) {
+      x0[view].push_back(n0->Projection2D(view).X());
+      y0[view].push_back(n0->Projection2D(view).Y());
+      x1[view].push_back(n1->Projection2D(view).X());
+      y1[view].push_back(n1->Projection2D(view).Y());
+    }
+  };
+  for (size_t i = v0; i < v1; i++)
+    addCandidate(fNodes[i], fNodes[i], fNodes[i]);
+  size_t const nNodes = elements.size();
+  for (auto segment : fSegments) {
+    if (segment->TPC() < 0) continue; // segment between TPC's
+    addCandidate(segment,
+                 static_cast<pma::Node3D const*>(segment->Prev()),
+                 static_cast<pma::Node3D const*>(segment->Next()));
+  }
+
+  for (size_t h = 0; h < hits.size(); ++h) {
+    unsigned int const view = hits.view[h];
+    int const tpc = hits.tpc[h];
+    double const px = hits.x[h], py = hits.y[h];
+    double const* ex0 = x0[view].data();
+    double const* ey0 = y0[view].data();
+    double const* ex1 = x1[view].data();
+    double const* ey1 = y1[view].data();
+
+    pma::Element3D* pe_min = nullptr;
+    auto min_dist = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < nNodes; i++)
+      if (tpcs[i] == tpc) {
+        double const dx = ex0[i] - px, dy = ey0[i] - py;
+        double const dist = cet::sum_of_squares(dx, dy);
+        if (dist < min_dist) {
+          min_dist = dist;
+          pe_min = elements[i];
+        }
+      }
+    for (size_t i = nNodes; i < elements.size(); i++)
+      if (tpcs[i] == tpc) {
+        double const dist = pma::Segment3D::GetDist2(px, py, ex0[i], ey0[i], ex1[i], ey1[i]);
+        if (dist < min_dist) {
+          min_dist = dist;
+          pe_min = elements[i];
+        }
+      }
+    if (!pe_min) throw cet::exception("pma::Track3D") << "Nearest element not found." << std::endl;
+    result[h] = pe_min;
+  }
+}
+
+bool pma::Track3D::SameNearestElements(std::vector<pma::Element3D*> const& nearest,
+                                       bool skipFrontVtx,
+                                       bool skipBackVtx) const
+{
+  for (size_t i = 0; i < fHits.size(); ++i) {
+    pma::Hit3D const& h = *(fHits[i]);
+    pma::Element3D const* pe =
+      GetNearestElement(h.Point2D(), h.View2D(), h.TPC(), skipFrontVtx, skipBackVtx);
+    if (pe == nearest[i]) continue;
+
+    // a different element is only fine if it is as close (a tie)
+    if (nearest[i]->TPC() != h.TPC()) return false;
+    double const d2 = pe->GetDistance2To(h.Point2D(), h.View2D());
+    if (std::fabs(nearest[i]->GetDistance2To(h.Point2D(), h.View2D()) - d2) > 1.0e-9 * d2)
+      return false;
+  }
+  return true;
+}
+
+void pma::Track3D::CacheHitArrays(bool state)
+{
+  for (auto n : fNodes)
+    n->CacheHitArrays(state);
+  for (auto s : fSegments)
+    s->CacheHitArrays(state);
+}
+
 pma::Element3D* pma::Track3D::GetNearestElement(const TVector3& p3d) const
 {
   pma::Element3D* pe_min = fNodes.front();
@@ -2902,11 +3017,17 @@ void pma::Track3D::MakeProjection()
   }
   if (!(fNodes.front()->IsFrozen()) && (fNodes.back()->NextCount() == 0)) { skipBackVtx = true; }
 
-  for (auto h : fHits) // assign hits to nodes/segments
-  {
-    pe = GetNearestElement(h->Point2D(), h->View2D(), h->TPC(), skipFrontVtx, skipBackVtx);
-    pe->AddHit(h);
-  }
+  pma::Hit2DArrays hits; // weights are not used here
+  hits.reserve(fHits.size());
+  for (auto h : fHits)
+    hits.push_back(*h, 1.0F);
+
+  std::vector<pma::Element3D*> nearest;
+  GetNearestElements(hits, skipFrontVtx, skipBackVtx, nearest);
+  assert(SameNearestElements(nearest, skipFrontVtx, skipBackVtx));
+
+  for (size_t i = 0; i < fHits.size(); ++i) // assign hits to nodes/segments
+    nearest[i]->AddHit(fHits[i]);
 
   for (auto p : fAssignedPoints) // assign ref points to nodes/segments
   {
@@ -2925,145 +3046,162 @@ void pma::Track3D::MakeFastProjection()
   std::vector<std::pair<pma::Hit3D*, pma::Element3D*>> assignments;
   assignments.reserve(fHits.size());
 
+  // where the hits are assigned now, the first place found looking at segments, then nodes
+  struct Location {
+    pma::Hit3D const* hit;
+    pma::Segment3D* seg;
+    pma::Node3D* node;
+    size_t index;
+  };
+  std::vector<Location> locations;
+  for (auto s : fSegments)
+    for (size_t j = 0; j < s->NHits(); ++j)
+      locations.push_back({s->Hits()[j], s, nullptr, j});
+  for (auto n : fNodes)
+    for (size_t j = 0; j < n->NHits(); ++j)
+      locations.push_back({n->Hits()[j], nullptr, n, j});
+  std::stable_sort(locations.begin(), locations.end(), [](Location const& a, Location const& b) {
+    return std::less<pma::Hit3D const*>()(a.hit, b.hit);
+  });
+
+  std::vector<std::pair<pma::Element3D*, size_t>> toRemove;
+  toRemove.reserve(fHits.size());
+
   for (auto hi : fHits) {
     pma::Element3D* pe = nullptr;
 
-    for (auto s : fSegments) {
-      for (size_t j = 0; j < s->NHits(); ++j)
-        if (hi == s->Hits()[j]) // look at next/prev vtx,seg,vtx
-        {
-          pe = s;
-          double min_d2 = s->GetDistance2To(hi->Point2D(), hi->View2D());
-          int const tpc = hi->TPC();
+    auto const loc = std::lower_bound(
+      locations.begin(), locations.end(), hi, [](Location const& a, pma::Hit3D const* h) {
+        return std::less<pma::Hit3D const*>()(a.hit, h);
+      });
+    if ((loc != locations.end()) && (loc->hit == hi)) {
+      if (loc->seg) // look at next/prev vtx,seg,vtx
+      {
+        pma::Segment3D* s = loc->seg;
+        pe = s;
+        double min_d2 = s->GetDistance2To(hi->Point2D(), hi->View2D());
+        int const tpc = hi->TPC();
+
+        pma::Node3D* nnext = static_cast<pma::Node3D*>(s->Next());
+        if (nnext->TPC() == tpc) {
+          double const d2 = nnext->GetDistance2To(hi->Point2D(), hi->View2D());
+          if (d2 < min_d2) {
+            min_d2 = d2;
+            pe = nnext;
+          }
 
-          pma::Node3D* nnext = static_cast<pma::Node3D*>(s->Next());
-          if (nnext->TPC() == tpc) {
-            double const d2 = nnext->GetDistance2To(hi->Point2D(), hi->View2D());
+          pma::Segment3D* snext = NextSegment(nnext);
+          if (snext && (snext->TPC() == tpc)) {
+            double const d2 = snext->GetDistance2To(hi->Point2D(), hi->View2D());
             if (d2 < min_d2) {
               min_d2 = d2;
-              pe = nnext;
+              pe = snext;
             }
 
-            pma::Segment3D* snext = NextSegment(nnext);
-            if (snext && (snext->TPC() == tpc)) {
-              double const d2 = snext->GetDistance2To(hi->Point2D(), hi->View2D());
+            nnext = static_cast<pma::Node3D*>(snext->Next());
+            if (nnext->TPC() == tpc) {
+              double const d2 = nnext->GetDistance2To(hi->Point2D(), hi->View2D());
               if (d2 < min_d2) {
                 min_d2 = d2;
-                pe = snext;
-              }
-
-              nnext = static_cast<pma::Node3D*>(snext->Next());
-              if (nnext->TPC() == tpc) {
-                double const d2 = nnext->GetDistance2To(hi->Point2D(), hi->View2D());
-                if (d2 < min_d2) {
-                  min_d2 = d2;
-                  pe = nnext;
-                }
+                pe = nnext;
               }
             }
           }
+        }
 
-          pma::Node3D* nprev = static_cast<pma::Node3D*>(s->Prev());
-          if (nprev->TPC() == tpc) {
-            double const d2 = nprev->GetDistance2To(hi->Point2D(), hi->View2D());
+        pma::Node3D* nprev = static_cast<pma::Node3D*>(s->Prev());
+        if (nprev->TPC() == tpc) {
+          double const d2 = nprev->GetDistance2To(hi->Point2D(), hi->View2D());
+          if (d2 < min_d2) {
+            min_d2 = d2;
+            pe = nprev;
+          }
+
+          pma::Segment3D* sprev = PrevSegment(nprev);
+          if (sprev && (sprev->TPC() == tpc)) {
+            double const d2 = sprev->GetDistance2To(hi->Point2D(), hi->View2D());
             if (d2 < min_d2) {
               min_d2 = d2;
-              pe = nprev;
+              pe = sprev;
             }
 
-            pma::Segment3D* sprev = PrevSegment(nprev);
-            if (sprev && (sprev->TPC() == tpc)) {
-              double const d2 = sprev->GetDistance2To(hi->Point2D(), hi->View2D());
+            nprev = static_cast<pma::Node3D*>(sprev->Prev());
+            if (nprev->TPC() == tpc) {
+              double const d2 = nprev->GetDistance2To(hi->Point2D(), hi->View2D());
               if (d2 < min_d2) {
                 min_d2 = d2;
-                pe = sprev;
-              }
-
-              nprev = static_cast<pma::Node3D*>(sprev->Prev());
-              if (nprev->TPC() == tpc) {
-                double const d2 = nprev->GetDistance2To(hi->Point2D(), hi->View2D());
-                if (d2 < min_d2) {
-                  min_d2 = d2;
-                  pe = nprev;
-                }
+                pe = nprev;
               }
             }
           }
-
-          s->RemoveHitAt(j);
-          break;
         }
-      if (pe) break;
-    }
 
-    if (!pe)
-      for (auto n : fNodes) {
-        for (size_t j = 0; j < n->NHits(); ++j)
-          if (hi == n->Hits()[j]) // look at next/prev seg,vtx,seg
-          {
-            pe = n;
-            double d2, min_d2 = n->GetDistance2To(hi->Point2D(), hi->View2D());
-            int tpc = hi->TPC();
+        toRemove.emplace_back(s, loc->index);
+      }
+      else // look at next/prev seg,vtx,seg
+      {
+        pma::Node3D* n = loc->node;
+        pe = n;
+        double d2, min_d2 = n->GetDistance2To(hi->Point2D(), hi->View2D());
+        int tpc = hi->TPC();
+
+        pma::Segment3D* snext = NextSegment(n);
+        if (snext && (snext->TPC() == tpc)) {
+          d2 = snext->GetDistance2To(hi->Point2D(), hi->View2D());
+          if (d2 < min_d2) {
+            min_d2 = d2;
+            pe = snext;
+          }
 
-            pma::Segment3D* snext = NextSegment(n);
+          pma::Node3D* nnext = static_cast<pma::Node3D*>(snext->Next());
+          if (nnext->TPC() == tpc) {
+            d2 = nnext->GetDistance2To(hi->Point2D(), hi->View2D());
+            if (d2 < min_d2) {
+              min_d2 = d2;
+              pe = nnext;
+            }
+
+            snext = NextSegment(nnext);
             if (snext && (snext->TPC() == tpc)) {
               d2 = snext->GetDistance2To(hi->Point2D(), hi->View2D());
               if (d2 < min_d2) {
                 min_d2 = d2;
                 pe = snext;
               }
+            }
+          }
+        }
 
-              pma::Node3D* nnext = static_cast<pma::Node3D*>(snext->Next());
-              if (nnext->TPC() == tpc) {
-                d2 = nnext->GetDistance2To(hi->Point2D(), hi->View2D());
-                if (d2 < min_d2) {
-                  min_d2 = d2;
-                  pe = nnext;
-                }
-
-                snext = NextSegment(nnext);
-                if (snext && (snext->TPC() == tpc)) {
-                  d2 = snext->GetDistance2To(hi->Point2D(), hi->View2D());
-                  if (d2 < min_d2) {
-                    min_d2 = d2;
-                    pe = snext;
-                  }
-                }
-              }
+        pma::Segment3D* sprev = PrevSegment(n);
+        if (sprev && (sprev->TPC() == tpc)) {
+          d2 = sprev->GetDistance2To(hi->Point2D(), hi->View2D());
+          if (d2 < min_d2) {
+            min_d2 = d2;
+            pe = sprev;
+          }
+
+          pma::Node3D* nprev = static_cast<pma::Node3D*>(sprev->Prev());
+          if (nprev->TPC() == tpc) {
+            d2 = nprev->GetDistance2To(hi->Point2D(), hi->View2D());
+            if (d2 < min_d2) {
+              min_d2 = d2;
+              pe = nprev;
             }
 
-            pma::Segment3D* sprev = PrevSegment(n);
+            sprev = PrevSegment(nprev);
             if (sprev && (sprev->TPC() == tpc)) {
               d2 = sprev->GetDistance2To(hi->Point2D(), hi->View2D());
               if (d2 < min_d2) {
                 min_d2 = d2;
                 pe = sprev;
               }
-
-              pma::Node3D* nprev = static_cast<pma::Node3D*>(sprev->Prev());
-              if (nprev->TPC() == tpc) {
-                d2 = nprev->GetDistance2To(hi->Point2D(), hi->View2D());
-                if (d2 < min_d2) {
-                  min_d2 = d2;
-                  pe = nprev;
-                }
-
-                sprev = PrevSegment(nprev);
-                if (sprev && (sprev->TPC() == tpc)) {
-                  d2 = sprev->GetDistance2To(hi->Point2D(), hi->View2D());
-                  if (d2 < min_d2) {
-                    min_d2 = d2;
-                    pe = sprev;
-                  }
-                }
-              }
             }
-
-            n->RemoveHitAt(j);
-            break;
           }
-        if (pe) break;
+        }
+
+        toRemove.emplace_back(n, loc->index);
       }
+    }
 
     if (pe)
       assignments.emplace_back(hi, pe);
@@ -3071,6 +3209,14 @@ void pma::Track3D::MakeFastProjection()
       mf::LogWarning("pma::Track3D") << "Hit was not assigned to any element.";
   }
 
+  // remove from the back of each element, other hits keep their order
+  std::sort(toRemove.begin(), toRemove.end(), [](auto const& a, auto const& b) {
+    return (a.first != b.first) ? std::less<pma::Element3D*>()(a.first, b.first) :
+                                  (a.second > b.second);
+  });
+  for (auto const& r : toRemove)
+    r.first->RemoveHitAt(r.second);
+
   for (auto const& a : assignments)
     a.second->AddHit(a.first);
 
@@ -21,6 +21,7 @@
 #include "TVector3.h"
 
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+#include "larreco/RecoAlg/PMAlg/PmaHit2DArrays.h"
 #include "larreco/RecoAlg/PMAlg/PmaHit3D.h"
 #include "larreco/RecoAlg/PMAlg/PmaNode3D.h"
 #include "larreco/RecoAlg/PMAlg/Utilities.h"
@@ -393,6 +394,22 @@ private:
                                     bool skipBackVtx = false) const;
   pma::Element3D* GetNearestElement(const TVector3& p3d) const;
 
+  /// Same as GetNearestElement() for all the hits, iterating over plain copies of the
+  /// node projections instead of the elements.
+  void GetNearestElements(pma::Hit2DArrays const& hits,
+                          bool skipFrontVtx,
+                          bool skipBackVtx,
+                          std::vector<pma::Element3D*>& result) const;
+
+  /// Debug check of GetNearestElements(): the nearest elements found for fHits are the
+  /// ones found by GetNearestElement() hit by hit, or as close to the hits.
+  bool SameNearestElements(std::vector<pma::Element3D*> const& nearest,
+                           bool skipFrontVtx,
+                           bool skipBackVtx) const;
+
+  /// Copy the hits of all nodes and segments to their contiguous arrays, or drop them.
+  void CacheHitArrays(bool state);
+
   std::vector<pma::Node3D*> fNodes;
   std::vector<pma::Segment3D*> fSegments;
 
@@ -17,6 +17,11 @@
 
 #include "TMath.h"
 
+#include "tbb/parallel_for.h"
+
+#include <algorithm>
+#include <iterator>
+
 using Point_t = recob::tracking::Point_t;
 using Vector_t = recob::tracking::Vector_t;
 using SMatrixSym55 = recob::tracking::SMatrixSym55;
@@ -314,6 +319,8 @@ pma::PMAlgTracker::PMAlgTracker(const std::vector<art::Ptr<recob::Hit>>& allhitl
   , fMatchT0inCPACrossing(pmalgTrackerConfig.MatchT0inCPACrossing())
   , fStitcher(pmstitchConfig)
   , fRunVertexing(pmalgTrackerConfig.RunVertexing())
+  , fParallelTPCs(pmalgTrackerConfig.ParallelTPCs())
+  , fCheckParallelTPCs(pmalgTrackerConfig.CheckParallelTPCs())
   , fAdcInPassingPoints(hpassing)
   , fAdcInRejectedPoints(hrejected)
   , fGeom(&*(art::ServiceHandle<geo::Geometry const>()))
@@ -354,6 +361,12 @@ pma::PMAlgTracker::PMAlgTracker(const std::vector<art::Ptr<recob::Hit>>& allhitl
     fValidation = pma::PMAlgTracker::kHits;
   }
 
+  if (fParallelTPCs && (fValidation != pma::PMAlgTracker::kHits)) {
+    mf::LogWarning("PMAlgTracker")
+      << "ADC images are prepared for one TPC at a time, build TPCs serially.";
+    fParallelTPCs = false;
+  }
+
   fAdcValidationThr = pmalgTrackerConfig.AdcValidationThr();
   if (fValidation == pma::PMAlgTracker::kAdc) {
     mf::LogVerbatim("PMAlgTracker") << "Validation ADC thresholds per plane:";
@@ -491,6 +504,7 @@ double pma::PMAlgTracker::validate(detinfo::DetectorPropertiesData const& detPro
 // ------------------------------------------------------
 
 bool pma::PMAlgTracker::reassignHits_1(detinfo::DetectorPropertiesData const& detProp,
+                                       ClusterUsage& usage,
                                        const std::vector<art::Ptr<recob::Hit>>& hits,
                                        pma::TrkCandidateColl& tracks,
                                        size_t trk_idx,
@@ -542,7 +556,7 @@ bool pma::PMAlgTracker::reassignHits_1(detinfo::DetectorPropertiesData const& de
       unsigned int cryo = hits.front()->WireID().Cryostat;
 
       pma::TrkCandidate candidate =
-        matchCluster(detProp, -1, hits, minSizeCompl, tpc, cryo, first_view);
+        matchCluster(detProp, usage, -1, hits, minSizeCompl, tpc, cryo, first_view);
 
       if (candidate.IsGood()) {
         mf::LogVerbatim("PMAlgTrackMaker")
@@ -606,6 +620,7 @@ double pma::PMAlgTracker::collectSingleViewFront(pma::Track3D& trk,
 }
 
 bool pma::PMAlgTracker::reassignSingleViewEnds_1(detinfo::DetectorPropertiesData const& detProp,
+                                                 ClusterUsage& usage,
                                                  pma::TrkCandidateColl& tracks)
 {
   bool result = false;
@@ -618,12 +633,12 @@ bool pma::PMAlgTracker::reassignSingleViewEnds_1(detinfo::DetectorPropertiesData
     std::vector<art::Ptr<recob::Hit>> hits;
 
     double d2 = collectSingleViewEnd(trk, hits);
-    result |= reassignHits_1(detProp, hits, tracks, t, d2);
+    result |= reassignHits_1(detProp, usage, hits, tracks, t, d2);
 
     hits.clear();
 
     d2 = collectSingleViewFront(trk, hits);
-    result |= reassignHits_1(detProp, hits, tracks, t, d2);
+    result |= reassignHits_1(detProp, usage, hits, tracks, t, d2);
 
     trk.SelectHits();
   }
@@ -944,58 +959,173 @@ size_t pma::PMAlgTracker::matchTrack(detinfo::DetectorPropertiesData const& detP
 
 // ------------------------------------------------------
 // ------------------------------------------------------
-int pma::PMAlgTracker::build(detinfo::DetectorClocksData const& clockData,
-                             detinfo::DetectorPropertiesData const& detProp)
+void pma::PMAlgTracker::buildTPC(detinfo::DetectorClocksData const& clockData,
+                                 detinfo::DetectorPropertiesData const& detProp,
+                                 geo::TPCID const& tpcid,
+                                 pma::TrkCandidateColl& tracks,
+                                 ClusterUsage& usage)
 {
-  fInitialClusters.clear();
-  fTriedClusters.clear();
-  fUsedClusters.clear();
+  mf::LogVerbatim("PMAlgTracker") << "Reconstruct tracks within Cryo:" << tpcid.Cryostat
+                                  << " / TPC:" << tpcid.TPC << ".";
 
-  size_t nplanes = fGeom->MaxPlanes();
+  if (fValidation != pma::PMAlgTracker::kHits) // initialize ADC images for all planes in
+                                               // this TPC (in "adc" and "calib")
+  {
+    mf::LogVerbatim("PMAlgTracker") << "Prepare validation ADC images...";
+    bool ok = true;
+    for (size_t p = 0; p < fAdcImages.size(); ++p) {
+      ok &=
+        fAdcImages[p].setWireDriftData(clockData, detProp, fWires, p, tpcid.TPC, tpcid.Cryostat);
+    }
+    if (ok) { mf::LogVerbatim("PMAlgTracker") << "  ...done."; }
+    else {
+      mf::LogVerbatim("PMAlgTracker") << "  ...failed.";
+      return;
+    }
+  }
 
-  pma::tpc_track_map tracks; // track parts in tpc's
+  // find reasonably large parts
+  fromMaxCluster_tpc(detProp, usage, tracks, fMinSeedSize1stPass, tpcid.TPC, tpcid.Cryostat);
+  // loop again to find small things
+  fromMaxCluster_tpc(detProp, usage, tracks, fMinSeedSize2ndPass, tpcid.TPC, tpcid.Cryostat);
 
+  //tryClusterLeftovers();
+
+  mf::LogVerbatim("PMAlgTracker") << "Found tracks: " << tracks.size();
+  if (tracks.empty()) { return; }
+
+  // add 3D ref.points for clean endpoints of wire-plane parallel track
+  guideEndpoints(detProp, tracks);
+  // try correcting single-view sections spuriously merged on 2D clusters
+  // level
+  reassignSingleViewEnds_1(detProp, usage, tracks);
+
+  if (fMergeWithinTPC) {
+    mf::LogVerbatim("PMAlgTracker") << "Merge co-linear tracks within TPC " << tpcid.TPC << ".";
+    while (mergeCoLinear(clockData, detProp, tracks)) {
+      mf::LogVerbatim("PMAlgTracker") << "  found co-linear tracks";
+    }
+  }
+}
+// ------------------------------------------------------
+
+namespace {
+  using TrackHits_t = std::vector<art::Ptr<recob::Hit>>;
+
+  /// Sorted hits of each track in the collection, tracks sorted as well
+  std::vector<TrackHits_t> sortedTrackHits(const pma::TrkCandidateColl& tracks)
+  {
+    std::vector<TrackHits_t> result;
+    for (auto const& candidate : tracks.tracks()) {
+      const pma::Track3D& trk = *(candidate.Track());
+      TrackHits_t hits;
+      for (size_t h = 0; h < trk.size(); ++h)
+        hits.push_back(trk[h]->Hit2DPtr());
+      std::sort(hits.begin(), hits.end());
+      result.push_back(std::move(hits));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+} // namespace
+
+void pma::PMAlgTracker::checkParallelTPCs(detinfo::DetectorClocksData const& clockData,
+                                          detinfo::DetectorPropertiesData const& detProp,
+                                          const pma::tpc_track_map& tracks)
+{
+  ClusterUsage usage;
+  pma::tpc_track_map serialTracks;
   for (auto const& tpcid : fGeom->Iterate<geo::TPCID>()) {
-    mf::LogVerbatim("PMAlgTracker")
-      << "Reconstruct tracks within Cryo:" << tpcid.Cryostat << " / TPC:" << tpcid.TPC << ".";
+    buildTPC(clockData, detProp, tpcid, serialTracks[tpcid.TPC], usage);
+  }
 
-    if (fValidation != pma::PMAlgTracker::kHits) // initialize ADC images for all planes in
-                                                 // this TPC (in "adc" and "calib")
-    {
-      mf::LogVerbatim("PMAlgTracker") << "Prepare validation ADC images...";
-      bool ok = true;
-      for (size_t p = 0; p < nplanes; ++p) {
-        ok &=
-          fAdcImages[p].setWireDriftData(clockData, detProp, fWires, p, tpcid.TPC, tpcid.Cryostat);
-      }
-      if (ok) { mf::LogVerbatim("PMAlgTracker") << "  ...done."; }
-      else {
-        mf::LogVerbatim("PMAlgTracker") << "  ...failed.";
-        continue;
+  size_t nSame = 0, nSerialOnly = 0, nCrossing = 0, nParallelOnly = 0;
+  for (auto& tpc_entry : serialTracks) {
+    auto const serialHits = sortedTrackHits(tpc_entry.second);
+    auto const parallelHits = sortedTrackHits(tracks.at(tpc_entry.first));
+
+    std::vector<TrackHits_t> serialOnly;
+    std::set_difference(serialHits.begin(),
+                        serialHits.end(),
+                        parallelHits.begin(),
+                        parallelHits.end(),
+                        std::back_inserter(serialOnly));
+    size_t const same = serialHits.size() - serialOnly.size();
+
+    nSame += same;
+    nSerialOnly += serialOnly.size();
+    nParallelOnly += parallelHits.size() - same;
+    for (auto const& hits : serialOnly) {
+      if (hits.empty()) continue;
+
+      // extended with clusters of other TPCs, not done in the parallel build
+      auto const tpcid = hits.front()->WireID().asTPCID();
+      for (auto const& h : hits) {
+        if (h->WireID().asTPCID() != tpcid) {
+          ++nCrossing;
+          break;
+        }
       }
     }
 
-    // find reasonably large parts
-    fromMaxCluster_tpc(detProp, tracks[tpcid.TPC], fMinSeedSize1stPass, tpcid.TPC, tpcid.Cryostat);
-    // loop again to find small things
-    fromMaxCluster_tpc(detProp, tracks[tpcid.TPC], fMinSeedSize2ndPass, tpcid.TPC, tpcid.Cryostat);
+    for (auto& trk : tpc_entry.second.tracks())
+      trk.DeleteTrack();
+  }
+
+  if (nSerialOnly || nParallelOnly) {
+    mf::LogWarning("PMAlgTracker")
+      << "Parallel TPC build: " << nSame << " tracks as in the serial build, " << nSerialOnly
+      << " only in the serial build (" << nCrossing << " of them crossing TPCs), "
+      << nParallelOnly << " only in the parallel build.";
+  }
+  else {
+    mf::LogVerbatim("PMAlgTracker")
+      << "Parallel TPC build: all " << nSame << " tracks as in the serial build.";
+  }
+}
+// ------------------------------------------------------
+
+int pma::PMAlgTracker::build(detinfo::DetectorClocksData const& clockData,
+                             detinfo::DetectorPropertiesData const& detProp)
+{
+  fClusterUsage = ClusterUsage();
 
-    //tryClusterLeftovers();
+  pma::tpc_track_map tracks; // track parts in tpc's
 
-    mf::LogVerbatim("PMAlgTracker") << "Found tracks: " << tracks[tpcid.TPC].size();
-    if (tracks[tpcid.TPC].empty()) { continue; }
+  if (fParallelTPCs) {
+    // TPCs with the same number share their track collection, so they are
+    // built one after another in a single task, as in the serial loop
+    std::map<unsigned int, std::vector<geo::TPCID>> tpcGroups;
+    for (auto const& tpcid : fGeom->Iterate<geo::TPCID>()) {
+      tpcGroups[tpcid.TPC].push_back(tpcid);
+      fHitMap[tpcid.Cryostat][tpcid.TPC]; // tasks must not insert into the outer maps
+    }
 
-    // add 3D ref.points for clean endpoints of wire-plane parallel track
-    guideEndpoints(detProp, tracks[tpcid.TPC]);
-    // try correcting single-view sections spuriously merged on 2D clusters
-    // level
-    reassignSingleViewEnds_1(detProp, tracks[tpcid.TPC]);
+    std::vector<std::pair<unsigned int, std::vector<geo::TPCID>>> groups(tpcGroups.begin(),
+                                                                         tpcGroups.end());
+    std::vector<pma::TrkCandidateColl> groupTracks(groups.size());
+    std::vector<ClusterUsage> groupUsage(groups.size());
+    for (auto& usage : groupUsage)
+      usage.ownTPCOnly = true;
 
-    if (fMergeWithinTPC) {
-      mf::LogVerbatim("PMAlgTracker") << "Merge co-linear tracks within TPC " << tpcid.TPC << ".";
-      while (mergeCoLinear(clockData, detProp, tracks[tpcid.TPC])) {
-        mf::LogVerbatim("PMAlgTracker") << "  found co-linear tracks";
+    tbb::parallel_for(static_cast<std::size_t>(0), groups.size(), [&](std::size_t g) {
+      for (auto const& tpcid : groups[g].second) {
+        buildTPC(clockData, detProp, tpcid, groupTracks[g], groupUsage[g]);
       }
+    });
+
+    // collect the results in the order of TPC numbers, independent of the scheduling
+    for (size_t g = 0; g < groups.size(); ++g) {
+      tracks[groups[g].first] = std::move(groupTracks[g]);
+      fClusterUsage.used.insert(
+        fClusterUsage.used.end(), groupUsage[g].used.begin(), groupUsage[g].used.end());
+    }
+
+    if (fCheckParallelTPCs) checkParallelTPCs(clockData, detProp, tracks);
+  }
+  else {
+    for (auto const& tpcid : fGeom->Iterate<geo::TPCID>()) {
+      buildTPC(clockData, detProp, tpcid, tracks[tpcid.TPC], fClusterUsage);
     }
   }
 
@@ -1064,12 +1194,13 @@ int pma::PMAlgTracker::build(detinfo::DetectorClocksData const& clockData,
 // ------------------------------------------------------
 
 void pma::PMAlgTracker::fromMaxCluster_tpc(detinfo::DetectorPropertiesData const& detProp,
+                                           ClusterUsage& usage,
                                            pma::TrkCandidateColl& result,
                                            size_t minBuildSize,
                                            unsigned int tpc,
                                            unsigned int cryo)
 {
-  fInitialClusters.clear();
+  usage.initial.clear();
 
   size_t minSizeCompl = minBuildSize / 8; // smaller minimum required in complementary views
   if (minSizeCompl < 2) minSizeCompl = 2; // but at least two hits!
@@ -1079,12 +1210,12 @@ void pma::PMAlgTracker::fromMaxCluster_tpc(detinfo::DetectorPropertiesData const
   {
     mf::LogVerbatim("PMAlgTracker") << "Find max cluster...";
     max_first_idx =
-      maxCluster(minBuildSize, geo::kUnknown, tpc, cryo); // any view, but must be track-like
+      maxCluster(usage, minBuildSize, geo::kUnknown, tpc, cryo); // any view, but track-like
     if ((max_first_idx >= 0) && !fCluHits[max_first_idx].empty()) {
       geo::View_t first_view = fCluHits[max_first_idx].front()->View();
 
       pma::TrkCandidate candidate =
-        matchCluster(detProp, max_first_idx, minSizeCompl, tpc, cryo, first_view);
+        matchCluster(detProp, usage, max_first_idx, minSizeCompl, tpc, cryo, first_view);
 
       if (candidate.IsGood()) result.push_back(candidate);
     }
@@ -1092,12 +1223,13 @@ void pma::PMAlgTracker::fromMaxCluster_tpc(detinfo::DetectorPropertiesData const
       mf::LogVerbatim("PMAlgTracker") << "small clusters only";
   }
 
-  fInitialClusters.clear();
+  usage.initial.clear();
 }
 // ------------------------------------------------------
 
 pma::TrkCandidate pma::PMAlgTracker::matchCluster(
   detinfo::DetectorPropertiesData const& detProp,
+  ClusterUsage& usage,
   int first_clu_idx,
   const std::vector<art::Ptr<recob::Hit>>& first_hits,
   size_t minSizeCompl,
@@ -1108,12 +1240,12 @@ pma::TrkCandidate pma::PMAlgTracker::matchCluster(
   pma::TrkCandidate result;
 
   for (auto av : fAvailableViews) {
-    fTriedClusters[av].clear();
+    usage.tried[av].clear();
   }
 
   if (first_clu_idx >= 0) {
-    fTriedClusters[first_view].push_back((size_t)first_clu_idx);
-    fInitialClusters.push_back((size_t)first_clu_idx);
+    usage.tried[first_view].push_back((size_t)first_clu_idx);
+    usage.initial.push_back((size_t)first_clu_idx);
   }
 
   unsigned int nFirstHits = first_hits.size(), first_plane_idx = first_hits.front()->WireID().Plane;
@@ -1146,15 +1278,15 @@ pma::TrkCandidate pma::PMAlgTracker::matchCluster(
     for (auto av : fAvailableViews) {
       if (av == first_view) continue;
 
-      av_idx =
-        maxCluster(detProp, first_clu_idx, candidates, xmin, xmax, minSizeCompl, av, tpc, cryo);
+      av_idx = maxCluster(
+        detProp, usage, first_clu_idx, candidates, xmin, xmax, minSizeCompl, av, tpc, cryo);
       if (av_idx >= 0) {
         nHits = fCluHits[av_idx].size();
         if ((nHits > nMaxHits) && (nHits >= minSizeCompl)) {
           nMaxHits = nHits;
           idx = av_idx;
           bestView = av;
-          fTriedClusters[av].push_back(idx);
+          usage.tried[av].push_back(idx);
           try_build = true;
         }
       }
@@ -1209,8 +1341,8 @@ pma::TrkCandidate pma::PMAlgTracker::matchCluster(
         idx = 0;
         while (idx >= 0) // try to collect matching clusters, use **any** plane except validation
         {
-          idx =
-            matchCluster(detProp, candidate, minSize, fraction, geo::kUnknown, testView, tpc, cryo);
+          idx = matchCluster(
+            detProp, usage, candidate, minSize, fraction, geo::kUnknown, testView, tpc, cryo);
           if (idx >= 0) {
             // try building extended copy:
             //                src,        hits,      valid.plane, add nodes
@@ -1231,8 +1363,8 @@ pma::TrkCandidate pma::PMAlgTracker::matchCluster(
                (testView != geo::kUnknown)) { //                     match clusters from the
                                               //                     plane used previously
                                               //                     for the validation
-          idx =
-            matchCluster(detProp, candidate, minSize, fraction, testView, geo::kUnknown, tpc, cryo);
+          idx = matchCluster(
+            detProp, usage, candidate, minSize, fraction, testView, geo::kUnknown, tpc, cryo);
           if (idx >= 0) {
             // validation not checked here, no new nodes:
             if (extendTrack(detProp, candidate, fCluHits[idx], geo::kUnknown, false)) {
@@ -1281,7 +1413,7 @@ pma::TrkCandidate pma::PMAlgTracker::matchCluster(
       candidates[best_trk].Track()->ShiftEndsToHits();
 
       for (auto c : candidates[best_trk].Clusters())
-        fUsedClusters.push_back(c);
+        usage.used.push_back(c);
 
       result = candidates[best_trk];
     }
@@ -1332,6 +1464,7 @@ bool pma::PMAlgTracker::extendTrack(detinfo::DetectorPropertiesData const& detPr
 // ------------------------------------------------------
 
 int pma::PMAlgTracker::matchCluster(detinfo::DetectorPropertiesData const& detProp,
+                                    const ClusterUsage& usage,
                                     const pma::TrkCandidate& trk,
                                     size_t minSize,
                                     double fraction,
@@ -1349,7 +1482,7 @@ int pma::PMAlgTracker::matchCluster(detinfo::DetectorPropertiesData const& detPr
     unsigned int view = fCluHits[i].front()->View();
     unsigned int nhits = fCluHits[i].size();
 
-    if (has(fUsedClusters, i) ||  // don't try already used clusters
+    if (has(usage.used, i) ||     // don't try already used clusters
         has(trk.Clusters(), i) || // don't try clusters from this candidate
         (view == testView) ||     // don't use clusters from validation view
         ((preferedView != geo::kUnknown) &&
@@ -1357,6 +1490,9 @@ int pma::PMAlgTracker::matchCluster(detinfo::DetectorPropertiesData const& detPr
         (nhits < minSize))          // skip small clusters
       continue;
 
+    // clusters of other TPCs may be taken concurrently by their own tracks
+    if (usage.ownTPCOnly && (fCluHits[i].front()->WireID().TPC != tpc)) continue;
+
     n = fProjectionMatchingAlg.testHits(detProp, *(trk.Track()), fCluHits[i]);
     f = n / (double)nhits;
     if ((f > fraction) && (n > max)) {
@@ -1376,6 +1512,7 @@ int pma::PMAlgTracker::matchCluster(detinfo::DetectorPropertiesData const& detPr
 // ------------------------------------------------------
 
 int pma::PMAlgTracker::maxCluster(detinfo::DetectorPropertiesData const& detProp,
+                                  ClusterUsage& usage,
                                   int first_idx_tag,
                                   const pma::TrkCandidateColl& candidates,
                                   float xmin,
@@ -1399,7 +1536,7 @@ int pma::PMAlgTracker::maxCluster(detinfo::DetectorPropertiesData const& detProp
 
   for (size_t i = 0; i < fCluHits.size(); ++i) {
     if ((fCluHits[i].size() < min_clu_size) || (fCluHits[i].front()->View() != view) ||
-        has(fUsedClusters, i) || has(fInitialClusters, i) || has(fTriedClusters[view], i))
+        has(usage.used, i) || has(usage.initial, i) || has(usage.tried[view], i))
       continue;
 
     bool pair_checked = false;
@@ -1432,7 +1569,8 @@ int pma::PMAlgTracker::maxCluster(detinfo::DetectorPropertiesData const& detProp
 }
 // ------------------------------------------------------
 
-int pma::PMAlgTracker::maxCluster(size_t min_clu_size,
+int pma::PMAlgTracker::maxCluster(ClusterUsage& usage,
+                                  size_t min_clu_size,
                                   geo::View_t view,
                                   unsigned int tpc,
                                   unsigned int cryo) const
@@ -1443,8 +1581,8 @@ int pma::PMAlgTracker::maxCluster(size_t min_clu_size,
   for (size_t i = 0; i < fCluHits.size(); ++i) {
     const auto& v = fCluHits[i];
 
-    if (v.empty() || (fCluWeights[i] < fTrackLikeThreshold) || has(fUsedClusters, i) ||
-        has(fInitialClusters, i) || has(fTriedClusters[view], i) ||
+    if (v.empty() || (fCluWeights[i] < fTrackLikeThreshold) || has(usage.used, i) ||
+        has(usage.initial, i) || has(usage.tried[view], i) ||
         ((view != geo::kUnknown) && (v.front()->View() != view)))
       continue;
 
@@ -1465,7 +1603,7 @@ void pma::PMAlgTracker::listUsedClusters(detinfo::DetectorPropertiesData const&
 {
   mf::LogVerbatim("PMAlgTracker") << std::endl << "----------- matched clusters: -----------";
   for (size_t i = 0; i < fCluHits.size(); ++i) {
-    if (!fCluHits[i].empty() && has(fUsedClusters, i)) {
+    if (!fCluHits[i].empty() && has(fClusterUsage.used, i)) {
       mf::LogVerbatim("PMAlgTracker")
         << "    tpc: " << fCluHits[i].front()->WireID().TPC
         << ";\tview: " << fCluHits[i].front()->View() << ";\tsize: " << fCluHits[i].size()
@@ -1476,7 +1614,7 @@ void pma::PMAlgTracker::listUsedClusters(detinfo::DetectorPropertiesData const&
   mf::LogVerbatim("PMAlgTracker") << "--------- not matched clusters: ---------";
   size_t nsingles = 0;
   for (size_t i = 0; i < fCluHits.size(); ++i) {
-    if (!fCluHits[i].empty() && !has(fUsedClusters, i)) {
+    if (!fCluHits[i].empty() && !has(fClusterUsage.used, i)) {
       if (fCluHits[i].size() == 1) { nsingles++; }
       else {
         mf::LogVerbatim("PMAlgTracker")
@@ -228,6 +228,20 @@ public:
       Name("MatchT0inCPACrossing"),
       Comment("match T0 of CPA-crossing tracks using PMAlgStitcher")};
 
+    fhicl::Atom<bool> ParallelTPCs{
+      Name("ParallelTPCs"),
+      Comment("build tracks in different TPCs concurrently (hits validation mode only); tracks "
+              "are not extended with clusters of other TPCs while they are built, so a track "
+              "crossing TPCs comes in parts, joined only if StitchBetweenTPCs is set; "
+              "stitching between TPCs and later steps stay serial"),
+      false};
+
+    fhicl::Atom<bool> CheckParallelTPCs{
+      Name("CheckParallelTPCs"),
+      Comment("with ParallelTPCs, build the TPCs also serially and report the tracks which "
+              "differ (slow, for validation)"),
+      false};
+
     fhicl::Atom<std::string> Validation{Name("Validation"),
                                         Comment("tracks validation mode: hits, adc, calib")};
 
@@ -263,15 +277,34 @@ public:
             detinfo::DetectorPropertiesData const& detProp);
 
 private:
+  /// Clusters used and tried while building tracks. Tracks in TPCs built
+  /// concurrently keep separate records, merged when all TPCs are done.
+  struct ClusterUsage {
+    std::vector<size_t> used, initial;
+    std::map<unsigned int, std::vector<size_t>> tried;
+    bool ownTPCOnly = false; ///< extend tracks only with clusters of the TPC being built
+  };
+
+  void buildTPC(detinfo::DetectorClocksData const& clockData,
+                detinfo::DetectorPropertiesData const& detProp,
+                geo::TPCID const& tpcid,
+                pma::TrkCandidateColl& tracks,
+                ClusterUsage& usage);
+  void checkParallelTPCs(detinfo::DetectorClocksData const& clockData,
+                         detinfo::DetectorPropertiesData const& detProp,
+                         const pma::tpc_track_map& tracks);
+
   double collectSingleViewEnd(pma::Track3D& trk, std::vector<art::Ptr<recob::Hit>>& hits) const;
   double collectSingleViewFront(pma::Track3D& trk, std::vector<art::Ptr<recob::Hit>>& hits) const;
 
   bool reassignHits_1(detinfo::DetectorPropertiesData const& detProp,
+                      ClusterUsage& usage,
                       const std::vector<art::Ptr<recob::Hit>>& hits,
                       pma::TrkCandidateColl& tracks,
                       size_t trk_idx,
                       double dist2);
   bool reassignSingleViewEnds_1(detinfo::DetectorPropertiesData const& detProp,
+                                ClusterUsage& usage,
                                 pma::TrkCandidateColl& tracks); // use clusters
 
   bool areCoLinear(pma::Track3D* trk1,
@@ -299,6 +332,7 @@ private:
                   unsigned int testView);
 
   void fromMaxCluster_tpc(detinfo::DetectorPropertiesData const& detProp,
+                          ClusterUsage& usage,
                           pma::TrkCandidateColl& result,
                           size_t minBuildSize,
                           unsigned int tpc,
@@ -309,6 +343,7 @@ private:
                     const std::vector<art::Ptr<recob::Hit>>& hits) const;
 
   pma::TrkCandidate matchCluster(detinfo::DetectorPropertiesData const& detProp,
+                                 ClusterUsage& usage,
                                  int first_clu_idx,
                                  const std::vector<art::Ptr<recob::Hit>>& first_hits,
                                  size_t minSizeCompl,
@@ -317,17 +352,25 @@ private:
                                  geo::View_t first_view);
 
   pma::TrkCandidate matchCluster(detinfo::DetectorPropertiesData const& detProp,
+                                 ClusterUsage& usage,
                                  int first_clu_idx,
                                  size_t minSizeCompl,
                                  unsigned int tpc,
                                  unsigned int cryo,
                                  geo::View_t first_view)
   {
-    return matchCluster(
-      detProp, first_clu_idx, fCluHits[first_clu_idx], minSizeCompl, tpc, cryo, first_view);
+    return matchCluster(detProp,
+                        usage,
+                        first_clu_idx,
+                        fCluHits[first_clu_idx],
+                        minSizeCompl,
+                        tpc,
+                        cryo,
+                        first_view);
   }
 
   int matchCluster(detinfo::DetectorPropertiesData const& detProp,
+                   const ClusterUsage& usage,
                    const pma::TrkCandidate& trk,
                    size_t minSize,
                    double fraction,
@@ -343,6 +386,7 @@ private:
                    bool add_nodes);
 
   int maxCluster(detinfo::DetectorPropertiesData const& detProp,
+                 ClusterUsage& usage,
                  int first_idx_tag,
                  const pma::TrkCandidateColl& candidates,
                  float xmin,
@@ -352,7 +396,11 @@ private:
                  unsigned int tpc,
                  unsigned int cryo) const;
 
-  int maxCluster(size_t min_clu_size, geo::View_t view, unsigned int tpc, unsigned int cryo) const;
+  int maxCluster(ClusterUsage& usage,
+                 size_t min_clu_size,
+                 geo::View_t view,
+                 unsigned int tpc,
+                 unsigned int cryo) const;
 
   void listUsedClusters(detinfo::DetectorPropertiesData const& detProp) const;
 
@@ -368,8 +416,7 @@ private:
   std::vector<float> fCluWeights;
 
   /// --------------------------------------------------------------
-  std::vector<size_t> fUsedClusters, fInitialClusters;
-  mutable std::map<unsigned int, std::vector<size_t>> fTriedClusters;
+  ClusterUsage fClusterUsage;
   std::vector<geo::View_t> fAvailableViews;
   /// --------------------------------------------------------------
 
@@ -410,6 +457,9 @@ private:
 
   bool fRunVertexing; // run vertex finding
 
+  bool fParallelTPCs;      // build tracks in different TPCs concurrently
+  bool fCheckParallelTPCs; // compare the concurrent build with the serial one
+
   EValidationMode fValidation;                  // track validation mode
   std::vector<img::DataProviderAlg> fAdcImages; // adc image making algorithms for each plane
   std::vector<double> fAdcValidationThr;        // threshold on pixel values in the adc image
@@ -676,15 +676,20 @@ namespace tca {
     bool isValid{false};                 // set false if this slice failed reconstruction
   };
 
-  extern TCEvent evt;
-  extern TCConfig tcc;
-  extern ShowerTreeVars stv;
-  extern std::vector<TjForecast> tjfs;
+  // The reconstruction state is thread-local so that events can be reconstructed
+  // concurrently on different threads (SharedProducer)
+  extern thread_local TCEvent evt;
+  extern thread_local TCConfig tcc;
+  extern thread_local std::vector<TjForecast> tjfs;
 
   // vector of hits, tjs, etc in each slice
-  extern std::vector<TCSlice> slices;
+  extern thread_local std::vector<TCSlice> slices;
   // vector of seed TPs
-  extern std::vector<TrajPoint> seeds;
+  extern thread_local std::vector<TrajPoint> seeds;
+
+  // shower tree variables are bound to TTree branches so they are shared by all
+  // threads. They are only filled in kSaveShowerTree mode, which is not run concurrently
+  extern ShowerTreeVars stv;
 
 } // namespace tca
 
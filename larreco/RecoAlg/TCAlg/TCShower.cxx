@@ -20,6 +20,7 @@
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,6 +31,9 @@ namespace tca {
 
   using namespace detail;
 
+  // serializes access to the TMVA reader, which is not thread safe
+  static std::mutex showerParentReaderMutex;
+
   ////////////////////////////////////////////////
   void ConfigureMVA(TCConfig& tcc, std::string fMVAShowerParentWeights)
   {
@@ -1728,7 +1732,13 @@ namespace tca {
       tcc.showerParentVars[6] = acos(costh2);
       tcc.showerParentVars[7] = chgFrac;
       tcc.showerParentVars[8] = prob;
-      float candParFOM = tcc.showerParentReader->EvaluateMVA("BDT");
+      float candParFOM = 0;
+      {
+        // The reader is shared by all threads and was bound to the variables of the
+        // configuring thread so pass this thread's variables explicitly
+        std::lock_guard<std::mutex> lock(showerParentReaderMutex);
+        candParFOM = tcc.showerParentReader->EvaluateMVA(tcc.showerParentVars, "BDT");
+      }
 
       if (prt) {
         mf::LogVerbatim myprt("TC");
@@ -11,6 +11,8 @@
 #include <stddef.h>
 #include <string>
 
+#include "tbb/parallel_invoke.h"
+
 #include "Math/BinaryOperators.h"
 #include "Math/Expression.h"
 #include "Math/GenVector/Cartesian3D.h"
@@ -54,35 +56,53 @@ bool trkf::TrackKalmanFitter::fitTrack(detinfo::DetectorPropertiesData const& de
     std::vector<art::Ptr<recob::Hit>> fwdHits;
     trkmkr::OptionalOutputs fwdoptionals;
     SMatrixSym55 fwdcov = covVtx;
-    bool okfwd = fitTrack(detProp,
-                          position,
-                          direction,
-                          fwdcov,
-                          hits,
-                          traj.Flags(),
-                          tkID,
-                          pval,
-                          pdgid,
-                          fwdTrack,
-                          fwdHits,
-                          fwdoptionals);
+    bool okfwd = false;
 
     recob::Track bwdTrack;
     std::vector<art::Ptr<recob::Hit>> bwdHits;
     trkmkr::OptionalOutputs bwdoptionals;
     SMatrixSym55 bwdcov = covEnd;
-    bool okbwd = fitTrack(detProp,
-                          position,
-                          -direction,
-                          bwdcov,
-                          hits,
-                          traj.Flags(),
-                          tkID,
-                          pval,
-                          pdgid,
-                          bwdTrack,
-                          bwdHits,
-                          bwdoptionals);
+    bool okbwd = false;
+
+    auto fitFwd = [&] {
+      okfwd = fitTrack(detProp,
+                       position,
+                       direction,
+                       fwdcov,
+                       hits,
+                       traj.Flags(),
+                       tkID,
+                       pval,
+                       pdgid,
+                       fwdTrack,
+                       fwdHits,
+                       fwdoptionals);
+    };
+    auto fitBwd = [&] {
+      okbwd = fitTrack(detProp,
+                       position,
+                       -direction,
+                       bwdcov,
+                       hits,
+                       traj.Flags(),
+                       tkID,
+                       pval,
+                       pdgid,
+                       bwdTrack,
+                       bwdHits,
+                       bwdoptionals);
+    };
+    if (parallelDirs_) {
+      // the fits in the two directions are independent; the hit pointers are
+      // resolved here, so that the two fits only read them
+      for (auto const& hit : hits)
+        hit.get();
+      tbb::parallel_invoke(fitFwd, fitBwd);
+    }
+    else {
+      fitFwd();
+      fitBwd();
+    }
 
     if (okfwd == false && okbwd == false) { return false; }
     else if (okfwd == true && okbwd == true) {
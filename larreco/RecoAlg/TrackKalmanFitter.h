@@ -48,6 +48,10 @@ namespace trkf {
    *
    * For configuration options see TrackKalmanFitter#Config
    *
+   * The fit keeps no state between calls, so the same fitter can fit several tracks concurrently,
+   * as long as the const interface of its TrackStatePropagator is thread-safe. With tryBothDirs
+   * and setParallelDirs(true), the fits in the two directions are run as concurrent tasks.
+   *
    * @author  G. Cerati (FNAL, MicroBooNE)
    * @date    2017
    * @version 1.0
@@ -216,6 +220,9 @@ namespace trkf {
                           p().dumpLevel())
     {}
 
+    /// Run the fits in the two directions of tryBothDirs as concurrent tasks (default: false)
+    void setParallelDirs(bool opt = true) { parallelDirs_ = opt; }
+
     /// Fit track starting from TrackTrajectory
     bool fitTrack(detinfo::DetectorPropertiesData const& detProp,
                   const recob::TrackTrajectory& traj,
@@ -316,6 +323,7 @@ namespace trkf {
     float maxDist_;
     float negDistTolerance_;
     int dumpLevel_;
+    bool parallelDirs_ = false;
   };
 
 }
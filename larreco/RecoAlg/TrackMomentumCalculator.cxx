@@ -6,6 +6,7 @@
 #include "cetlib/pow.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
@@ -18,8 +19,6 @@
 #include "Math/GenVector/PositionVector3D.h"
 #include "Minuit2/Minuit2Minimizer.h"
 #include "Rtypes.h"
-#include "TAxis.h"
-#include "TGraphErrors.h"
 #include "TMath.h"
 #include "TMatrixDSymEigen.h"
 #include "TMatrixDSymfwd.h"
@@ -122,6 +121,94 @@ namespace {
     std::vector<double> const eymeas_;
   };
 
+  using Matrix33_t = std::array<std::array<double, 3>, 3>;
+  using Vector3_t = std::array<double, 3>;
+
+  // Unit eigenvector of a symmetric 3x3 matrix for a simple eigenvalue lambda: the largest
+  // cross product of two rows of m - lambda I, which are orthogonal to it
+  Vector3_t null_direction(Matrix33_t const& m, double const lambda)
+  {
+    Matrix33_t a = m;
+    for (int r = 0; r < 3; ++r)
+      a[r][r] -= lambda;
+
+    Vector3_t best{{1., 0., 0.}};
+    double bestNorm2 = 0.;
+    for (auto const& [r1, r2] :
+         {std::make_pair(0, 1), std::make_pair(0, 2), std::make_pair(1, 2)}) {
+      Vector3_t const v{{a[r1][1] * a[r2][2] - a[r1][2] * a[r2][1],
+                         a[r1][2] * a[r2][0] - a[r1][0] * a[r2][2],
+                         a[r1][0] * a[r2][1] - a[r1][1] * a[r2][0]}};
+      double const norm2 = cet::sum_of_squares(v[0], v[1], v[2]);
+      if (norm2 > bestNorm2) {
+        bestNorm2 = norm2;
+        best = v;
+      }
+    }
+    if (bestNorm2 == 0.) return {{1., 0., 0.}};
+
+    double const norm = std::sqrt(bestNorm2);
+    return {{best[0] / norm, best[1] / norm, best[2] / norm}};
+  }
+
+  double bilinear(Vector3_t const& u, Matrix33_t const& m, Vector3_t const& v)
+  {
+    double result = 0.;
+    for (int r = 0; r < 3; ++r)
+      for (int c = 0; c < 3; ++c)
+        result += u[r] * m[r][c] * v[c];
+    return result;
+  }
+
+}
+
+namespace trkf::details {
+
+  std::tuple<double, double, double> principal_axis(Matrix33_t const& m)
+  {
+    // eigenvalues from the trigonometric solution of the characteristic equation
+    double const p1 = cet::sum_of_squares(m[0][1], m[0][2], m[1][2]);
+    double const q = (m[0][0] + m[1][1] + m[2][2]) / 3.0;
+    double const p2 = cet::sum_of_squares(m[0][0] - q, m[1][1] - q, m[2][2] - q) + 2.0 * p1;
+    double const p = std::sqrt(p2 / 6.0);
+    if (p == 0.) return {1., 0., 0.}; // multiple of the identity, any axis will do
+
+    Matrix33_t b;
+    for (int r = 0; r < 3; ++r)
+      for (int c = 0; c < 3; ++c)
+        b[r][c] = (m[r][c] - (r == c ? q : 0.)) / p;
+    double const detB = b[0][0] * (b[1][1] * b[2][2] - b[1][2] * b[2][1]) -
+                        b[0][1] * (b[1][0] * b[2][2] - b[1][2] * b[2][0]) +
+                        b[0][2] * (b[1][0] * b[2][1] - b[1][1] * b[2][0]);
+    double const phi = std::acos(std::clamp(detB / 2.0, -1.0, 1.0)) / 3.0;
+    double const lambda1 = q + 2.0 * p * std::cos(phi);
+    double const lambda3 = q + 2.0 * p * std::cos(phi + 2.0 * TMath::Pi() / 3.0);
+    double const lambda2 = 3.0 * q - lambda1 - lambda3;
+
+    if (lambda1 - lambda2 >= lambda2 - lambda3) {
+      auto const v1 = null_direction(m, lambda1);
+      return {v1[0], v1[1], v1[2]};
+    }
+
+    // The largest eigenvalue is closer to the middle one than the smallest is, and its
+    // eigenvector may be ill defined: take the eigenvector of the smallest, then the largest
+    // axis of m in the plane orthogonal to it.
+    auto const v3 = null_direction(m, lambda3);
+    Vector3_t u = (std::abs(v3[0]) > std::abs(v3[1])) ? Vector3_t{{-v3[2], 0., v3[0]}} :
+                                                        Vector3_t{{0., v3[2], -v3[1]}};
+    double const uNorm = std::sqrt(cet::sum_of_squares(u[0], u[1], u[2]));
+    for (auto& c : u)
+      c /= uNorm;
+    Vector3_t const w{{v3[1] * u[2] - v3[2] * u[1],
+                       v3[2] * u[0] - v3[0] * u[2],
+                       v3[0] * u[1] - v3[1] * u[0]}};
+
+    double const theta =
+      0.5 * std::atan2(2.0 * bilinear(u, m, w), bilinear(u, m, u) - bilinear(w, m, w));
+    double const c = std::cos(theta), s = std::sin(theta);
+    return {c * u[0] + s * w[0], c * u[1] + s * w[1], c * u[2] + s * w[2]};
+  }
+
 }
 
 namespace trkf {
@@ -309,6 +396,120 @@ namespace trkf {
     return bf;
   }
 
+  double TrackMomentumCalculator::GetMomentumMultiScatterLLHDLean(
+    art::Ptr<recob::Track> const& trk,
+    bool const checkValidPoints,
+    int const maxMomentum_MeV,
+    int const MomentumStep_MeV,
+    int const max_resolution) const
+  {
+    std::vector<float> recoX;
+    std::vector<float> recoY;
+    std::vector<float> recoZ;
+
+    int n_points = trk->NumberTrajectoryPoints();
+
+    for (int i = 0; i < n_points; i++) {
+      if (checkValidPoints && !trk->HasValidPoint(i)) continue;
+      auto const& pos = trk->LocationAtPoint(i);
+      recoX.push_back(pos.X());
+      recoY.push_back(pos.Y());
+      recoZ.push_back(pos.Z());
+    }
+
+    if (recoX.size() < 2) return -1.0;
+
+    double const seg_size{steps_size};
+
+    auto const segments = segmentTrack_(recoX, recoY, recoZ, seg_size, true);
+    if (!segments.has_value()) return -1.0;
+
+    auto const seg_steps = segments->x.size();
+    if (seg_steps < 2) return -1;
+
+    double const recoL = segments->L.at(seg_steps - 1);
+    if (recoL < minLength || recoL > maxLength) return -1;
+
+    std::vector<float> dEi;
+    std::vector<float> dEj;
+    std::vector<float> dthij;
+    std::vector<float> ind;
+    if (getDeltaThetaij_(dEi, dEj, dthij, ind, *segments, seg_size) != 0) return -1.0;
+
+    return scanMomentumLLHD_(
+      dEi, dEj, dthij, ind, maxMomentum_MeV / MomentumStep_MeV, max_resolution);
+  }
+
+  double TrackMomentumCalculator::scanMomentumLLHD_(std::vector<float> const& dEi,
+                                                    std::vector<float> const& dEj,
+                                                    std::vector<float> const& dthij,
+                                                    std::vector<float> const& ind,
+                                                    int const nMomenta,
+                                                    int const max_resolution) const
+  {
+    // Same terms as my_mcs_llhd(), evaluated for all the momenta of the scan
+    // at once: the inner loops run over independent momenta and vectorize.
+    std::size_t const nP = nMomenta + 1;
+    std::vector<double> p(nP);
+    for (std::size_t k = 0; k < nP; ++k)
+      p[k] = 0.001 + k * 0.01;
+
+    double const red_length = steps_size / rad_length;
+    double const highland1 = 1.0 + 0.038 * std::log(red_length);
+    double const highland2 = std::sqrt(red_length);
+    double const log_norm = -0.5 * std::log(2.0 * TMath::Pi());
+
+    // for each momentum, the lowest value over the resolutions, the first one on ties
+    std::vector<double> best(nP, 1e+16);
+    std::vector<double> addth(nP);
+    std::vector<double> result(nP);
+
+    for (int l = 0; l <= max_resolution; ++l) {
+      double const res_test = (max_resolution == 0) ? 2.0 : 0.001 + l * 1.0;
+      double const res2 = cet::square(res_test);
+
+      std::fill(addth.begin(), addth.end(), 0.);
+      std::fill(result.begin(), result.end(), 0.);
+
+      for (std::size_t i = 0; i < dEi.size(); ++i) {
+        double const ei = dEi[i];
+        double const ej = dEj[i];
+
+        // once the muon stops inside for a momentum, 1 rad is added from then on
+        for (std::size_t k = 0; k < nP; ++k) {
+          if (p[k] - ei > 0 && p[k] - ej < 0) addth[k] = 3.14 * 1000.0;
+        }
+
+        if (ind[i] != 1) continue;
+
+        double const th = dthij[i];
+        for (std::size_t k = 0; k < nP; ++k) {
+          double const Ei = std::abs(p[k] - ei);
+          double const Ej = std::abs(p[k] - ej);
+          double const tH0 = (13.6 / std::sqrt(Ei * Ej)) * highland1 * highland2;
+          double const rms = std::sqrt(tH0 * tH0 + res2);
+          double const arg = (th + addth[k]) / rms;
+          double const prob = (rms == 0.) ? 0. : log_norm - std::log(rms) - 0.5 * arg * arg;
+          result[k] = result[k] - 2.0 * prob;
+        }
+      }
+
+      for (std::size_t k = 0; k < nP; ++k) {
+        if (result[k] < best[k]) best[k] = result[k];
+      }
+    }
+
+    double logL = 1e+16;
+    double bf = -666.0;
+    for (std::size_t k = 0; k < nP; ++k) {
+      if (best[k] < logL) {
+        bf = p[k];
+        logL = best[k];
+      }
+    }
+    return bf;
+  }
+
   TVector3 TrackMomentumCalculator::GetMultiScatterStartingPoint(const art::Ptr<recob::Track>& trk)
   {
     double const LLHDp = GetMuMultiScatterLLHD3(trk, true);
@@ -503,9 +704,47 @@ namespace trkf {
     double const recoL = segments->L.at(seg_steps - 1);
     if (recoL < minLength || recoL > maxLength) return -1;
 
-    double ymax = -999.0;
-    double ymin = +999.0;
+    return fitMomentumChi2_(*segments, recoL, maxMomentum_MeV);
+  }
+
+  double TrackMomentumCalculator::GetMomentumMultiScatterChi2Lean(
+    art::Ptr<recob::Track> const& trk,
+    bool const checkValidPoints,
+    int const maxMomentum_MeV) const
+  {
+    std::vector<float> recoX;
+    std::vector<float> recoY;
+    std::vector<float> recoZ;
+
+    int n_points = trk->NumberTrajectoryPoints();
+
+    for (int i = 0; i < n_points; i++) {
+      if (checkValidPoints && !trk->HasValidPoint(i)) continue;
+      auto const& pos = trk->LocationAtPoint(i);
+      recoX.push_back(pos.X());
+      recoY.push_back(pos.Y());
+      recoZ.push_back(pos.Z());
+    }
+
+    if (recoX.size() < 2) return -1.0;
+
+    double const seg_size{steps_size};
+    auto const segments = segmentTrack_(recoX, recoY, recoZ, seg_size, true);
+    if (!segments.has_value()) return -1.0;
+
+    auto const seg_steps = segments->x.size();
+    if (seg_steps < 2) return -1;
+
+    double const recoL = segments->L.at(seg_steps - 1);
+    if (recoL < minLength || recoL > maxLength) return -1;
+
+    return fitMomentumChi2_(*segments, recoL, maxMomentum_MeV);
+  }
 
+  double TrackMomentumCalculator::fitMomentumChi2_(Segments const& segments,
+                                                   double const recoL,
+                                                   int const maxMomentum_MeV) const
+  {
     std::vector<double> xmeas;
     std::vector<double> ymeas;
     std::vector<double> eymeas;
@@ -514,7 +753,7 @@ namespace trkf {
     eymeas.reserve(n_steps);
     for (int j = 0; j < n_steps; j++) {
       double const trial = steps.at(j);
-      auto const [mean, rms, rmse] = getDeltaThetaRMS_(*segments, trial);
+      auto const [mean, rms, rmse] = getDeltaThetaRMS_(segments, trial);
 
       if (std::isnan(mean) || std::isinf(mean)) {
         mf::LogDebug("TrackMomentumCalculator") << "Returned mean is either nan or infinity.";
@@ -533,29 +772,12 @@ namespace trkf {
       ymeas.push_back(rms);
       eymeas.push_back(std::sqrt(cet::sum_of_squares(
         rmse, 0.05 * rms))); // <--- conservative syst. error to fix chi^{2} behaviour !!!
-
-      if (ymin > rms) ymin = rms;
-      if (ymax < rms) ymax = rms;
     }
 
     assert(xmeas.size() == ymeas.size());
     assert(xmeas.size() == eymeas.size());
     if (xmeas.empty()) { return -1.0; }
 
-    TGraphErrors gr_meas{n_steps, xmeas.data(), ymeas.data(), nullptr, eymeas.data()};
-
-    gr_meas.SetTitle("(#Delta#theta)_{rms} versus material thickness; Material "
-                     "thickness in cm; (#Delta#theta)_{rms} in mrad");
-
-    gr_meas.SetLineColor(kBlack);
-    gr_meas.SetMarkerColor(kBlack);
-    gr_meas.SetMarkerStyle(20);
-    gr_meas.SetMarkerSize(1.2);
-
-    gr_meas.GetXaxis()->SetLimits(steps.at(0) - steps.at(0), steps.at(n_steps - 1) + steps.at(0));
-    gr_meas.SetMinimum(0.0);
-    gr_meas.SetMaximum(1.80 * ymax);
-
     ROOT::Minuit2::Minuit2Minimizer mP{};
     FcnWrapper const wrapper{move(xmeas), move(ymeas), move(eymeas)};
     ROOT::Math::Functor FCA([&wrapper](double const* xs) { return wrapper.my_mcs_chi2(xs); }, 2);
@@ -613,15 +835,16 @@ namespace trkf {
     return true;
   }
 
-  void TrackMomentumCalculator::compute_max_fluctuation_vector(const std::vector<float> segx,
-                                                               const std::vector<float> segy,
-                                                               const std::vector<float> segz,
+  void TrackMomentumCalculator::compute_max_fluctuation_vector(std::vector<float> const& segx,
+                                                               std::vector<float> const& segy,
+                                                               std::vector<float> const& segz,
                                                                std::vector<float>& segnx,
                                                                std::vector<float>& segny,
                                                                std::vector<float>& segnz,
                                                                std::vector<float>& vx,
                                                                std::vector<float>& vy,
-                                                               std::vector<float>& vz)
+                                                               std::vector<float>& vz,
+                                                               bool const closedForm) const
   {
     auto const na = vx.size();
 
@@ -639,72 +862,88 @@ namespace trkf {
     sumy /= na;
     sumz /= na;
 
-    std::vector<double> mx;
-    std::vector<double> my;
-    std::vector<double> mz;
+    double ax, ay, az;
+
+    if (closedForm) {
+      // same sums as below, without the intermediate buffers
+      std::array<std::array<double, 3>, 3> m{};
+      for (std::size_t i = 0; i < na; ++i) {
+        double const w[3] = {vx[i] - sumx, vy[i] - sumy, vz[i] - sumz};
+        for (int r = 0; r < 3; ++r)
+          for (int c = 0; c < 3; ++c)
+            m[r][c] += w[r] * w[c] / na;
+      }
+      std::tie(ax, ay, az) = details::principal_axis(m);
+    }
+    else {
+      std::vector<double> mx;
+      std::vector<double> my;
+      std::vector<double> mz;
 
-    TMatrixDSym m(3);
+      TMatrixDSym m(3);
 
-    for (std::size_t i = 0; i < na; ++i) {
-      double const xxw1 = vx.at(i);
-      double const yyw1 = vy.at(i);
-      double const zzw1 = vz.at(i);
+      for (std::size_t i = 0; i < na; ++i) {
+        double const xxw1 = vx.at(i);
+        double const yyw1 = vy.at(i);
+        double const zzw1 = vz.at(i);
 
-      mx.push_back(xxw1 - sumx);
-      my.push_back(yyw1 - sumy);
-      mz.push_back(zzw1 - sumz);
+        mx.push_back(xxw1 - sumx);
+        my.push_back(yyw1 - sumy);
+        mz.push_back(zzw1 - sumz);
 
-      double const xxw0 = mx.at(i);
-      double const yyw0 = my.at(i);
-      double const zzw0 = mz.at(i);
+        double const xxw0 = mx.at(i);
+        double const yyw0 = my.at(i);
+        double const zzw0 = mz.at(i);
 
-      m(0, 0) += xxw0 * xxw0 / na;
-      m(0, 1) += xxw0 * yyw0 / na;
-      m(0, 2) += xxw0 * zzw0 / na;
+        m(0, 0) += xxw0 * xxw0 / na;
+        m(0, 1) += xxw0 * yyw0 / na;
+        m(0, 2) += xxw0 * zzw0 / na;
 
-      m(1, 0) += yyw0 * xxw0 / na;
-      m(1, 1) += yyw0 * yyw0 / na;
-      m(1, 2) += yyw0 * zzw0 / na;
+        m(1, 0) += yyw0 * xxw0 / na;
+        m(1, 1) += yyw0 * yyw0 / na;
+        m(1, 2) += yyw0 * zzw0 / na;
 
-      m(2, 0) += zzw0 * xxw0 / na;
-      m(2, 1) += zzw0 * yyw0 / na;
-      m(2, 2) += zzw0 * zzw0 / na;
-    }
+        m(2, 0) += zzw0 * xxw0 / na;
+        m(2, 1) += zzw0 * yyw0 / na;
+        m(2, 2) += zzw0 * zzw0 / na;
+      }
 
-    TMatrixDSymEigen me(m);
+      TMatrixDSymEigen me(m);
 
-    TVectorD eigenval = me.GetEigenValues();
-    TMatrixD eigenvec = me.GetEigenVectors();
+      TVectorD eigenval = me.GetEigenValues();
+      TMatrixD eigenvec = me.GetEigenVectors();
 
-    double max1 = -666.0;
+      double max1 = -666.0;
 
-    double ind1 = 0;
+      double ind1 = 0;
 
-    for (int i = 0; i < 3; ++i) {
-      double const p1 = eigenval(i);
+      for (int i = 0; i < 3; ++i) {
+        double const p1 = eigenval(i);
 
-      if (p1 > max1) {
-        max1 = p1;
-        ind1 = i;
+        if (p1 > max1) {
+          max1 = p1;
+          ind1 = i;
+        }
       }
-    }
 
-    double ax = eigenvec(0, ind1);
-    double ay = eigenvec(1, ind1);
-    double az = eigenvec(2, ind1);
+      ax = eigenvec(0, ind1);
+      ay = eigenvec(1, ind1);
+      az = eigenvec(2, ind1);
+    }
 
-    if (n_seg > 1) {
-      if (segx.at(n_seg - 1) - segx.at(n_seg - 2) > 0)
+    auto const nSeg = segx.size();
+    if (nSeg > 1) {
+      if (segx.at(nSeg - 1) - segx.at(nSeg - 2) > 0)
         ax = std::abs(ax);
       else
         ax = -1.0 * std::abs(ax);
 
-      if (segy.at(n_seg - 1) - segy.at(n_seg - 2) > 0)
+      if (segy.at(nSeg - 1) - segy.at(nSeg - 2) > 0)
         ay = std::abs(ay);
       else
         ay = -1.0 * std::abs(ay);
 
-      if (segz.at(n_seg - 1) - segz.at(n_seg - 2) > 0)
+      if (segz.at(nSeg - 1) - segz.at(nSeg - 2) > 0)
         az = std::abs(az);
       else
         az = -1.0 * std::abs(az);
@@ -718,11 +957,12 @@ namespace trkf {
     vz.clear();
   }
 
-  std::optional<TrackMomentumCalculator::Segments> TrackMomentumCalculator::getSegTracks_(
+  std::optional<TrackMomentumCalculator::Segments> TrackMomentumCalculator::segmentTrack_(
     std::vector<float> const& xxx,
     std::vector<float> const& yyy,
     std::vector<float> const& zzz,
-    double const seg_size)
+    double const seg_size,
+    bool const closedForm) const
   {
     double stag = 0.0;
 
@@ -744,7 +984,7 @@ namespace trkf {
 
     int ntot = 0;
 
-    n_seg = 0;
+    int nSeg = 0;
 
     double x0{};
     double y0{};
@@ -774,11 +1014,7 @@ namespace trkf {
 
         segL.push_back(stag);
 
-        x_seg[n_seg] = x0;
-        y_seg[n_seg] = y0;
-        z_seg[n_seg] = z0;
-
-        n_seg++;
+        nSeg++;
 
         vx.push_back(x0);
         vy.push_back(y0);
@@ -845,12 +1081,9 @@ namespace trkf {
         segy.push_back(yp);
         segz.push_back(zp);
 
-        segL.push_back(1.0 * n_seg * 1.0 * seg_size + stag);
+        segL.push_back(1.0 * nSeg * 1.0 * seg_size + stag);
 
-        x_seg[n_seg] = xp;
-        y_seg[n_seg] = yp;
-        z_seg[n_seg] = zp;
-        n_seg++;
+        nSeg++;
 
         x0 = xp;
         y0 = yp;
@@ -861,10 +1094,11 @@ namespace trkf {
         vz.push_back(z0);
 
         ntot++;
-        if (n_seg <= 1) // This should never happen
+        if (nSeg <= 1) // This should never happen
           return std::nullopt;
 
-        compute_max_fluctuation_vector(segx, segy, segz, segnx, segny, segnz, vx, vy, vz);
+        compute_max_fluctuation_vector(
+          segx, segy, segz, segnx, segny, segnz, vx, vy, vz, closedForm);
 
         ntot = 1;
         vx.push_back(x0);
@@ -892,12 +1126,9 @@ namespace trkf {
         segx.push_back(xp);
         segy.push_back(yp);
         segz.push_back(zp);
-        segL.push_back(1.0 * n_seg * 1.0 * seg_size + stag);
+        segL.push_back(1.0 * nSeg * 1.0 * seg_size + stag);
 
-        x_seg[n_seg] = xp;
-        y_seg[n_seg] = yp;
-        z_seg[n_seg] = zp;
-        n_seg++;
+        nSeg++;
 
         x0 = xp;
         y0 = yp;
@@ -908,10 +1139,11 @@ namespace trkf {
         vz.push_back(z0);
 
         ntot++;
-        if (n_seg <= 1) // This should never happen
+        if (nSeg <= 1) // This should never happen
           return std::nullopt;
 
-        compute_max_fluctuation_vector(segx, segy, segz, segnx, segny, segnz, vx, vy, vz);
+        compute_max_fluctuation_vector(
+          segx, segy, segz, segnx, segny, segnz, vx, vy, vz, closedForm);
 
         // vectors are cleared in previous step
         ntot = 1;
@@ -920,16 +1152,33 @@ namespace trkf {
         vz.push_back(z0);
       }
 
-      if (n_seg >= (stopper + 1.0) && seg_stop != -1) break;
+      if (nSeg >= (stopper + 1.0) && seg_stop != -1) break;
     }
 
+    return std::make_optional<Segments>(Segments{segx, segnx, segy, segny, segz, segnz, segL});
+  }
+
+  std::optional<TrackMomentumCalculator::Segments> TrackMomentumCalculator::getSegTracks_(
+    std::vector<float> const& xxx,
+    std::vector<float> const& yyy,
+    std::vector<float> const& zzz,
+    double const seg_size)
+  {
+    auto segments = segmentTrack_(xxx, yyy, zzz, seg_size, false);
+    if (!segments.has_value()) return std::nullopt;
+
+    n_seg = std::min(segments->x.size(), std::size(x_seg));
+    std::copy_n(segments->x.begin(), n_seg, x_seg);
+    std::copy_n(segments->y.begin(), n_seg, y_seg);
+    std::copy_n(segments->z.begin(), n_seg, z_seg);
+
     delete gr_seg_xyz;
     gr_seg_xyz = new TPolyLine3D{n_seg, z_seg, x_seg, y_seg};
     gr_seg_yz = TGraph{n_seg, z_seg, y_seg};
     gr_seg_xz = TGraph{n_seg, z_seg, x_seg};
     gr_seg_xy = TGraph{n_seg, x_seg, y_seg};
 
-    return std::make_optional<Segments>(Segments{segx, segnx, segy, segny, segz, segnz, segL});
+    return segments;
   }
 
   std::tuple<double, double, double> TrackMomentumCalculator::getDeltaThetaRMS_(
@@ -10,6 +10,7 @@
 #include "TGraph.h"
 #include "TVector3.h"
 
+#include <array>
 #include <optional>
 #include <tuple>
 #include <vector>
@@ -66,6 +67,31 @@ namespace trkf {
                                        const int maxMomentum_MeV = 7500,
                                        const int MomentumStep_MeV = 10,
                                        const int max_resolution = 0);
+
+    /**
+    * @brief  Same as GetMomentumMultiScatterChi2, for production use
+    *
+    * No ROOT graphics object is made, the segment directions come from a
+    * closed form eigen solver instead of TMatrixDSymEigen, and no data member is
+    * modified: the same calculator can be used from several threads at once.
+    * The result agrees with GetMomentumMultiScatterChi2 to rounding.
+    */
+    double GetMomentumMultiScatterChi2Lean(art::Ptr<recob::Track> const& trk,
+                                           bool checkValidPoints = false,
+                                           int maxMomentum_MeV = 7500) const;
+
+    /**
+    * @brief  Same as GetMomentumMultiScatterLLHD, for production use
+    *
+    * As GetMomentumMultiScatterChi2Lean; in addition the likelihood is
+    * evaluated for all the momenta of the scan in one pass over the angles.
+    */
+    double GetMomentumMultiScatterLLHDLean(art::Ptr<recob::Track> const& trk,
+                                           bool checkValidPoints = false,
+                                           int maxMomentum_MeV = 7500,
+                                           int MomentumStep_MeV = 10,
+                                           int max_resolution = 0) const;
+
     double GetMuMultiScatterLLHD3(art::Ptr<recob::Track> const& trk, bool dir);
     TVector3 GetMultiScatterStartingPoint(art::Ptr<recob::Track> const& trk);
 
@@ -79,17 +105,19 @@ namespace trkf {
     * @param segx, segy, segz segments points
     * @param segnx, segny, segnz vector components to be filled
     * @param vector used to control points to be used at segments
+    * @param closedForm use the closed form eigen solver instead of TMatrixDSymEigen
     *
     */
-    void compute_max_fluctuation_vector(const std::vector<float> segx,
-                                        const std::vector<float> segy,
-                                        const std::vector<float> segz,
+    void compute_max_fluctuation_vector(std::vector<float> const& segx,
+                                        std::vector<float> const& segy,
+                                        std::vector<float> const& segz,
                                         std::vector<float>& segnx,
                                         std::vector<float>& segny,
                                         std::vector<float>& segnz,
                                         std::vector<float>& vx,
                                         std::vector<float>& vy,
-                                        std::vector<float>& vz);
+                                        std::vector<float>& vz,
+                                        bool closedForm) const;
     /**
     * \struct Segments
     * @brief Struct to store segments.
@@ -122,6 +150,17 @@ namespace trkf {
                                           std::vector<float> const& zzz,
                                           double seg_size);
 
+    /**
+    * @brief Same as getSegTracks_, without filling the segment graphs
+    *
+    * @param closedForm use the closed form eigen solver for the segment directions
+    */
+    std::optional<Segments> segmentTrack_(std::vector<float> const& xxx,
+                                          std::vector<float> const& yyy,
+                                          std::vector<float> const& zzz,
+                                          double seg_size,
+                                          bool closedForm) const;
+
     /**
     * @brief Gets the scattered angle RMS for a all segments
     *
@@ -185,6 +224,32 @@ namespace trkf {
                        double x0,
                        double x1) const;
 
+    /**
+    * @brief  Scans my_mcs_llhd over momentum and resolution
+    *
+    * @param  nMomenta number of 10 MeV steps of the scan, which starts at 1 MeV
+    * @param  max_resolution as in GetMomentumMultiScatterLLHD
+    *
+    * @return momentum in GeV with the lowest value, the first one on ties
+    */
+    double scanMomentumLLHD_(std::vector<float> const& dEi,
+                             std::vector<float> const& dEj,
+                             std::vector<float> const& dthij,
+                             std::vector<float> const& ind,
+                             int nMomenta,
+                             int max_resolution) const;
+
+    /**
+    * @brief  Fits the scattered angle RMS versus segment size with Minuit2
+    *
+    * @param  segments segments computed
+    * @param  recoL length of the track from the segments
+    * @param  maxMomentum_MeV maximum momentum in MeV for the minimization
+    *
+    * @return momentum in GeV, or -1 if the fit fails
+    */
+    double fitMomentumChi2_(Segments const& segments, double recoL, int maxMomentum_MeV) const;
+
     float seg_stop{-1.};
     int n_seg{};
 
@@ -231,6 +296,19 @@ namespace trkf {
     TGraph gr_seg_xz{};
   };
 
+  namespace details {
+
+    /**
+    * @brief Eigenvector of the largest eigenvalue of a symmetric 3x3 matrix, in closed form
+    *
+    * Used by the lean methods of TrackMomentumCalculator instead of TMatrixDSymEigen.
+    * When the two largest eigenvalues are equal, any unit vector in their plane is returned.
+    */
+    std::tuple<double, double, double> principal_axis(
+      std::array<std::array<double, 3>, 3> const& m);
+
+  } // namespace details
+
 } // namespace trkf
 
 #endif // TrackMomentumCalculator_H
@@ -76,6 +76,7 @@ namespace tca {
     if (!aveHitRMS.empty()) {
       evt.aveHitRMSValid = true;
       evt.aveHitRMS = aveHitRMS;
+      fAveHitRMS = aveHitRMS;
     }
     tcc.angleRanges = pset.get<std::vector<float>>("AngleRanges");
     tcc.nPtsAve = pset.get<short>("NPtsAve", 20);
@@ -299,6 +300,9 @@ namespace tca {
     evt.eventsProcessed = 0;
 
     tcc.caloAlg = &fCaloAlg;
+    // save the configuration so that it can be installed on the thread that
+    // reconstructs each event
+    fTCConfig = tcc;
   }
 
   ////////////////////////////////////////////////
@@ -308,6 +312,12 @@ namespace tca {
   {
     // defines the pointer to the input hit collection, analyzes them,
     // initializes global counters and refreshes service references
+    // install the configuration in the (thread-local) state of the calling thread
+    tcc = fTCConfig;
+    if (!fAveHitRMS.empty()) {
+      evt.aveHitRMSValid = true;
+      evt.aveHitRMS = fAveHitRMS;
+    }
     ClearResults();
     evt.allHits = &inputHits;
     evt.run = run;
@@ -324,6 +334,7 @@ namespace tca {
     // find the average hit RMS using the full hit collection and define the
     // configuration for the current TPC
 
+    evt.eventsProcessed = fEventsProcessed;
     if (tcc.modes[kDebug] && evt.eventsProcessed == 0) PrintDebugMode();
 
     return AnalyzeHits();
@@ -353,7 +364,7 @@ namespace tca {
   {
     // Reconstruct everything using the hits in a slice
 
-    if (slices.empty()) ++evt.eventsProcessed;
+    if (slices.empty()) evt.eventsProcessed = ++fEventsProcessed;
     if (hitsInSlice.size() < 2) return;
     if (tcc.recoSlice > 0 && sliceID != tcc.recoSlice) return;
 
@@ -418,10 +429,13 @@ namespace tca {
     Finish3DShowers(slc);
 
     // count algorithm usage
-    for (auto& tj : slc.tjs) {
-      for (unsigned short ib = 0; ib < AlgBitNames.size(); ++ib)
-        if (tj.AlgMod[ib]) ++fAlgModCount[ib];
-    } // tj
+    {
+      std::lock_guard<std::mutex> lock(fAlgModCountMutex);
+      for (auto& tj : slc.tjs) {
+        for (unsigned short ib = 0; ib < AlgBitNames.size(); ++ib)
+          if (tj.AlgMod[ib]) ++fAlgModCount[ib];
+      } // tj
+    }
 
     // clear vectors that are not needed later
     slc.mallTraj.resize(0);
@@ -10,6 +10,8 @@
 #define TRAJCLUSTERALG_H
 
 // C/C++ standard libraries
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <utility> // std::pair<>
 #include <vector>
@@ -67,6 +69,11 @@ namespace tca {
 
     std::vector<unsigned int> const& GetAlgModCount() const { return fAlgModCount; }
     std::vector<std::string> const& GetAlgBitNames() const { return AlgBitNames; }
+    /// True if events must be reconstructed one at a time (debugging, shower tree)
+    bool SerialOnly() const
+    {
+      return fTCConfig.modes[kDebug] || fTCConfig.modes[kSaveShowerTree];
+    }
 
     /// Deletes all the results
     void ClearResults()
@@ -85,7 +92,14 @@ namespace tca {
     calo::CalorimetryAlg fCaloAlg;
     TMVA::Reader fMVAReader;
 
+    // configuration that is installed in tcc of the calling thread for each event
+    TCConfig fTCConfig;
+    std::vector<float> fAveHitRMS;
+    // the number of events, counted as in the serial reconstruction (see RunTrajClusterAlg)
+    std::atomic<unsigned int> fEventsProcessed{0};
+
     std::vector<unsigned int> fAlgModCount;
+    std::mutex fAlgModCountMutex;
 
     void ReconstructAllTraj(detinfo::DetectorPropertiesData const& detProp,
                             TCSlice& slc,
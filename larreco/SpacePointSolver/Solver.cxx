@@ -1,10 +1,17 @@
 #include "larreco/SpacePointSolver/Solver.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
-#include <set>
 #include <string>
+#include <tuple>
+#include <unordered_map>
+
+#include "larreco/SpacePointSolver/HashTuple.h"
+
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
 
 template <class T>
 T sqr(T x)
@@ -13,36 +20,30 @@ T sqr(T x)
 }
 
 // ---------------------------------------------------------------------------
-InductionWireHit::InductionWireHit(int chan, double q) : fChannel(chan), fCharge(q), fPred(0) {}
-
-// ---------------------------------------------------------------------------
-Neighbour::Neighbour(SpaceCharge* sc, double coupling) : fSC(sc), fCoupling(coupling) {}
-
-// ---------------------------------------------------------------------------
-SpaceCharge::SpaceCharge(double x,
-                         double y,
-                         double z,
-                         CollectionWireHit* cwire,
-                         InductionWireHit* wire1,
-                         InductionWireHit* wire2)
-  : fX(x), fY(y), fZ(z), fCWire(cwire), fWire1(wire1), fWire2(wire2), fPred(0), fNeiPotential(0)
-{}
+int SolverSystem::AddInductionWire(double q)
+{
+  fIWireCharge.push_back(q);
+  fIWirePred.push_back(0);
+  fIWireInCWire.push_back(false);
+  return fIWireCharge.size() - 1;
+}
 
 // ---------------------------------------------------------------------------
-void SpaceCharge::AddCharge(double dq)
+void SolverSystem::AddSpaceCharge(const Crossing& crossing, int cwire)
 {
-  fPred += dq;
-
-  for (Neighbour& nei : fNeighbours)
-    nei.fSC->fNeiPotential += dq * nei.fCoupling;
-
-  if (fWire1) fWire1->fPred += dq;
-  if (fWire2) fWire2->fPred += dq;
+  fX.push_back(crossing.x);
+  fY.push_back(crossing.y);
+  fZ.push_back(crossing.z);
+  fCWire.push_back(cwire);
+  fWire1.push_back(crossing.wire1);
+  fWire2.push_back(crossing.wire2);
+  fPred.push_back(0);
+  fNeiPotential.push_back(0);
+  fNeiFirst.push_back(fNeiIndex.size());
 }
 
 // ---------------------------------------------------------------------------
-CollectionWireHit::CollectionWireHit(int chan, double q, const std::vector<SpaceCharge*>& cross)
-  : fChannel(chan), fCharge(q), fCrossings(cross)
+void SolverSystem::AddCollectionWire(double q, const std::vector<Crossing>& crossings)
 {
   if (q < 0) {
     std::cout << "Trying to construct collection wire with negative charge " << q
@@ -50,20 +51,144 @@ CollectionWireHit::CollectionWireHit(int chan, double q, const std::vector<Space
     abort();
   }
 
-  const double p = q / cross.size();
+  if (NSpaceCharges() != OrphansBegin()) {
+    std::cout << "Trying to add a collection wire after the orphan space charges,"
+              << " this should never happen." << std::endl;
+    abort();
+  }
+
+  const int cwire = fCWireCharge.size();
+  fCWireCharge.push_back(q);
+
+  for (const Crossing& crossing : crossings) {
+    AddSpaceCharge(crossing, cwire);
+
+    for (int iwire : {crossing.wire1, crossing.wire2}) {
+      if (iwire >= 0 && !fIWireInCWire[iwire]) {
+        fIWireInCWire[iwire] = true;
+        fCWireIWires.push_back(iwire);
+      }
+    }
+  }
+
+  fCWireFirstSC.push_back(NSpaceCharges());
+
+  const double p = q / crossings.size();
+
+  for (unsigned int sc = CWireBegin(cwire); sc < CWireEnd(cwire); ++sc)
+    AddCharge(*this, sc, p);
+}
+
+// ---------------------------------------------------------------------------
+void SolverSystem::AddOrphan(const Crossing& crossing)
+{
+  AddSpaceCharge(crossing, -1);
+}
+
+// ---------------------------------------------------------------------------
+long SolverSystem::AddNeighbours(double critDist)
+{
+  // Hashed voxel grid: space charges sorted by cell, and the range of each
+  // occupied cell in that ordering
+  using Cell = std::tuple<int, int, int>;
+
+  const unsigned int N = NSpaceCharges();
+
+  auto cellOf = [&](unsigned int sc) {
+    return Cell(std::floor(fX[sc] / critDist),
+                std::floor(fY[sc] / critDist),
+                std::floor(fZ[sc] / critDist));
+  };
+
+  std::vector<Cell> cells(N);
+  std::vector<unsigned int> sorted(N);
+  for (unsigned int sc = 0; sc < N; ++sc) {
+    cells[sc] = cellOf(sc);
+    sorted[sc] = sc;
+  }
+
+  std::stable_sort(sorted.begin(), sorted.end(), [&](unsigned int a, unsigned int b) {
+    return cells[a] < cells[b];
+  });
+
+  std::unordered_map<Cell, std::pair<unsigned int, unsigned int>> grid;
+  grid.reserve(N);
+  for (unsigned int begin = 0; begin < N;) {
+    unsigned int end = begin + 1;
+    while (end < N && cells[sorted[end]] == cells[sorted[begin]])
+      ++end;
+    grid.emplace(cells[sorted[begin]], std::make_pair(begin, end));
+    begin = end;
+  }
+
+  fNeiFirst.assign(1, 0);
+  fNeiIndex.clear();
+  fNeiCoupling.clear();
+
+  long Ntests = 0;
+  for (unsigned int sc1 = 0; sc1 < N; ++sc1) {
+    const Cell& c = cells[sc1];
+
+    for (int dx = -1; dx <= +1; ++dx) {
+      for (int dy = -1; dy <= +1; ++dy) {
+        for (int dz = -1; dz <= +1; ++dz) {
+          const auto it = grid.find(
+            Cell(std::get<0>(c) + dx, std::get<1>(c) + dy, std::get<2>(c) + dz));
+          if (it == grid.end()) continue;
+
+          for (unsigned int k = it->second.first; k < it->second.second; ++k) {
+            const unsigned int sc2 = sorted[k];
+
+            ++Ntests;
+
+            if (sc1 == sc2) continue;
+            const double dist2 =
+              sqr(fX[sc1] - fX[sc2]) + sqr(fY[sc1] - fY[sc2]) + sqr(fZ[sc1] - fZ[sc2]);
+
+            if (dist2 > sqr(critDist)) continue;
+
+            if (dist2 == 0) {
+              std::cout << "ZERO DISTANCE SOMEHOW?" << std::endl;
+              std::cout << fCWire[sc1] << " " << fWire1[sc1] << " " << fWire2[sc1] << std::endl;
+              std::cout << fCWire[sc2] << " " << fWire1[sc2] << " " << fWire2[sc2] << std::endl;
+              std::cout << dist2 << " " << fX[sc1] << " " << fX[sc2] << " " << fY[sc1] << " "
+                        << fY[sc2] << " " << fZ[sc1] << " " << fZ[sc2] << std::endl;
+              continue;
+            }
+
+            // This is a pretty random guess
+            fNeiIndex.push_back(sc2);
+            fNeiCoupling.push_back(exp(-sqrt(dist2) / 2));
+          } // end for sc2
+        }
+      }
+    } // end for neighbouring cells
+
+    fNeiFirst.push_back(fNeiIndex.size());
+  } // end for sc1
+
+  fNeiIndex.shrink_to_fit();
+  fNeiCoupling.shrink_to_fit();
+
+  for (unsigned int sc = 0; sc < N; ++sc) {
+    fNeiPotential[sc] = 0;
+    for (unsigned int nei = fNeiFirst[sc]; nei < fNeiFirst[sc + 1]; ++nei)
+      fNeiPotential[sc] += fNeiCoupling[nei] * fPred[fNeiIndex[nei]];
+  }
 
-  for (SpaceCharge* sc : cross)
-    sc->AddCharge(p);
+  return Ntests;
 }
 
 // ---------------------------------------------------------------------------
-CollectionWireHit::~CollectionWireHit()
+void AddCharge(SolverSystem& sys, unsigned int sc, double dq)
 {
-  // Each SpaceCharge can only be in one collection wire, so we own them. But
-  // not SpaceCharge does not clean up its induction wires since they're
-  // shared.
-  for (SpaceCharge* sc : fCrossings)
-    delete sc;
+  sys.fPred[sc] += dq;
+
+  for (unsigned int nei = sys.fNeiFirst[sc]; nei < sys.fNeiFirst[sc + 1]; ++nei)
+    sys.fNeiPotential[sys.fNeiIndex[nei]] += dq * sys.fNeiCoupling[nei];
+
+  if (sys.fWire1[sc] >= 0) sys.fIWirePred[sys.fWire1[sc]] += dq;
+  if (sys.fWire2[sc] >= 0) sys.fIWirePred[sys.fWire2[sc]] += dq;
 }
 
 // ---------------------------------------------------------------------------
@@ -79,41 +204,29 @@ QuadExpr Metric(double q, QuadExpr p)
 }
 
 // ---------------------------------------------------------------------------
-double Metric(const std::vector<SpaceCharge*>& scs, double alpha)
+double Metric(const SolverSystem& sys, double alpha)
 {
   double ret = 0;
 
-  std::set<InductionWireHit*> iwires;
-  for (const SpaceCharge* sc : scs) {
-    if (sc->fWire1) iwires.insert(sc->fWire1);
-    if (sc->fWire2) iwires.insert(sc->fWire2);
-
-    if (alpha != 0) {
-      ret -= alpha * sqr(sc->fPred);
+  if (alpha != 0) {
+    for (unsigned int sc = 0; sc < sys.OrphansBegin(); ++sc) {
+      const double pred = sys.fPred[sc];
+      ret -= alpha * sqr(pred);
       // "Double-counting" of the two ends of the connection is
       // intentional. Otherwise we'd have a half in the line above.
-      ret -= alpha * sc->fPred * sc->fNeiPotential;
+      ret -= alpha * pred * sys.fNeiPotential[sc];
     }
   }
 
-  for (const InductionWireHit* iwire : iwires) {
-    ret += Metric(iwire->fCharge, iwire->fPred);
+  for (unsigned int iwire : sys.fCWireIWires) {
+    ret += Metric(sys.fIWireCharge[iwire], sys.fIWirePred[iwire]);
   }
 
   return ret;
 }
 
 // ---------------------------------------------------------------------------
-double Metric(const std::vector<CollectionWireHit*>& cwires, double alpha)
-{
-  std::vector<SpaceCharge*> scs;
-  for (CollectionWireHit* cwire : cwires)
-    scs.insert(scs.end(), cwire->fCrossings.begin(), cwire->fCrossings.end());
-  return Metric(scs, alpha);
-}
-
-// ---------------------------------------------------------------------------
-QuadExpr Metric(const SpaceCharge* sci, const SpaceCharge* scj, double alpha)
+QuadExpr Metric(const SolverSystem& sys, unsigned int sci, unsigned int scj, double alpha)
 {
   QuadExpr ret = 0;
 
@@ -121,8 +234,8 @@ QuadExpr Metric(const SpaceCharge* sci, const SpaceCharge* scj, double alpha)
   QuadExpr x = QuadExpr::X();
 
   if (alpha != 0) {
-    const double scip = sci->fPred;
-    const double scjp = scj->fPred;
+    const double scip = sys.fPred[sci];
+    const double scjp = sys.fPred[scj];
 
     // Self energy. SpaceCharges are never the same object
     ret -= alpha * sqr(scip + x);
@@ -130,63 +243,65 @@ QuadExpr Metric(const SpaceCharge* sci, const SpaceCharge* scj, double alpha)
 
     // Interaction. We're only seeing one end of the double-ended connection
     // here, so multiply by two.
-    ret -= 2 * alpha * (scip + x) * sci->fNeiPotential;
-    ret -= 2 * alpha * (scjp - x) * scj->fNeiPotential;
+    ret -= 2 * alpha * (scip + x) * sys.fNeiPotential[sci];
+    ret -= 2 * alpha * (scjp - x) * sys.fNeiPotential[scj];
 
     // This miscounts if i and j are neighbours of each other
-    for (const Neighbour& n : sci->fNeighbours) {
-      if (n.fSC == scj) {
+    for (unsigned int nei = sys.fNeiFirst[sci]; nei < sys.fNeiFirst[sci + 1]; ++nei) {
+      if (sys.fNeiIndex[nei] == scj) {
+        const double coupling = sys.fNeiCoupling[nei];
+
         // If we detect that case, remove the erroneous terms
-        ret += 2 * alpha * (scip + x) * scjp * n.fCoupling;
-        ret += 2 * alpha * (scjp - x) * scip * n.fCoupling;
+        ret += 2 * alpha * (scip + x) * scjp * coupling;
+        ret += 2 * alpha * (scjp - x) * scip * coupling;
 
         // And replace with the correct interaction terms
-        ret -= 2 * alpha * (scip + x) * (scjp - x) * n.fCoupling;
+        ret -= 2 * alpha * (scip + x) * (scjp - x) * coupling;
         break;
       }
     }
   }
 
-  const InductionWireHit* iwire1 = sci->fWire1;
-  const InductionWireHit* jwire1 = scj->fWire1;
+  const int iwire1 = sys.fWire1[sci];
+  const int jwire1 = sys.fWire1[scj];
 
-  const double qi1 = iwire1 ? iwire1->fCharge : 0;
-  const double pi1 = iwire1 ? iwire1->fPred : 0;
+  const double qi1 = iwire1 >= 0 ? sys.fIWireCharge[iwire1] : 0;
+  const double pi1 = iwire1 >= 0 ? sys.fIWirePred[iwire1] : 0;
 
-  const double qj1 = jwire1 ? jwire1->fCharge : 0;
-  const double pj1 = jwire1 ? jwire1->fPred : 0;
+  const double qj1 = jwire1 >= 0 ? sys.fIWireCharge[jwire1] : 0;
+  const double pj1 = jwire1 >= 0 ? sys.fIWirePred[jwire1] : 0;
 
   if (iwire1 == jwire1) {
     // Same wire means movement of charge cancels itself out
-    if (iwire1) ret += Metric(qi1, pi1);
+    if (iwire1 >= 0) ret += Metric(qi1, pi1);
   }
   else {
-    if (iwire1) ret += Metric(qi1, pi1 + x);
-    if (jwire1) ret += Metric(qj1, pj1 - x);
+    if (iwire1 >= 0) ret += Metric(qi1, pi1 + x);
+    if (jwire1 >= 0) ret += Metric(qj1, pj1 - x);
   }
 
-  const InductionWireHit* iwire2 = sci->fWire2;
-  const InductionWireHit* jwire2 = scj->fWire2;
+  const int iwire2 = sys.fWire2[sci];
+  const int jwire2 = sys.fWire2[scj];
 
-  const double qi2 = iwire2 ? iwire2->fCharge : 0;
-  const double pi2 = iwire2 ? iwire2->fPred : 0;
+  const double qi2 = iwire2 >= 0 ? sys.fIWireCharge[iwire2] : 0;
+  const double pi2 = iwire2 >= 0 ? sys.fIWirePred[iwire2] : 0;
 
-  const double qj2 = jwire2 ? jwire2->fCharge : 0;
-  const double pj2 = jwire2 ? jwire2->fPred : 0;
+  const double qj2 = jwire2 >= 0 ? sys.fIWireCharge[jwire2] : 0;
+  const double pj2 = jwire2 >= 0 ? sys.fIWirePred[jwire2] : 0;
 
   if (iwire2 == jwire2) {
-    if (iwire2) ret += Metric(qi2, pi2);
+    if (iwire2 >= 0) ret += Metric(qi2, pi2);
   }
   else {
-    if (iwire2) ret += Metric(qi2, pi2 + x);
-    if (jwire2) ret += Metric(qj2, pj2 - x);
+    if (iwire2 >= 0) ret += Metric(qi2, pi2 + x);
+    if (jwire2 >= 0) ret += Metric(qj2, pj2 - x);
   }
 
   return ret;
 }
 
 // ---------------------------------------------------------------------------
-QuadExpr Metric(const SpaceCharge* sc, double alpha)
+QuadExpr Metric(const SolverSystem& sys, unsigned int sc, double alpha)
 {
   QuadExpr ret = 0;
 
@@ -194,35 +309,37 @@ QuadExpr Metric(const SpaceCharge* sc, double alpha)
   QuadExpr x = QuadExpr::X();
 
   if (alpha != 0) {
-    const double scp = sc->fPred;
+    const double scp = sys.fPred[sc];
 
     // Self energy
     ret -= alpha * sqr(scp + x);
 
     // Interaction. We're only seeing one end of the double-ended connection
     // here, so multiply by two.
-    ret -= 2 * alpha * (scp + x) * sc->fNeiPotential;
+    ret -= 2 * alpha * (scp + x) * sys.fNeiPotential[sc];
   }
 
   // Prediction of the induction wires
-  ret += Metric(sc->fWire1->fCharge, sc->fWire1->fPred + x);
-  ret += Metric(sc->fWire2->fCharge, sc->fWire2->fPred + x);
+  const int wire1 = sys.fWire1[sc];
+  const int wire2 = sys.fWire2[sc];
+  ret += Metric(sys.fIWireCharge[wire1], sys.fIWirePred[wire1] + x);
+  ret += Metric(sys.fIWireCharge[wire2], sys.fIWirePred[wire2] + x);
 
   return ret;
 }
 
 // ---------------------------------------------------------------------------
-double SolvePair(CollectionWireHit* cwire, SpaceCharge* sci, SpaceCharge* scj, double alpha)
+double SolvePair(const SolverSystem& sys, unsigned int sci, unsigned int scj, double alpha)
 {
-  const QuadExpr chisq = Metric(sci, scj, alpha);
+  const QuadExpr chisq = Metric(sys, sci, scj, alpha);
   const double chisq0 = chisq.Eval(0);
 
   // Find the minimum of a quadratic expression
   double x = -chisq.Linear() / (2 * chisq.Quadratic());
 
   // Don't allow either SpaceCharge to go negative
-  const double xmin = -sci->fPred;
-  const double xmax = scj->fPred;
+  const double xmin = -sys.fPred[sci];
+  const double xmax = sys.fPred[scj];
 
   // Clamp to allowed range
   x = std::min(xmax, x);
@@ -257,38 +374,35 @@ double SolvePair(CollectionWireHit* cwire, SpaceCharge* sci, SpaceCharge* scj, d
 }
 
 // ---------------------------------------------------------------------------
-void Iterate(CollectionWireHit* cwire, double alpha)
+void IterateCWire(SolverSystem& sys, unsigned int cwire, double alpha)
 {
   // Consider all pairs of crossings
-  const unsigned int N = cwire->fCrossings.size();
-
-  for (unsigned int i = 0; i + 1 < N; ++i) {
-    SpaceCharge* sci = cwire->fCrossings[i];
-
-    for (unsigned int j = i + 1; j < N; ++j) {
-      SpaceCharge* scj = cwire->fCrossings[j];
+  const unsigned int begin = sys.CWireBegin(cwire);
+  const unsigned int end = sys.CWireEnd(cwire);
 
-      const double x = SolvePair(cwire, sci, scj, alpha);
+  for (unsigned int sci = begin; sci + 1 < end; ++sci) {
+    for (unsigned int scj = sci + 1; scj < end; ++scj) {
+      const double x = SolvePair(sys, sci, scj, alpha);
 
       if (x == 0) continue;
 
       // Actually make the update
-      sci->AddCharge(+x);
-      scj->AddCharge(-x);
+      AddCharge(sys, sci, +x);
+      AddCharge(sys, scj, -x);
     } // end for j
   }   // end for i
 }
 
 // ---------------------------------------------------------------------------
-void Iterate(SpaceCharge* sc, double alpha)
+void IterateSpaceCharge(SolverSystem& sys, unsigned int sc, double alpha)
 {
-  const QuadExpr chisq = Metric(sc, alpha);
+  const QuadExpr chisq = Metric(sys, sc, alpha);
 
   // Find the minimum of a quadratic expression
   double x = -chisq.Linear() / (2 * chisq.Quadratic());
 
   // Don't allow the SpaceCharge to go negative
-  const double xmin = -sc->fPred;
+  const double xmin = -sys.fPred[sc];
 
   // Clamp to allowed range
   x = std::max(xmin, x);
@@ -301,28 +415,137 @@ void Iterate(SpaceCharge* sc, double alpha)
   const double chisq_n = chisq.Eval(xmin);
 
   if (chisq_n < chisq_new)
-    sc->AddCharge(xmin);
+    AddCharge(sys, sc, xmin);
   else
-    sc->AddCharge(x);
+    AddCharge(sys, sc, x);
 }
 
 // ---------------------------------------------------------------------------
-void Iterate(const std::vector<CollectionWireHit*>& cwires,
-             const std::vector<SpaceCharge*>& orphanSCs,
-             double alpha)
+void Iterate(SolverSystem& sys, double alpha)
 {
   // Visiting in a "random" order helps prevent local artefacts that are slow
   // to break up.
+  const unsigned int nCWires = sys.NCollectionWires();
   unsigned int cwireIdx = 0;
-  if (!cwires.empty()) {
+  if (nCWires != 0) {
     do {
-      Iterate(cwires[cwireIdx], alpha);
+      IterateCWire(sys, cwireIdx, alpha);
 
       const unsigned int prime = 1299827;
-      cwireIdx = (cwireIdx + prime) % cwires.size();
+      cwireIdx = (cwireIdx + prime) % nCWires;
     } while (cwireIdx != 0);
   }
 
-  for (SpaceCharge* sc : orphanSCs)
-    Iterate(sc, alpha);
+  for (unsigned int sc = sys.OrphansBegin(); sc < sys.NSpaceCharges(); ++sc)
+    IterateSpaceCharge(sys, sc, alpha);
+}
+
+// ---------------------------------------------------------------------------
+// Everything that iterating on sc may modify: the space charge itself, the
+// potential of its neighbours and the prediction of its induction wires.
+// Induction wires are numbered after the space charges.
+void AddWriteSet(const SolverSystem& sys, unsigned int sc, std::vector<unsigned int>& writes)
+{
+  writes.push_back(sc);
+  for (unsigned int nei = sys.fNeiFirst[sc]; nei < sys.fNeiFirst[sc + 1]; ++nei)
+    writes.push_back(sys.fNeiIndex[nei]);
+  if (sys.fWire1[sc] >= 0) writes.push_back(sys.NSpaceCharges() + sys.fWire1[sc]);
+  if (sys.fWire2[sc] >= 0) writes.push_back(sys.NSpaceCharges() + sys.fWire2[sc]);
+}
+
+// ---------------------------------------------------------------------------
+// Greedy colouring: each unit gets the first set none of whose members shares
+// any state with it. Units are considered in the same order as the serial
+// Iterate() visits the collection wires.
+template <class F>
+std::vector<std::vector<unsigned int>> GreedyColor(const SolverSystem& sys,
+                                                   const std::vector<unsigned int>& units,
+                                                   F fillWriteSet)
+{
+  std::vector<std::vector<unsigned int>> sets;
+
+  if (units.empty()) return sets;
+
+  // The sets that already modify each piece of state
+  std::vector<std::vector<unsigned int>> usedSets(sys.NSpaceCharges() + sys.NInductionWires());
+  // Marks the sets excluded for the current unit
+  std::vector<unsigned int> excluded;
+  std::vector<unsigned int> writes;
+
+  unsigned int idx = 0;
+  do {
+    const unsigned int unit = units[idx];
+    const unsigned int stamp = idx + 1;
+
+    writes.clear();
+    fillWriteSet(unit, writes);
+
+    for (unsigned int w : writes) {
+      for (unsigned int set : usedSets[w])
+        excluded[set] = stamp;
+    }
+
+    unsigned int set = 0;
+    while (set < sets.size() && excluded[set] == stamp)
+      ++set;
+
+    if (set == sets.size()) {
+      sets.emplace_back();
+      excluded.push_back(0);
+    }
+    sets[set].push_back(unit);
+
+    for (unsigned int w : writes)
+      usedSets[w].push_back(set);
+
+    const unsigned int prime = 1299827;
+    idx = (idx + prime) % units.size();
+  } while (idx != 0);
+
+  return sets;
+}
+
+// ---------------------------------------------------------------------------
+IndependentSets ColorSystem(const SolverSystem& sys)
+{
+  IndependentSets ret;
+
+  std::vector<unsigned int> units(sys.NCollectionWires());
+  for (unsigned int cwire = 0; cwire < units.size(); ++cwire)
+    units[cwire] = cwire;
+
+  ret.cwires = GreedyColor(sys, units, [&](unsigned int cwire, std::vector<unsigned int>& writes) {
+    for (unsigned int sc = sys.CWireBegin(cwire); sc < sys.CWireEnd(cwire); ++sc)
+      AddWriteSet(sys, sc, writes);
+  });
+
+  units.clear();
+  for (unsigned int sc = sys.OrphansBegin(); sc < sys.NSpaceCharges(); ++sc)
+    units.push_back(sc);
+
+  ret.orphanSCs = GreedyColor(sys, units, [&](unsigned int sc, std::vector<unsigned int>& writes) {
+    AddWriteSet(sys, sc, writes);
+  });
+
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+void Iterate(SolverSystem& sys, const IndependentSets& sets, double alpha)
+{
+  for (const std::vector<unsigned int>& cwires : sets.cwires) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, cwires.size()),
+                      [&](const tbb::blocked_range<size_t>& range) {
+                        for (size_t i = range.begin(); i != range.end(); ++i)
+                          IterateCWire(sys, cwires[i], alpha);
+                      });
+  }
+
+  for (const std::vector<unsigned int>& scs : sets.orphanSCs) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, scs.size()),
+                      [&](const tbb::blocked_range<size_t>& range) {
+                        for (size_t i = range.begin(); i != range.end(); ++i)
+                          IterateSpaceCharge(sys, scs[i], alpha);
+                      });
+  }
 }
@@ -7,84 +7,99 @@
 
 #include "larreco/SpacePointSolver/QuadExpr.h"
 
-/// Allow InductionWireHit and CollectionWireHit to be put in the same maps
-/// where necessary.
-class WireHit {
-  // Do not add any virtual functions: will increase memory usage of all wires
+/// A potential space point, where a collection wire crosses (up to) two
+/// induction wires. Wires are referred to by their index in the SolverSystem,
+/// -1 meaning no wire.
+struct Crossing {
+  double x, y, z;
+  int wire1, wire2;
 };
 
-class InductionWireHit : public WireHit {
+/// The system solved by the SpacePointSolver, stored as parallel arrays
+/// indexed by wire or space charge number.
+///
+/// The space charges of each collection wire are contiguous, in the order the
+/// wires were added, and they are followed by the orphan space charges (those
+/// with no collection wire). Neighbour lists are in compressed sparse row form.
+class SolverSystem {
 public:
-  InductionWireHit(int chan, double q);
-
-  //protected:
-  int fChannel;
-
-  double fCharge;
-
-  double fPred;
-};
-
-class SpaceCharge;
-class Neighbour {
-public:
-  Neighbour(SpaceCharge* sc, double coupling);
-
-  SpaceCharge* fSC;
-  double fCoupling;
-};
-
-class CollectionWireHit;
-
-class SpaceCharge {
-public:
-  SpaceCharge(double x,
-              double y,
-              double z,
-              CollectionWireHit* cwire,
-              InductionWireHit* wire1,
-              InductionWireHit* wire2);
-
-  void AddCharge(double dq);
-
-  //protected:
-  double fX, fY, fZ;
-  CollectionWireHit* fCWire;
-  InductionWireHit *fWire1, *fWire2;
-
-  std::vector<Neighbour> fNeighbours;
-
-  double fPred;
-  double fNeiPotential; ///< Neighbour-induced potential
+  /// Returns the index of the new induction wire
+  int AddInductionWire(double q);
+
+  /// Adds a collection wire with charge q, shared evenly among its crossings
+  void AddCollectionWire(double q, const std::vector<Crossing>& crossings);
+
+  /// Adds a space charge with no collection wire; call after all the
+  /// collection wires have been added
+  void AddOrphan(const Crossing& crossing);
+
+  /// Couples every pair of space charges closer than critDist, with strength
+  /// exp(-dist/2). Returns the number of distance tests made.
+  long AddNeighbours(double critDist);
+
+  unsigned int NCollectionWires() const { return fCWireCharge.size(); }
+  unsigned int NInductionWires() const { return fIWireCharge.size(); }
+  unsigned int NSpaceCharges() const { return fPred.size(); }
+  unsigned int NNeighbours() const { return fNeiIndex.size(); }
+
+  /// The space charges of collection wire i are [CWireBegin(i), CWireEnd(i))
+  unsigned int CWireBegin(unsigned int i) const { return fCWireFirstSC[i]; }
+  unsigned int CWireEnd(unsigned int i) const { return fCWireFirstSC[i + 1]; }
+
+  /// The orphan space charges are [OrphansBegin(), NSpaceCharges())
+  unsigned int OrphansBegin() const { return fCWireFirstSC.back(); }
+
+  // Induction wires
+  std::vector<double> fIWireCharge;
+  std::vector<double> fIWirePred;
+
+  // Collection wires
+  std::vector<double> fCWireCharge;
+  std::vector<unsigned int> fCWireFirstSC{0};
+
+  // Space charges
+  std::vector<double> fX, fY, fZ;
+  std::vector<int> fCWire; ///< -1 for orphans
+  std::vector<int> fWire1, fWire2;
+  std::vector<double> fPred;
+  std::vector<double> fNeiPotential; ///< Neighbour-induced potential
+
+  // Neighbours of space charge i are [fNeiFirst[i], fNeiFirst[i+1])
+  std::vector<unsigned int> fNeiFirst{0};
+  std::vector<unsigned int> fNeiIndex;
+  std::vector<double> fNeiCoupling;
+
+  /// Induction wires crossed by the collection wire space charges
+  std::vector<unsigned int> fCWireIWires;
+  std::vector<bool> fIWireInCWire;
+
+protected:
+  void AddSpaceCharge(const Crossing& crossing, int cwire);
 };
 
-class CollectionWireHit : public WireHit {
-public:
-  CollectionWireHit(int chan, double q, const std::vector<SpaceCharge*>& cross);
-  ~CollectionWireHit();
+void AddCharge(SolverSystem& sys, unsigned int sc, double dq);
 
-  //protected:
-  int fChannel;
+/// Metric of the collection wires (and the induction wires they cross)
+double Metric(const SolverSystem& sys, double alpha);
+QuadExpr Metric(const SolverSystem& sys, unsigned int sci, unsigned int scj, double alpha);
+QuadExpr Metric(const SolverSystem& sys, unsigned int sc, double alpha);
 
-  double fCharge;
+double SolvePair(const SolverSystem& sys, unsigned int sci, unsigned int scj, double alpha);
+void IterateCWire(SolverSystem& sys, unsigned int cwire, double alpha);
+void IterateSpaceCharge(SolverSystem& sys, unsigned int sc, double alpha);
+void Iterate(SolverSystem& sys, double alpha);
 
-  std::vector<SpaceCharge*> fCrossings;
+/// Collection wires and orphan space charges split into sets whose members
+/// modify disjoint state (space charges, neighbour potentials and induction
+/// wires), so that all the members of a set can be iterated concurrently.
+struct IndependentSets {
+  std::vector<std::vector<unsigned int>> cwires;
+  std::vector<std::vector<unsigned int>> orphanSCs;
 };
 
-double Metric(const std::vector<SpaceCharge*>& scs, double alpha);
-double Metric(const std::vector<CollectionWireHit*>& cwires, double alpha);
-QuadExpr Metric(const SpaceCharge* sci, const SpaceCharge* scj, double alpha);
-
-double SolvePair(CollectionWireHit* cwire,
-                 SpaceCharge* sci,
-                 SpaceCharge* scj,
-                 double xmin,
-                 double xmax,
-                 double alpha);
-void Iterate(CollectionWireHit* cwire, double alpha);
-void Iterate(SpaceCharge* sc, double alpha);
-void Iterate(const std::vector<CollectionWireHit*>& cwires,
-             const std::vector<SpaceCharge*>& orphanSCs,
-             double alpha);
+IndependentSets ColorSystem(const SolverSystem& sys);
+/// Parallel version of the Iterate() above: the sets are visited in turn and
+/// the members of each set are updated concurrently
+void Iterate(SolverSystem& sys, const IndependentSets& sets, double alpha);
 
 #endif
@@ -4,18 +4,19 @@
 
 // C/C++ standard libraries
 #include <iostream>
+#include <map>
+#include <set>
 #include <string>
 
 // framework libraries
-#include "art/Framework/Core/EDProducer.h"
 #include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Core/SharedProducer.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Handle.h"
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "art/Utilities/make_tool.h"
 #include "canvas/Persistency/Common/Assns.h"
 #include "canvas/Persistency/Common/Ptr.h"
-#include "cetlib/pow.h"
 #include "fhiclcpp/ParameterSet.h"
 
 // LArSoft libraries
@@ -35,60 +36,49 @@
 
 namespace reco3d {
 
-  /// The position in the drift direction that an induction wire's time implies
-  /// depends on which TPC we assume the hit originated in.
-  struct InductionWireWithXPos {
-    InductionWireWithXPos(InductionWireHit* w, double x) : iwire(w), xpos(x) {}
-
-    bool operator<(const InductionWireWithXPos& w) const { return xpos < w.xpos; }
-
-    InductionWireHit* iwire;
-    double xpos;
-  };
-
-  class SpacePointSolver : public art::EDProducer {
+  class SpacePointSolver : public art::SharedProducer {
   public:
-    explicit SpacePointSolver(const fhicl::ParameterSet& pset);
+    explicit SpacePointSolver(const fhicl::ParameterSet& pset, art::ProcessingFrame const&);
 
   private:
-    void produce(art::Event& evt) override;
-    void beginJob() override;
-
-    void AddNeighbours(const std::vector<SpaceCharge*>& spaceCharges) const;
-
-    typedef std::map<const WireHit*, const recob::Hit*> HitMap_t;
+    void produce(art::Event& evt, art::ProcessingFrame const&) override;
+    void beginJob(art::ProcessingFrame const&) override;
 
+    /// Fills sys; the hits of its collection and induction wires are stored,
+    /// by wire index, in cwireHits and iwireHits
     void BuildSystem(const std::vector<HitTriplet>& triplets,
-                     std::vector<CollectionWireHit*>& cwires,
-                     std::vector<InductionWireHit*>& iwires,
-                     std::vector<SpaceCharge*>& orphanSCs,
-                     bool incNei,
-                     HitMap_t& hitmap) const;
-
-    void Minimize(const std::vector<CollectionWireHit*>& cwires,
-                  const std::vector<SpaceCharge*>& orphanSCs,
+                     SolverSystem& sys,
+                     std::vector<const recob::Hit*>& cwireHits,
+                     std::vector<const recob::Hit*>& iwireHits,
+                     bool incNei) const;
+
+    void Minimize(SolverSystem& sys,
+                  const IndependentSets* sets,
                   double alpha,
-                  int maxiterations);
+                  int maxiterations) const;
 
     /// return whether the point was inserted (only happens when it has charge)
-    bool AddSpacePoint(const SpaceCharge& sc,
+    bool AddSpacePoint(const SolverSystem& sys,
+                       unsigned int sc,
                        int id,
                        recob::ChargedSpacePointCollectionCreator& points) const;
 
-    void FillSystemToSpacePoints(const std::vector<CollectionWireHit*>& cwires,
-                                 const std::vector<SpaceCharge*>& orphanSCs,
+    void FillSystemToSpacePoints(const SolverSystem& sys,
                                  recob::ChargedSpacePointCollectionCreator& pts) const;
 
     void FillSystemToSpacePointsAndAssns(const std::vector<art::Ptr<recob::Hit>>& hitlist,
-                                         const std::vector<CollectionWireHit*>& cwires,
-                                         const std::vector<SpaceCharge*>& orphanSCs,
-                                         const HitMap_t& hitmap,
+                                         const SolverSystem& sys,
+                                         const std::vector<const recob::Hit*>& cwireHits,
+                                         const std::vector<const recob::Hit*>& iwireHits,
                                          recob::ChargedSpacePointCollectionCreator& points,
                                          art::Assns<recob::SpacePoint, recob::Hit>& assn) const;
 
     std::string fHitLabel;
 
     bool fFit;
+    bool fParallel;
+    bool fSortedSweep;
+    bool fCheckSortedSweep;
     bool fAllowBadInductionHit, fAllowBadCollectionHit;
 
     double fAlpha;
@@ -110,10 +100,13 @@ namespace reco3d {
   DEFINE_ART_MODULE(SpacePointSolver)
 
   // ---------------------------------------------------------------------------
-  SpacePointSolver::SpacePointSolver(const fhicl::ParameterSet& pset)
-    : EDProducer{pset}
+  SpacePointSolver::SpacePointSolver(const fhicl::ParameterSet& pset, art::ProcessingFrame const&)
+    : SharedProducer{pset}
     , fHitLabel(pset.get<std::string>("HitLabel"))
     , fFit(pset.get<bool>("Fit"))
+    , fParallel(pset.get<bool>("Parallel", false))
+    , fSortedSweep(pset.get<bool>("SortedSweep", false))
+    , fCheckSortedSweep(pset.get<bool>("CheckSortedSweep", false))
     , fAllowBadInductionHit(pset.get<bool>("AllowBadInductionHit"))
     , fAllowBadCollectionHit(pset.get<bool>("AllowBadCollectionHit"))
     , fAlpha(pset.get<double>("Alpha"))
@@ -124,6 +117,9 @@ namespace reco3d {
     , fXHitOffset(pset.get<double>("XHitOffset"))
     , fMinNHits(pset.get<unsigned int>("MinNHits"))
   {
+    // All per-event state lives in produce(), the hit reader tools are const
+    async<art::InEvent>();
+
     recob::ChargedSpacePointCollectionCreator::produces(producesCollector(), "pre");
     if (fFit) {
       recob::ChargedSpacePointCollectionCreator::produces(producesCollector());
@@ -135,115 +131,17 @@ namespace reco3d {
   }
 
   // ---------------------------------------------------------------------------
-  void SpacePointSolver::beginJob()
+  void SpacePointSolver::beginJob(art::ProcessingFrame const&)
   {
     geom = art::ServiceHandle<geo::Geometry const>()->provider();
   }
 
-  // ---------------------------------------------------------------------------
-  void SpacePointSolver::AddNeighbours(const std::vector<SpaceCharge*>& spaceCharges) const
-  {
-    static const double kCritDist = 5;
-
-    // Could use a QuadTree or VPTree etc, but seems like overkill
-    class IntCoord {
-    public:
-      IntCoord(const SpaceCharge& sc)
-        : fX(sc.fX / kCritDist), fY(sc.fY / kCritDist), fZ(sc.fZ / kCritDist)
-      {}
-
-      bool operator<(const IntCoord& i) const
-      {
-        return std::make_tuple(fX, fY, fZ) < std::make_tuple(i.fX, i.fY, i.fZ);
-      }
-
-      std::vector<IntCoord> Neighbours() const
-      {
-        std::vector<IntCoord> ret;
-        for (int dx = -1; dx <= +1; ++dx) {
-          for (int dy = -1; dy <= +1; ++dy) {
-            for (int dz = -1; dz <= +1; ++dz) {
-              ret.push_back(IntCoord(fX + dx, fY + dy, fZ + dz));
-            }
-          }
-        }
-        return ret;
-      }
-
-    protected:
-      IntCoord(int x, int y, int z) : fX(x), fY(y), fZ(z) {}
-
-      int fX, fY, fZ;
-    };
-
-    std::map<IntCoord, std::vector<SpaceCharge*>> scMap;
-    for (SpaceCharge* sc : spaceCharges) {
-      scMap[IntCoord(*sc)].push_back(sc);
-    }
-
-    std::cout << "Neighbour search..." << std::endl;
-
-    // Now that we know all the space charges, can go through and assign neighbours
-
-    int Ntests = 0;
-    int Nnei = 0;
-    for (SpaceCharge* sc1 : spaceCharges) {
-      IntCoord ic(*sc1);
-      for (IntCoord icn : ic.Neighbours()) {
-        for (SpaceCharge* sc2 : scMap[icn]) {
-
-          ++Ntests;
-
-          if (sc1 == sc2) continue;
-          double dist2 =
-            cet::sum_of_squares(sc1->fX - sc2->fX, sc1->fY - sc2->fY, sc1->fZ - sc2->fZ);
-
-          if (dist2 > cet::square(kCritDist)) continue;
-
-          if (dist2 == 0) {
-            std::cout << "ZERO DISTANCE SOMEHOW?" << std::endl;
-            std::cout << sc1->fCWire << " " << sc1->fWire1 << " " << sc1->fWire2 << std::endl;
-            std::cout << sc2->fCWire << " " << sc2->fWire1 << " " << sc2->fWire2 << std::endl;
-            std::cout << dist2 << " " << sc1->fX << " " << sc2->fX << " " << sc1->fY << " "
-                      << sc2->fY << " " << sc1->fZ << " " << sc2->fZ << std::endl;
-            continue;
-            dist2 = cet::square(kCritDist);
-          }
-
-          ++Nnei;
-
-          // This is a pretty random guess
-          const double coupling = exp(-sqrt(dist2) / 2);
-          sc1->fNeighbours.emplace_back(sc2, coupling);
-
-          if (isnan(1 / sqrt(dist2)) || isinf(1 / sqrt(dist2))) {
-            std::cout << dist2 << " " << sc1->fX << " " << sc2->fX << " " << sc1->fY << " "
-                      << sc2->fY << " " << sc1->fZ << " " << sc2->fZ << std::endl;
-            abort();
-          }
-        } // end for sc2
-      }   // end for icn
-
-      // The neighbours lists use the most memory, so be careful to trim
-      sc1->fNeighbours.shrink_to_fit();
-    } // end for sc1
-
-    for (SpaceCharge* sc : spaceCharges) {
-      for (Neighbour& nei : sc->fNeighbours) {
-        sc->fNeiPotential += nei.fCoupling * nei.fSC->fPred;
-      }
-    }
-
-    std::cout << Ntests << " tests to find " << Nnei << " neighbours" << std::endl;
-  }
-
   // ---------------------------------------------------------------------------
   void SpacePointSolver::BuildSystem(const std::vector<HitTriplet>& triplets,
-                                     std::vector<CollectionWireHit*>& cwires,
-                                     std::vector<InductionWireHit*>& iwires,
-                                     std::vector<SpaceCharge*>& orphanSCs,
-                                     bool incNei,
-                                     HitMap_t& hitmap) const
+                                     SolverSystem& sys,
+                                     std::vector<const recob::Hit*>& cwireHits,
+                                     std::vector<const recob::Hit*>& iwireHits,
+                                     bool incNei) const
   {
     std::set<const recob::Hit*> ihits;
     std::set<const recob::Hit*> chits;
@@ -253,29 +151,27 @@ namespace reco3d {
       if (trip.v) ihits.insert(trip.v);
     }
 
-    std::map<const recob::Hit*, InductionWireHit*> inductionMap;
+    std::map<const recob::Hit*, int> inductionMap;
+    inductionMap[nullptr] = -1;
     for (const recob::Hit* hit : ihits) {
-      InductionWireHit* iwire = new InductionWireHit(hit->Channel(), hit->Integral());
-      inductionMap[hit] = iwire;
-      iwires.emplace_back(iwire);
-      hitmap[iwire] = hit;
+      inductionMap[hit] = sys.AddInductionWire(hit->Integral());
+      iwireHits.push_back(hit);
     }
 
-    std::map<const recob::Hit*, std::vector<SpaceCharge*>> collectionMap;
-    std::map<const recob::Hit*, std::vector<SpaceCharge*>> collectionMapBad;
+    std::map<const recob::Hit*, std::vector<Crossing>> collectionMap;
+    std::map<const recob::Hit*, std::vector<Crossing>> collectionMapBad;
 
-    std::set<InductionWireHit*> satisfiedInduction;
+    std::set<int> satisfiedInduction;
 
     for (const HitTriplet& trip : triplets) {
-      // Don't have a cwire object yet, set it later
-      SpaceCharge* sc = new SpaceCharge(
-        trip.pt.x, trip.pt.y, trip.pt.z, 0, inductionMap[trip.u], inductionMap[trip.v]);
+      const Crossing sc{
+        trip.pt.x, trip.pt.y, trip.pt.z, inductionMap.at(trip.u), inductionMap.at(trip.v)};
 
       if (trip.u && trip.v) {
         collectionMap[trip.x].push_back(sc);
         if (trip.x) {
-          satisfiedInduction.insert(inductionMap[trip.u]);
-          satisfiedInduction.insert(inductionMap[trip.v]);
+          satisfiedInduction.insert(sc.wire1);
+          satisfiedInduction.insert(sc.wire2);
         }
       }
       else {
@@ -283,52 +179,42 @@ namespace reco3d {
       }
     }
 
-    std::vector<SpaceCharge*> spaceCharges;
-
     for (const recob::Hit* hit : chits) {
       // Find the space charges associated with this hit
-      std::vector<SpaceCharge*>& scs = collectionMap[hit];
-      if (scs.empty()) {
+      const std::vector<Crossing>* scs = &collectionMap[hit];
+      if (scs->empty()) {
         // If there are no full triplets try the triplets with one bad channel
-        scs = collectionMapBad[hit];
-      }
-      else {
-        // If there were good triplets, delete the bad hit ones
-        for (SpaceCharge* sc : collectionMapBad[hit])
-          delete sc;
+        scs = &collectionMapBad[hit];
       }
       // Still no space points, don't bother making a wire
-      if (scs.empty()) continue;
-
-      CollectionWireHit* cwire = new CollectionWireHit(hit->Channel(), hit->Integral(), scs);
-      hitmap[cwire] = hit;
-      cwires.push_back(cwire);
-      spaceCharges.insert(spaceCharges.end(), scs.begin(), scs.end());
-      for (SpaceCharge* sc : scs)
-        sc->fCWire = cwire;
+      if (scs->empty()) continue;
+
+      sys.AddCollectionWire(hit->Integral(), *scs);
+      cwireHits.push_back(hit);
     } // end for hit
 
     // Space charges whose collection wire is bad, which we have no other way of
     // addressing.
-    for (SpaceCharge* sc : collectionMap[0]) {
+    for (const Crossing& sc : collectionMap[nullptr]) {
       // Only count orphans where an induction wire has no other explanation
-      if (satisfiedInduction.count(sc->fWire1) == 0 || satisfiedInduction.count(sc->fWire2) == 0) {
-        orphanSCs.push_back(sc);
-      }
-      else {
-        delete sc;
+      if (satisfiedInduction.count(sc.wire1) == 0 || satisfiedInduction.count(sc.wire2) == 0) {
+        sys.AddOrphan(sc);
       }
     }
-    spaceCharges.insert(spaceCharges.end(), orphanSCs.begin(), orphanSCs.end());
 
-    std::cout << cwires.size() << " collection wire objects" << std::endl;
-    std::cout << spaceCharges.size() << " potential space points" << std::endl;
+    std::cout << sys.NCollectionWires() << " collection wire objects" << std::endl;
+    std::cout << sys.NSpaceCharges() << " potential space points" << std::endl;
 
-    if (incNei) AddNeighbours(spaceCharges);
+    if (incNei) {
+      std::cout << "Neighbour search..." << std::endl;
+      const long Ntests = sys.AddNeighbours(5);
+      std::cout << Ntests << " tests to find " << sys.NNeighbours() << " neighbours" << std::endl;
+    }
   }
 
   // ---------------------------------------------------------------------------
-  bool SpacePointSolver::AddSpacePoint(const SpaceCharge& sc,
+  bool SpacePointSolver::AddSpacePoint(const SolverSystem& sys,
+                                       unsigned int sc,
                                        int id,
                                        recob::ChargedSpacePointCollectionCreator& points) const
   {
@@ -336,10 +222,10 @@ namespace reco3d {
       0,
     };
 
-    const float charge = sc.fPred;
+    const float charge = sys.fPred[sc];
     if (charge == 0) return false;
 
-    const double xyz[3] = {sc.fX, sc.fY, sc.fZ};
+    const double xyz[3] = {sys.fX[sc], sys.fY[sc], sys.fZ[sc]};
     points.add({xyz, err, 0.0, id}, charge);
 
     return true;
@@ -347,27 +233,20 @@ namespace reco3d {
 
   // ---------------------------------------------------------------------------
   void SpacePointSolver::FillSystemToSpacePoints(
-    const std::vector<CollectionWireHit*>& cwires,
-    const std::vector<SpaceCharge*>& orphanSCs,
+    const SolverSystem& sys,
     recob::ChargedSpacePointCollectionCreator& points) const
   {
-    int iPoint = 0;
-    for (const CollectionWireHit* cwire : cwires) {
-      for (const SpaceCharge* sc : cwire->fCrossings) {
-        AddSpacePoint(*sc, iPoint++, points);
-      } // for sc
-    }   // for cwire
-
-    for (const SpaceCharge* sc : orphanSCs)
-      AddSpacePoint(*sc, iPoint++, points);
+    // Collection wire space charges come first, then the orphans
+    for (unsigned int sc = 0; sc < sys.NSpaceCharges(); ++sc)
+      AddSpacePoint(sys, sc, sc, points);
   }
 
   // ---------------------------------------------------------------------------
   void SpacePointSolver::FillSystemToSpacePointsAndAssns(
     const std::vector<art::Ptr<recob::Hit>>& hitlist,
-    const std::vector<CollectionWireHit*>& cwires,
-    const std::vector<SpaceCharge*>& orphanSCs,
-    const HitMap_t& hitmap,
+    const SolverSystem& sys,
+    const std::vector<const recob::Hit*>& cwireHits,
+    const std::vector<const recob::Hit*>& iwireHits,
     recob::ChargedSpacePointCollectionCreator& points,
     art::Assns<recob::SpacePoint, recob::Hit>& assn) const
   {
@@ -375,36 +254,39 @@ namespace reco3d {
     for (art::Ptr<recob::Hit> hit : hitlist)
       ptrmap[hit.get()] = hit;
 
-    std::vector<const SpaceCharge*> scs;
-    for (const SpaceCharge* sc : orphanSCs)
+    // Orphans first, then the space charges of the collection wires
+    std::vector<unsigned int> scs;
+    for (unsigned int sc = sys.OrphansBegin(); sc < sys.NSpaceCharges(); ++sc)
+      scs.push_back(sc);
+    for (unsigned int sc = 0; sc < sys.OrphansBegin(); ++sc)
       scs.push_back(sc);
-    for (const CollectionWireHit* cwire : cwires)
-      for (const SpaceCharge* sc : cwire->fCrossings)
-        scs.push_back(sc);
 
     int iPoint = 0;
 
-    for (const SpaceCharge* sc : scs) {
-      if (!AddSpacePoint(*sc, iPoint++, points)) continue;
+    for (unsigned int sc : scs) {
+      if (!AddSpacePoint(sys, sc, iPoint++, points)) continue;
       const auto& spsPtr = points.lastSpacePointPtr();
 
-      if (sc->fCWire) { assn.addSingle(spsPtr, ptrmap[hitmap.at(sc->fCWire)]); }
-      if (sc->fWire1) { assn.addSingle(spsPtr, ptrmap[hitmap.at(sc->fWire1)]); }
-      if (sc->fWire2) { assn.addSingle(spsPtr, ptrmap[hitmap.at(sc->fWire2)]); }
+      if (sys.fCWire[sc] >= 0) { assn.addSingle(spsPtr, ptrmap[cwireHits[sys.fCWire[sc]]]); }
+      if (sys.fWire1[sc] >= 0) { assn.addSingle(spsPtr, ptrmap[iwireHits[sys.fWire1[sc]]]); }
+      if (sys.fWire2[sc] >= 0) { assn.addSingle(spsPtr, ptrmap[iwireHits[sys.fWire2[sc]]]); }
     }
   }
 
   // ---------------------------------------------------------------------------
-  void SpacePointSolver::Minimize(const std::vector<CollectionWireHit*>& cwires,
-                                  const std::vector<SpaceCharge*>& orphanSCs,
+  void SpacePointSolver::Minimize(SolverSystem& sys,
+                                  const IndependentSets* sets,
                                   double alpha,
-                                  int maxiterations)
+                                  int maxiterations) const
   {
-    double prevMetric = Metric(cwires, alpha);
+    double prevMetric = Metric(sys, alpha);
     std::cout << "Begin: " << prevMetric << std::endl;
     for (int i = 0; i < maxiterations; ++i) {
-      Iterate(cwires, orphanSCs, alpha);
-      const double metric = Metric(cwires, alpha);
+      if (sets)
+        Iterate(sys, *sets, alpha);
+      else
+        Iterate(sys, alpha);
+      const double metric = Metric(sys, alpha);
       std::cout << i << " " << metric << std::endl;
       if (metric > prevMetric) {
         std::cout << "Warning: metric increased" << std::endl;
@@ -416,7 +298,7 @@ namespace reco3d {
   }
 
   // ---------------------------------------------------------------------------
-  void SpacePointSolver::produce(art::Event& evt)
+  void SpacePointSolver::produce(art::Event& evt, art::ProcessingFrame const&)
   {
     art::Handle<std::vector<recob::Hit>> hits;
     std::vector<art::Ptr<recob::Hit>> hitlist;
@@ -461,16 +343,13 @@ namespace reco3d {
     std::cout << xbadchans.size() << " X, " << ubadchans.size() << " U, " << vbadchans.size()
               << " V bad channels" << std::endl;
 
-    std::vector<CollectionWireHit*> cwires;
-    // So we can find them all to free the memory
-    std::vector<InductionWireHit*> iwires;
-    // Nodes with a bad collection wire that we otherwise can't address
-    std::vector<SpaceCharge*> orphanSCs;
+    SolverSystem sys;
+    // The hits each collection and induction wire of the system came from
+    std::vector<const recob::Hit*> cwireHits, iwireHits;
 
     auto const detProp =
       art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(evt);
 
-    HitMap_t hitmap;
     if (is2view) {
       std::cout << "Finding 2-view coincidences..." << std::endl;
       TripletFinder tf(detProp,
@@ -482,8 +361,10 @@ namespace reco3d {
                        {},
                        fDistThresh,
                        fDistThreshDrift,
-                       fXHitOffset);
-      BuildSystem(tf.TripletsTwoView(), cwires, iwires, orphanSCs, fAlpha != 0, hitmap);
+                       fXHitOffset,
+                       fSortedSweep,
+                       fCheckSortedSweep);
+      BuildSystem(tf.TripletsTwoView(), sys, cwireHits, iwireHits, fAlpha != 0);
     }
     else {
       std::cout << "Finding XUV coincidences..." << std::endl;
@@ -496,34 +377,37 @@ namespace reco3d {
                        vbadchans,
                        fDistThresh,
                        fDistThreshDrift,
-                       fXHitOffset);
-      BuildSystem(tf.Triplets(), cwires, iwires, orphanSCs, fAlpha != 0, hitmap);
+                       fXHitOffset,
+                       fSortedSweep,
+                       fCheckSortedSweep);
+      BuildSystem(tf.Triplets(), sys, cwireHits, iwireHits, fAlpha != 0);
     }
 
-    FillSystemToSpacePoints(cwires, orphanSCs, spcol_pre);
+    FillSystemToSpacePoints(sys, spcol_pre);
     spcol_pre.put();
 
     if (fFit) {
+      // Sets of wires that can be updated concurrently
+      IndependentSets sets;
+      if (fParallel) {
+        sets = ColorSystem(sys);
+        std::cout << sets.cwires.size() << " independent sets of collection wires, "
+                  << sets.orphanSCs.size() << " of orphan space charges" << std::endl;
+      }
+
       std::cout << "Iterating with no regularization..." << std::endl;
-      Minimize(cwires, orphanSCs, 0, fMaxIterationsNoReg);
+      Minimize(sys, fParallel ? &sets : nullptr, 0, fMaxIterationsNoReg);
 
-      FillSystemToSpacePoints(cwires, orphanSCs, spcol_noreg);
+      FillSystemToSpacePoints(sys, spcol_noreg);
       spcol_noreg.put();
 
       std::cout << "Now with regularization..." << std::endl;
-      Minimize(cwires, orphanSCs, fAlpha, fMaxIterationsReg);
+      Minimize(sys, fParallel ? &sets : nullptr, fAlpha, fMaxIterationsReg);
 
-      FillSystemToSpacePointsAndAssns(hitlist, cwires, orphanSCs, hitmap, spcol, *assns);
+      FillSystemToSpacePointsAndAssns(hitlist, sys, cwireHits, iwireHits, spcol, *assns);
       spcol.put();
       evt.put(std::move(assns));
     } // end if fFit
-
-    for (InductionWireHit* i : iwires)
-      delete i;
-    for (CollectionWireHit* c : cwires)
-      delete c;
-    for (SpaceCharge* s : orphanSCs)
-      delete s;
   }
 
 } // end namespace reco3d
@@ -1,6 +1,14 @@
 #include "larreco/SpacePointSolver/TripletFinder.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <tuple>
+#include <unordered_map>
+
 #include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
 
 #include "TVector3.h"
 
@@ -8,6 +16,9 @@
 #include "larcorealg/Geometry/GeometryCore.h"
 #include "lardataalg/DetectorInfo/DetectorPropertiesData.h"
 
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
 namespace reco3d {
   // -------------------------------------------------------------------------
   TripletFinder::TripletFinder(const detinfo::DetectorPropertiesData& detProp,
@@ -19,11 +30,15 @@ namespace reco3d {
                                const std::vector<raw::ChannelID_t>& vbad,
                                double distThresh,
                                double distThreshDrift,
-                               double xhitOffset)
+                               double xhitOffset,
+                               bool sortedSweep,
+                               bool checkSortedSweep)
     : geom(art::ServiceHandle<geo::Geometry const>()->provider())
     , fDistThresh(distThresh)
     , fDistThreshDrift(distThreshDrift)
     , fXHitOffset(xhitOffset)
+    , fSortedSweep(sortedSweep)
+    , fCheckSortedSweep(checkSortedSweep)
   {
     FillHitMap(detProp, xhits, fX_by_tpc);
     FillHitMap(detProp, uhits, fU_by_tpc);
@@ -67,26 +82,33 @@ namespace reco3d {
     }
   }
 
+  // -------------------------------------------------------------------------
+  /// The list for tpc in the map, or an empty list
+  template <class T>
+  const std::vector<T>& InTPC(const std::map<geo::TPCID, std::vector<T>>& m, geo::TPCID tpc)
+  {
+    static const std::vector<T> empty;
+    const auto it = m.find(tpc);
+    return it == m.end() ? empty : it->second;
+  }
+
   // -------------------------------------------------------------------------
   class IntersectionCache {
   public:
-    IntersectionCache(geo::TPCID tpc)
-      : geom(art::ServiceHandle<geo::Geometry const>()->provider()), fTPC(tpc)
-    {}
+    IntersectionCache(const geo::GeometryCore* g, geo::TPCID tpc) : geom(g), fTPC(tpc) {}
 
     bool operator()(raw::ChannelID_t a, raw::ChannelID_t b, geo::WireIDIntersection& pt)
     {
-      const auto key = std::make_pair(a, b);
+      const uint64_t key = (uint64_t(a) << 32) | b;
 
       auto it = fMap.find(key);
       if (it != fMap.end()) {
-        pt = fPtMap[key];
-        return it->second;
+        pt = it->second.second;
+        return it->second.first;
       }
 
       const bool res = ISect(a, b, pt);
-      fMap.insert({key, res});
-      fPtMap.insert({key, pt});
+      fMap.emplace(key, std::make_pair(res, pt));
       return res;
     }
 
@@ -107,8 +129,8 @@ namespace reco3d {
 
     const geo::GeometryCore* geom;
 
-    std::map<std::pair<raw::ChannelID_t, raw::ChannelID_t>, bool> fMap;
-    std::map<std::pair<raw::ChannelID_t, raw::ChannelID_t>, geo::WireIDIntersection> fPtMap;
+    /// Keyed by both channel numbers
+    std::unordered_map<uint64_t, std::pair<bool, geo::WireIDIntersection>> fMap;
 
     geo::TPCID fTPC;
   };
@@ -145,81 +167,112 @@ namespace reco3d {
   // -------------------------------------------------------------------------
   std::vector<HitTriplet> TripletFinder::Triplets()
   {
+    std::vector<geo::TPCID> tpcs;
+    for (const auto& it : fX_by_tpc)
+      tpcs.push_back(it.first);
+
+    std::vector<std::vector<HitTriplet>> xuvs(tpcs.size());
+    std::vector<size_t> nxus(tpcs.size()), nxvs(tpcs.size());
+
+    if (fSortedSweep) {
+      // TPCs are independent. Results are kept per TPC so that the output
+      // order does not depend on the scheduling.
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, tpcs.size()),
+                        [&](const tbb::blocked_range<size_t>& range) {
+                          for (size_t i = range.begin(); i != range.end(); ++i)
+                            xuvs[i] = TripletsTPC(tpcs[i], nxus[i], nxvs[i]);
+                        });
+    }
+    else {
+      for (size_t i = 0; i < tpcs.size(); ++i)
+        xuvs[i] = TripletsTPC(tpcs[i], nxus[i], nxvs[i]);
+    }
+
     std::vector<HitTriplet> ret;
 
-    for (const auto& it : fX_by_tpc) {
-      const geo::TPCID& tpc = it.first;
+    for (size_t i = 0; i < tpcs.size(); ++i) {
+      std::cout << tpcs[i] << " " << nxus[i] << " XUs and " << nxvs[i] << " XVs -> "
+                << xuvs[i].size() << " XUVs" << std::endl;
 
-      std::vector<ChannelDoublet> xus = DoubletsXU(tpc);
-      std::vector<ChannelDoublet> xvs = DoubletsXV(tpc);
+      ret.insert(ret.end(), xuvs[i].begin(), xuvs[i].end());
+    }
 
-      // Cache to prevent repeating the same questions
-      IntersectionCache isectUV(tpc);
+    std::cout << ret.size() << " XUVs total" << std::endl;
 
-      // For the efficient looping below to work we need to sort the doublet
-      // lists so the X hits occur in the same order.
-      std::sort(xus.begin(), xus.end(), LessThanXHit);
-      std::sort(xvs.begin(), xvs.end(), LessThanXHit);
+    return ret;
+  }
 
-      auto xvit_begin = xvs.begin();
+  // -------------------------------------------------------------------------
+  std::vector<HitTriplet> TripletFinder::TripletsTPC(geo::TPCID tpc,
+                                                     size_t& nxu,
+                                                     size_t& nxv) const
+  {
+    std::vector<HitTriplet> ret;
 
-      int nxuv = 0;
-      for (const ChannelDoublet& xu : xus) {
-        const HitOrChan& x = xu.a;
-        const HitOrChan& u = xu.b;
+    std::vector<ChannelDoublet> xus = DoubletsXU(tpc);
+    std::vector<ChannelDoublet> xvs = DoubletsXV(tpc);
 
-        // Catch up until we're looking at the same X hit in XV
-        while (xvit_begin != xvs.end() && LessThanXHit(*xvit_begin, xu))
-          ++xvit_begin;
+    // Cache to prevent repeating the same questions
+    IntersectionCache isectUV(geom, tpc);
 
-        // Loop through all those matching hits
-        for (auto xvit = xvit_begin; xvit != xvs.end() && SameXHit(*xvit, xu); ++xvit) {
-          const HitOrChan& v = xvit->b;
+    // For the efficient looping below to work we need to sort the doublet
+    // lists so the X hits occur in the same order.
+    std::sort(xus.begin(), xus.end(), LessThanXHit);
+    std::sort(xvs.begin(), xvs.end(), LessThanXHit);
 
-          // Only allow one bad channel per triplet
-          if (!x.hit && !u.hit) continue;
-          if (!x.hit && !v.hit) continue;
-          if (!u.hit && !v.hit) continue;
+    auto xvit_begin = xvs.begin();
 
-          if (u.hit && v.hit && !CloseDrift(u.xpos, v.xpos)) continue;
+    for (const ChannelDoublet& xu : xus) {
+      const HitOrChan& x = xu.a;
+      const HitOrChan& u = xu.b;
 
-          geo::WireIDIntersection ptUV;
-          if (!isectUV(u.chan, v.chan, ptUV)) continue;
+      // Catch up until we're looking at the same X hit in XV
+      while (xvit_begin != xvs.end() && LessThanXHit(*xvit_begin, xu))
+        ++xvit_begin;
 
-          if (!CloseSpace(xu.pt, xvit->pt) || !CloseSpace(xu.pt, ptUV) ||
-              !CloseSpace(xvit->pt, ptUV))
-            continue;
+      // Loop through all those matching hits
+      for (auto xvit = xvit_begin; xvit != xvs.end() && SameXHit(*xvit, xu); ++xvit) {
+        const HitOrChan& v = xvit->b;
 
-          double xavg = 0;
-          int nx = 0;
-          if (x.hit) {
-            xavg += x.xpos;
-            ++nx;
-          }
-          if (u.hit) {
-            xavg += u.xpos;
-            ++nx;
-          }
-          if (v.hit) {
-            xavg += v.xpos;
-            ++nx;
-          }
-          xavg /= nx;
+        // Only allow one bad channel per triplet
+        if (!x.hit && !u.hit) continue;
+        if (!x.hit && !v.hit) continue;
+        if (!u.hit && !v.hit) continue;
+
+        if (u.hit && v.hit && !CloseDrift(u.xpos, v.xpos)) continue;
+
+        geo::WireIDIntersection ptUV;
+        if (!isectUV(u.chan, v.chan, ptUV)) continue;
 
-          const XYZ pt{
-            xavg, (xu.pt.y + xvit->pt.y + ptUV.y) / 3, (xu.pt.z + xvit->pt.z + ptUV.z) / 3};
+        if (!CloseSpace(xu.pt, xvit->pt) || !CloseSpace(xu.pt, ptUV) ||
+            !CloseSpace(xvit->pt, ptUV))
+          continue;
 
-          ret.emplace_back(HitTriplet{x.hit, u.hit, v.hit, pt});
-          ++nxuv;
-        } // end for xv
-      }   // end for xu
+        double xavg = 0;
+        int nx = 0;
+        if (x.hit) {
+          xavg += x.xpos;
+          ++nx;
+        }
+        if (u.hit) {
+          xavg += u.xpos;
+          ++nx;
+        }
+        if (v.hit) {
+          xavg += v.xpos;
+          ++nx;
+        }
+        xavg /= nx;
 
-      std::cout << tpc << " " << xus.size() << " XUs and " << xvs.size() << " XVs -> " << nxuv
-                << " XUVs" << std::endl;
+        const XYZ pt{
+          xavg, (xu.pt.y + xvit->pt.y + ptUV.y) / 3, (xu.pt.z + xvit->pt.z + ptUV.z) / 3};
 
-    } // end for tpc
+        ret.emplace_back(HitTriplet{x.hit, u.hit, v.hit, pt});
+      } // end for xv
+    }   // end for xu
 
-    std::cout << ret.size() << " XUVs total" << std::endl;
+    nxu = xus.size();
+    nxv = xvs.size();
 
     return ret;
   }
@@ -258,13 +311,13 @@ namespace reco3d {
   }
 
   // -------------------------------------------------------------------------
-  std::vector<ChannelDoublet> TripletFinder::DoubletsXU(geo::TPCID tpc)
+  std::vector<ChannelDoublet> TripletFinder::DoubletsXU(geo::TPCID tpc) const
   {
-    std::vector<ChannelDoublet> ret =
-      DoubletHelper(tpc, fX_by_tpc[tpc], fU_by_tpc[tpc], fUbad_by_tpc[tpc]);
+    std::vector<ChannelDoublet> ret = FindDoublets(
+      tpc, InTPC(fX_by_tpc, tpc), InTPC(fU_by_tpc, tpc), InTPC(fUbad_by_tpc, tpc));
 
     // Find X(bad)+U(good) doublets, have to flip them for the final result
-    for (auto it : DoubletHelper(tpc, fU_by_tpc[tpc], {}, fXbad_by_tpc[tpc])) {
+    for (auto it : FindDoublets(tpc, InTPC(fU_by_tpc, tpc), {}, InTPC(fXbad_by_tpc, tpc))) {
       ret.push_back({it.b, it.a, it.pt});
     }
 
@@ -272,19 +325,47 @@ namespace reco3d {
   }
 
   // -------------------------------------------------------------------------
-  std::vector<ChannelDoublet> TripletFinder::DoubletsXV(geo::TPCID tpc)
+  std::vector<ChannelDoublet> TripletFinder::DoubletsXV(geo::TPCID tpc) const
   {
-    std::vector<ChannelDoublet> ret =
-      DoubletHelper(tpc, fX_by_tpc[tpc], fV_by_tpc[tpc], fVbad_by_tpc[tpc]);
+    std::vector<ChannelDoublet> ret = FindDoublets(
+      tpc, InTPC(fX_by_tpc, tpc), InTPC(fV_by_tpc, tpc), InTPC(fVbad_by_tpc, tpc));
 
     // Find X(bad)+V(good) doublets, have to flip them for the final result
-    for (auto it : DoubletHelper(tpc, fV_by_tpc[tpc], {}, fXbad_by_tpc[tpc])) {
+    for (auto it : FindDoublets(tpc, InTPC(fV_by_tpc, tpc), {}, InTPC(fXbad_by_tpc, tpc))) {
       ret.push_back({it.b, it.a, it.pt});
     }
 
     return ret;
   }
 
+  // -------------------------------------------------------------------------
+  std::vector<ChannelDoublet> TripletFinder::FindDoublets(
+    geo::TPCID tpc,
+    const std::vector<HitOrChan>& ahits,
+    const std::vector<HitOrChan>& bhits,
+    const std::vector<raw::ChannelID_t>& bbads) const
+  {
+    if (!fSortedSweep) return DoubletHelper(tpc, ahits, bhits, bbads);
+
+    std::vector<ChannelDoublet> ret = SweepDoubletHelper(tpc, ahits, bhits, bbads);
+    if (!fCheckSortedSweep) return ret;
+
+    // The sweep depends on the wire geometry (e.g. wrapped induction wires),
+    // so it can be checked against the exhaustive search on a real detector
+    const std::vector<ChannelDoublet> ref = DoubletHelper(tpc, ahits, bhits, bbads);
+    const auto same = [](const ChannelDoublet& x, const ChannelDoublet& y) {
+      return x.a.chan == y.a.chan && x.a.hit == y.a.hit && x.b.chan == y.b.chan &&
+             x.b.hit == y.b.hit;
+    };
+    if (!std::equal(ret.begin(), ret.end(), ref.begin(), ref.end(), same)) {
+      throw cet::exception("TripletFinder")
+        << "SortedSweep found " << ret.size() << " doublets in " << tpc
+        << " but the default search found " << ref.size() << " (or a different list)\n";
+    }
+
+    return ret;
+  }
+
   // -------------------------------------------------------------------------
   std::vector<ChannelDoublet> TripletFinder::DoubletHelper(
     geo::TPCID tpc,
@@ -294,7 +375,7 @@ namespace reco3d {
   {
     std::vector<ChannelDoublet> ret;
 
-    IntersectionCache isect(tpc);
+    IntersectionCache isect(geom, tpc);
 
     auto b_begin = bhits.begin();
 
@@ -322,4 +403,156 @@ namespace reco3d {
 
     return ret;
   }
+
+  // -------------------------------------------------------------------------
+  std::vector<geo::WireID> TripletFinder::WiresInTPC(raw::ChannelID_t chan, geo::TPCID tpc) const
+  {
+    std::vector<geo::WireID> ret;
+    for (geo::WireID wire : geom->ChannelToWire(chan)) {
+      if (geo::TPCID(wire) == tpc) ret.push_back(wire);
+    }
+    return ret;
+  }
+
+  // -------------------------------------------------------------------------
+  TripletFinder::SortedHits TripletFinder::SortHits(geo::TPCID tpc,
+                                                    const std::vector<HitOrChan>& hits,
+                                                    const std::vector<raw::ChannelID_t>& bads) const
+  {
+    SortedHits ret;
+    ret.xmin = hits.empty() ? 0 : hits.front().xpos;
+
+    // Hits arrive sorted in drift position. A channel can have several
+    // (wrapped) wires in the TPC, its hits are indexed under each of them
+    std::vector<std::tuple<unsigned int, unsigned int, size_t>> keys;
+    for (size_t i = 0; i < hits.size(); ++i) {
+      const unsigned int bin = (hits[i].xpos - ret.xmin) / fDistThreshDrift;
+      for (const geo::WireID& wire : WiresInTPC(hits[i].chan, tpc)) {
+        ret.plane = wire;
+        keys.emplace_back(bin, wire.Wire, i);
+      }
+    }
+
+    std::vector<std::pair<unsigned int, size_t>> badKeys;
+    for (size_t i = 0; i < bads.size(); ++i) {
+      for (const geo::WireID& wire : WiresInTPC(bads[i], tpc)) {
+        ret.plane = wire;
+        badKeys.emplace_back(wire.Wire, i);
+      }
+    }
+
+    // By bin, then wire, keeping the drift order within each wire
+    std::stable_sort(keys.begin(), keys.end(), [](const auto& a, const auto& b) {
+      return std::tie(std::get<0>(a), std::get<1>(a)) < std::tie(std::get<0>(b), std::get<1>(b));
+    });
+    std::sort(badKeys.begin(), badKeys.end());
+
+    const unsigned int nbins = keys.empty() ? 0 : std::get<0>(keys.back()) + 1;
+    ret.firstHit.assign(nbins + 1, 0);
+    for (const auto& key : keys) {
+      ++ret.firstHit[std::get<0>(key) + 1];
+      ret.wires.push_back(std::get<1>(key));
+      ret.hits.push_back(std::get<2>(key));
+    }
+    for (unsigned int bin = 0; bin < nbins; ++bin)
+      ret.firstHit[bin + 1] += ret.firstHit[bin];
+
+    for (const auto& key : badKeys) {
+      ret.badWires.push_back(key.first);
+      ret.bads.push_back(key.second);
+    }
+
+    return ret;
+  }
+
+  // -------------------------------------------------------------------------
+  std::vector<ChannelDoublet> TripletFinder::SweepDoubletHelper(
+    geo::TPCID tpc,
+    const std::vector<HitOrChan>& ahits,
+    const std::vector<HitOrChan>& bhits,
+    const std::vector<raw::ChannelID_t>& bbads) const
+  {
+    std::vector<ChannelDoublet> ret;
+
+    const SortedHits b = SortHits(tpc, bhits, bbads);
+    if (!b.plane) return ret;
+
+    const int nbins = b.firstHit.size() - 1;
+
+    IntersectionCache isect(geom, tpc);
+
+    // The ranges of b wires crossing each a channel, one per wire of the
+    // channel in the TPC
+    std::map<raw::ChannelID_t, std::vector<std::pair<unsigned int, unsigned int>>> wireRanges;
+
+    // Indices of the candidate b hits (or bad channels) of one a hit. A b hit
+    // can be found under several wires, or in several ranges, so they are
+    // deduplicated, and sorted to test them in the order of DoubletHelper
+    std::vector<size_t> cands;
+
+    for (const HitOrChan& a : ahits) {
+      auto rangeIt = wireRanges.find(a.chan);
+      if (rangeIt == wireRanges.end()) {
+        std::vector<std::pair<unsigned int, unsigned int>> ranges;
+
+        for (const geo::WireID& awire : WiresInTPC(a.chan, tpc)) {
+          const auto ends = geom->WireEndPoints(awire);
+          const double c0 = geom->WireCoordinate(ends.start(), b.plane);
+          const double c1 = geom->WireCoordinate(ends.end(), b.plane);
+
+          // One wire of margin, the intersection test below is exact
+          ranges.emplace_back(std::max(0., std::floor(std::min(c0, c1)) - 1),
+                              std::max(0., std::ceil(std::max(c0, c1)) + 1));
+        }
+
+        rangeIt = wireRanges.emplace(a.chan, ranges).first;
+      }
+
+      // Bad channels are easy because there's no timing constraint
+      cands.clear();
+      for (const auto& range : rangeIt->second) {
+        for (auto it = std::lower_bound(b.badWires.begin(), b.badWires.end(), range.first);
+             it != b.badWires.end() && *it <= range.second;
+             ++it) {
+          cands.push_back(b.bads[it - b.badWires.begin()]);
+        }
+      }
+      std::sort(cands.begin(), cands.end());
+      cands.erase(std::unique(cands.begin(), cands.end()), cands.end());
+
+      for (size_t i : cands) {
+        geo::WireIDIntersection pt;
+        if (isect(a.chan, bbads[i], pt)) { ret.emplace_back(a, bbads[i], pt); }
+      }
+
+      // Hits within the drift threshold are in this bin or its neighbours
+      const int bin = std::floor((a.xpos - b.xmin) / fDistThreshDrift);
+
+      cands.clear();
+      for (int ibin = std::max(0, bin - 1); ibin <= std::min(nbins - 1, bin + 1); ++ibin) {
+        const auto wbegin = b.wires.begin() + b.firstHit[ibin];
+        const auto wend = b.wires.begin() + b.firstHit[ibin + 1];
+
+        for (const auto& range : rangeIt->second) {
+          for (auto it = std::lower_bound(wbegin, wend, range.first);
+               it != wend && *it <= range.second;
+               ++it) {
+            const size_t i = b.hits[it - b.wires.begin()];
+            if (CloseDrift(bhits[i].xpos, a.xpos)) cands.push_back(i);
+          }
+        }
+      } // end for ibin
+      std::sort(cands.begin(), cands.end());
+      cands.erase(std::unique(cands.begin(), cands.end()), cands.end());
+
+      for (size_t i : cands) {
+        geo::WireIDIntersection pt;
+        if (!isect(a.chan, bhits[i].chan, pt)) continue;
+
+        ret.emplace_back(a, bhits[i], pt);
+      } // end for b
+    }   // end for a
+
+    return ret;
+  }
 }
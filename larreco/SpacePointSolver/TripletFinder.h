@@ -59,13 +59,29 @@ namespace reco3d {
                   const std::vector<raw::ChannelID_t>& vbad,
                   double distThresh,
                   double distThreshDrift,
-                  double xhitOffset);
+                  double xhitOffset,
+                  bool sortedSweep = false,
+                  bool checkSortedSweep = false);
 
     std::vector<HitTriplet> Triplets();
     /// Only search for XU intersections
     std::vector<HitTriplet> TripletsTwoView();
 
   protected:
+    /// Hits and bad channels of one view in one TPC, indexed for
+    /// SweepDoubletHelper. The hits are binned in drift position, with bins as
+    /// wide as the drift threshold, and sorted by wire number within each bin.
+    /// A hit on a channel with several wires in the TPC has one entry per wire.
+    struct SortedHits {
+      geo::PlaneID plane;
+      double xmin;
+      std::vector<size_t> hits;           ///< Index of the hit of each entry
+      std::vector<unsigned int> wires;    ///< Wire number of each entry
+      std::vector<unsigned int> firstHit; ///< Entries of bin i are [firstHit[i], firstHit[i+1])
+      std::vector<size_t> bads;           ///< Index of the bad channel, sorted by wire number
+      std::vector<unsigned int> badWires;
+    };
+
     const geo::GeometryCore* geom;
 
     /// Helper for constructor
@@ -79,17 +95,42 @@ namespace reco3d {
     bool CloseDrift(double xa, double xb) const;
     bool CloseSpace(geo::WireIDIntersection ra, geo::WireIDIntersection rb) const;
 
-    std::vector<ChannelDoublet> DoubletsXU(geo::TPCID tpc);
-    std::vector<ChannelDoublet> DoubletsXV(geo::TPCID tpc);
+    /// The XUV triplets of one TPC, also returning the number of doublets
+    std::vector<HitTriplet> TripletsTPC(geo::TPCID tpc, size_t& nxu, size_t& nxv) const;
+
+    std::vector<ChannelDoublet> DoubletsXU(geo::TPCID tpc) const;
+    std::vector<ChannelDoublet> DoubletsXV(geo::TPCID tpc) const;
+
+    /// DoubletHelper or SweepDoubletHelper, comparing the two if requested
+    std::vector<ChannelDoublet> FindDoublets(geo::TPCID tpc,
+                                             const std::vector<HitOrChan>& ahits,
+                                             const std::vector<HitOrChan>& bhits,
+                                             const std::vector<raw::ChannelID_t>& bbads) const;
 
     std::vector<ChannelDoublet> DoubletHelper(geo::TPCID tpc,
                                               const std::vector<HitOrChan>& ahits,
                                               const std::vector<HitOrChan>& bhits,
                                               const std::vector<raw::ChannelID_t>& bbads) const;
 
+    /// Same result (and order) as DoubletHelper, but only considers the b hits
+    /// in the drift bins around each a hit and on wires crossing it
+    std::vector<ChannelDoublet> SweepDoubletHelper(geo::TPCID tpc,
+                                                   const std::vector<HitOrChan>& ahits,
+                                                   const std::vector<HitOrChan>& bhits,
+                                                   const std::vector<raw::ChannelID_t>& bbads) const;
+
+    /// The wires of chan in tpc (several for wrapped induction channels)
+    std::vector<geo::WireID> WiresInTPC(raw::ChannelID_t chan, geo::TPCID tpc) const;
+
+    SortedHits SortHits(geo::TPCID tpc,
+                        const std::vector<HitOrChan>& hits,
+                        const std::vector<raw::ChannelID_t>& bads) const;
+
     double fDistThresh;
     double fDistThreshDrift;
     double fXHitOffset;
+    bool fSortedSweep;      ///< Use SweepDoubletHelper, and process TPCs in parallel
+    bool fCheckSortedSweep; ///< Throw if SweepDoubletHelper differs from DoubletHelper
 
     std::map<geo::TPCID, std::vector<HitOrChan>> fX_by_tpc;
     std::map<geo::TPCID, std::vector<HitOrChan>> fU_by_tpc;
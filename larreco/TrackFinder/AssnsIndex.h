@@ -0,0 +1,95 @@
+#ifndef ASSNSINDEX_H
+#define ASSNSINDEX_H
+
+#include "canvas/Persistency/Common/Assns.h"
+#include "canvas/Persistency/Common/Ptr.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace trkf {
+
+  /**
+   * @file  larreco/TrackFinder/AssnsIndex.h
+   * @class trkf::AssnsIndex
+   *
+   * @brief Index of an association by the key of its left side.
+   *
+   * Unlike art::FindManyP, the right side elements are returned in the same
+   * order as they appear in the association. The index is built in one pass
+   * over the association, and each look up only visits the matching entries,
+   * so that gathering the hits of all the tracks in an event takes linear time
+   * instead of scanning the association once per track.
+   *
+   * The association must outlive the index.
+   */
+  template <typename L, typename R>
+  class AssnsIndex {
+  public:
+    using Assns_t = art::Assns<L, R>;
+
+    explicit AssnsIndex(Assns_t const& assns) : fAssns(&assns)
+    {
+      // counting sort of the entries by left key, stable in association order
+      for (auto const& assn : assns) {
+        std::size_t const key = assn.first.key();
+        if (key >= fFirst.size()) fFirst.resize(key + 1, 0);
+        ++fFirst[key];
+      }
+      std::size_t start = 0;
+      for (std::size_t& first : fFirst) {
+        std::size_t const count = first;
+        first = start;
+        start += count;
+      }
+      fFirst.push_back(start);
+
+      fEntries.resize(start);
+      std::vector<std::size_t> next(fFirst.begin(), fFirst.end() - 1);
+      for (std::size_t i = 0; i < assns.size(); ++i)
+        fEntries[next[assns[i].first.key()]++] = i;
+    }
+
+    /// Appends the right side of all the pairs with this left side to out
+    void append(art::Ptr<L> const& left, std::vector<art::Ptr<R>>& out) const
+    {
+      if (left.key() + 1 >= fFirst.size()) return;
+      for (std::size_t i = fFirst[left.key()]; i < fFirst[left.key() + 1]; ++i) {
+        auto const& assn = (*fAssns)[fEntries[i]];
+        if (assn.first == left) out.push_back(assn.second);
+      }
+    }
+
+    /// Appends the right side of all the pairs with this left key to out
+    void append(std::size_t leftKey, std::vector<art::Ptr<R>>& out) const
+    {
+      if (leftKey + 1 >= fFirst.size()) return;
+      for (std::size_t i = fFirst[leftKey]; i < fFirst[leftKey + 1]; ++i)
+        out.push_back((*fAssns)[fEntries[i]].second);
+    }
+
+    /// Returns the right side of all the pairs with this left side
+    std::vector<art::Ptr<R>> at(art::Ptr<L> const& left) const
+    {
+      std::vector<art::Ptr<R>> ret;
+      append(left, ret);
+      return ret;
+    }
+
+    /// Returns the right side of all the pairs with this left key
+    std::vector<art::Ptr<R>> at(std::size_t leftKey) const
+    {
+      std::vector<art::Ptr<R>> ret;
+      append(leftKey, ret);
+      return ret;
+    }
+
+  private:
+    Assns_t const* fAssns;
+    std::vector<std::size_t> fFirst;   ///< first entry of each left key, plus the end
+    std::vector<std::size_t> fEntries; ///< association positions sorted by left key
+  };
+
+} // namespace trkf
+
+#endif
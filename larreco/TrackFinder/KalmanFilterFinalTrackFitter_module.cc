@@ -5,8 +5,8 @@
 /// \author G. Cerati
 ///
 
-#include "art/Framework/Core/EDProducer.h"
 #include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Core/SharedProducer.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Handle.h"
 
@@ -32,13 +32,17 @@
 #include "lardataobj/MCBase/MCTrack.h"
 #include "larreco/RecoAlg/TrackKalmanFitter.h"
 #include "larreco/RecoAlg/TrackMomentumCalculator.h"
+#include "larreco/TrackFinder/AssnsIndex.h"
 #include "larreco/TrackFinder/TrackMaker.h"
 
 #include <memory>
+#include <mutex>
+
+#include "tbb/parallel_for.h"
 
 namespace trkf {
 
-  class KalmanFilterFinalTrackFitter : public art::EDProducer {
+  class KalmanFilterFinalTrackFitter : public art::SharedProducer {
   public:
     struct Inputs {
       using Name = fhicl::Name;
@@ -128,6 +132,18 @@ namespace trkf {
                 "It may also modify the trajectory point flags. In order to avoid inconsistencies, "
                 "it has to be used with the following fitter options all set to false: "
                 "sortHitsByPlane, sortOutputHitsMinLength, skipNegProp.")};
+      fhicl::Atom<bool> parallelFit{
+        Name("parallelFit"),
+        Comment("Fit the tracks of an event concurrently, and with fitter.tryBothDirs the two "
+                "directions of each track. The output is the same as with the serial fit, in the "
+                "same order."),
+        false};
+      fhicl::Atom<bool> leanMCS{
+        Name("leanMCS"),
+        Comment("With momFromMSChi2, use the thread-safe "
+                "trkf::TrackMomentumCalculator::GetMomentumMultiScatterChi2Lean(), which makes no "
+                "ROOT graphics objects."),
+        false};
     };
 
     struct Config {
@@ -139,9 +155,9 @@ namespace trkf {
       fhicl::Table<TrackStatePropagator::Config> propagator{Name("propagator")};
       fhicl::Table<TrackKalmanFitter::Config> fitter{Name("fitter")};
     };
-    using Parameters = art::EDProducer::Table<Config>;
+    using Parameters = art::SharedProducer::Table<Config>;
 
-    explicit KalmanFilterFinalTrackFitter(Parameters const& p);
+    explicit KalmanFilterFinalTrackFitter(Parameters const& p, art::ProcessingFrame const&);
 
     // Plugins should not be copied or assigned.
     KalmanFilterFinalTrackFitter(KalmanFilterFinalTrackFitter const&) = delete;
@@ -150,12 +166,13 @@ namespace trkf {
     KalmanFilterFinalTrackFitter& operator=(KalmanFilterFinalTrackFitter&&) = delete;
 
   private:
-    void produce(art::Event& e) override;
+    void produce(art::Event& e, art::ProcessingFrame const&) override;
 
     Parameters p_;
     TrackStatePropagator prop;
     trkf::TrackKalmanFitter kalmanFitter;
     mutable trkf::TrackMomentumCalculator tmc{};
+    mutable std::mutex tmcMutex; ///< The MCS momentum estimate uses state in tmc, unless leanMCS
     bool inputFromPF;
 
     art::InputTag pfParticleInputTag;
@@ -165,12 +182,6 @@ namespace trkf {
     art::InputTag pidInputTag;
     art::InputTag simTrackInputTag;
 
-    std::unique_ptr<art::FindManyP<anab::Calorimetry>> trackCalo;
-    std::unique_ptr<art::FindManyP<anab::ParticleID>> trackId;
-    std::unique_ptr<art::FindManyP<recob::Track>> assocTracks;
-    std::unique_ptr<art::FindManyP<recob::Shower>> assocShowers;
-    std::unique_ptr<art::FindManyP<recob::Vertex>> assocVertices;
-
     double setMomValue(art::Ptr<recob::Track> ptrack,
                        const std::unique_ptr<art::FindManyP<anab::Calorimetry>>& trackCalo,
                        const double pMC,
@@ -182,6 +193,25 @@ namespace trkf {
                     TVector3& mcdir,
                     const std::vector<art::Ptr<recob::Vertex>>* vertices = 0) const;
 
+    /// Input and result of the fit of one track, or of one shower
+    struct FitJob {
+      const recob::Track* track = nullptr;   ///< Track to refit
+      const recob::Shower* shower = nullptr; ///< Shower to fit, if there is no track
+      unsigned int iPF = 0;
+      int pId = 0;
+      double mom = 0.;
+      bool flipDir = false;
+      std::vector<art::Ptr<recob::Hit>> inHits;
+      bool fitok = false;
+      recob::Track outTrack;
+      std::vector<art::Ptr<recob::Hit>> outHits;
+      trkmkr::OptionalOutputs optionals;
+    };
+
+    /// Runs all the fits, concurrently if parallelFit is set
+    void fitJobs(detinfo::DetectorPropertiesData const& detProp, std::vector<FitJob>& jobs) const;
+    void fitJob(detinfo::DetectorPropertiesData const& detProp, FitJob& job) const;
+
     void restoreInputPoints(const recob::Trajectory& track,
                             const std::vector<art::Ptr<recob::Hit>>& inHits,
                             recob::Track& outTrack,
@@ -190,13 +220,17 @@ namespace trkf {
 }
 
 trkf::KalmanFilterFinalTrackFitter::KalmanFilterFinalTrackFitter(
-  trkf::KalmanFilterFinalTrackFitter::Parameters const& p)
-  : EDProducer{p}
+  trkf::KalmanFilterFinalTrackFitter::Parameters const& p,
+  art::ProcessingFrame const&)
+  : SharedProducer{p}
   , p_(p)
   , prop{p_().propagator}
   , kalmanFitter{&prop, p_().fitter}
   , inputFromPF{p_().options().trackFromPF() || p_().options().showerFromPF()}
 {
+  // Association finders are created per event in produce(), the fitter is const
+  async<art::InEvent>();
+  kalmanFitter.setParallelDirs(p_().options().parallelFit());
 
   if (inputFromPF) {
     pfParticleInputTag = art::InputTag(p_().inputs().inputPFParticleLabel());
@@ -289,7 +323,7 @@ trkf::KalmanFilterFinalTrackFitter::KalmanFilterFinalTrackFitter(
   }
 }
 
-void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
+void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e, art::ProcessingFrame const&)
 {
   auto outputTracks = std::make_unique<std::vector<recob::Track>>();
   auto outputHitsMeta =
@@ -326,6 +360,42 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
 
   auto const detProp = art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(e);
 
+  std::unique_ptr<art::FindManyP<anab::Calorimetry>> trackCalo;
+  std::unique_ptr<art::FindManyP<anab::ParticleID>> trackId;
+  std::unique_ptr<art::FindManyP<recob::Track>> assocTracks;
+  std::unique_ptr<art::FindManyP<recob::Shower>> assocShowers;
+  std::unique_ptr<art::FindManyP<recob::Vertex>> assocVertices;
+
+  // stores the result of a successful fit, in the order of the fit jobs
+  auto storeResult = [&](FitJob& job, bool withSpacePoints) {
+    outputTracks->emplace_back(std::move(job.outTrack));
+    art::Ptr<recob::Track> aptr(tid, outputTracks->size() - 1, tidgetter);
+    unsigned int ip = 0;
+    for (auto const& trhit : job.outHits) {
+      //the fitter produces collections with 1-1 match between hits and point
+      recob::TrackHitMeta metadata(ip, -1);
+      outputHitsMeta->addSingle(aptr, trhit, metadata);
+      outputHits->addSingle(aptr, trhit);
+      if (withSpacePoints && p_().options().produceSpacePoints() &&
+          outputTracks->back().HasValidPoint(ip)) {
+        auto& tp = outputTracks->back().Trajectory().LocationAtPoint(ip);
+        double fXYZ[3] = {tp.X(), tp.Y(), tp.Z()};
+        double fErrXYZ[6] = {0};
+        recob::SpacePoint sp(fXYZ, fErrXYZ, -1.);
+        outputSpacePoints->emplace_back(std::move(sp));
+        art::Ptr<recob::SpacePoint> apsp(spid, outputSpacePoints->size() - 1, spidgetter);
+        outputHitSpacePointAssn->addSingle(trhit, apsp);
+      }
+      ip++;
+    }
+    outputHitInfo->emplace_back(job.optionals.trackFitHitInfos());
+    return aptr;
+  };
+
+  // the fit inputs are collected first, then all the fits are run, possibly
+  // in parallel, and finally the outputs are stored in the input order
+  std::vector<FitJob> jobs;
+
   if (inputFromPF) {
 
     auto outputPFAssn = std::make_unique<art::Assns<recob::PFParticle, recob::Track>>();
@@ -340,12 +410,20 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
     assocVertices =
       std::make_unique<art::FindManyP<recob::Vertex>>(inputPFParticle, e, pfParticleInputTag);
 
+    // the indices preserve the order of the associations, unlike FindManyP;
+    // they are built the first time they are needed
+    std::unique_ptr<AssnsIndex<recob::Track, recob::Hit>> tkHits;
+    std::unique_ptr<AssnsIndex<recob::PFParticle, recob::Cluster>> pfClusters;
+    std::unique_ptr<AssnsIndex<recob::Cluster, recob::Hit>> clHits;
+
     for (unsigned int iPF = 0; iPF < inputPFParticle->size(); ++iPF) {
 
       if (p_().options().trackFromPF()) {
         const std::vector<art::Ptr<recob::Track>>& tracks = assocTracks->at(iPF);
-        auto const& tkHitsAssn =
-          *e.getValidHandle<art::Assns<recob::Track, recob::Hit>>(pfParticleInputTag);
+        if (!tkHits) {
+          tkHits = std::make_unique<AssnsIndex<recob::Track, recob::Hit>>(
+            *e.getValidHandle<art::Assns<recob::Track, recob::Hit>>(pfParticleInputTag));
+        }
         const std::vector<art::Ptr<recob::Vertex>>& vertices = assocVertices->at(iPF);
 
         if (p_().options().pFromCalo()) {
@@ -356,53 +434,15 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
 
           const recob::Track& track = *tracks[iTrack];
           art::Ptr<recob::Track> ptrack = tracks[iTrack];
-          const int pId = setPId(iTrack, trackId, inputPFParticle->at(iPF).PdgCode());
-          const double mom = setMomValue(ptrack, trackCalo, pMC, pId);
-          const bool flipDir = setDirFlip(track, mcdir, &vertices);
-
-          //this is not computationally optimal, but at least preserves the order unlike FindManyP
-          std::vector<art::Ptr<recob::Hit>> inHits;
-          for (auto it = tkHitsAssn.begin(); it != tkHitsAssn.end(); ++it) {
-            if (it->first == ptrack)
-              inHits.push_back(it->second);
-            else if (inHits.size() > 0)
-              break;
-          }
-
-          recob::Track outTrack;
-          std::vector<art::Ptr<recob::Hit>> outHits;
-          trkmkr::OptionalOutputs optionals;
-          if (p_().options().produceTrackFitHitInfo()) optionals.initTrackFitInfos();
-          bool fitok = kalmanFitter.fitTrack(detProp,
-                                             track.Trajectory(),
-                                             track.ID(),
-                                             track.VertexCovarianceLocal5D(),
-                                             track.EndCovarianceLocal5D(),
-                                             inHits,
-                                             mom,
-                                             pId,
-                                             flipDir,
-                                             outTrack,
-                                             outHits,
-                                             optionals);
-          if (!fitok) continue;
-
-          if (p_().options().keepInputTrajectoryPoints()) {
-            restoreInputPoints(track.Trajectory().Trajectory(), inHits, outTrack, outHits);
-          }
-
-          outputTracks->emplace_back(std::move(outTrack));
-          art::Ptr<recob::Track> aptr(tid, outputTracks->size() - 1, tidgetter);
-          unsigned int ip = 0;
-          for (auto const& trhit : outHits) {
-            //the fitter produces collections with 1-1 match between hits and point
-            recob::TrackHitMeta metadata(ip, -1);
-            outputHitsMeta->addSingle(aptr, trhit, metadata);
-            outputHits->addSingle(aptr, trhit);
-            ip++;
-          }
-          outputPFAssn->addSingle(art::Ptr<recob::PFParticle>(inputPFParticle, iPF), aptr);
-          outputHitInfo->emplace_back(optionals.trackFitHitInfos());
+
+          FitJob job;
+          job.track = &track;
+          job.iPF = iPF;
+          job.pId = setPId(iTrack, trackId, inputPFParticle->at(iPF).PdgCode());
+          job.mom = setMomValue(ptrack, trackCalo, pMC, job.pId);
+          job.flipDir = setDirFlip(track, mcdir, &vertices);
+          job.inHits = tkHits->at(ptrack);
+          jobs.push_back(std::move(job));
         }
       }
 
@@ -410,70 +450,36 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
         art::Ptr<recob::PFParticle> pPF(inputPFParticle, iPF);
         const std::vector<art::Ptr<recob::Shower>>& showers = assocShowers->at(iPF);
         if (showers.size() == 0) continue;
-        auto const& pfClustersAssn =
-          *e.getValidHandle<art::Assns<recob::PFParticle, recob::Cluster>>(showerInputTag);
-        auto const& clHitsAssn =
-          *e.getValidHandle<art::Assns<recob::Cluster, recob::Hit>>(showerInputTag);
-        std::vector<art::Ptr<recob::Hit>> inHits;
-        for (auto itpf = pfClustersAssn.begin(); itpf != pfClustersAssn.end(); ++itpf) {
-          if (itpf->first == pPF) {
-            art::Ptr<recob::Cluster> clust = itpf->second;
-            for (auto it = clHitsAssn.begin(); it != clHitsAssn.end(); ++it) {
-              if (it->first == clust) inHits.push_back(it->second);
-            }
-          }
-          else if (inHits.size() > 0)
-            break;
+        if (!pfClusters) {
+          pfClusters = std::make_unique<AssnsIndex<recob::PFParticle, recob::Cluster>>(
+            *e.getValidHandle<art::Assns<recob::PFParticle, recob::Cluster>>(showerInputTag));
+          clHits = std::make_unique<AssnsIndex<recob::Cluster, recob::Hit>>(
+            *e.getValidHandle<art::Assns<recob::Cluster, recob::Hit>>(showerInputTag));
         }
+        std::vector<art::Ptr<recob::Hit>> inHits;
+        for (art::Ptr<recob::Cluster> const& clust : pfClusters->at(pPF))
+          clHits->append(clust, inHits);
         for (unsigned int iShower = 0; iShower < showers.size(); ++iShower) {
-          const recob::Shower& shower = *showers[iShower];
-          recob::Track outTrack;
-          std::vector<art::Ptr<recob::Hit>> outHits;
-          trkmkr::OptionalOutputs optionals;
-          if (p_().options().produceTrackFitHitInfo()) optionals.initTrackFitInfos();
-          Point_t pos(shower.ShowerStart().X(), shower.ShowerStart().Y(), shower.ShowerStart().Z());
-          Vector_t dir(shower.Direction().X(), shower.Direction().Y(), shower.Direction().Z());
-          auto cov = SMatrixSym55();
-          auto pid = p_().options().pdgId();
-          auto mom = p_().options().pval();
-          bool fitok = kalmanFitter.fitTrack(detProp,
-                                             pos,
-                                             dir,
-                                             cov,
-                                             inHits,
-                                             std::vector<recob::TrajectoryPointFlags>(),
-                                             shower.ID(),
-                                             mom,
-                                             pid,
-                                             outTrack,
-                                             outHits,
-                                             optionals);
-          if (!fitok) continue;
-
-          outputTracks->emplace_back(std::move(outTrack));
-          art::Ptr<recob::Track> aptr(tid, outputTracks->size() - 1, tidgetter);
-          unsigned int ip = 0;
-          for (auto const& trhit : outHits) {
-            // the fitter produces collections with 1-1 match between hits and point
-            recob::TrackHitMeta metadata(ip, -1);
-            outputHitsMeta->addSingle(aptr, trhit, metadata);
-            outputHits->addSingle(aptr, trhit);
-            if (p_().options().produceSpacePoints() && outputTracks->back().HasValidPoint(ip)) {
-              auto& tp = outputTracks->back().Trajectory().LocationAtPoint(ip);
-              double fXYZ[3] = {tp.X(), tp.Y(), tp.Z()};
-              double fErrXYZ[6] = {0};
-              recob::SpacePoint sp(fXYZ, fErrXYZ, -1.);
-              outputSpacePoints->emplace_back(std::move(sp));
-              art::Ptr<recob::SpacePoint> apsp(spid, outputSpacePoints->size() - 1, spidgetter);
-              outputHitSpacePointAssn->addSingle(trhit, apsp);
-            }
-            ip++;
-          }
-          outputPFAssn->addSingle(art::Ptr<recob::PFParticle>(inputPFParticle, iPF), aptr);
-          outputHitInfo->emplace_back(optionals.trackFitHitInfos());
+          FitJob job;
+          job.shower = showers[iShower].get();
+          job.iPF = iPF;
+          job.pId = p_().options().pdgId();
+          job.mom = p_().options().pval();
+          job.inHits = inHits;
+          jobs.push_back(std::move(job));
         }
       }
     }
+
+    fitJobs(detProp, jobs);
+
+    for (FitJob& job : jobs) {
+      if (!job.fitok) continue;
+      // the space points are produced only for the tracks fit from showers
+      art::Ptr<recob::Track> aptr = storeResult(job, job.shower != nullptr);
+      outputPFAssn->addSingle(art::Ptr<recob::PFParticle>(inputPFParticle, job.iPF), aptr);
+    }
+
     e.put(std::move(outputTracks));
     e.put(std::move(outputHitsMeta));
     e.put(std::move(outputHits));
@@ -488,7 +494,9 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
 
     art::ValidHandle<std::vector<recob::Track>> inputTracks =
       e.getValidHandle<std::vector<recob::Track>>(trackInputTag);
-    auto const& tkHitsAssn = *e.getValidHandle<art::Assns<recob::Track, recob::Hit>>(trackInputTag);
+    // the index preserves the order of the association, unlike FindManyP
+    const AssnsIndex<recob::Track, recob::Hit> tkHits(
+      *e.getValidHandle<art::Assns<recob::Track, recob::Hit>>(trackInputTag));
 
     if (p_().options().pFromCalo()) {
       trackCalo = std::make_unique<art::FindManyP<anab::Calorimetry>>(inputTracks, e, caloInputTag);
@@ -498,66 +506,26 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
       trackId = std::make_unique<art::FindManyP<anab::ParticleID>>(inputTracks, e, pidInputTag);
     }
 
+    jobs.resize(inputTracks->size());
     for (unsigned int iTrack = 0; iTrack < inputTracks->size(); ++iTrack) {
 
       const recob::Track& track = inputTracks->at(iTrack);
       art::Ptr<recob::Track> ptrack(inputTracks, iTrack);
-      const int pId = setPId(iTrack, trackId);
-      const double mom = setMomValue(ptrack, trackCalo, pMC, pId);
-      const bool flipDir = setDirFlip(track, mcdir);
 
-      //this is not computationally optimal, but at least preserves the order unlike FindManyP
-      std::vector<art::Ptr<recob::Hit>> inHits;
-      for (auto it = tkHitsAssn.begin(); it != tkHitsAssn.end(); ++it) {
-        if (it->first == ptrack)
-          inHits.push_back(it->second);
-        else if (inHits.size() > 0)
-          break;
-      }
+      FitJob& job = jobs[iTrack];
+      job.track = &track;
+      job.pId = setPId(iTrack, trackId);
+      job.mom = setMomValue(ptrack, trackCalo, pMC, job.pId);
+      job.flipDir = setDirFlip(track, mcdir);
+      job.inHits = tkHits.at(ptrack);
+    }
 
-      recob::Track outTrack;
-      std::vector<art::Ptr<recob::Hit>> outHits;
-      trkmkr::OptionalOutputs optionals;
-      if (p_().options().produceTrackFitHitInfo()) optionals.initTrackFitInfos();
-      bool fitok = kalmanFitter.fitTrack(detProp,
-                                         track.Trajectory(),
-                                         track.ID(),
-                                         track.VertexCovarianceLocal5D(),
-                                         track.EndCovarianceLocal5D(),
-                                         inHits,
-                                         mom,
-                                         pId,
-                                         flipDir,
-                                         outTrack,
-                                         outHits,
-                                         optionals);
-      if (!fitok) continue;
-
-      if (p_().options().keepInputTrajectoryPoints()) {
-        restoreInputPoints(track.Trajectory().Trajectory(), inHits, outTrack, outHits);
-      }
+    fitJobs(detProp, jobs);
 
-      outputTracks->emplace_back(std::move(outTrack));
-      art::Ptr<recob::Track> aptr(tid, outputTracks->size() - 1, tidgetter);
-      unsigned int ip = 0;
-      for (auto const& trhit : outHits) {
-        //the fitter produces collections with 1-1 match between hits and point
-        recob::TrackHitMeta metadata(ip, -1);
-        outputHitsMeta->addSingle(aptr, trhit, metadata);
-        outputHits->addSingle(aptr, trhit);
-        if (p_().options().produceSpacePoints() && outputTracks->back().HasValidPoint(ip)) {
-          auto& tp = outputTracks->back().Trajectory().LocationAtPoint(ip);
-          double fXYZ[3] = {tp.X(), tp.Y(), tp.Z()};
-          double fErrXYZ[6] = {0};
-          recob::SpacePoint sp(fXYZ, fErrXYZ, -1.);
-          outputSpacePoints->emplace_back(std::move(sp));
-          art::Ptr<recob::SpacePoint> apsp(spid, outputSpacePoints->size() - 1, spidgetter);
-          outputHitSpacePointAssn->addSingle(trhit, apsp);
-        }
-        ip++;
-      }
-      outputHitInfo->emplace_back(optionals.trackFitHitInfos());
+    for (FitJob& job : jobs) {
+      if (job.fitok) storeResult(job, true);
     }
+
     e.put(std::move(outputTracks));
     e.put(std::move(outputHitsMeta));
     e.put(std::move(outputHits));
@@ -569,6 +537,63 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event& e)
   }
 }
 
+void trkf::KalmanFilterFinalTrackFitter::fitJobs(detinfo::DetectorPropertiesData const& detProp,
+                                                 std::vector<FitJob>& jobs) const
+{
+  if (!p_().options().parallelFit()) {
+    for (FitJob& job : jobs)
+      fitJob(detProp, job);
+    return;
+  }
+  // each job only writes its own results, so the output order is preserved
+  tbb::parallel_for(static_cast<std::size_t>(0), jobs.size(), [&](std::size_t iJob) {
+    fitJob(detProp, jobs[iJob]);
+  });
+}
+
+void trkf::KalmanFilterFinalTrackFitter::fitJob(detinfo::DetectorPropertiesData const& detProp,
+                                                FitJob& job) const
+{
+  if (p_().options().produceTrackFitHitInfo()) job.optionals.initTrackFitInfos();
+
+  if (job.track) {
+    const recob::Track& track = *job.track;
+    job.fitok = kalmanFitter.fitTrack(detProp,
+                                      track.Trajectory(),
+                                      track.ID(),
+                                      track.VertexCovarianceLocal5D(),
+                                      track.EndCovarianceLocal5D(),
+                                      job.inHits,
+                                      job.mom,
+                                      job.pId,
+                                      job.flipDir,
+                                      job.outTrack,
+                                      job.outHits,
+                                      job.optionals);
+    if (job.fitok && p_().options().keepInputTrajectoryPoints()) {
+      restoreInputPoints(track.Trajectory().Trajectory(), job.inHits, job.outTrack, job.outHits);
+    }
+    return;
+  }
+
+  const recob::Shower& shower = *job.shower;
+  Point_t pos(shower.ShowerStart().X(), shower.ShowerStart().Y(), shower.ShowerStart().Z());
+  Vector_t dir(shower.Direction().X(), shower.Direction().Y(), shower.Direction().Z());
+  auto cov = SMatrixSym55();
+  job.fitok = kalmanFitter.fitTrack(detProp,
+                                    pos,
+                                    dir,
+                                    cov,
+                                    job.inHits,
+                                    std::vector<recob::TrajectoryPointFlags>(),
+                                    shower.ID(),
+                                    job.mom,
+                                    job.pId,
+                                    job.outTrack,
+                                    job.outHits,
+                                    job.optionals);
+}
+
 void trkf::KalmanFilterFinalTrackFitter::restoreInputPoints(
   const recob::Trajectory& track,
   const std::vector<art::Ptr<recob::Hit>>& inHits,
@@ -613,7 +638,13 @@ double trkf::KalmanFilterFinalTrackFitter::setMomValue(
   const int pId) const
 {
   double result = p_().options().pval();
-  if (p_().options().pFromMSChi2()) { result = tmc.GetMomentumMultiScatterChi2(ptrack); }
+  if (p_().options().pFromMSChi2()) {
+    if (p_().options().leanMCS()) { result = tmc.GetMomentumMultiScatterChi2Lean(ptrack); }
+    else {
+      std::lock_guard<std::mutex> lock(tmcMutex);
+      result = tmc.GetMomentumMultiScatterChi2(ptrack);
+    }
+  }
   else if (p_().options().pFromLength()) {
     result = tmc.GetTrackMomentum(ptrack->Length(), pId);
   }
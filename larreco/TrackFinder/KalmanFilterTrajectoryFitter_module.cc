@@ -25,10 +25,13 @@
 #include "lardataobj/RecoBase/TrackHitMeta.h"
 #include "larreco/RecoAlg/TrackKalmanFitter.h"
 #include "larreco/RecoAlg/TrackMomentumCalculator.h"
+#include "larreco/TrackFinder/AssnsIndex.h"
 #include "larreco/TrackFinder/TrackMaker.h"
 
 #include <memory>
 
+#include "tbb/parallel_for.h"
+
 namespace trkf {
 
   class KalmanFilterTrajectoryFitter : public art::EDProducer {
@@ -90,6 +93,12 @@ namespace trkf {
                 "It may also modify the trajectory point flags. In order to avoid inconsistencies, "
                 "it has to be used with the following fitter options all set to false: "
                 "sortHitsByPlane, sortOutputHitsMinLength, skipNegProp.")};
+      fhicl::Atom<bool> parallelFit{
+        Name("parallelFit"),
+        Comment("Fit the trajectories of an event concurrently, and with fitter.tryBothDirs the "
+                "two directions of each trajectory. The output is the same as with the serial "
+                "fit, in the same order."),
+        false};
     };
 
     struct Config {
@@ -147,6 +156,7 @@ trkf::KalmanFilterTrajectoryFitter::KalmanFilterTrajectoryFitter(
     simTrackInputTag = art::InputTag{p_().inputs().inputMCLabel()};
 
   isTT = p_().inputs().isTrackTrajectory();
+  kalmanFitter.setParallelDirs(p_().options().parallelFit());
 
   produces<std::vector<recob::Track>>();
   produces<art::Assns<recob::Track, recob::Hit>>();
@@ -246,6 +256,8 @@ void trkf::KalmanFilterTrajectoryFitter::produce(art::Event& e)
   const std::vector<recob::Trajectory>* trajectoryVec = nullptr;
   const art::Assns<recob::TrackTrajectory, recob::Hit>* trackTrajectoryHitsAssn = nullptr;
   const art::Assns<recob::Trajectory, recob::Hit>* trajectoryHitsAssn = nullptr;
+  std::unique_ptr<AssnsIndex<recob::TrackTrajectory, recob::Hit>> trackTrajectoryHits;
+  std::unique_ptr<AssnsIndex<recob::Trajectory, recob::Hit>> trajectoryHits;
   if (isTT) {
     bool ok = e.getByLabel(trajectoryInputTag, inputTrackTrajectoryH);
     if (!ok)
@@ -255,6 +267,8 @@ void trkf::KalmanFilterTrajectoryFitter::produce(art::Event& e)
     trackTrajectoryHitsAssn =
       e.getValidHandle<art::Assns<recob::TrackTrajectory, recob::Hit>>(trajectoryInputTag)
         .product();
+    trackTrajectoryHits =
+      std::make_unique<AssnsIndex<recob::TrackTrajectory, recob::Hit>>(*trackTrajectoryHitsAssn);
     nTrajs = trackTrajectoryVec->size();
   }
   else {
@@ -265,66 +279,84 @@ void trkf::KalmanFilterTrajectoryFitter::produce(art::Event& e)
     trajectoryVec = inputTrajectoryH.product();
     trajectoryHitsAssn =
       e.getValidHandle<art::Assns<recob::Trajectory, recob::Hit>>(trajectoryInputTag).product();
+    trajectoryHits =
+      std::make_unique<AssnsIndex<recob::Trajectory, recob::Hit>>(*trajectoryHitsAssn);
     nTrajs = trajectoryVec->size();
   }
 
   auto const detProp = art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(e);
 
-  for (unsigned int iTraj = 0; iTraj < nTrajs; ++iTraj) {
-
-    const recob::TrackTrajectory& inTraj =
-      (isTT ? trackTrajectoryVec->at(iTraj) :
-              recob::TrackTrajectory(trajectoryVec->at(iTraj),
-                                     std::vector<recob::TrajectoryPointFlags>()));
-    // this is not computationally optimal, but at least preserves the order
-    // unlike FindManyP
+  // the inputs are collected first, then all the fits are run, possibly in
+  // parallel, and finally the outputs are stored in the input order
+  struct FitJob {
+    const recob::TrackTrajectory* inTraj = nullptr;
     std::vector<art::Ptr<recob::Hit>> inHits;
-    if (isTT) {
-      for (auto it = trackTrajectoryHitsAssn->begin(); it != trackTrajectoryHitsAssn->end(); ++it) {
-        if (it->first.key() == iTraj)
-          inHits.push_back(it->second);
-        else if (inHits.size() > 0)
-          break;
-      }
-    }
-    else {
-      for (auto it = trajectoryHitsAssn->begin(); it != trajectoryHitsAssn->end(); ++it) {
-        if (it->first.key() == iTraj)
-          inHits.push_back(it->second);
-        else if (inHits.size() > 0)
-          break;
-      }
-    }
-    const int pId = setPId();
-    const double mom = setMomValue(&inTraj, pMC, pId);
-    const bool flipDir = setDirFlip(&inTraj, mcdir);
-
+    int pId = 0;
+    double mom = 0.;
+    bool flipDir = false;
+    bool fitok = false;
     recob::Track outTrack;
     std::vector<art::Ptr<recob::Hit>> outHits;
     trkmkr::OptionalOutputs optionals;
-    if (p_().options().produceTrackFitHitInfo()) optionals.initTrackFitInfos();
-    bool fitok = kalmanFitter.fitTrack(detProp,
-                                       inTraj,
-                                       iTraj,
-                                       SMatrixSym55(),
-                                       SMatrixSym55(),
-                                       inHits, // inFlags,
-                                       mom,
-                                       pId,
-                                       flipDir,
-                                       outTrack,
-                                       outHits,
-                                       optionals);
-    if (!fitok) continue;
-
-    if (p_().options().keepInputTrajectoryPoints()) {
-      restoreInputPoints(inTraj, inHits, outTrack, outHits);
+  };
+  std::vector<FitJob> jobs(nTrajs);
+
+  // a recob::Trajectory input needs its own TrackTrajectory; the reserve
+  // keeps the job pointers into this vector valid
+  std::vector<recob::TrackTrajectory> convertedTrajs;
+  if (!isTT) convertedTrajs.reserve(nTrajs);
+
+  for (unsigned int iTraj = 0; iTraj < nTrajs; ++iTraj) {
+    FitJob& job = jobs[iTraj];
+    if (isTT)
+      job.inTraj = &trackTrajectoryVec->at(iTraj);
+    else {
+      convertedTrajs.emplace_back(trajectoryVec->at(iTraj),
+                                  std::vector<recob::TrajectoryPointFlags>());
+      job.inTraj = &convertedTrajs.back();
+    }
+    // the index preserves the order, unlike FindManyP
+    job.inHits = isTT ? trackTrajectoryHits->at(iTraj) : trajectoryHits->at(iTraj);
+    job.pId = setPId();
+    job.mom = setMomValue(job.inTraj, pMC, job.pId);
+    job.flipDir = setDirFlip(job.inTraj, mcdir);
+  }
+
+  // each fit only writes its own job
+  auto fitJob = [&](std::size_t iTraj) {
+    FitJob& job = jobs[iTraj];
+    if (p_().options().produceTrackFitHitInfo()) job.optionals.initTrackFitInfos();
+    job.fitok = kalmanFitter.fitTrack(detProp,
+                                      *job.inTraj,
+                                      iTraj,
+                                      SMatrixSym55(),
+                                      SMatrixSym55(),
+                                      job.inHits, // inFlags,
+                                      job.mom,
+                                      job.pId,
+                                      job.flipDir,
+                                      job.outTrack,
+                                      job.outHits,
+                                      job.optionals);
+    if (job.fitok && p_().options().keepInputTrajectoryPoints()) {
+      restoreInputPoints(*job.inTraj, job.inHits, job.outTrack, job.outHits);
     }
+  };
+  if (p_().options().parallelFit())
+    tbb::parallel_for(static_cast<std::size_t>(0), jobs.size(), fitJob);
+  else {
+    for (std::size_t iTraj = 0; iTraj < jobs.size(); ++iTraj)
+      fitJob(iTraj);
+  }
+
+  for (unsigned int iTraj = 0; iTraj < nTrajs; ++iTraj) {
+    FitJob& job = jobs[iTraj];
+    if (!job.fitok) continue;
 
-    outputTracks->emplace_back(std::move(outTrack));
+    outputTracks->emplace_back(std::move(job.outTrack));
     art::Ptr<recob::Track> aptr(tid, outputTracks->size() - 1, tidgetter);
     unsigned int ip = 0;
-    for (auto const& trhit : outHits) {
+    for (auto const& trhit : job.outHits) {
       //the fitter produces collections with 1-1 match between hits and point
       recob::TrackHitMeta metadata(ip, -1);
       outputHitsMeta->addSingle(aptr, trhit, metadata);
@@ -340,7 +372,7 @@ void trkf::KalmanFilterTrajectoryFitter::produce(art::Event& e)
       }
       ip++;
     }
-    outputHitInfo->emplace_back(optionals.trackFitHitInfos());
+    outputHitInfo->emplace_back(job.optionals.trackFitHitInfos());
     if (isTT) {
       outputTTjTAssn->addSingle(art::Ptr<recob::TrackTrajectory>(inputTrackTrajectoryH, iTraj),
                                 aptr);
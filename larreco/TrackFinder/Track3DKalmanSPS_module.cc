@@ -183,6 +183,7 @@ namespace trkf {
     int fPdg;
     double fChi2Thresh;
     int fMaxPass;
+    bool fUniformMedium;
 
     genf::GFAbsTrackRep* repMC;
     genf::GFAbsTrackRep* rep;
@@ -238,6 +239,8 @@ namespace trkf {
     fChi2Thresh = pset.get<double>("Chi2HitThresh", 12.0E12); //For Re-pass.
     fSortDim = pset.get<std::string>("SortDirection", "z");   // case sensitive
     fMaxPass = pset.get<int>("MaxPass", 2);                   // mu+ Hypothesis.
+    // Skip the geometry navigation in the material effects: all LAr anyway.
+    fUniformMedium = pset.get<bool>("UniformMedium", false);
     bool fGenfPRINT;
     if (pset.get_if_present("GenfPRINT", fGenfPRINT)) {
       MF_LOG_WARNING("Track3DKalmanSPS_GenFit")
@@ -775,11 +778,13 @@ namespace trkf {
         genf::GFDetPlane planeG((TVector3)(spacepointss[0]->XYZ()), momM);
 
         // Initialize with 1st spacepoint location and ...
-        rep = new genf::RKTrackRep((TVector3)(spacepointss[0]->XYZ()),
-                                   momM,
-                                   posErr,
-                                   momErrFit,
-                                   fPdg); // mu+ hypothesis
+        auto rkRep = new genf::RKTrackRep((TVector3)(spacepointss[0]->XYZ()),
+                                          momM,
+                                          posErr,
+                                          momErrFit,
+                                          fPdg); // mu+ hypothesis
+        rkRep->setUniformMedium(fUniformMedium);
+        rep = rkRep;
 
         genf::GFTrack fitTrack(rep); //initialized with smeared rep
         fitTrack.setPDG(fPdg);
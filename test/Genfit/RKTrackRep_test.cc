@@ -0,0 +1,189 @@
+/**
+ * @file   RKTrackRep_test.cc
+ * @brief  Checks the straight line propagation of RKTrackRep and times it
+ *
+ * Usage:
+ *
+ *     RKTrackRep_test [NTracks]
+ *
+ * Muons are propagated, with their covariance, through a block of liquid argon
+ * from plane to plane, as a Kalman fit does: once in a null field, where the
+ * straight line propagation is used, and once in a negligible field, where the
+ * full Runge-Kutta propagation is used. The straight line propagation is then
+ * repeated with the material effects in uniform medium mode, without geometry
+ * navigation. The predicted states and covariances must agree, and the time
+ * per extrapolation is printed for all of them.
+ *
+ * Other tracks cross a daughter volume, so that the steps are split at its
+ * boundaries. They are propagated with and without the cache of the segments
+ * to the next boundary in the material effects, which must agree as well.
+ */
+
+#include "larreco/Genfit/GFConstField.h"
+#include "larreco/Genfit/GFDetPlane.h"
+#include "larreco/Genfit/GFFieldManager.h"
+#include "larreco/Genfit/GFMaterialEffects.h"
+#include "larreco/Genfit/RKTrackRep.h"
+
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMatrix.h"
+#include "TGeoMedium.h"
+#include "TGeoVolume.h"
+#include "TMatrixT.h"
+#include "TVector3.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+  constexpr int kPlanes = 200;
+  constexpr double kPlanePitch = 1.; // cm
+
+  // the tracks crossing the daughter volume start around this x position
+  constexpr double kSlabX = 500.; // cm
+
+  struct Propagation {
+    std::vector<TMatrixT<Double_t>> states;
+    std::vector<TMatrixT<Double_t>> covs;
+    double time = 0.; // ms
+  };
+
+  void makeGeometry()
+  {
+    new TGeoManager("RKTrackRep_test", "block of liquid argon");
+    auto* lar = new TGeoMaterial("LAr", 39.948, 18., 1.396, 14.0, 83.7);
+    auto* medium = new TGeoMedium("LAr", 1, lar);
+    TGeoVolume* world = gGeoManager->MakeBox("World", medium, 1000., 1000., 1000.);
+    gGeoManager->SetTopVolume(world);
+    // a slab of steel crossed by the tracks starting around kSlabX, between z = 70 and 130 cm
+    auto* steel = new TGeoMaterial("Steel", 55.85, 26., 7.87, 1.76, 17.);
+    auto* steelMedium = new TGeoMedium("Steel", 2, steel);
+    TGeoVolume* slab = gGeoManager->MakeBox("Slab", steelMedium, 100., 100., 30.);
+    world->AddNode(slab, 1, new TGeoTranslation(kSlabX, 0., 100.));
+    gGeoManager->CloseGeometry();
+  }
+
+  Propagation propagate(genf::GFAbsBField* field,
+                        int nTracks,
+                        double x0 = 0.,
+                        bool uniformMedium = false)
+  {
+    genf::GFFieldManager::getInstance()->init(field);
+
+    std::mt19937 engine(12345);
+    std::uniform_real_distribution<double> flat(-1., 1.);
+
+    Propagation result;
+    result.states.reserve(nTracks * kPlanes);
+    result.covs.reserve(nTracks * kPlanes);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int track = 0; track < nTracks; track++) {
+      TVector3 pos(x0 + 10. * flat(engine), 10. * flat(engine), 0.);
+      TVector3 mom(0.3 * flat(engine), 0.3 * flat(engine), 1.);
+      mom.SetMag(1.5 + 0.5 * flat(engine)); // GeV
+
+      genf::RKTrackRep rep(pos, mom, TVector3(0.1, 0.1, 0.1), TVector3(0.1, 0.1, 0.1), 13);
+      rep.setUniformMedium(uniformMedium);
+
+      for (int plane = 1; plane <= kPlanes; plane++) {
+        genf::GFDetPlane pl(
+          TVector3(0., 0., plane * kPlanePitch), TVector3(1., 0., 0.), TVector3(0., 1., 0.));
+
+        TMatrixT<Double_t> state(5, 1);
+        TMatrixT<Double_t> cov(5, 5);
+
+        rep.extrapolate(pl, state, cov);
+        rep.setData(state, pl, &cov);
+
+        result.states.push_back(state);
+        result.covs.push_back(cov);
+      }
+    }
+
+    result.time =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    return result;
+  }
+
+  bool close(const TMatrixT<Double_t>& a, const TMatrixT<Double_t>& b)
+  {
+    for (int i = 0; i < a.GetNrows(); i++) {
+      for (int j = 0; j < a.GetNcols(); j++) {
+        double const tolerance = 1.e-6 * (std::abs(a[i][j]) + std::abs(b[i][j])) + 1.e-12;
+        if (std::abs(a[i][j] - b[i][j]) > tolerance) return false;
+      }
+    }
+    return true;
+  }
+
+} // namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char const** argv)
+{
+  int nErrors(0);
+
+  int nTracks = (argc > 1) ? std::atoi(argv[1]) : 100;
+
+  makeGeometry();
+
+  genf::GFConstField nullField(0., 0., 0.);
+  genf::GFConstField weakField(0., 0., 1.e-12); // kGauss, no visible bending
+
+  Propagation straight = propagate(&nullField, nTracks);
+  Propagation rungeKutta = propagate(&weakField, nTracks);
+
+  Propagation uniform = propagate(&nullField, nTracks, 0., true);
+
+  Propagation cached = propagate(&nullField, nTracks, kSlabX);
+  genf::GFMaterialEffects::getInstance()->setCacheSegments(false);
+  Propagation uncached = propagate(&nullField, nTracks, kSlabX);
+  genf::GFMaterialEffects::getInstance()->setCacheSegments(true);
+
+  for (size_t idx = 0; idx < straight.states.size(); idx++) {
+    for (const Propagation* other : {&rungeKutta, &uniform}) {
+      if (!close(straight.states[idx], other->states[idx]) ||
+          !close(straight.covs[idx], other->covs[idx])) {
+        if (nErrors < 10)
+          std::cerr << "Mismatch with the "
+                    << (other == &uniform ? "uniform medium" : "Runge-Kutta")
+                    << " propagation at track " << idx / kPlanes << ", plane "
+                    << idx % kPlanes + 1 << std::endl;
+        nErrors++;
+      }
+    }
+    if (!close(cached.states[idx], uncached.states[idx]) ||
+        !close(cached.covs[idx], uncached.covs[idx])) {
+      if (nErrors < 10)
+        std::cerr << "Mismatch without the segment cache at track " << idx / kPlanes
+                  << ", plane " << idx % kPlanes + 1 << std::endl;
+      nErrors++;
+    }
+  }
+
+  double nExtrapolations = nTracks * kPlanes;
+
+  std::cout << "Extrapolated " << nTracks << " tracks through " << kPlanes << " planes\n"
+            << "  straight line:  " << straight.time << " ms, "
+            << 1.e3 * straight.time / nExtrapolations << " us per extrapolation\n"
+            << "  Runge-Kutta:    " << rungeKutta.time << " ms, "
+            << 1.e3 * rungeKutta.time / nExtrapolations << " us per extrapolation\n"
+            << "  uniform medium: " << uniform.time << " ms, "
+            << 1.e3 * uniform.time / nExtrapolations << " us per extrapolation\n"
+            << "Through a daughter volume\n"
+            << "  cached:         " << cached.time << " ms, "
+            << 1.e3 * cached.time / nExtrapolations << " us per extrapolation\n"
+            << "  uncached:       " << uncached.time << " ms, "
+            << 1.e3 * uncached.time / nExtrapolations << " us per extrapolation" << std::endl;
+
+  return nErrors;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file   PeakFitterGaussianLM_test.cc
+ * @brief  Compares the fits of PeakFitterGaussianLM with those of PeakFitterGaussian
+ * @see    PeakFitterGaussianLM_tool.cc, PeakFitterGaussian_tool.cc
+ *
+ * Both tools fit the same waveforms, made of up to 14 Gaussian peaks plus
+ * noise on a fixed or floating baseline, starting from the same candidates.
+ * They minimize the same chi square, so the chi square and the peak
+ * parameters must agree within the convergence of the two minimizers. The
+ * parameters are compared in units of their fit uncertainty. The peaks are
+ * overlapping but at least about three sigma apart: closer than that the
+ * minimum is too flat for the two minimizers to stop at the same place.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (PeakFitterGaussianLM_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/HitFinder/HitFinderTools/IPeakFitter.h"
+
+// framework libraries
+#include "art/Utilities/make_tool.h"
+#include "fhiclcpp/ParameterSet.h"
+
+namespace {
+
+  using reco_tool::ICandidateHitFinder;
+  using reco_tool::IPeakFitter;
+
+  struct Peak {
+    double amplitude;
+    double center;
+    double sigma;
+  };
+
+  struct FitResult {
+    IPeakFitter::PeakParamsVec peaks;
+    double chi2PerNDF = 0.;
+    int NDF = 0;
+  };
+
+  std::unique_ptr<IPeakFitter> makeFitter(std::string const& toolType, bool floatBaseline)
+  {
+    fhicl::ParameterSet pset;
+
+    pset.put<std::string>("tool_type", toolType);
+    pset.put("FloatBaseline", floatBaseline);
+    pset.put("Refit", false);
+    pset.put("RefitThreshold", 40.);
+    pset.put("RefitImprovement", 2.);
+
+    return art::make_tool<IPeakFitter>(pset);
+  }
+
+  /// Waveform of the peaks on the baseline, sampled at the tick centers, plus noise
+  std::vector<float> makeWaveform(std::vector<Peak> const& peaks,
+                                  std::size_t nTicks,
+                                  double baseline,
+                                  std::mt19937& engine)
+  {
+    std::normal_distribution<float> noise(0.f, 1.f);
+    std::vector<float> waveform(nTicks);
+
+    for (std::size_t tick = 0; tick < nTicks; ++tick) {
+      double value = baseline;
+      for (auto const& peak : peaks) {
+        double const z = (tick + 0.5 - peak.center) / peak.sigma;
+        value += peak.amplitude * std::exp(-0.5 * z * z);
+      }
+      waveform[tick] = value + noise(engine);
+    }
+
+    return waveform;
+  }
+
+  /// Candidates a little off the true peaks, covering all the waveform but its edges
+  ICandidateHitFinder::HitCandidateVec makeCandidates(std::vector<Peak> const& peaks,
+                                                      std::size_t nTicks)
+  {
+    ICandidateHitFinder::HitCandidateVec candidates;
+
+    for (auto const& peak : peaks)
+      candidates.push_back({0,
+                            0,
+                            0,
+                            0,
+                            0.f,
+                            0.f,
+                            float(peak.center + 0.7),
+                            float(peak.sigma * 1.2),
+                            float(peak.amplitude * 0.9)});
+
+    candidates.front().startTick = 2;
+    candidates.back().stopTick = nTicks - 2;
+
+    return candidates;
+  }
+
+  FitResult fit(IPeakFitter const& fitter,
+                std::vector<float> const& waveform,
+                ICandidateHitFinder::HitCandidateVec const& candidates)
+  {
+    FitResult result;
+
+    fitter.findPeakParameters(waveform, candidates, result.peaks, result.chi2PerNDF, result.NDF);
+
+    return result;
+  }
+
+  void checkSameFit(FitResult const& lm, FitResult const& root)
+  {
+    BOOST_TEST(std::isfinite(root.chi2PerNDF));
+    BOOST_TEST(lm.NDF == root.NDF);
+    BOOST_TEST(lm.chi2PerNDF == root.chi2PerNDF, boost::test_tools::tolerance(1.e-3));
+
+    BOOST_TEST_REQUIRE(lm.peaks.size() == root.peaks.size());
+    for (std::size_t iPeak = 0; iPeak < lm.peaks.size(); ++iPeak) {
+      auto const& lmPeak = lm.peaks[iPeak];
+      auto const& rootPeak = root.peaks[iPeak];
+
+      BOOST_TEST_INFO("peak #" << iPeak);
+      BOOST_TEST(std::abs(lmPeak.peakAmplitude - rootPeak.peakAmplitude) <=
+                 0.5 * lmPeak.peakAmplitudeError);
+      BOOST_TEST_INFO("peak #" << iPeak);
+      BOOST_TEST(std::abs(lmPeak.peakCenter - rootPeak.peakCenter) <=
+                 0.5 * lmPeak.peakCenterError);
+      BOOST_TEST_INFO("peak #" << iPeak);
+      BOOST_TEST(std::abs(lmPeak.peakSigma - rootPeak.peakSigma) <= 0.5 * lmPeak.peakSigmaError);
+    }
+  }
+
+  void compareFitters(bool floatBaseline)
+  {
+    auto const lmFitter = makeFitter("PeakFitterGaussianLM", floatBaseline);
+    auto const rootFitter = makeFitter("PeakFitterGaussian", floatBaseline);
+
+    std::mt19937 engine(12345);
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    double const baseline = floatBaseline ? 3. : 0.;
+
+    for (std::size_t nPeaks : {1, 2, 3, 5, 8, 11, 12, 14}) {
+      for (double spacing : {10., 14.}) { // overlapping and separate peaks
+        std::vector<Peak> peaks;
+        for (std::size_t iPeak = 0; iPeak < nPeaks; ++iPeak)
+          peaks.push_back({10. + 30. * uniform(engine),
+                           14. + spacing * iPeak + 2. * uniform(engine),
+                           2. + 1.5 * uniform(engine)});
+
+        std::size_t const nTicks = std::size_t(28. + spacing * nPeaks);
+        auto const waveform = makeWaveform(peaks, nTicks, baseline, engine);
+        auto const candidates = makeCandidates(peaks, nTicks);
+
+        BOOST_TEST_CONTEXT(nPeaks << " peaks " << spacing << " ticks apart")
+        {
+          checkSameFit(fit(*lmFitter, waveform, candidates),
+                       fit(*rootFitter, waveform, candidates));
+        }
+      }
+    }
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(FixedBaselineTest)
+{
+  compareFitters(false);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(FloatingBaselineTest)
+{
+  compareFitters(true);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file   WaveformMorphology_test.cc
+ * @brief  Checks the running extremum of WaveformMorphology.h and times it
+ * @see    WaveformMorphology.h
+ *
+ * Usage:
+ *
+ *     WaveformMorphology_test [--timing [NWaveforms]]
+ *
+ * The van Herk/Gil-Werman running minimum and maximum are compared with the
+ * window rescanning algorithm previously used by WaveformTools, for short,
+ * float and double waveforms of various lengths and structuring elements.
+ * With --timing, the time per waveform of both is then printed for a range of
+ * window sizes, for noisy waveforms with pulses and for falling ramps, like
+ * long pulse tails, where the extremum leaves the window at every tick.
+ */
+
+#include "larreco/HitFinder/HitFinderTools/WaveformMorphology.h"
+#include "WaveformTestUtils.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+  /// The running extremum as computed by WaveformTools before, by scanning
+  /// the whole window again each time the extremum leaves it
+  template <typename T, typename Compare>
+  void rescanExtremum(const std::vector<T>& input,
+                      int halfWindowSize,
+                      Compare comp,
+                      std::vector<T>& output)
+  {
+    output.resize(input.size());
+
+    auto extremumItr = std::min_element(input.begin(), input.begin() + halfWindowSize, comp);
+
+    auto outItr = output.begin();
+    for (auto inputItr = input.begin(); inputItr != input.end(); inputItr++) {
+      if (std::distance(inputItr, input.end()) > halfWindowSize) {
+        if (std::distance(extremumItr, inputItr) >= halfWindowSize)
+          extremumItr =
+            std::min_element(inputItr - halfWindowSize + 1, inputItr + halfWindowSize + 1, comp);
+        else if (comp(*(inputItr + halfWindowSize), *extremumItr))
+          extremumItr = inputItr + halfWindowSize;
+      }
+      *outItr++ = *extremumItr;
+    }
+  }
+
+  template <typename T>
+  int checkType(std::mt19937& engine, char const* typeName)
+  {
+    int nErrors(0);
+
+    for (int nBins : {1, 2, 3, 7, 20, 21, 64, 333, 1000}) {
+      for (int structuringElement : {0, 1, 2, 3, 4, 7, 20, 21, 50, 2000}) {
+        int const halfWindowSize = structuringElement / 2;
+
+        std::vector<T> const waveform = waveform_test::makeWaveform<T>(engine, nBins);
+        std::vector<T> erosion, dilation, expErosion, expDilation;
+
+        reco_tool::runningExtremum(waveform, halfWindowSize, std::less<T>(), erosion);
+        reco_tool::runningExtremum(waveform, halfWindowSize, std::greater<T>(), dilation);
+
+        if (halfWindowSize < 1) {
+          // no window: the input is left as it is
+          expErosion = expDilation = waveform;
+        }
+        else if (nBins <= halfWindowSize) {
+          // a single window for the whole input
+          expErosion.assign(nBins, *std::min_element(waveform.begin(), waveform.end()));
+          expDilation.assign(nBins, *std::max_element(waveform.begin(), waveform.end()));
+        }
+        else {
+          rescanExtremum(waveform, halfWindowSize, std::less<T>(), expErosion);
+          rescanExtremum(waveform, halfWindowSize, std::greater<T>(), expDilation);
+        }
+
+        if ((erosion != expErosion) || (dilation != expDilation)) {
+          std::cerr << "Mismatch for " << typeName << " waveform of " << nBins
+                    << " bins and structuring element " << structuringElement << std::endl;
+          nErrors++;
+        }
+      }
+    }
+    return nErrors;
+  }
+
+} // namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char const** argv)
+{
+  int nErrors(0);
+
+  waveform_test::Options const options = waveform_test::parseOptions(argc, argv);
+
+  std::mt19937 engine(12345);
+
+  nErrors += checkType<short>(engine, "short");
+  nErrors += checkType<float>(engine, "float");
+  nErrors += checkType<double>(engine, "double");
+
+  if (!options.timing) return nErrors;
+
+  std::vector<std::vector<float>> waveforms, ramps;
+  for (int i = 0; i < options.nWaveforms; i++) {
+    waveforms.push_back(waveform_test::makeWaveform<float>(engine, 500));
+    ramps.push_back(waveforms.back());
+    std::sort(ramps.back().begin(), ramps.back().end(), std::greater<float>());
+  }
+
+  std::cout << "Erosion and dilation of " << options.nWaveforms << " waveforms of 500 ticks [us]\n"
+            << "  structuring element   pulses: rescan  running   ramps: rescan  running"
+            << std::endl;
+
+  std::vector<float> erosion, dilation;
+  float sum = 0; // keeps the work from being optimized away
+
+  for (int structuringElement : {4, 10, 20, 50, 100, 200}) {
+    int const halfWindowSize = structuringElement / 2;
+
+    auto rescan = [&](auto const& in) {
+      rescanExtremum(in, halfWindowSize, std::less<float>(), erosion);
+      rescanExtremum(in, halfWindowSize, std::greater<float>(), dilation);
+      sum += erosion.back() + dilation.front();
+    };
+    auto running = [&](auto const& in) {
+      reco_tool::runningExtremum(in, halfWindowSize, std::less<float>(), erosion);
+      reco_tool::runningExtremum(in, halfWindowSize, std::greater<float>(), dilation);
+      sum += erosion.back() + dilation.front();
+    };
+
+    std::cout << "  " << structuringElement << "\t\t\t"
+              << waveform_test::timePerWaveform(waveforms, rescan) << "\t  "
+              << waveform_test::timePerWaveform(waveforms, running) << "\t    "
+              << waveform_test::timePerWaveform(ramps, rescan) << "\t   "
+              << waveform_test::timePerWaveform(ramps, running) << std::endl;
+  }
+  if (sum == 12345.F) std::cout << " ";
+
+  return nErrors;
+}
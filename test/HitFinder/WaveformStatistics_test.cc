@@ -0,0 +1,225 @@
+/**
+ * @file   WaveformStatistics_test.cc
+ * @brief  Checks the running median and truncated RMS of WaveformStatistics.h
+ * @see    WaveformStatistics.h
+ *
+ * Usage:
+ *
+ *     WaveformStatistics_test [--timing [NWaveforms]]
+ *
+ * The sliding median and the selection based truncated mean/RMS are compared
+ * with the sorting algorithms previously used by WaveformTools, for float and
+ * double waveforms of various lengths, medians over windows of various sizes
+ * and waveforms with narrow and very wide ranges of values. With --timing,
+ * the time per waveform of both is then printed.
+ */
+
+#include "larreco/HitFinder/HitFinderTools/WaveformStatistics.h"
+#include "WaveformTestUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+  /// The median smoothing as computed by WaveformTools before
+  template <typename T>
+  void sortMedian(const std::vector<T>& inputVec, size_t nBins, std::vector<T>& smoothVec)
+  {
+    if (nBins % 2 == 0) nBins++;
+    if (inputVec.size() != smoothVec.size()) smoothVec.resize(inputVec.size());
+
+    std::vector<T> medianVec(nBins);
+    auto startItr = inputVec.begin();
+    auto stopItr = startItr;
+    std::advance(stopItr, inputVec.size() - nBins);
+
+    size_t medianBin = nBins / 2;
+    size_t smoothBin = medianBin;
+
+    std::copy(startItr, startItr + medianBin, smoothVec.begin());
+
+    while (std::distance(startItr, stopItr) > 0) {
+      std::copy(startItr, startItr + nBins, medianVec.begin());
+      std::sort(medianVec.begin(), medianVec.end());
+      smoothVec[smoothBin++] = medianVec[medianBin];
+      startItr++;
+    }
+
+    std::copy(startItr + medianBin, inputVec.end(), smoothVec.begin() + smoothBin);
+  }
+
+  /// The truncated mean and RMS as computed by WaveformTools before
+  template <typename T>
+  void sortTruncatedMeanRMS(const std::vector<T>& waveform,
+                            T& mean,
+                            T& rmsFull,
+                            T& rmsTrunc,
+                            int& nTrunc)
+  {
+    std::map<int, int> frequencyMap;
+    int mpCount(0);
+    int mpVal(0);
+
+    for (const auto& val : waveform) {
+      int intVal = std::round(4. * val);
+      frequencyMap[intVal]++;
+      if (frequencyMap.at(intVal) > mpCount) {
+        mpCount = frequencyMap.at(intVal);
+        mpVal = intVal;
+      }
+    }
+
+    int meanCnt = 0;
+    int meanSum = 0;
+    int binRange = std::min(16, int(frequencyMap.size() / 2 + 1));
+
+    for (int idx = -binRange; idx <= binRange; idx++) {
+      auto neighborItr = frequencyMap.find(mpVal + idx);
+      if (neighborItr != frequencyMap.end() && 5 * neighborItr->second > mpCount) {
+        meanSum += neighborItr->first * neighborItr->second;
+        meanCnt += neighborItr->second;
+      }
+    }
+
+    mean = 0.25 * T(meanSum) / T(meanCnt);
+
+    std::vector<T> locWaveform = waveform;
+    std::transform(locWaveform.begin(),
+                   locWaveform.end(),
+                   locWaveform.begin(),
+                   std::bind(std::minus<T>(), std::placeholders::_1, mean));
+
+    std::sort(locWaveform.begin(), locWaveform.end(), [](const auto& left, const auto& right) {
+      return std::fabs(left) < std::fabs(right);
+    });
+
+    rmsFull = std::inner_product(locWaveform.begin(), locWaveform.end(), locWaveform.begin(), 0.);
+    rmsFull = std::sqrt(std::max(T(0.), rmsFull / T(locWaveform.size())));
+
+    rmsTrunc = std::inner_product(
+      locWaveform.begin(), locWaveform.begin() + meanCnt, locWaveform.begin(), 0.);
+    rmsTrunc = std::sqrt(std::max(T(0.), rmsTrunc / T(meanCnt)));
+    nTrunc = meanCnt;
+  }
+
+  /// The full RMS around mean, summed in the order of the samples
+  template <typename T>
+  T orderedRMS(const std::vector<T>& waveform, T mean)
+  {
+    double sum = 0.;
+    for (const auto& val : waveform)
+      sum += (val - mean) * (val - mean);
+    T rms = sum;
+    return std::sqrt(std::max(T(0.), rms / T(waveform.size())));
+  }
+
+  bool close(double a, double b)
+  {
+    return std::abs(a - b) <= 1.e-12 * std::abs(a) + 1.e-300;
+  }
+
+  template <typename T>
+  int checkType(std::mt19937& engine, char const* typeName)
+  {
+    int nErrors(0);
+
+    for (int nBins : {1, 2, 7, 20, 64, 333, 1000}) {
+      for (double pulseHeight : {50., 1.e5}) {
+        std::vector<T> const waveform =
+          waveform_test::makeWaveform<T>(engine, nBins, pulseHeight);
+
+        for (size_t window : {1, 2, 3, 4, 7, 9, 21, 50}) {
+          if (window > waveform.size()) continue; // the previous smoothing needs a full window
+
+          std::vector<T> smooth, expSmooth;
+          reco_tool::slidingMedian(waveform, window, smooth);
+          sortMedian(waveform, window, expSmooth);
+
+          if (smooth != expSmooth) {
+            std::cerr << "Median mismatch for " << typeName << " waveform of " << nBins
+                      << " bins and window " << window << std::endl;
+            nErrors++;
+          }
+        }
+
+        T mean, rmsFull, rmsTrunc, expMean, expRmsFull, expRmsTrunc;
+        int nTrunc, expNTrunc;
+        reco_tool::truncatedMeanRMS(waveform, mean, rmsFull, rmsTrunc, nTrunc);
+        sortTruncatedMeanRMS(waveform, expMean, expRmsFull, expRmsTrunc, expNTrunc);
+
+        // the sums of squares are accumulated in a different order than after the
+        // sorting, but the full one always in the order of the samples
+        bool const sameFull =
+          std::is_same_v<T, double> ? (rmsFull == orderedRMS(waveform, mean)) : true;
+        if ((nTrunc != expNTrunc) || (mean != expMean) || !sameFull ||
+            !close(rmsFull, expRmsFull) || !close(rmsTrunc, expRmsTrunc)) {
+          std::cerr << "Truncated RMS mismatch for " << typeName << " waveform of " << nBins
+                    << " bins and pulses of " << pulseHeight << ": mean " << mean << " ("
+                    << expMean << "), RMS " << rmsFull << " (" << expRmsFull << "), truncated "
+                    << rmsTrunc << " (" << expRmsTrunc << ") of " << nTrunc << " (" << expNTrunc
+                    << ")" << std::endl;
+          nErrors++;
+        }
+      }
+    }
+    return nErrors;
+  }
+
+} // namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char const** argv)
+{
+  int nErrors(0);
+
+  waveform_test::Options const options = waveform_test::parseOptions(argc, argv);
+
+  std::mt19937 engine(12345);
+
+  nErrors += checkType<float>(engine, "float");
+  nErrors += checkType<double>(engine, "double");
+
+  if (!options.timing) return nErrors;
+
+  using waveform_test::timePerWaveform;
+
+  std::vector<std::vector<float>> waveforms;
+  for (int i = 0; i < options.nWaveforms; i++)
+    waveforms.push_back(waveform_test::makeWaveform<float>(engine, 500));
+
+  std::vector<float> smooth;
+  float mean, rmsFull, rmsTrunc;
+  int nTrunc;
+
+  std::cout << "Time per waveform of 500 ticks [us]:  sorting    selection\n";
+  for (size_t window : {3, 9, 31}) {
+    std::cout << "  median over " << window << " ticks:\t\t"
+              << timePerWaveform(waveforms,
+                                 [&](auto const& in) { sortMedian(in, window, smooth); })
+              << "\t   "
+              << timePerWaveform(
+                   waveforms,
+                   [&](auto const& in) { reco_tool::slidingMedian(in, window, smooth); })
+              << "\n";
+  }
+  std::cout << "  truncated mean/RMS:\t\t"
+            << timePerWaveform(
+                 waveforms,
+                 [&](auto const& in) { sortTruncatedMeanRMS(in, mean, rmsFull, rmsTrunc, nTrunc); })
+            << "\t   "
+            << timePerWaveform(waveforms,
+                               [&](auto const& in) {
+                                 reco_tool::truncatedMeanRMS(in, mean, rmsFull, rmsTrunc, nTrunc);
+                               })
+            << std::endl;
+
+  return nErrors;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file   WaveformTestUtils.h
+ * @brief  Waveforms and options shared by the WaveformTools algorithm tests
+ *
+ * Usage of the tests:
+ *
+ *     Waveform<...>_test [--timing [NWaveforms]]
+ *
+ * By default only the correctness checks are run. With `--timing`, the time
+ * per waveform of the new and of the previous algorithm is also printed, for
+ * NWaveforms waveforms (1000 by default).
+ */
+
+#ifndef WAVEFORMTESTUTILS_H
+#define WAVEFORMTESTUTILS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace waveform_test {
+
+  /// Options from the command line of a test
+  struct Options {
+    bool timing = false; ///< whether to time the algorithms
+    int nWaveforms = 1000; ///< number of waveforms to time them on
+  };
+
+  inline Options parseOptions(int argc, char const** argv)
+  {
+    Options options;
+    if (argc > 1) {
+      if (std::strcmp(argv[1], "--timing") != 0) {
+        std::cerr << "Usage: " << argv[0] << " [--timing [NWaveforms]]" << std::endl;
+        std::exit(1);
+      }
+      options.timing = true;
+      if (argc > 2) options.nWaveforms = std::atoi(argv[2]);
+    }
+    return options;
+  }
+
+  /// Integer ADC counts: a pedestal with noise and a few triangular pulses on top
+  template <typename T>
+  std::vector<T> makeWaveform(std::mt19937& engine, int nBins, double pulseHeight = 50.)
+  {
+    std::normal_distribution<double> noise(0., 3.);
+    std::uniform_int_distribution<int> position(0, nBins - 1);
+
+    std::vector<double> adc(nBins, 0.);
+    for (int pulse = 0; pulse < 1 + nBins / 200; pulse++) {
+      int const peak = position(engine);
+      for (int bin = std::max(0, peak - 10); bin < std::min(nBins, peak + 10); bin++)
+        adc[bin] += pulseHeight * (10 - std::abs(bin - peak));
+    }
+    for (auto& value : adc)
+      value = std::round(value + 400. + noise(engine));
+    return std::vector<T>(adc.begin(), adc.end());
+  }
+
+  /// Average time of function over all the waveforms [us]
+  template <typename Function>
+  double timePerWaveform(const std::vector<std::vector<float>>& waveforms, Function function)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (auto const& waveform : waveforms)
+      function(waveform);
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+             .count() /
+           waveforms.size();
+  }
+
+} // namespace waveform_test
+
+#endif // WAVEFORMTESTUTILS_H
@@ -0,0 +1,219 @@
+/**
+ * @file   CMergeManager_test.cc
+ * @brief  Test for the broad phase and the parallel pairs of cmtool::CMergeManager
+ * @see    CMergeManager.h
+ *
+ * Synthetic clusters on three planes, with quadrilateral polygons of various
+ * sizes scattered so that some overlap, contain or are close to one another,
+ * are merged in one pass with RunMerge() by merging algorithms and AND/OR
+ * combinations of them in a CBAlgoArray. The merges with BroadPhase() and/or
+ * ParallelPairs() must be the same as the ones of the plain serial loop over
+ * all the pairs, and none of the pairs pruned by the broad phase may be one
+ * the algorithm would merge.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <utility>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (CMergeManager_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "lardata/Utilities/PxUtils.h"
+#include "larreco/RecoAlg/CMTool/CMTAlgMerge/CBAlgoArray.h"
+#include "larreco/RecoAlg/CMTool/CMTAlgMerge/CBAlgoPolyContain.h"
+#include "larreco/RecoAlg/CMTool/CMTAlgMerge/CBAlgoPolyOverlap.h"
+#include "larreco/RecoAlg/CMTool/CMTAlgMerge/CBAlgoPolyShortestDist.h"
+#include "larreco/RecoAlg/CMTool/CMToolBase/CMergeBookKeeper.h"
+#include "larreco/RecoAlg/CMTool/CMToolBase/CMergeManager.h"
+#include "larreco/RecoAlg/ClusterRecoUtil/ClusterParamsAlg.h"
+#include "larreco/RecoAlg/ClusterRecoUtil/Polygon2D.h"
+
+namespace {
+
+  using Clusters_t = std::vector<cluster::ClusterParamsAlg>;
+  using Pairs_t = std::vector<std::pair<std::size_t, std::size_t>>;
+  using Result_t = std::vector<std::vector<unsigned short>>;
+
+  /// Runs a single merging pass, without the cluster parameters which need the geometry
+  class TestMergeManager : public cmtool::CMergeManager {
+  public:
+    Result_t Merge(Clusters_t const& clusters)
+    {
+      ComputePriority(clusters);
+      _merge_algo->EventBegin(clusters);
+      _merge_algo->IterationBegin(clusters);
+
+      cmtool::CMergeBookKeeper bk;
+      bk.Reset(clusters.size());
+      RunMerge(clusters, bk);
+
+      _merge_algo->IterationEnd();
+      _merge_algo->EventEnd();
+      return bk.GetResult();
+    }
+
+    Pairs_t Candidates(Clusters_t const& clusters)
+    {
+      ComputePriority(clusters);
+      return MergeCandidates(clusters, std::vector<bool>(clusters.size(), true));
+    }
+  };
+
+  /// Clusters with hits on one plane and a quadrilateral polygon around a center
+  Clusters_t makeClusters()
+  {
+    std::mt19937 engine(2468);
+    std::uniform_real_distribution<float> center(0.F, 60.F);
+    std::uniform_real_distribution<float> halfSize(0.5F, 4.F);
+    std::uniform_real_distribution<float> jitter(-0.2F, 0.2F);
+    std::uniform_int_distribution<int> nHits(3, 30);
+
+    Clusters_t clusters;
+    float cw = 0.F, ct = 0.F; // center of the last cluster
+    for (unsigned int plane = 0; plane < 3; ++plane) {
+      for (int i = 0; i < 40; ++i) {
+        float hw = 0.2F, ht = 0.2F;
+
+        // one in five is a small one inside the previous cluster
+        if (i % 5 != 4) {
+          cw = center(engine);
+          ct = center(engine);
+          hw = halfSize(engine);
+          ht = halfSize(engine);
+        }
+
+        std::vector<util::PxHit> hits(nHits(engine));
+        for (auto& hit : hits) {
+          hit.plane = plane;
+          hit.w = cw;
+          hit.t = ct;
+          hit.charge = 1.;
+        }
+
+        cluster::ClusterParamsAlg c;
+        c.SetVerbose(false);
+        c.SetMinNHits(1);
+        c.SetHits(hits);
+        c.fParams.N_Hits = hits.size();
+        c.fParams.PolyObject = Polygon2D({{cw - hw + jitter(engine), ct - ht + jitter(engine)},
+                                          {cw + hw + jitter(engine), ct - ht + jitter(engine)},
+                                          {cw + hw + jitter(engine), ct + ht + jitter(engine)},
+                                          {cw - hw + jitter(engine), ct + ht + jitter(engine)}});
+        clusters.push_back(std::move(c));
+      }
+    }
+    return clusters;
+  }
+
+  /// Merges with all the combinations of the switches are the same as the plain ones
+  void checkMerges(cmtool::CBoolAlgoBase& algo)
+  {
+    Clusters_t const clusters = makeClusters();
+
+    TestMergeManager plain;
+    plain.AddMergeAlgo(&algo);
+    Result_t const expected = plain.Merge(clusters);
+    Pairs_t const allPairs = plain.Candidates(clusters);
+
+    // some merging, but not everything
+    BOOST_TEST(expected.size() < clusters.size());
+    BOOST_TEST(expected.size() > 3U);
+
+    for (bool const broad : {false, true}) {
+      for (bool const parallel : {false, true}) {
+        BOOST_TEST_MESSAGE("BroadPhase(" << broad << "), ParallelPairs(" << parallel << ")");
+        TestMergeManager manager;
+        manager.AddMergeAlgo(&algo);
+        manager.BroadPhase(broad);
+        manager.ParallelPairs(parallel);
+        BOOST_CHECK(manager.Merge(clusters) == expected);
+      }
+    }
+
+    // the pairs left out by the broad phase are not merged
+    TestMergeManager pruning;
+    pruning.AddMergeAlgo(&algo);
+    pruning.BroadPhase();
+    Pairs_t const candidates = pruning.Candidates(clusters);
+    BOOST_TEST(candidates.size() < allPairs.size());
+
+    unsigned int nPrunedMerged = 0;
+    for (auto const& pair : allPairs) {
+      if (std::find(candidates.begin(), candidates.end(), pair) != candidates.end()) continue;
+      if (algo.Bool(clusters[pair.first], clusters[pair.second])) ++nPrunedMerged;
+    }
+    BOOST_TEST(nPrunedMerged == 0U);
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(PolyOverlapTest)
+{
+  cmtool::CBAlgoPolyOverlap overlap;
+  checkMerges(overlap);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(PolyShortestDistTest)
+{
+  cmtool::CBAlgoPolyShortestDist dist;
+  dist.SetMinDistSquared(4.);
+  checkMerges(dist);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(OverlapOrContainTest)
+{
+  cmtool::CBAlgoPolyOverlap overlap;
+  cmtool::CBAlgoPolyContain contain;
+  cmtool::CBAlgoArray array;
+  array.AddAlgo(&overlap, false);
+  array.AddAlgo(&contain, false);
+  checkMerges(array);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(OverlapOrShortestDistTest)
+{
+  cmtool::CBAlgoPolyOverlap overlap;
+  cmtool::CBAlgoPolyShortestDist dist;
+  dist.SetMinDistSquared(9.);
+  cmtool::CBAlgoArray array;
+  array.AddAlgo(&overlap, false);
+  array.AddAlgo(&dist, false);
+  checkMerges(array);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ShortestDistAndOverlapOrContainTest)
+{
+  // (dist AND overlap) OR contain
+  cmtool::CBAlgoPolyShortestDist dist;
+  dist.SetMinDistSquared(9.);
+  cmtool::CBAlgoPolyOverlap overlap;
+  cmtool::CBAlgoPolyContain contain;
+  cmtool::CBAlgoArray array;
+  array.AddAlgo(&dist, false);
+  array.AddAlgo(&overlap, true);
+  array.AddAlgo(&contain, false);
+  checkMerges(array);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(OverlapAndShortestDistTest)
+{
+  cmtool::CBAlgoPolyOverlap overlap;
+  cmtool::CBAlgoPolyShortestDist dist;
+  dist.SetMinDistSquared(1.);
+  cmtool::CBAlgoArray array;
+  array.AddAlgo(&overlap, false);
+  array.AddAlgo(&dist, true);
+  checkMerges(array);
+}
@@ -0,0 +1,152 @@
+/**
+ * @file   HoughTransform_test.cc
+ * @brief  Test for the accumulators of cluster::HoughTransform
+ * @see    HoughBaseAlg.h
+ *
+ * The same points are added to (and some subtracted from) a transform with the
+ * counter maps and one with the dense tiled accumulator. The maxima returned
+ * for each point, the overall maximum and the content of every cell must be
+ * the same. The batch fill of the dense accumulator, in parallel over slices
+ * of angles, is compared in the same way. Finally the tiles are checked with
+ * negative distances, which fall before the first tile.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <array>
+#include <random>
+#include <utility>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (HoughTransform_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/HoughBaseAlg.h"
+
+namespace {
+
+  constexpr unsigned int kDx = 240;
+  constexpr unsigned int kDy = 400;
+  constexpr float kRhoResolution = 2.;
+  constexpr unsigned int kNumAngles = 1080; // three slices of the parallel fill
+
+  /// 60 points on a line, 40 random ones and a few outside the accumulator
+  std::vector<std::pair<int, int>> makePoints()
+  {
+    std::mt19937 engine(4321);
+    std::uniform_int_distribution<int> wire(0, kDx);
+    std::uniform_int_distribution<int> tick(0, kDy);
+
+    std::vector<std::pair<int, int>> points;
+    for (int x = 0; x < 60; ++x)
+      points.emplace_back(2 * x + 50, 3 * x + 20);
+    for (int i = 0; i < 40; ++i)
+      points.emplace_back(wire(engine), tick(engine));
+    points.emplace_back(-1, 10);
+    points.emplace_back(10, kDy + 1);
+    std::shuffle(points.begin(), points.end(), engine);
+    return points;
+  }
+
+  void checkSameCells(cluster::HoughTransform& maps, cluster::HoughTransform& dense)
+  {
+    int numRows = 0, numCols = 0;
+    maps.GetAccumSize(numRows, numCols);
+    int denseRows = 0, denseCols = 0;
+    dense.GetAccumSize(denseRows, denseCols);
+    BOOST_TEST(denseRows == numRows);
+    BOOST_TEST(denseCols == numCols);
+    BOOST_TEST(dense.NumAccumulated() == maps.NumAccumulated());
+
+    int xMax = -1, yMax = -1;
+    int const maxVal = maps.GetMax(xMax, yMax);
+    int denseXMax = -1, denseYMax = -1;
+    BOOST_TEST(dense.GetMax(denseXMax, denseYMax) == maxVal);
+    BOOST_TEST(denseXMax == xMax);
+    BOOST_TEST(denseYMax == yMax);
+
+    unsigned int nDifferent = 0;
+    for (int row = 0; row < numRows; ++row)
+      for (int col = 0; col < numCols; ++col)
+        if (dense.GetCell(row, col) != maps.GetCell(row, col)) ++nDifferent;
+    BOOST_TEST(nDifferent == 0U);
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(AddPointReturnMaxTest)
+{
+  cluster::HoughTransform maps, dense;
+  maps.Init(kDx, kDy, kRhoResolution, kNumAngles, false);
+  dense.Init(kDx, kDy, kRhoResolution, kNumAngles, true);
+
+  auto const points = makePoints();
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    auto const [x, y] = points[i];
+    std::array<int, 3> const max = maps.AddPointReturnMax(x, y);
+    std::array<int, 3> const denseMax = dense.AddPointReturnMax(x, y);
+    BOOST_CHECK(denseMax == max);
+
+    // take back every fifth point added so far
+    if (i % 5 == 4) {
+      auto const [sx, sy] = points[i - 2];
+      BOOST_TEST(dense.SubtractPoint(sx, sy) == maps.SubtractPoint(sx, sy));
+    }
+  }
+
+  checkSameCells(maps, dense);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(AddPointsTest)
+{
+  cluster::HoughTransform maps, dense;
+  maps.Init(kDx, kDy, kRhoResolution, kNumAngles, false);
+  dense.Init(kDx, kDy, kRhoResolution, kNumAngles, true);
+
+  auto const points = makePoints();
+  for (auto const& [x, y] : points)
+    maps.AddPointReturnMax(x, y);
+  dense.AddPoints(points);
+
+  checkSameCells(maps, dense);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(TilesNegativeDistanceTest)
+{
+  using Tiles_t = cluster::HoughTransformTiles;
+
+  Tiles_t tiles;
+  tiles.Init(16);
+
+  // a range across the tiles before distance 0, and one overlapping it
+  Tiles_t::Max_t max{{0, 0, 0}};
+  tiles.AddRange(9, -200, -100, 1, max);
+  BOOST_TEST(max[0] == 1);
+  BOOST_TEST(max[1] == -200);
+  BOOST_TEST(max[2] == 9);
+  tiles.AddRange(9, -130, 10, 1, max);
+  BOOST_TEST(max[0] == 2);
+  BOOST_TEST(max[1] == -130);
+
+  for (int dist = -250; dist < 50; ++dist) {
+    int const expected = (dist >= -200 && dist < -100) + (dist >= -130 && dist < 10);
+    BOOST_TEST(tiles.Get(9, dist) == expected);
+    BOOST_TEST(tiles.Get(8, dist) == 0);
+    BOOST_TEST(tiles.Get(10, dist) == 0);
+  }
+
+  Tiles_t::Max_t rowMax{{0, 0, 0}};
+  tiles.GetMax(9, rowMax);
+  BOOST_TEST(rowMax[0] == 2);
+  BOOST_TEST(rowMax[1] == -130);
+  BOOST_TEST(rowMax[2] == 9);
+
+  tiles.Set(9, -1000, 5);
+  BOOST_TEST(tiles.Get(9, -1000) == 5);
+  BOOST_TEST(tiles.Get(9, -999) == 0);
+}
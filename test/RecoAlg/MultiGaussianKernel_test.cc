@@ -0,0 +1,91 @@
+/**
+ * @file   MultiGaussianKernel_test.cc
+ * @brief  Test for the functions in MultiGaussianKernel.h
+ * @see    MultiGaussianKernel.h
+ *
+ * The vectorized kernel is compared with a plain std::exp implementation for
+ * a range of numbers of Gaussians and of points (to exercise the partial
+ * vectors at the end of the range).
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (MultiGaussianKernel_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/MultiGaussianKernel.h"
+
+namespace {
+
+  struct Reference {
+    double value;
+    double scale; ///< sum of the absolute values of the terms
+    std::vector<double> jacobian;
+  };
+
+  Reference evaluate(std::vector<double> const& params, double baseline, double x)
+  {
+    Reference ref{baseline, std::abs(baseline), {}};
+
+    for (std::size_t iPar = 0; iPar < params.size(); iPar += 3) {
+      double const z = (x - params[iPar + 1]) / params[iPar + 2];
+      double const expo = std::exp(-0.5 * z * z);
+      double const value = params[iPar] * expo;
+
+      ref.value += value;
+      ref.scale += std::abs(value);
+      ref.jacobian.push_back(expo);
+      ref.jacobian.push_back(value * z / params[iPar + 2]);
+      ref.jacobian.push_back(value * z * z / params[iPar + 2]);
+    }
+
+    return ref;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(MultiGaussianKernelTest)
+{
+  BOOST_TEST_MESSAGE("Kernel instruction set: " << hit::MultiGaussianKernelInstructionSet());
+
+  for (std::size_t nGaus = 0; nGaus <= 5; ++nGaus) {
+    std::vector<double> params;
+    for (std::size_t iGaus = 0; iGaus < nGaus; ++iGaus) {
+      params.push_back(50. - 15. * iGaus);  // amplitude
+      params.push_back(10. + 12.3 * iGaus); // mean
+      params.push_back(1.5 + 0.7 * iGaus);  // sigma
+    }
+
+    for (std::size_t nPoints = 1; nPoints <= 77; nPoints += 4) {
+      double const xStart = -3.25;
+      double const baseline = 0.5;
+      std::size_t const stride = nPoints + 3;
+
+      std::vector<double> model(nPoints), modelOnly(nPoints);
+      std::vector<double> jacobian(3 * nGaus * stride);
+
+      hit::EvaluateMultiGaussianAndJacobian(
+        params.data(), nGaus, baseline, xStart, nPoints, model.data(), jacobian.data(), stride);
+      hit::EvaluateMultiGaussian(params.data(), nGaus, baseline, xStart, nPoints, modelOnly.data());
+
+      for (std::size_t iPoint = 0; iPoint < nPoints; ++iPoint) {
+        Reference const ref = evaluate(params, baseline, xStart + iPoint);
+
+        BOOST_TEST(model[iPoint] == modelOnly[iPoint]);
+        BOOST_TEST(std::abs(model[iPoint] - ref.value) <= 1e-12 * ref.scale);
+
+        for (std::size_t iPar = 0; iPar < 3 * nGaus; ++iPar) {
+          double const expected = ref.jacobian[iPar];
+          BOOST_TEST(std::abs(jacobian[iPar * stride + iPoint] - expected) <=
+                     1e-12 * std::abs(expected) + 1e-300);
+        }
+      } // for points
+    }   // for number of points
+  }     // for number of Gaussians
+} // BOOST_AUTO_TEST_CASE(MultiGaussianKernelTest)
@@ -0,0 +1,175 @@
+/**
+ * @file   PooledAllocator_test.cc
+ * @brief  Test for the pooled list allocator of the 3D clustering
+ * @see    PooledAllocator.h
+ *
+ * Lists using reco::PooledAllocator are filled, spliced and sorted like
+ * standard lists. Nodes allocated on a thread and freed on another one must go
+ * back to the thread which allocated them, also after that thread has exited,
+ * and the chunks must be given back by ReleasePooledMemory once all their nodes
+ * are free. Each test case uses its own element type so that each has a pool
+ * of its own.
+ */
+
+// C/C++ standard libraries
+#include <algorithm>
+#include <set>
+#include <thread>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (PooledAllocator_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/Cluster3DAlgs/PooledAllocator.h"
+
+namespace {
+
+  /// Payload of a given size, to give each test case its own pool
+  template <std::size_t N>
+  struct Payload {
+    int value = 0;
+    char padding[N];
+  };
+
+  template <std::size_t N>
+  using PayloadAllocator = reco::PooledAllocator<Payload<N>>;
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ListInterfaceTest)
+{
+  reco::PooledList<int> list1, list2;
+  for (int i = 0; i < 5000; ++i)
+    (i % 2 ? list1 : list2).push_front(i);
+
+  list1.splice(list1.end(), list2);
+  BOOST_TEST(list2.empty());
+  BOOST_TEST(list1.size() == 5000U);
+
+  list1.sort();
+  list1.remove_if([](int i) { return i % 3 == 0; });
+  BOOST_TEST(std::is_sorted(list1.begin(), list1.end()));
+  BOOST_TEST(list1.size() == 3333U);
+  BOOST_TEST(list1.front() == 1);
+  BOOST_TEST(list1.back() == 4999);
+
+  reco::PooledList<int> list3(std::move(list1));
+  BOOST_TEST(list3.size() == 3333U);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ReleaseTest)
+{
+  using Allocator_t = PayloadAllocator<40>;
+  Allocator_t allocator;
+
+  std::vector<Payload<40>*> nodes;
+  for (int i = 0; i < 5000; ++i)
+    nodes.push_back(allocator.allocate(1));
+  std::size_t const nChunks = Allocator_t::numChunks();
+  BOOST_TEST(nChunks > 1U);
+
+  // nodes still in use: nothing can be freed
+  reco::ReleasePooledMemory();
+  BOOST_TEST(Allocator_t::numChunks() == nChunks);
+
+  // the nodes are recycled before any new chunk is made
+  std::set<Payload<40>*> const used(nodes.begin(), nodes.end());
+  for (auto* node : nodes)
+    allocator.deallocate(node, 1);
+  for (auto& node : nodes)
+    node = allocator.allocate(1);
+  BOOST_TEST(Allocator_t::numChunks() == nChunks);
+  BOOST_CHECK(std::set<Payload<40>*>(nodes.begin(), nodes.end()) == used);
+
+  {
+    reco::PooledMemoryScope scope;
+    for (auto* node : nodes)
+      allocator.deallocate(node, 1);
+  }
+  BOOST_TEST(Allocator_t::numChunks() == 0U);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(CrossThreadFreeTest)
+{
+  using Allocator_t = PayloadAllocator<48>;
+
+  // the worker allocates, another thread frees, then the worker allocates again:
+  // the nodes must come back to the worker instead of new chunks being made
+  std::size_t nChunks = 0, nChunksReused = 0, nChunksAfterRelease = 1;
+
+  std::thread worker([&] {
+    Allocator_t allocator;
+    std::vector<Payload<48>*> nodes;
+    for (int i = 0; i < 3000; ++i)
+      nodes.push_back(allocator.allocate(1));
+    nChunks = Allocator_t::numChunks();
+
+    std::thread freeing([&] {
+      for (auto* node : nodes)
+        allocator.deallocate(node, 1);
+    });
+    freeing.join();
+
+    for (auto& node : nodes)
+      node = allocator.allocate(1);
+    nChunksReused = Allocator_t::numChunks();
+
+    // nodes freed by another thread are only given back once drained
+    std::thread freeingAgain([&] {
+      for (auto* node : nodes)
+        allocator.deallocate(node, 1);
+    });
+    freeingAgain.join();
+
+    reco::ReleasePooledMemory();
+    nChunksAfterRelease = Allocator_t::numChunks();
+  });
+  worker.join();
+
+  BOOST_TEST(nChunks > 1U);
+  BOOST_TEST(nChunksReused == nChunks);
+  BOOST_TEST(nChunksAfterRelease == 0U);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(ExitedThreadTest)
+{
+  using Allocator_t = PayloadAllocator<56>;
+
+  // nodes of a thread which has exited by the time they are freed
+  std::vector<Payload<56>*> nodes;
+  std::thread builder([&nodes] {
+    Allocator_t allocator;
+    for (int i = 0; i < 2000; ++i)
+      nodes.push_back(allocator.allocate(1));
+  });
+  builder.join();
+
+  std::size_t const nChunks = Allocator_t::numChunks();
+  BOOST_TEST(nChunks > 0U);
+
+  Allocator_t allocator;
+  for (auto* node : nodes)
+    allocator.deallocate(node, 1);
+  BOOST_TEST(Allocator_t::numChunks() == nChunks);
+
+  reco::ReleasePooledMemory();
+  BOOST_TEST(Allocator_t::numChunks() == 0U);
+
+  // a new thread takes over the cache left behind and gives its chunk back on release
+  std::size_t nChunksInThread = 0;
+  std::thread user([&nChunksInThread] {
+    Allocator_t allocator;
+    allocator.deallocate(allocator.allocate(1), 1);
+    nChunksInThread = Allocator_t::numChunks();
+    reco::ReleasePooledMemory();
+  });
+  user.join();
+  BOOST_TEST(nChunksInThread == 1U);
+  BOOST_TEST(Allocator_t::numChunks() == 0U);
+}
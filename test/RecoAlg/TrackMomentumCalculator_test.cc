@@ -0,0 +1,189 @@
+/**
+ * @file   TrackMomentumCalculator_test.cc
+ * @brief  Test for the lean multiple scattering methods of trkf::TrackMomentumCalculator
+ * @see    TrackMomentumCalculator.h
+ *
+ * The closed form principal axis used by the lean methods is compared with the
+ * one from TMatrixDSymEigen for covariance-like matrices in random orientations,
+ * from well separated eigenvalues to two or three (nearly) equal ones. Where
+ * the largest eigenvalue is degenerate, the axis is only required to be in its
+ * eigenspace. Then GetMomentumMultiScatterChi2Lean() and
+ * GetMomentumMultiScatterLLHDLean() are run on the same scattered muon-like
+ * tracks as GetMomentumMultiScatterChi2() and GetMomentumMultiScatterLLHD().
+ */
+
+// C/C++ standard libraries
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <utility>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (TrackMomentumCalculator_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "lardataobj/RecoBase/Track.h"
+#include "lardataobj/RecoBase/TrackTrajectory.h"
+#include "larreco/RecoAlg/TrackMomentumCalculator.h"
+
+// framework libraries
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+
+// ROOT libraries
+#include "TMatrixDSym.h"
+#include "TMatrixDSymEigen.h"
+
+namespace {
+
+  using Matrix33_t = std::array<std::array<double, 3>, 3>;
+
+  /// A random rotation matrix, from a uniformly distributed unit quaternion
+  Matrix33_t randomRotation(std::mt19937& engine)
+  {
+    std::normal_distribution<double> gaus;
+    double w = gaus(engine), x = gaus(engine), y = gaus(engine), z = gaus(engine);
+    double const norm = std::sqrt(w * w + x * x + y * y + z * z);
+    w /= norm;
+    x /= norm;
+    y /= norm;
+    z /= norm;
+    return {{{{1. - 2. * (y * y + z * z), 2. * (x * y - z * w), 2. * (x * z + y * w)}},
+             {{2. * (x * y + z * w), 1. - 2. * (x * x + z * z), 2. * (y * z - x * w)}},
+             {{2. * (x * z - y * w), 2. * (y * z + x * w), 1. - 2. * (x * x + y * y)}}}};
+  }
+
+  /// The matrix with these eigenvalues, along the columns of rotation
+  Matrix33_t withEigenvalues(Matrix33_t const& rotation, std::array<double, 3> const& lambda)
+  {
+    Matrix33_t m{};
+    for (int r = 0; r < 3; ++r)
+      for (int c = 0; c < 3; ++c)
+        for (int k = 0; k < 3; ++k)
+          m[r][c] += rotation[r][k] * lambda[k] * rotation[c][k];
+    return m;
+  }
+
+  /// A track along z with multiple scattering kinks and position smearing every 0.3 cm
+  recob::Track makeTrack(std::mt19937& engine, double length, double theta0PerStep)
+  {
+    constexpr double step = 0.3;
+    std::normal_distribution<double> kink(0., theta0PerStep);
+    std::normal_distribution<double> smear(0., 0.03);
+
+    recob::TrackTrajectory::Positions_t positions;
+    recob::TrackTrajectory::Momenta_t momenta;
+    double x = 10., y = 20., z = 30.;
+    double dx = 0.1, dy = -0.2, dz = 1.;
+    for (double s = 0.; s < length; s += step) {
+      positions.emplace_back(x + smear(engine), y + smear(engine), z + smear(engine));
+      double const norm = std::sqrt(dx * dx + dy * dy + dz * dz);
+      momenta.emplace_back(dx / norm, dy / norm, dz / norm);
+
+      x += step * dx / norm;
+      y += step * dy / norm;
+      z += step * dz / norm;
+      dx = dx / norm + kink(engine);
+      dy = dy / norm + kink(engine);
+      dz = dz / norm;
+    }
+    recob::TrackTrajectory::Flags_t flags(positions.size());
+    recob::TrackTrajectory trajectory(
+      std::move(positions), std::move(momenta), std::move(flags), false);
+    return recob::Track(std::move(trajectory), 13, -1.F, -1, {}, {}, 0);
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(PrincipalAxisTest)
+{
+  std::mt19937 engine(13579);
+
+  // largest, middle and smallest eigenvalues; the last ones are nearly or fully degenerate
+  std::vector<std::array<double, 3>> const spectra{{{4., 1., 0.25}},
+                                                   {{1., 1e-3, 1e-6}},
+                                                   {{1., 0.5, 0.5}},
+                                                   {{1., 1., 0.}},
+                                                   {{1.1, 1., 1.}},
+                                                   {{1. + 1e-6, 1., 0.1}},
+                                                   {{1. + 1e-6, 1., 1.}},
+                                                   {{1. + 1e-12, 1., 0.1}},
+                                                   {{1., 1., 0.1}},
+                                                   {{1., 1., 1.}}};
+
+  for (auto const& lambda : spectra) {
+    // the eigenvector is well defined, and so compared with TMatrixDSymEigen's
+    bool const separated = (lambda[0] - lambda[1]) > 1e-8 * lambda[0];
+
+    for (int i = 0; i < 200; ++i) {
+      Matrix33_t const m = withEigenvalues(randomRotation(engine), lambda);
+
+      TMatrixDSym tm(3);
+      for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+          tm(r, c) = m[r][c];
+      TMatrixDSymEigen const eigen(tm);
+      TVectorD const eigenval = eigen.GetEigenValues();
+      TMatrixD const eigenvec = eigen.GetEigenVectors();
+      int iMax = 0;
+      for (int k = 1; k < 3; ++k)
+        if (eigenval(k) > eigenval(iMax)) iMax = k;
+
+      auto const [ax, ay, az] = trkf::details::principal_axis(m);
+      BOOST_TEST(std::hypot(ax, ay, az) == 1., boost::test_tools::tolerance(1e-12));
+
+      // m a . a is the largest eigenvalue only along its eigenspace
+      double rayleigh = 0.;
+      std::array<double, 3> const a{{ax, ay, az}};
+      for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+          rayleigh += a[r] * m[r][c] * a[c];
+      BOOST_TEST(rayleigh == eigenval(iMax), boost::test_tools::tolerance(1e-12));
+
+      if (separated) {
+        double const dot = ax * eigenvec(0, iMax) + ay * eigenvec(1, iMax) + az * eigenvec(2, iMax);
+        BOOST_TEST(std::abs(dot) == 1., boost::test_tools::tolerance(1e-9));
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(LeanMethodsTest)
+{
+  std::mt19937 engine(24680);
+  art::ProductID const trackID{1};
+
+  trkf::TrackMomentumCalculator calculator;
+
+  // scattering per step for about 0.3, 1 and 3 GeV muons, on tracks 1.5 to 4 m long
+  std::size_t key = 0;
+  for (double const theta0 : {0.009, 0.0027, 0.0009}) {
+    for (double const length : {150., 250., 400.}) {
+      recob::Track const track = makeTrack(engine, length, theta0);
+      art::Ptr<recob::Track> const ptr(trackID, &track, key++);
+
+      double const chi2 = calculator.GetMomentumMultiScatterChi2(ptr);
+      double const chi2Lean = calculator.GetMomentumMultiScatterChi2Lean(ptr);
+      BOOST_TEST(chi2 > 0.);
+      BOOST_TEST(chi2Lean == chi2, boost::test_tools::tolerance(1e-4));
+
+      double const llhd = calculator.GetMomentumMultiScatterLLHD(ptr);
+      double const llhdLean = calculator.GetMomentumMultiScatterLLHDLean(ptr);
+      BOOST_TEST(llhd > 0.);
+      BOOST_TEST(llhdLean == llhd, boost::test_tools::tolerance(1e-6));
+    }
+  }
+
+  // too short for the calculator: both fail the same way
+  recob::Track const shortTrack = makeTrack(engine, 50., 0.003);
+  art::Ptr<recob::Track> const shortPtr(trackID, &shortTrack, key++);
+  BOOST_TEST(calculator.GetMomentumMultiScatterChi2Lean(shortPtr) ==
+             calculator.GetMomentumMultiScatterChi2(shortPtr));
+  BOOST_TEST(calculator.GetMomentumMultiScatterLLHDLean(shortPtr) ==
+             calculator.GetMomentumMultiScatterLLHD(shortPtr));
+}
@@ -0,0 +1,225 @@
+/**
+ * @file   kdTree_test.cc
+ * @brief  Checks the flat kdTree against the node based one and times both
+ *
+ * Usage:
+ *
+ *     kdTree_test [HitFile]
+ *
+ * Without arguments a synthetic event (a handful of tracks plus noise) is used.
+ * A recorded set of 3D hits can be given instead as a text file with one hit per
+ * line: x y z peakTime sigmaPeakTime wireU wireV wireW
+ *
+ * The neighborhoods returned by the flat tree, both one at a time and batched,
+ * must be identical (content and order) to those of the node based tree.
+ */
+
+#include "fhiclcpp/ParameterSet.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+  constexpr float kWirePitch = 0.3;
+  constexpr float kTickToCm = 0.08;
+
+  void addHit(reco::HitPairList& hitPairList,
+              const Eigen::Vector3f& position,
+              float peakTime,
+              float sigmaPeakTime,
+              const std::vector<geo::WireID>& wireIDs)
+  {
+    reco::ClusterHit2DVec hitVec(3, nullptr);
+    std::vector<float> hitDelTSigVec(3, 0.);
+
+    hitPairList.emplace_back(hitPairList.size(),
+                             0,
+                             position,
+                             1.,
+                             peakTime,
+                             0.,
+                             sigmaPeakTime,
+                             1.,
+                             1.,
+                             0.,
+                             0.,
+                             0.,
+                             hitVec,
+                             hitDelTSigVec,
+                             wireIDs);
+  }
+
+  void makeSyntheticHits(reco::HitPairList& hitPairList, size_t nTracks, size_t nNoise)
+  {
+    std::mt19937 engine(12345);
+    std::uniform_real_distribution<float> flat(0., 1.);
+    std::normal_distribution<float> smear(0., 0.1);
+
+    auto addPoint = [&](const Eigen::Vector3f& position) {
+      // Induction wires at +/- 60 degrees, collection along z
+      float u = 0.5 * position[2] - 0.866 * position[1];
+      float v = 0.5 * position[2] + 0.866 * position[1];
+      std::vector<geo::WireID> wireIDs{geo::WireID(0, 0, 0, unsigned(u / kWirePitch + 2000.)),
+                                       geo::WireID(0, 0, 1, unsigned(v / kWirePitch + 2000.)),
+                                       geo::WireID(0, 0, 2, unsigned(position[2] / kWirePitch))};
+
+      addHit(hitPairList, position, position[0] / kTickToCm, 2., wireIDs);
+    };
+
+    for (size_t track = 0; track < nTracks; track++) {
+      Eigen::Vector3f start(150. * flat(engine), 200. * flat(engine) - 100., 500. * flat(engine));
+      Eigen::Vector3f dir(flat(engine) - 0.5, flat(engine) - 0.5, flat(engine) - 0.5);
+
+      dir.normalize();
+
+      for (float arcLen = 0.; arcLen < 100.; arcLen += 0.3) {
+        Eigen::Vector3f position = start + arcLen * dir;
+
+        addPoint(position + Eigen::Vector3f(smear(engine), smear(engine), smear(engine)));
+      }
+    }
+
+    for (size_t noise = 0; noise < nNoise; noise++)
+      addPoint(
+        Eigen::Vector3f(150. * flat(engine), 200. * flat(engine) - 100., 500. * flat(engine)));
+  }
+
+  bool readHits(const char* fileName, reco::HitPairList& hitPairList)
+  {
+    std::ifstream hitFile(fileName);
+
+    if (!hitFile) return false;
+
+    float x, y, z, peakTime, sigmaPeakTime;
+    unsigned wireU, wireV, wireW;
+
+    while (hitFile >> x >> y >> z >> peakTime >> sigmaPeakTime >> wireU >> wireV >> wireW)
+      addHit(hitPairList,
+             Eigen::Vector3f(x, y, z),
+             peakTime,
+             sigmaPeakTime,
+             {geo::WireID(0, 0, 0, wireU), geo::WireID(0, 0, 1, wireV), geo::WireID(0, 0, 2, wireW)});
+
+    return true;
+  }
+
+  double elapsed(std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+  }
+
+} // namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char const** argv)
+{
+  int nErrors(0);
+
+  reco::HitPairList hitPairList;
+
+  if (argc > 1) {
+    if (!readHits(argv[1], hitPairList)) {
+      std::cerr << "Unable to read hits from " << argv[1] << std::endl;
+      return 1;
+    }
+  }
+  else
+    makeSyntheticHits(hitPairList, 100, 2000);
+
+  fhicl::ParameterSet pset;
+
+  pset.put<bool>("EnableMonitoring", false);
+  pset.put<float>("RefLeafBestDist", 0.59);
+
+  lar_cluster3d::kdTree kdTree(pset);
+
+  std::cout << "Testing " << hitPairList.size() << " hits" << std::endl;
+
+  // The two starting distances used by DBScanAlg and MinSpanTreeAlg
+  for (float startDist : {std::numeric_limits<float>::max(), float(1.5)}) {
+    // Node based tree, one query at a time
+    auto start = std::chrono::steady_clock::now();
+
+    lar_cluster3d::kdTree::KdTreeNodeList kdTreeNodeContainer;
+    lar_cluster3d::kdTree::KdTreeNode topNode =
+      kdTree.BuildKdTree(hitPairList, kdTreeNodeContainer);
+
+    double nodeBuildTime = elapsed(start);
+
+    std::vector<lar_cluster3d::kdTree::CandPairList> nodeResults;
+
+    nodeResults.reserve(hitPairList.size());
+
+    for (const auto& hit : hitPairList) {
+      float bestDist(startDist);
+
+      nodeResults.emplace_back();
+      kdTree.FindNearestNeighbors(&hit, topNode, nodeResults.back(), bestDist);
+    }
+
+    double nodeTotalTime = elapsed(start);
+
+    // Flat tree, one query at a time
+    start = std::chrono::steady_clock::now();
+
+    lar_cluster3d::kdTree::FlatKdTree flatKdTree;
+
+    kdTree.BuildFlatKdTree(hitPairList, flatKdTree);
+
+    double flatBuildTime = elapsed(start);
+
+    std::vector<lar_cluster3d::kdTree::CandPairVec> flatResults(flatKdTree.size());
+
+    for (size_t idx = 0; idx < flatKdTree.size(); idx++) {
+      float bestDist(startDist);
+
+      kdTree.FindNearestNeighbors(idx, flatKdTree, flatResults[idx], bestDist);
+    }
+
+    double flatTotalTime = elapsed(start);
+
+    // Flat tree, batched
+    start = std::chrono::steady_clock::now();
+
+    std::vector<lar_cluster3d::kdTree::CandPairVec> batchResults;
+
+    kdTree.FindAllNearestNeighbors(flatKdTree, batchResults, startDist);
+
+    double batchQueryTime = elapsed(start);
+
+    size_t nNeighbors(0);
+
+    for (size_t idx = 0; idx < hitPairList.size(); idx++) {
+      const auto& nodeResult = nodeResults[idx];
+      bool same = nodeResult.size() == flatResults[idx].size() &&
+                  std::equal(nodeResult.begin(), nodeResult.end(), flatResults[idx].begin()) &&
+                  flatResults[idx] == batchResults[idx];
+
+      if (!same) {
+        if (nErrors < 10)
+          std::cerr << "Neighborhood mismatch for hit " << idx << ", start distance " << startDist
+                    << std::endl;
+        nErrors++;
+      }
+
+      nNeighbors += nodeResult.size();
+    }
+
+    std::cout << "Start distance " << startDist << ", " << nNeighbors << " neighbors\n"
+              << "  node tree: build " << nodeBuildTime << " ms, build + queries "
+              << nodeTotalTime << " ms\n"
+              << "  flat tree: build " << flatBuildTime << " ms, build + queries "
+              << flatTotalTime << " ms, batched queries " << batchQueryTime << " ms" << std::endl;
+  }
+
+  return nErrors;
+}
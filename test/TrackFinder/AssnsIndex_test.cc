@@ -0,0 +1,148 @@
+/**
+ * @file   AssnsIndex_test.cc
+ * @brief  Test for trkf::AssnsIndex
+ * @see    AssnsIndex.h
+ *
+ * The hits of each track are looked up by track pointer and by track key, and
+ * compared with a scan of the whole association. Associations written one
+ * track at a time give the same hits as the scans the Kalman fitters used,
+ * which stopped at the end of the first contiguous run of a track. When the
+ * hits of a track are split in more runs, the index returns all of them, in
+ * association order. Look up by pointer also tells apart tracks with the same
+ * key from different data products, look up by key does not.
+ */
+
+// C/C++ standard libraries
+#include <cstddef>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE (AssnsIndex_test)
+#include "boost/test/unit_test.hpp"
+
+// LArSoft libraries
+#include "lardataobj/RecoBase/Hit.h"
+#include "lardataobj/RecoBase/Track.h"
+#include "larreco/TrackFinder/AssnsIndex.h"
+
+// framework libraries
+#include "canvas/Persistency/Common/Assns.h"
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+
+namespace {
+
+  using TrackPtr_t = art::Ptr<recob::Track>;
+  using HitPtr_t = art::Ptr<recob::Hit>;
+  using Assns_t = art::Assns<recob::Track, recob::Hit>;
+  using Index_t = trkf::AssnsIndex<recob::Track, recob::Hit>;
+
+  art::ProductID const trackID{1};
+  art::ProductID const otherTrackID{2};
+  art::ProductID const hitID{3};
+
+  TrackPtr_t track(std::size_t key, art::ProductID id = trackID)
+  {
+    return TrackPtr_t(id, key, nullptr);
+  }
+
+  HitPtr_t hit(std::size_t key) { return HitPtr_t(hitID, key, nullptr); }
+
+  /// The hits of the track in association order, from a scan of all the pairs
+  std::vector<HitPtr_t> allPairs(Assns_t const& assns, TrackPtr_t const& trk)
+  {
+    std::vector<HitPtr_t> hits;
+    for (auto const& assn : assns)
+      if (assn.first == trk) hits.push_back(assn.second);
+    return hits;
+  }
+
+  /// The hits of the track as the fitters used to scan them: the first contiguous run
+  std::vector<HitPtr_t> firstRun(Assns_t const& assns, TrackPtr_t const& trk)
+  {
+    std::vector<HitPtr_t> hits;
+    for (auto const& assn : assns) {
+      if (assn.first == trk)
+        hits.push_back(assn.second);
+      else if (!hits.empty())
+        break;
+    }
+    return hits;
+  }
+
+} // local namespace
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(OneTrackAtATimeTest)
+{
+  // tracks 0, 2 and 5 with hits, written one track at a time out of key order
+  Assns_t assns;
+  for (std::size_t h : {7, 3, 9})
+    assns.addSingle(track(2), hit(h));
+  for (std::size_t h : {1, 4})
+    assns.addSingle(track(0), hit(h));
+  for (std::size_t h : {8, 2, 6, 5})
+    assns.addSingle(track(5), hit(h));
+
+  Index_t const index(assns);
+  for (std::size_t key = 0; key < 8; ++key) {
+    auto const expected = firstRun(assns, track(key));
+    BOOST_CHECK(expected == allPairs(assns, track(key)));
+    BOOST_CHECK(index.at(track(key)) == expected);
+    BOOST_CHECK(index.at(key) == expected);
+  }
+  BOOST_TEST(index.at(track(5)).size() == 4U);
+  BOOST_TEST(index.at(track(1)).empty());
+  BOOST_TEST(index.at(track(6)).empty()); // past the last key
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(SplitRunsTest)
+{
+  // the hits of track 1 in two runs, with a hit of track 3 between them
+  Assns_t assns;
+  assns.addSingle(track(1), hit(10));
+  assns.addSingle(track(1), hit(11));
+  assns.addSingle(track(3), hit(20));
+  assns.addSingle(track(1), hit(12));
+  assns.addSingle(track(3), hit(21));
+
+  Index_t const index(assns);
+
+  std::vector<HitPtr_t> const expected{hit(10), hit(11), hit(12)};
+  BOOST_CHECK(allPairs(assns, track(1)) == expected);
+  BOOST_CHECK(index.at(track(1)) == expected);
+  BOOST_CHECK(index.at(1) == expected);
+
+  // the scans stopped at the end of the first run
+  BOOST_TEST(firstRun(assns, track(1)).size() == 2U);
+  BOOST_TEST(firstRun(assns, track(3)).size() == 1U);
+  BOOST_CHECK(index.at(track(3)) == allPairs(assns, track(3)));
+
+  // append() adds after what is already there
+  std::vector<HitPtr_t> hits{hit(0)};
+  index.append(track(3), hits);
+  index.append(track(1), hits);
+  std::vector<HitPtr_t> const appended{hit(0), hit(20), hit(21), hit(10), hit(11), hit(12)};
+  BOOST_CHECK(hits == appended);
+}
+
+//------------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE(SameKeyOtherProductTest)
+{
+  // tracks with key 0 from two data products
+  Assns_t assns;
+  assns.addSingle(track(0), hit(1));
+  assns.addSingle(track(0, otherTrackID), hit(2));
+  assns.addSingle(track(0), hit(3));
+
+  Index_t const index(assns);
+
+  std::vector<HitPtr_t> const expected{hit(1), hit(3)};
+  BOOST_CHECK(index.at(track(0)) == expected);
+  BOOST_CHECK(index.at(track(0, otherTrackID)) == std::vector<HitPtr_t>{hit(2)});
+
+  // by key, the pairs of both products
+  std::vector<HitPtr_t> const byKey{hit(1), hit(2), hit(3)};
+  BOOST_CHECK(index.at(0) == byKey);
+}